@@ -490,3 +490,169 @@ nm_dispatcher_utils_construct_envp (const char *action,
 	return envp;
 }
 
+/*****************************************************************************/
+
+/**
+ * nm_dispatcher_utils_script_get_group:
+ * @path: the path of a dispatcher script
+ *
+ * Returns: the number the file name of @path starts with, or -1 if
+ *   it doesn't start with a digit.
+ */
+gint64
+nm_dispatcher_utils_script_get_group (const char *path)
+{
+	const char *name;
+	gint64 group = 0;
+
+	name = strrchr (path, '/');
+	name = name ? name + 1 : path;
+
+	if (!g_ascii_isdigit (name[0]))
+		return -1;
+
+	for (; g_ascii_isdigit (name[0]); name++) {
+		group = group * 10 + (name[0] - '0');
+		if (group > G_MAXINT32)
+			return G_MAXINT32;
+	}
+	return group;
+}
+
+/**
+ * nm_dispatcher_utils_scripts_next_parallel:
+ * @scripts: the scripts of a request, in the order of execution
+ * @len: the number of @scripts
+ *
+ * Scripts whose name starts with a number only start after all "wait"
+ * scripts with a lower number completed. Scripts with the same number,
+ * and scripts without a number, don't wait for each other. "no-wait"
+ * scripts are not considered.
+ *
+ * Returns: the index of the next "wait" script that may be started,
+ *   or -1 if there is none.
+ */
+int
+nm_dispatcher_utils_scripts_next_parallel (const NMDispatcherScriptState *const*scripts,
+                                           guint len)
+{
+	gint64 min_group = G_MAXINT64;
+	guint i;
+
+	for (i = 0; i < len; i++) {
+		if (   scripts[i]->wait
+		    && !scripts[i]->done
+		    && scripts[i]->group >= 0)
+			min_group = MIN (min_group, scripts[i]->group);
+	}
+
+	for (i = 0; i < len; i++) {
+		if (   scripts[i]->wait
+		    && !scripts[i]->dispatched
+		    && scripts[i]->group <= min_group)
+			return i;
+	}
+	return -1;
+}
+
+/*****************************************************************************/
+
+/* Run time statistics per script, as histogram of the latency. The
+ * last bucket counts all runs longer than the largest bound. */
+static const guint32 stats_bucket_bounds_msec[] = { 10, 50, 100, 500, 1000, 5000, 10000, 60000 };
+
+#define STATS_N_BUCKETS (G_N_ELEMENTS (stats_bucket_bounds_msec) + 1)
+
+typedef struct {
+	guint32 count;
+	guint64 total_usec;
+	guint64 max_usec;
+	guint32 buckets[STATS_N_BUCKETS];
+} ScriptStats;
+
+/**
+ * nm_dispatcher_utils_stats_new:
+ *
+ * Returns: a new table for the run time statistics, mapping the path
+ *   of a script to its statistics.
+ */
+GHashTable *
+nm_dispatcher_utils_stats_new (void)
+{
+	return g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+void
+nm_dispatcher_utils_stats_record (GHashTable *stats,
+                                  const char *path,
+                                  guint64 usec)
+{
+	ScriptStats *script_stats;
+	guint i;
+
+	g_return_if_fail (stats);
+	g_return_if_fail (path);
+
+	script_stats = g_hash_table_lookup (stats, path);
+	if (!script_stats) {
+		script_stats = g_new0 (ScriptStats, 1);
+		g_hash_table_insert (stats, g_strdup (path), script_stats);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (stats_bucket_bounds_msec); i++) {
+		if (usec <= (guint64) stats_bucket_bounds_msec[i] * 1000)
+			break;
+	}
+	script_stats->buckets[i]++;
+	script_stats->count++;
+	script_stats->total_usec += usec;
+	script_stats->max_usec = MAX (script_stats->max_usec, usec);
+}
+
+/**
+ * nm_dispatcher_utils_stats_get:
+ * @stats: (allow-none): the statistics
+ * @out_bucket_bounds: the upper bounds of the histogram buckets, as "au"
+ * @out_scripts: the statistics per script, as "a(suttau)"
+ *
+ * Returns the statistics in the format of the GetStatistics D-Bus
+ * method. The returned variants are floating.
+ */
+void
+nm_dispatcher_utils_stats_get (GHashTable *stats,
+                               GVariant **out_bucket_bounds,
+                               GVariant **out_scripts)
+{
+	GVariantBuilder bounds;
+	GVariantBuilder scripts;
+	GHashTableIter iter;
+	const char *path;
+	ScriptStats *script_stats;
+	guint i;
+
+	g_return_if_fail (out_bucket_bounds);
+	g_return_if_fail (out_scripts);
+
+	g_variant_builder_init (&bounds, G_VARIANT_TYPE ("au"));
+	for (i = 0; i < G_N_ELEMENTS (stats_bucket_bounds_msec); i++)
+		g_variant_builder_add (&bounds, "u", stats_bucket_bounds_msec[i]);
+
+	g_variant_builder_init (&scripts, G_VARIANT_TYPE ("a(suttau)"));
+	if (stats) {
+		g_hash_table_iter_init (&iter, stats);
+		while (g_hash_table_iter_next (&iter, (gpointer *) &path, (gpointer *) &script_stats)) {
+			g_variant_builder_add (&scripts, "(sutt@au)",
+			                       path,
+			                       script_stats->count,
+			                       script_stats->total_usec,
+			                       script_stats->max_usec,
+			                       g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32,
+			                                                  script_stats->buckets,
+			                                                  STATS_N_BUCKETS,
+			                                                  sizeof (guint32)));
+		}
+	}
+
+	*out_bucket_bounds = g_variant_builder_end (&bounds);
+	*out_scripts = g_variant_builder_end (&scripts);
+}
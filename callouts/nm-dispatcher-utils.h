@@ -39,5 +39,29 @@ nm_dispatcher_utils_construct_envp (const char *action,
                                     char **out_iface,
                                     const char **out_error_message);
 
+/* The scheduling state of a script of a request. */
+typedef struct {
+	/* the numeric prefix of the script name, or -1 if it has none. */
+	gint64 group;
+	gboolean wait;
+	gboolean dispatched;
+	gboolean done;
+} NMDispatcherScriptState;
+
+gint64 nm_dispatcher_utils_script_get_group (const char *path);
+
+int nm_dispatcher_utils_scripts_next_parallel (const NMDispatcherScriptState *const*scripts,
+                                               guint len);
+
+GHashTable *nm_dispatcher_utils_stats_new (void);
+
+void nm_dispatcher_utils_stats_record (GHashTable *stats,
+                                       const char *path,
+                                       guint64 usec);
+
+void nm_dispatcher_utils_stats_get (GHashTable *stats,
+                                    GVariant **out_bucket_bounds,
+                                    GVariant **out_scripts);
+
 #endif  /* __NETWORKMANAGER_DISPATCHER_UTILS_H__ */
 
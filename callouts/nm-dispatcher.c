@@ -38,9 +38,13 @@
 
 #include "nmdbus-dispatcher.h"
 
+#define SCRIPT_TIMEOUT 600  /* 10 minutes */
+
 static GMainLoop *loop = NULL;
 static gboolean debug = FALSE;
 static gboolean persist = FALSE;
+static int max_parallel = 1;
+static int script_timeout = SCRIPT_TIMEOUT;
 static guint quit_id;
 static guint request_id_counter = 0;
 
@@ -87,6 +91,17 @@ handle_action (NMDBusDispatcher *dbus_dispatcher,
                gboolean request_debug,
                gpointer user_data);
 
+static gboolean
+handle_action_batch (NMDBusDispatcher *dbus_dispatcher,
+                     GDBusMethodInvocation *context,
+                     GVariant *events,
+                     gpointer user_data);
+
+static gboolean
+handle_get_statistics (NMDBusDispatcher *dbus_dispatcher,
+                       GDBusMethodInvocation *context,
+                       gpointer user_data);
+
 static void
 handler_init (Handler *h)
 {
@@ -94,6 +109,10 @@ handler_init (Handler *h)
 	h->dbus_dispatcher = nmdbus_dispatcher_skeleton_new ();
 	g_signal_connect (h->dbus_dispatcher, "handle-action",
 	                  G_CALLBACK (handle_action), h);
+	g_signal_connect (h->dbus_dispatcher, "handle-action-batch",
+	                  G_CALLBACK (handle_action_batch), h);
+	g_signal_connect (h->dbus_dispatcher, "handle-get-statistics",
+	                  G_CALLBACK (handle_get_statistics), h);
 }
 
 static void
@@ -104,24 +123,41 @@ handler_class_init (HandlerClass *h_class)
 static gboolean dispatch_one_script (Request *request);
 
 typedef struct {
+	/* must be the first field, see dispatch_parallel_scripts(). */
+	NMDispatcherScriptState state;
+
 	Request *request;
 
 	char *script;
 	GPid pid;
 	DispatchResult result;
 	char *error;
-	gboolean wait;
-	gboolean dispatched;
 	guint watch_id;
 	guint timeout_id;
+
+	gint64 start_time;
 } ScriptInfo;
 
+/* The events of one ActionBatch call. Each event becomes a separate
+ * request, and the call is answered once all requests completed. */
+typedef struct {
+	NMDBusDispatcher *dbus_dispatcher;
+	GDBusMethodInvocation *context;
+	GVariant **results;
+	guint n_events;
+	guint n_pending;
+} Batch;
+
 struct Request {
 	Handler *handler;
 
 	guint request_id;
 
+	/* Either @context, or @batch and the index of the request in it. */
 	GDBusMethodInvocation *context;
+	Batch *batch;
+	guint batch_idx;
+
 	char *action;
 	char *iface;
 	char **envp;
@@ -131,6 +167,7 @@ struct Request {
 	guint idx;
 	gint num_scripts_done;
 	gint num_scripts_nowait;
+	guint num_scripts_running;  /* "wait" scripts currently running */
 };
 
 /*****************************************************************************/
@@ -184,6 +221,42 @@ _LOG_R_D_enabled (const Request *request)
 
 /*****************************************************************************/
 
+static GHashTable *script_stats;
+
+static void
+script_stats_record (const ScriptInfo *script)
+{
+	guint64 usec;
+
+	if (G_UNLIKELY (!script_stats))
+		script_stats = nm_dispatcher_utils_stats_new ();
+
+	usec = MAX (g_get_monotonic_time () - script->start_time, 0);
+	nm_dispatcher_utils_stats_record (script_stats, script->script, usec);
+
+	_LOG_S_D (script, "run time %llu.%03llu msec",
+	          (unsigned long long) (usec / 1000),
+	          (unsigned long long) (usec % 1000));
+}
+
+static gboolean
+handle_get_statistics (NMDBusDispatcher *dbus_dispatcher,
+                       GDBusMethodInvocation *context,
+                       gpointer user_data)
+{
+	GVariant *bucket_bounds;
+	GVariant *scripts;
+
+	nm_dispatcher_utils_stats_get (script_stats, &bucket_bounds, &scripts);
+	nmdbus_dispatcher_complete_get_statistics (dbus_dispatcher,
+	                                           context,
+	                                           bucket_bounds,
+	                                           scripts);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
 static void
 script_info_free (gpointer ptr)
 {
@@ -265,6 +338,41 @@ next_request (Handler *h, Request *request)
 	return TRUE;
 }
 
+static void
+batch_complete_event (Batch *batch, guint idx, GVariant *results)
+{
+	GVariantBuilder builder;
+	guint i;
+
+	nm_assert (idx < batch->n_events);
+	nm_assert (!batch->results[idx]);
+	nm_assert (batch->n_pending > 0);
+
+	batch->results[idx] = g_variant_ref_sink (results);
+	if (--batch->n_pending > 0)
+		return;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa(sus)"));
+	for (i = 0; i < batch->n_events; i++) {
+		g_variant_builder_add_value (&builder, batch->results[i]);
+		g_variant_unref (batch->results[i]);
+	}
+	nmdbus_dispatcher_complete_action_batch (batch->dbus_dispatcher,
+	                                         batch->context,
+	                                         g_variant_builder_end (&builder));
+	g_free (batch->results);
+	g_slice_free (Batch, batch);
+}
+
+static void
+request_return (Request *request, GVariant *results)
+{
+	if (request->batch)
+		batch_complete_event (request->batch, request->batch_idx, results);
+	else
+		g_dbus_method_invocation_return_value (request->context, g_variant_new ("(@a(sus))", results));
+}
+
 /**
  * complete_request:
  * @request: the request
@@ -278,7 +386,6 @@ static void
 complete_request (Request *request)
 {
 	GVariantBuilder results;
-	GVariant *ret;
 	guint i;
 	Handler *handler = request->handler;
 
@@ -298,8 +405,7 @@ complete_request (Request *request)
 		                       script->error ? script->error : "");
 	}
 
-	ret = g_variant_new ("(a(sus))", &results);
-	g_dbus_method_invocation_return_value (request->context, ret);
+	request_return (request, g_variant_builder_end (&results));
 
 	_LOG_R_D (request, "completed (%u scripts)", request->scripts->len);
 
@@ -320,7 +426,7 @@ complete_script (ScriptInfo *script)
 {
 	Handler *handler;
 	Request *request;
-	gboolean wait = script->wait;
+	gboolean wait = script->state.wait;
 
 	request = script->request;
 
@@ -363,8 +469,8 @@ complete_script (ScriptInfo *script)
 		 *
 		 * Also, it cannot be that there is another request currently being
 		 * processed because only requests with "wait" scripts can become
-		 * @current_request. As there can only be one "wait" script running
-		 * at any time, it means complete_request() above completed @request. */
+		 * @current_request. As dispatch_one_script() found no "wait" script
+		 * running, it means complete_request() above completed @request. */
 		nm_assert (!handler->current_request);
 	}
 
@@ -394,9 +500,14 @@ script_watch_cb (GPid pid, gint status, gpointer user_data)
 
 	script->watch_id = 0;
 	nm_clear_g_source (&script->timeout_id);
+	script->state.done = TRUE;
 	script->request->num_scripts_done++;
-	if (!script->wait)
+	if (!script->state.wait)
 		script->request->num_scripts_nowait--;
+	else
+		script->request->num_scripts_running--;
+
+	script_stats_record (script);
 
 	if (WIFEXITED (status)) {
 		err = WEXITSTATUS (status);
@@ -436,9 +547,12 @@ script_timeout_cb (gpointer user_data)
 
 	script->timeout_id = 0;
 	nm_clear_g_source (&script->watch_id);
+	script->state.done = TRUE;
 	script->request->num_scripts_done++;
-	if (!script->wait)
+	if (!script->state.wait)
 		script->request->num_scripts_nowait--;
+	else
+		script->request->num_scripts_running--;
 
 	_LOG_S_W (script, "complete: timeout (kill script)");
 
@@ -454,6 +568,8 @@ again:
 
 	g_spawn_close_pid (script->pid);
 
+	script_stats_record (script);
+
 	complete_script (script);
 
 	return FALSE;
@@ -520,8 +636,6 @@ check_filename (const char *file_name)
 	return TRUE;
 }
 
-#define SCRIPT_TIMEOUT 600  /* 10 minutes */
-
 static gboolean
 script_dispatch (ScriptInfo *script)
 {
@@ -529,10 +643,10 @@ script_dispatch (ScriptInfo *script)
 	gchar *argv[4];
 	Request *request = script->request;
 
-	if (script->dispatched)
+	if (script->state.dispatched)
 		return FALSE;
 
-	script->dispatched = TRUE;
+	script->state.dispatched = TRUE;
 
 	argv[0] = script->script;
 	argv[1] = request->iface
@@ -541,30 +655,75 @@ script_dispatch (ScriptInfo *script)
 	argv[2] = request->action;
 	argv[3] = NULL;
 
-	_LOG_S_D (script, "run script%s", script->wait ? "" : " (no-wait)");
+	_LOG_S_D (script, "run script%s", script->state.wait ? "" : " (no-wait)");
 
+	script->start_time = g_get_monotonic_time ();
 	if (g_spawn_async ("/", argv, request->envp, G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &script->pid, &error)) {
 		script->watch_id = g_child_watch_add (script->pid, (GChildWatchFunc) script_watch_cb, script);
-		script->timeout_id = g_timeout_add_seconds (SCRIPT_TIMEOUT, script_timeout_cb, script);
-		if (!script->wait)
+		script->timeout_id = g_timeout_add_seconds (script_timeout, script_timeout_cb, script);
+		if (!script->state.wait)
 			request->num_scripts_nowait++;
+		else
+			request->num_scripts_running++;
 		return TRUE;
 	} else {
 		_LOG_S_W (script, "complete: failed to execute script: %s", error->message);
 		script->result = DISPATCH_RESULT_EXEC_FAILED;
 		script->error = g_strdup (error->message);
+		script->state.done = TRUE;
 		request->num_scripts_done++;
 		g_clear_error (&error);
 		return FALSE;
 	}
 }
 
+/**
+ * dispatch_parallel_scripts:
+ * @request: the request
+ *
+ * Starts as many "wait" scripts of @request as allowed by --parallel,
+ * in the order given by nm_dispatcher_utils_scripts_next_parallel().
+ *
+ * Returns: %TRUE, if there are "wait" scripts running.
+ */
+static gboolean
+dispatch_parallel_scripts (Request *request)
+{
+	int i;
+
+	while (request->num_scripts_running < (guint) max_parallel) {
+		i = nm_dispatcher_utils_scripts_next_parallel ((const NMDispatcherScriptState *const*) request->scripts->pdata,
+		                                               request->scripts->len);
+		if (i < 0)
+			break;
+
+		/* A script that fails to execute is done right away,
+		 * which might allow the next group to start. */
+		script_dispatch (g_ptr_array_index (request->scripts, i));
+	}
+
+	return request->num_scripts_running > 0;
+}
+
+/**
+ * dispatch_one_script:
+ * @request: the request
+ *
+ * Starts the next "wait" script of @request, once all "no-wait" scripts
+ * of the request completed. With --parallel, starts several scripts
+ * at once.
+ *
+ * Returns: %TRUE, if the request must wait for running scripts.
+ */
 static gboolean
 dispatch_one_script (Request *request)
 {
 	if (request->num_scripts_nowait > 0)
 		return TRUE;
 
+	if (max_parallel > 1)
+		return dispatch_parallel_scripts (request);
+
 	while (request->idx < request->scripts->len) {
 		ScriptInfo *script;
 
@@ -575,29 +734,174 @@ dispatch_one_script (Request *request)
 	return FALSE;
 }
 
-static GSList *
-find_scripts (const char *str_action)
+static gboolean
+script_must_wait (const char *path)
+{
+	gs_free char *link = NULL;
+	gs_free char *dir = NULL;
+	gs_free char *real = NULL;
+	char *tmp;
+
+	link = g_file_read_link (path, NULL);
+	if (link) {
+		if (!g_path_is_absolute (link)) {
+			dir = g_path_get_dirname (path);
+			tmp = g_build_path ("/", dir, link, NULL);
+			g_free (link);
+			g_free (dir);
+			link = tmp;
+		}
+
+		dir = g_path_get_dirname (link);
+		real = realpath (dir, NULL);
+
+		if (real && !strcmp (real, NMD_SCRIPT_DIR_NO_WAIT))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	char *path;
+	gboolean wait;
+	gint64 group;
+} ScriptEntry;
+
+typedef enum {
+	SCRIPT_DIR_DEFAULT,
+	SCRIPT_DIR_PRE_UP,
+	SCRIPT_DIR_PRE_DOWN,
+	_SCRIPT_DIR_NUM_LISTED,
+
+	/* only monitored, because it affects script_must_wait() and
+	 * the permissions of the scripts linking there. */
+	SCRIPT_DIR_NO_WAIT = _SCRIPT_DIR_NUM_LISTED,
+	_SCRIPT_DIR_NUM,
+} ScriptDir;
+
+static const char *const script_dirs[_SCRIPT_DIR_NUM] = {
+	[SCRIPT_DIR_DEFAULT]  = NMD_SCRIPT_DIR_DEFAULT,
+	[SCRIPT_DIR_PRE_UP]   = NMD_SCRIPT_DIR_PRE_UP,
+	[SCRIPT_DIR_PRE_DOWN] = NMD_SCRIPT_DIR_PRE_DOWN,
+	[SCRIPT_DIR_NO_WAIT]  = NMD_SCRIPT_DIR_NO_WAIT,
+};
+
+/* The scripts of each directory are only looked up once and cached
+ * until a change in one of the directories is noticed. Changes to
+ * scripts linking outside of the monitored directories are not noticed. */
+static struct {
+	gboolean monitor_tried;
+	gboolean monitoring;
+	GFileMonitor *monitors[_SCRIPT_DIR_NUM];
+	GPtrArray *scripts[_SCRIPT_DIR_NUM_LISTED];  /* list of ScriptEntry */
+} script_cache;
+
+static void
+script_entry_free (gpointer data)
+{
+	ScriptEntry *entry = data;
+
+	g_free (entry->path);
+	g_slice_free (ScriptEntry, entry);
+}
+
+static int
+script_entry_cmp (gconstpointer a, gconstpointer b)
+{
+	const ScriptEntry *entry_a = *((const ScriptEntry **) a);
+	const ScriptEntry *entry_b = *((const ScriptEntry **) b);
+
+	return strcmp (entry_a->path, entry_b->path);
+}
+
+static void
+script_cache_invalidate (void)
+{
+	guint i;
+
+	for (i = 0; i < _SCRIPT_DIR_NUM_LISTED; i++)
+		g_clear_pointer (&script_cache.scripts[i], g_ptr_array_unref);
+}
+
+static void
+script_cache_changed_cb (GFileMonitor *monitor,
+                         GFile *file,
+                         GFile *other_file,
+                         GFileMonitorEvent event_type,
+                         gpointer user_data)
+{
+	if (debug) {
+		gs_free char *path = g_file_get_path (file);
+
+		g_debug ("find-scripts: '%s' changed, invalidate cache", path);
+	}
+	script_cache_invalidate ();
+}
+
+static void
+script_cache_clear (void)
+{
+	guint i;
+
+	script_cache_invalidate ();
+	for (i = 0; i < _SCRIPT_DIR_NUM; i++) {
+		if (script_cache.monitors[i]) {
+			g_signal_handlers_disconnect_by_func (script_cache.monitors[i], script_cache_changed_cb, NULL);
+			g_file_monitor_cancel (script_cache.monitors[i]);
+			g_clear_object (&script_cache.monitors[i]);
+		}
+	}
+	script_cache.monitoring = FALSE;
+}
+
+static gboolean
+script_cache_monitor (void)
+{
+	guint i;
+
+	if (script_cache.monitor_tried)
+		return script_cache.monitoring;
+	script_cache.monitor_tried = TRUE;
+
+	for (i = 0; i < _SCRIPT_DIR_NUM; i++) {
+		gs_unref_object GFile *file = NULL;
+		GError *error = NULL;
+
+		file = g_file_new_for_path (script_dirs[i]);
+		script_cache.monitors[i] = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, &error);
+		if (!script_cache.monitors[i]) {
+			g_message ("find-scripts: Failed to monitor dispatcher directory '%s', don't cache scripts: %s",
+			           script_dirs[i], error->message);
+			g_error_free (error);
+			script_cache_clear ();
+			return FALSE;
+		}
+		g_signal_connect (script_cache.monitors[i], "changed",
+		                  G_CALLBACK (script_cache_changed_cb), NULL);
+	}
+
+	script_cache.monitoring = TRUE;
+	return TRUE;
+}
+
+static GPtrArray *
+read_scripts (const char *dirname)
 {
 	GDir *dir;
 	const char *filename;
-	GSList *sorted = NULL;
+	GPtrArray *scripts;
 	GError *error = NULL;
-	const char *dirname;
 
-	if (   strcmp (str_action, NMD_ACTION_PRE_UP) == 0
-	    || strcmp (str_action, NMD_ACTION_VPN_PRE_UP) == 0)
-		dirname = NMD_SCRIPT_DIR_PRE_UP;
-	else if (   strcmp (str_action, NMD_ACTION_PRE_DOWN) == 0
-	         || strcmp (str_action, NMD_ACTION_VPN_PRE_DOWN) == 0)
-		dirname = NMD_SCRIPT_DIR_PRE_DOWN;
-	else
-		dirname = NMD_SCRIPT_DIR_DEFAULT;
+	scripts = g_ptr_array_new_with_free_func (script_entry_free);
 
 	if (!(dir = g_dir_open (dirname, 0, &error))) {
 		g_message ("find-scripts: Failed to open dispatcher directory '%s': %s",
 		           dirname, error->message);
 		g_error_free (error);
-		return NULL;
+		return scripts;
 	}
 
 	while ((filename = g_dir_read_name (dir))) {
@@ -620,47 +924,56 @@ find_scripts (const char *str_action)
 			g_warning ("find-scripts: Cannot execute '%s': %s", path, err_msg);
 		else {
 			/* success */
-			sorted = g_slist_insert_sorted (sorted, path, (GCompareFunc) g_strcmp0);
+			ScriptEntry *entry;
+
+			entry = g_slice_new (ScriptEntry);
+			entry->path = path;
+			entry->wait = script_must_wait (path);
+			entry->group = nm_dispatcher_utils_script_get_group (path);
+			g_ptr_array_add (scripts, entry);
 			path = NULL;
 		}
 		g_free (path);
 	}
 	g_dir_close (dir);
 
-	return sorted;
+	g_ptr_array_sort (scripts, script_entry_cmp);
+	return scripts;
 }
 
-static gboolean
-script_must_wait (const char *path)
+static GPtrArray *
+find_scripts (const char *str_action)
 {
-	gs_free char *link = NULL;
-	gs_free char *dir = NULL;
-	gs_free char *real = NULL;
-	char *tmp;
+	ScriptDir dir_idx;
+	GPtrArray *scripts;
 
-	link = g_file_read_link (path, NULL);
-	if (link) {
-		if (!g_path_is_absolute (link)) {
-			dir = g_path_get_dirname (path);
-			tmp = g_build_path ("/", dir, link, NULL);
-			g_free (link);
-			g_free (dir);
-			link = tmp;
-		}
+	if (   strcmp (str_action, NMD_ACTION_PRE_UP) == 0
+	    || strcmp (str_action, NMD_ACTION_VPN_PRE_UP) == 0)
+		dir_idx = SCRIPT_DIR_PRE_UP;
+	else if (   strcmp (str_action, NMD_ACTION_PRE_DOWN) == 0
+	         || strcmp (str_action, NMD_ACTION_VPN_PRE_DOWN) == 0)
+		dir_idx = SCRIPT_DIR_PRE_DOWN;
+	else
+		dir_idx = SCRIPT_DIR_DEFAULT;
 
-		dir = g_path_get_dirname (link);
-		real = realpath (dir, NULL);
+	/* start monitoring before reading the directory, so that
+	 * we don't miss changes in between. */
+	if (!script_cache_monitor ())
+		return read_scripts (script_dirs[dir_idx]);
 
-		if (real && !strcmp (real, NMD_SCRIPT_DIR_NO_WAIT))
-			return FALSE;
+	scripts = script_cache.scripts[dir_idx];
+	if (!scripts) {
+		scripts = read_scripts (script_dirs[dir_idx]);
+		script_cache.scripts[dir_idx] = scripts;
 	}
-
-	return TRUE;
+	return g_ptr_array_ref (scripts);
 }
 
-static gboolean
-handle_action (NMDBusDispatcher *dbus_dispatcher,
+static void
+request_start (Handler *h,
                GDBusMethodInvocation *context,
+               Batch *batch,
+               guint batch_idx,
                const char *str_action,
                GVariant *connection_dict,
                GVariant *connection_props,
@@ -673,24 +986,23 @@ handle_action (NMDBusDispatcher *dbus_dispatcher,
                const char *vpn_ip_iface,
                GVariant *vpn_ip4_props,
                GVariant *vpn_ip6_props,
-               gboolean request_debug,
-               gpointer user_data)
+               gboolean request_debug)
 {
-	Handler *h = user_data;
-	GSList *sorted_scripts = NULL;
-	GSList *iter;
+	gs_unref_ptrarray GPtrArray *scripts = NULL;
 	Request *request;
 	char **p;
 	guint i, num_nowait = 0;
 	const char *error_message = NULL;
 
-	sorted_scripts = find_scripts (str_action);
+	scripts = find_scripts (str_action);
 
 	request = g_slice_new0 (Request);
 	request->request_id = ++request_id_counter;
 	request->handler = h;
 	request->debug = request_debug || debug;
 	request->context = context;
+	request->batch = batch;
+	request->batch_idx = batch_idx;
 	request->action = g_strdup (str_action);
 
 	request->envp = nm_dispatcher_utils_construct_envp (str_action,
@@ -708,17 +1020,18 @@ handle_action (NMDBusDispatcher *dbus_dispatcher,
 	                                                    &request->iface,
 	                                                    &error_message);
 
-	request->scripts = g_ptr_array_new_full (5, script_info_free);
-	for (iter = sorted_scripts; iter; iter = g_slist_next (iter)) {
+	request->scripts = g_ptr_array_new_full (scripts->len, script_info_free);
+	for (i = 0; i < scripts->len; i++) {
+		const ScriptEntry *entry = scripts->pdata[i];
 		ScriptInfo *s;
 
 		s = g_slice_new0 (ScriptInfo);
 		s->request = request;
-		s->script = iter->data;
-		s->wait = script_must_wait (s->script);
+		s->script = g_strdup (entry->path);
+		s->state.wait = entry->wait;
+		s->state.group = entry->group;
 		g_ptr_array_add (request->scripts, s);
 	}
-	g_slist_free (sorted_scripts);
 
 	_LOG_R_I (request, "new request (%u scripts)", request->scripts->len);
 	if (   _LOG_R_D_enabled (request)
@@ -728,18 +1041,15 @@ handle_action (NMDBusDispatcher *dbus_dispatcher,
 	}
 
 	if (error_message || request->scripts->len == 0) {
-		GVariant *results;
-
 		if (error_message)
 			_LOG_R_W (request, "completed: invalid request: %s", error_message);
 		else
 			_LOG_R_I (request, "completed: no scripts");
 
-		results = g_variant_new_array (G_VARIANT_TYPE ("(sus)"), NULL, 0);
-		g_dbus_method_invocation_return_value (context, g_variant_new ("(@a(sus))", results));
+		request_return (request, g_variant_new_array (G_VARIANT_TYPE ("(sus)"), NULL, 0));
 		request->num_scripts_done = request->scripts->len;
 		request_free (request);
-		return TRUE;
+		return;
 	}
 
 	nm_clear_g_source (&quit_id);
@@ -749,7 +1059,7 @@ handle_action (NMDBusDispatcher *dbus_dispatcher,
 	for (i = 0; i < request->scripts->len; i++) {
 		ScriptInfo *s = g_ptr_array_index (request->scripts, i);
 
-		if (!s->wait) {
+		if (!s->state.wait) {
 			script_dispatch (s);
 			num_nowait++;
 		}
@@ -787,6 +1097,115 @@ handle_action (NMDBusDispatcher *dbus_dispatcher,
 		 * that have any "wait" scripts. */
 		complete_request (request);
 	}
+}
+
+static gboolean
+handle_action (NMDBusDispatcher *dbus_dispatcher,
+               GDBusMethodInvocation *context,
+               const char *str_action,
+               GVariant *connection_dict,
+               GVariant *connection_props,
+               GVariant *device_props,
+               GVariant *device_ip4_props,
+               GVariant *device_ip6_props,
+               GVariant *device_dhcp4_props,
+               GVariant *device_dhcp6_props,
+               const char *connectivity_state,
+               const char *vpn_ip_iface,
+               GVariant *vpn_ip4_props,
+               GVariant *vpn_ip6_props,
+               gboolean request_debug,
+               gpointer user_data)
+{
+	request_start (user_data, context, NULL, 0,
+	               str_action,
+	               connection_dict,
+	               connection_props,
+	               device_props,
+	               device_ip4_props,
+	               device_ip6_props,
+	               device_dhcp4_props,
+	               device_dhcp6_props,
+	               connectivity_state,
+	               vpn_ip_iface,
+	               vpn_ip4_props,
+	               vpn_ip6_props,
+	               request_debug);
+	return TRUE;
+}
+
+static gboolean
+handle_action_batch (NMDBusDispatcher *dbus_dispatcher,
+                     GDBusMethodInvocation *context,
+                     GVariant *events,
+                     gpointer user_data)
+{
+	Handler *h = user_data;
+	Batch *batch;
+	GVariantIter iter;
+	guint i;
+
+	if (g_variant_n_children (events) == 0) {
+		nmdbus_dispatcher_complete_action_batch (dbus_dispatcher, context,
+		                                         g_variant_new_array (G_VARIANT_TYPE ("a(sus)"), NULL, 0));
+		return TRUE;
+	}
+
+	batch = g_slice_new0 (Batch);
+	batch->dbus_dispatcher = dbus_dispatcher;
+	batch->context = context;
+	batch->n_events = g_variant_n_children (events);
+	batch->n_pending = batch->n_events;
+	batch->results = g_new0 (GVariant *, batch->n_events);
+
+	/* The events become requests in the order of the batch, so
+	 * that they are processed in the same order as individual
+	 * Action calls would be. */
+	g_variant_iter_init (&iter, events);
+	for (i = 0; i < batch->n_events; i++) {
+		const char *str_action, *connectivity_state, *vpn_ip_iface;
+		gs_unref_variant GVariant *connection_dict = NULL;
+		gs_unref_variant GVariant *connection_props = NULL;
+		gs_unref_variant GVariant *device_props = NULL;
+		gs_unref_variant GVariant *device_ip4_props = NULL;
+		gs_unref_variant GVariant *device_ip6_props = NULL;
+		gs_unref_variant GVariant *device_dhcp4_props = NULL;
+		gs_unref_variant GVariant *device_dhcp6_props = NULL;
+		gs_unref_variant GVariant *vpn_ip4_props = NULL;
+		gs_unref_variant GVariant *vpn_ip6_props = NULL;
+		gboolean request_debug;
+
+		g_variant_iter_next (&iter,
+		                     "(&s@a{sa{sv}}@a{sv}@a{sv}@a{sv}@a{sv}@a{sv}@a{sv}&s&s@a{sv}@a{sv}b)",
+		                     &str_action,
+		                     &connection_dict,
+		                     &connection_props,
+		                     &device_props,
+		                     &device_ip4_props,
+		                     &device_ip6_props,
+		                     &device_dhcp4_props,
+		                     &device_dhcp6_props,
+		                     &connectivity_state,
+		                     &vpn_ip_iface,
+		                     &vpn_ip4_props,
+		                     &vpn_ip6_props,
+		                     &request_debug);
+
+		request_start (h, NULL, batch, i,
+		               str_action,
+		               connection_dict,
+		               connection_props,
+		               device_props,
+		               device_ip4_props,
+		               device_ip6_props,
+		               device_dhcp4_props,
+		               device_dhcp6_props,
+		               connectivity_state,
+		               vpn_ip_iface,
+		               vpn_ip4_props,
+		               vpn_ip6_props,
+		               request_debug);
+	}
 
 	return TRUE;
 }
@@ -895,6 +1314,8 @@ main (int argc, char **argv)
 	GOptionEntry entries[] = {
 		{ "debug", 0, 0, G_OPTION_ARG_NONE, &debug, "Output to console rather than syslog", NULL },
 		{ "persist", 0, 0, G_OPTION_ARG_NONE, &persist, "Don't quit after a short timeout", NULL },
+		{ "parallel", 0, 0, G_OPTION_ARG_INT, &max_parallel, "Run up to N scripts of an event at the same time, ordered only by the numeric prefix of their name", "N" },
+		{ "script-timeout", 0, 0, G_OPTION_ARG_INT, &script_timeout, "Kill scripts that run longer than SECONDS (default: 600)", "SECONDS" },
 		{ NULL }
 	};
 
@@ -910,6 +1331,11 @@ main (int argc, char **argv)
 
 	g_option_context_free (opt_ctx);
 
+	if (max_parallel < 1)
+		max_parallel = 1;
+	if (script_timeout < 1)
+		script_timeout = SCRIPT_TIMEOUT;
+
 	nm_g_type_init ();
 
 	g_unix_signal_add (SIGTERM, signal_handler, GINT_TO_POINTER (SIGTERM));
@@ -962,6 +1388,8 @@ main (int argc, char **argv)
 
 	g_queue_free (handler->requests_waiting);
 	g_object_unref (handler);
+	g_clear_pointer (&script_stats, g_hash_table_unref);
+	script_cache_clear ();
 
 	if (!debug)
 		logging_shutdown ();
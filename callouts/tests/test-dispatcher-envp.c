@@ -629,6 +629,134 @@ test_up_empty_vpn_iface (void)
 
 /*******************************************/
 
+static void
+test_script_group (void)
+{
+	g_assert_cmpint (nm_dispatcher_utils_script_get_group ("/etc/NetworkManager/dispatcher.d/10-foo"), ==, 10);
+	g_assert_cmpint (nm_dispatcher_utils_script_get_group ("007-bar"), ==, 7);
+	g_assert_cmpint (nm_dispatcher_utils_script_get_group ("20"), ==, 20);
+	g_assert_cmpint (nm_dispatcher_utils_script_get_group ("/etc/NetworkManager/dispatcher.d/foo-10"), ==, -1);
+	g_assert_cmpint (nm_dispatcher_utils_script_get_group ("/10-dir/foo"), ==, -1);
+	g_assert_cmpint (nm_dispatcher_utils_script_get_group ("99999999999-huge"), ==, G_MAXINT32);
+}
+
+static void
+test_parallel_barrier (void)
+{
+	NMDispatcherScriptState states[] = {
+		{ .group = 10, .wait = TRUE },   /* 10-a */
+		{ .group = 10, .wait = TRUE },   /* 10-b */
+		{ .group = 15, .wait = FALSE },  /* 15-nowait */
+		{ .group = 20, .wait = TRUE },   /* 20-c */
+		{ .group = -1, .wait = TRUE },   /* x */
+		{ .group = 30, .wait = TRUE },   /* 30-d */
+		{ .group = 30, .wait = TRUE },   /* 30-e */
+	};
+	const NMDispatcherScriptState *scripts[G_N_ELEMENTS (states)];
+	guint i;
+
+#define _next() nm_dispatcher_utils_scripts_next_parallel (scripts, G_N_ELEMENTS (scripts))
+
+	for (i = 0; i < G_N_ELEMENTS (states); i++)
+		scripts[i] = &states[i];
+
+	/* the scripts of the lowest group and the ones without a group
+	 * start right away. */
+	g_assert_cmpint (_next (), ==, 0);
+	states[0].dispatched = TRUE;
+	g_assert_cmpint (_next (), ==, 1);
+	states[1].dispatched = TRUE;
+	g_assert_cmpint (_next (), ==, 4);
+	states[4].dispatched = TRUE;
+	g_assert_cmpint (_next (), ==, -1);
+
+	/* the next group waits until the whole group completed. The
+	 * "no-wait" script and the script without a group don't block it. */
+	states[0].done = TRUE;
+	g_assert_cmpint (_next (), ==, -1);
+	states[1].done = TRUE;
+	g_assert_cmpint (_next (), ==, 3);
+	states[3].dispatched = TRUE;
+	g_assert_cmpint (_next (), ==, -1);
+
+	states[3].done = TRUE;
+	g_assert_cmpint (_next (), ==, 5);
+
+	/* a script that fails to execute is done right away. */
+	states[5].dispatched = TRUE;
+	states[5].done = TRUE;
+	g_assert_cmpint (_next (), ==, 6);
+	states[6].dispatched = TRUE;
+	g_assert_cmpint (_next (), ==, -1);
+
+	states[4].done = TRUE;
+	states[6].done = TRUE;
+	g_assert_cmpint (_next (), ==, -1);
+
+	g_assert_cmpint (nm_dispatcher_utils_scripts_next_parallel (scripts, 0), ==, -1);
+
+#undef _next
+}
+
+static void
+test_statistics (void)
+{
+	GHashTable *stats;
+	GVariant *bucket_bounds;
+	GVariant *scripts;
+	const guint32 *bounds, *buckets;
+	gs_unref_variant GVariant *buckets_variant = NULL;
+	gsize n_bounds, n_buckets;
+	const char *path;
+	guint32 count;
+	guint64 total_usec, max_usec;
+
+	/* no script ran yet. */
+	nm_dispatcher_utils_stats_get (NULL, &bucket_bounds, &scripts);
+	g_variant_ref_sink (bucket_bounds);
+	g_variant_ref_sink (scripts);
+	g_assert (g_variant_is_of_type (bucket_bounds, G_VARIANT_TYPE ("au")));
+	g_assert (g_variant_is_of_type (scripts, G_VARIANT_TYPE ("a(suttau)")));
+	g_assert_cmpint (g_variant_n_children (scripts), ==, 0);
+	g_variant_unref (bucket_bounds);
+	g_variant_unref (scripts);
+
+	stats = nm_dispatcher_utils_stats_new ();
+	nm_dispatcher_utils_stats_record (stats, "/etc/NetworkManager/dispatcher.d/10-a", 5000);
+	nm_dispatcher_utils_stats_record (stats, "/etc/NetworkManager/dispatcher.d/10-a", 10000);
+	nm_dispatcher_utils_stats_record (stats, "/etc/NetworkManager/dispatcher.d/10-a", 10001);
+	nm_dispatcher_utils_stats_record (stats, "/etc/NetworkManager/dispatcher.d/10-a", 120 * G_USEC_PER_SEC);
+
+	nm_dispatcher_utils_stats_get (stats, &bucket_bounds, &scripts);
+	g_variant_ref_sink (bucket_bounds);
+	g_variant_ref_sink (scripts);
+
+	bounds = g_variant_get_fixed_array (bucket_bounds, &n_bounds, sizeof (guint32));
+	g_assert_cmpint (n_bounds, >, 1);
+	g_assert_cmpint (bounds[0], ==, 10);
+	g_assert_cmpint (bounds[n_bounds - 1], <, 120 * 1000);
+
+	g_assert_cmpint (g_variant_n_children (scripts), ==, 1);
+	g_variant_get_child (scripts, 0, "(&sutt@au)", &path, &count, &total_usec, &max_usec, &buckets_variant);
+	g_assert_cmpstr (path, ==, "/etc/NetworkManager/dispatcher.d/10-a");
+	g_assert_cmpint (count, ==, 4);
+	g_assert_cmpint (total_usec, ==, 5000 + 10000 + 10001 + 120 * G_USEC_PER_SEC);
+	g_assert_cmpint (max_usec, ==, 120 * G_USEC_PER_SEC);
+
+	/* the bounds are inclusive and the last bucket counts the longer runs. */
+	buckets = g_variant_get_fixed_array (buckets_variant, &n_buckets, sizeof (guint32));
+	g_assert_cmpint (n_buckets, ==, n_bounds + 1);
+	g_assert_cmpint (buckets[0], ==, 2);
+	g_assert_cmpint (buckets[1], ==, 1);
+	g_assert_cmpint (buckets[n_buckets - 1], ==, 1);
+
+	g_variant_unref (bucket_bounds);
+	g_variant_unref (scripts);
+	g_hash_table_unref (stats);
+}
+
+/*******************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -645,6 +773,10 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/dispatcher/up_empty_vpn_iface", test_up_empty_vpn_iface);
 
+	g_test_add_func ("/dispatcher/script_group", test_script_group);
+	g_test_add_func ("/dispatcher/parallel_barrier", test_parallel_barrier);
+	g_test_add_func ("/dispatcher/statistics", test_statistics);
+
 	return g_test_run ();
 }
 
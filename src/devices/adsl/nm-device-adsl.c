@@ -633,6 +633,8 @@ nm_device_adsl_class_init (NMDeviceAdslClass *klass)
 
 	g_type_class_add_private (object_class, sizeof (NMDeviceAdslPrivate));
 
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_ADSL_SETTING_NAME)
+
 	object_class->constructed  = constructed;
 	object_class->dispose      = dispose;
 	object_class->get_property = get_property;
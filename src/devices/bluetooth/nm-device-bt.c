@@ -1144,6 +1144,8 @@ nm_device_bt_class_init (NMDeviceBtClass *klass)
 
 	g_type_class_add_private (object_class, sizeof (NMDeviceBtPrivate));
 
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_BLUETOOTH_SETTING_NAME)
+
 	object_class->constructed = constructed;
 	object_class->get_property = get_property;
 	object_class->set_property = set_property;
@@ -498,6 +498,7 @@ nm_device_bond_class_init (NMDeviceBondClass *klass)
 	g_type_class_add_private (object_class, sizeof (NMDeviceBondPrivate));
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NM_SETTING_BOND_SETTING_NAME, NM_LINK_TYPE_BOND)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_BOND_SETTING_NAME)
 
 	parent_class->get_generic_capabilities = get_generic_capabilities;
 	parent_class->is_available = is_available;
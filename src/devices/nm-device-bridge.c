@@ -427,6 +427,7 @@ nm_device_bridge_class_init (NMDeviceBridgeClass *klass)
 	g_type_class_add_private (object_class, sizeof (NMDeviceBridgePrivate));
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NM_SETTING_BRIDGE_SETTING_NAME, NM_LINK_TYPE_BRIDGE)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_BRIDGE_SETTING_NAME)
 
 	parent_class->get_generic_capabilities = get_generic_capabilities;
 	parent_class->is_available = is_available;
@@ -431,6 +431,21 @@ check_connection_compatible (NMDevice *device, NMConnection *connection)
 	return TRUE;
 }
 
+static void
+candidate_filter_init (NMDevice *device, NMSettingsCandidateFilter *filter)
+{
+	NMDeviceEthernetPrivate *priv = NM_DEVICE_ETHERNET_GET_PRIVATE (device);
+
+	NM_DEVICE_CLASS (nm_device_ethernet_parent_class)->candidate_filter_init (device, filter);
+
+	/* With s390 subchannels, the MAC address of a connection might not be
+	 * checked at all (see match_subchans()). */
+	if (_subchannels_count_num ((const char * const *) priv->subchannels_dbus) == 0) {
+		filter->filter_hwaddr = TRUE;
+		filter->hwaddr = nm_device_get_permanent_hw_address (device, TRUE);
+	}
+}
+
 /*****************************************************************************/
 /* 802.1X */
 
@@ -1643,6 +1658,7 @@ nm_device_ethernet_class_init (NMDeviceEthernetClass *klass)
 	g_type_class_add_private (object_class, sizeof (NMDeviceEthernetPrivate));
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NM_SETTING_WIRED_SETTING_NAME, NM_LINK_TYPE_ETHERNET)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_WIRED_SETTING_NAME, NM_SETTING_PPPOE_SETTING_NAME)
 
 	/* virtual methods */
 	object_class->constructed = constructed;
@@ -1653,6 +1669,7 @@ nm_device_ethernet_class_init (NMDeviceEthernetClass *klass)
 
 	parent_class->get_generic_capabilities = get_generic_capabilities;
 	parent_class->check_connection_compatible = check_connection_compatible;
+	parent_class->candidate_filter_init = candidate_filter_init;
 	parent_class->complete_connection = complete_connection;
 	parent_class->new_default_connection = new_default_connection;
 
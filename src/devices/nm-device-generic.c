@@ -197,6 +197,7 @@ nm_device_generic_class_init (NMDeviceGenericClass *klass)
 	g_type_class_add_private (klass, sizeof (NMDeviceGenericPrivate));
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NM_SETTING_GENERIC_SETTING_NAME, NM_LINK_TYPE_ANY)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_GENERIC_SETTING_NAME)
 
 	object_class->constructor = constructor;
 	object_class->dispose = dispose;
@@ -361,6 +361,7 @@ nm_device_infiniband_class_init (NMDeviceInfinibandClass *klass)
 	g_type_class_add_private (object_class, sizeof (NMDeviceInfinibandPrivate));
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NM_SETTING_INFINIBAND_SETTING_NAME, NM_LINK_TYPE_INFINIBAND)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_INFINIBAND_SETTING_NAME)
 
 	/* virtual methods */
 	object_class->get_property = get_property;
@@ -895,6 +895,7 @@ nm_device_ip_tunnel_class_init (NMDeviceIPTunnelClass *klass)
 	                               NM_LINK_TYPE_IP6TNL,
 	                               NM_LINK_TYPE_IPIP,
 	                               NM_LINK_TYPE_SIT);
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_IP_TUNNEL_SETTING_NAME)
 
 	/* properties */
 	g_object_class_install_property
@@ -418,6 +418,32 @@ check_connection_compatible (NMDevice *device, NMConnection *connection)
 	return TRUE;
 }
 
+static void
+candidate_filter_init (NMDevice *device, NMSettingsCandidateFilter *filter)
+{
+	NMDeviceMacvlanPrivate *priv = NM_DEVICE_MACVLAN_GET_PRIVATE (device);
+	NMActRequest *parent_req;
+	NMConnection *parent_connection;
+
+	NM_DEVICE_CLASS (nm_device_macvlan_parent_class)->candidate_filter_init (device, filter);
+
+	/* The parent is only checked once the device is realized. See match_parent(). */
+	if (!nm_device_is_real (device))
+		return;
+
+	filter->filter_parent = TRUE;
+	if (!priv->parent)
+		return;
+
+	filter->parent_iface = nm_device_get_ip_iface (priv->parent);
+	parent_req = nm_device_get_act_request (priv->parent);
+	if (parent_req) {
+		parent_connection = nm_active_connection_get_applied_connection (NM_ACTIVE_CONNECTION (parent_req));
+		if (parent_connection)
+			filter->parent_uuid = nm_connection_get_uuid (parent_connection);
+	}
+}
+
 static gboolean
 complete_connection (NMDevice *device,
                      NMConnection *connection,
@@ -610,6 +636,7 @@ nm_device_macvlan_class_init (NMDeviceMacvlanClass *klass)
 	g_type_class_add_private (klass, sizeof (NMDeviceMacvlanPrivate));
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NULL, NM_LINK_TYPE_MACVLAN, NM_LINK_TYPE_MACVTAP)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_MACVLAN_SETTING_NAME)
 
 	object_class->dispose = dispose;
 	object_class->get_property = get_property;
@@ -618,6 +645,7 @@ nm_device_macvlan_class_init (NMDeviceMacvlanClass *klass)
 	device_class->act_stage1_prepare = act_stage1_prepare;
 	device_class->bring_up = bring_up;
 	device_class->check_connection_compatible = check_connection_compatible;
+	device_class->candidate_filter_init = candidate_filter_init;
 	device_class->complete_connection = complete_connection;
 	device_class->connection_type = NM_SETTING_MACVLAN_SETTING_NAME;
 	device_class->create_and_realize = create_and_realize;
@@ -121,4 +121,10 @@ gboolean nm_device_ipv6_sysctl_set (NMDevice *self, const char *property, const
 		NM_DEVICE_CLASS (klass)->link_types = link_types; \
 	}
 
+#define NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES(klass, ...) \
+	{ \
+		static const char *const compatible_connection_types[] = { __VA_ARGS__, NULL }; \
+		NM_DEVICE_CLASS (klass)->compatible_connection_types = compatible_connection_types; \
+	}
+
 #endif	/* NM_DEVICE_PRIVATE_H */
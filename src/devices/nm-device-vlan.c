@@ -429,6 +429,32 @@ check_connection_compatible (NMDevice *device, NMConnection *connection)
 	return TRUE;
 }
 
+static void
+candidate_filter_init (NMDevice *device, NMSettingsCandidateFilter *filter)
+{
+	NMDeviceVlanPrivate *priv = NM_DEVICE_VLAN_GET_PRIVATE (device);
+	NMActRequest *parent_req;
+	NMConnection *parent_connection;
+
+	NM_DEVICE_CLASS (nm_device_vlan_parent_class)->candidate_filter_init (device, filter);
+
+	/* The parent is only checked once the device is realized. See match_parent(). */
+	if (!nm_device_is_real (device))
+		return;
+
+	filter->filter_parent = TRUE;
+	if (!priv->parent)
+		return;
+
+	filter->parent_iface = nm_device_get_ip_iface (priv->parent);
+	parent_req = nm_device_get_act_request (priv->parent);
+	if (parent_req) {
+		parent_connection = nm_active_connection_get_applied_connection (NM_ACTIVE_CONNECTION (parent_req));
+		if (parent_connection)
+			filter->parent_uuid = nm_connection_get_uuid (parent_connection);
+	}
+}
+
 static gboolean
 check_connection_available (NMDevice *device,
                             NMConnection *connection,
@@ -661,6 +687,7 @@ nm_device_vlan_class_init (NMDeviceVlanClass *klass)
 	NMDeviceClass *parent_class = NM_DEVICE_CLASS (klass);
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NM_SETTING_VLAN_SETTING_NAME, NM_LINK_TYPE_VLAN)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_VLAN_SETTING_NAME)
 
 	g_type_class_add_private (object_class, sizeof (NMDeviceVlanPrivate));
 
@@ -680,6 +707,7 @@ nm_device_vlan_class_init (NMDeviceVlanClass *klass)
 	parent_class->notify_new_device_added = notify_new_device_added;
 
 	parent_class->check_connection_compatible = check_connection_compatible;
+	parent_class->candidate_filter_init = candidate_filter_init;
 	parent_class->check_connection_available = check_connection_available;
 	parent_class->complete_connection = complete_connection;
 	parent_class->update_connection = update_connection;
@@ -637,6 +637,7 @@ nm_device_vxlan_class_init (NMDeviceVxlanClass *klass)
 	g_type_class_add_private (klass, sizeof (NMDeviceVxlanPrivate));
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NULL, NM_LINK_TYPE_VXLAN)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_VXLAN_SETTING_NAME)
 
 	object_class->get_property = get_property;
 	object_class->dispose = dispose;
@@ -209,6 +209,21 @@ typedef struct {
 	NMIP4Config **configs;
 } ArpingData;
 
+/* Maximum number of platform changes applied incrementally to the external
+ * IP configuration. With more changes, the configuration is captured anew. */
+#define IP_CONFIG_DELTAS_MAX   64
+
+typedef struct {
+	NMPObjectType obj_type;
+	NMPlatformSignalChangeType change_type;
+	union {
+		NMPlatformIP4Address ip4_address;
+		NMPlatformIP4Route ip4_route;
+		NMPlatformIP6Address ip6_address;
+		NMPlatformIP6Route ip6_route;
+	};
+} IPConfigDelta;
+
 typedef enum {
 	HW_ADDR_TYPE_UNSET = 0,
 	HW_ADDR_TYPE_PERMANENT,
@@ -219,14 +234,19 @@ typedef enum {
 typedef struct _NMDevicePrivate {
 	bool in_state_changed;
 
-	guint device_link_changed_id;
-	guint device_ip_link_changed_id;
-
 	NMDeviceState state;
 	NMDeviceStateReason state_reason;
 	QueuedState   queued_state;
 	guint queued_ip4_config_id;
 	guint queued_ip6_config_id;
+	/* The platform changes since the queued IP config change was
+	 * scheduled, or %NULL if the configuration must be captured anew. */
+	GArray *ip4_deltas;
+	GArray *ip6_deltas;
+	/* The internal configurations changed since the external ones were
+	 * captured, so applying @ip4_deltas/@ip6_deltas is not enough. */
+	bool ext_ip4_config_need_capture;
+	bool ext_ip6_config_need_capture;
 	GSList *pending_actions;
 	GSList *dad6_failed_addrs;
 
@@ -1662,7 +1682,7 @@ device_recheck_slave_status (NMDevice *self, const NMPlatformLink *plink)
 	}
 }
 
-static gboolean
+static void
 device_link_changed (NMDevice *self)
 {
 	NMDeviceClass *klass = NM_DEVICE_GET_CLASS (self);
@@ -1676,12 +1696,10 @@ device_link_changed (NMDevice *self)
 	gboolean update_unmanaged_specs = FALSE;
 	gboolean got_hw_addr = FALSE, had_hw_addr;
 
-	priv->device_link_changed_id = 0;
-
 	ifindex = nm_device_get_ifindex (self);
 	pllink = nm_platform_link_get (NM_PLATFORM_GET, ifindex);
 	if (!pllink)
-		return G_SOURCE_REMOVE;
+		return;
 
 	info = *pllink;
 
@@ -1821,24 +1839,20 @@ device_link_changed (NMDevice *self)
 		                                   NM_DEVICE_STATE_REASON_NONE,
 		                                   NM_DEVICE_STATE_REASON_NONE);
 	}
-
-	return G_SOURCE_REMOVE;
 }
 
-static gboolean
+static void
 device_ip_link_changed (NMDevice *self)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 	const NMPlatformLink *pllink;
 
-	priv->device_ip_link_changed_id = 0;
-
 	if (!priv->ip_ifindex)
-		return G_SOURCE_REMOVE;
+		return;
 
 	pllink = nm_platform_link_get (NM_PLATFORM_GET, priv->ip_ifindex);
 	if (!pllink)
-		return G_SOURCE_REMOVE;
+		return;
 
 	if (pllink->name[0] && g_strcmp0 (priv->ip_iface, pllink->name)) {
 		_LOGI (LOGD_DEVICE, "interface index %d renamed ip_iface (%d) from '%s' to '%s'",
@@ -1850,34 +1864,32 @@ device_ip_link_changed (NMDevice *self)
 		_notify (self, PROP_IP_IFACE);
 		nm_device_update_dynamic_ip_setup (self);
 	}
-	return G_SOURCE_REMOVE;
 }
 
-static void
-link_changed_cb (NMPlatform *platform,
-                 NMPObjectType obj_type,
-                 int ifindex,
-                 NMPlatformLink *info,
-                 NMPlatformSignalChangeType change_type,
-                 NMDevice *self)
+/**
+ * nm_device_platform_link_changed:
+ * @self: the #NMDevice
+ * @ifindex: the interface index of the link that changed
+ *
+ * Notifies @self that the platform link @ifindex changed, if it is
+ * the link or the IP link of @self. #NMManager collects the platform
+ * link changes and calls this once per batch, no matter how often
+ * the link changed in the meantime.
+ */
+void
+nm_device_platform_link_changed (NMDevice *self, int ifindex)
 {
-	NMDevicePrivate *priv;
+	g_return_if_fail (NM_IS_DEVICE (self));
 
-	if (change_type != NM_PLATFORM_SIGNAL_CHANGED)
+	if (ifindex <= 0)
 		return;
 
-	priv = NM_DEVICE_GET_PRIVATE (self);
-
 	if (ifindex == nm_device_get_ifindex (self)) {
-		if (!priv->device_link_changed_id) {
-			priv->device_link_changed_id = g_idle_add ((GSourceFunc) device_link_changed, self);
-			_LOGD (LOGD_DEVICE, "queued link change for ifindex %d", ifindex);
-		}
+		_LOGD (LOGD_DEVICE, "link change for ifindex %d", ifindex);
+		device_link_changed (self);
 	} else if (ifindex == nm_device_get_ip_ifindex (self)) {
-		if (!priv->device_ip_link_changed_id) {
-			priv->device_ip_link_changed_id = g_idle_add ((GSourceFunc) device_ip_link_changed, self);
-			_LOGD (LOGD_DEVICE, "queued link change for ip-ifindex %d", ifindex);
-		}
+		_LOGD (LOGD_DEVICE, "link change for ip-ifindex %d", ifindex);
+		device_ip_link_changed (self);
 	}
 }
 
@@ -3280,10 +3292,17 @@ nm_device_complete_connection (NMDevice *self,
 static gboolean
 check_connection_compatible (NMDevice *self, NMConnection *connection)
 {
+	const char *const*types = NM_DEVICE_GET_CLASS (self)->compatible_connection_types;
 	const char *device_iface = nm_device_get_iface (self);
-	gs_free char *conn_iface = nm_manager_get_connection_iface (nm_manager_get (),
-	                                                            connection,
-	                                                            NULL, NULL);
+	gs_free char *conn_iface = NULL;
+
+	if (   types
+	    && !g_strv_contains (types, nm_connection_get_connection_type (connection) ?: ""))
+		return FALSE;
+
+	conn_iface = nm_manager_get_connection_iface (nm_manager_get (),
+	                                              connection,
+	                                              NULL, NULL);
 
 	/* We always need a interface name for virtual devices, but for
 	 * physical ones a connection without interface name is fine for
@@ -3321,6 +3340,38 @@ nm_device_check_connection_compatible (NMDevice *self, NMConnection *connection)
 	return NM_DEVICE_GET_CLASS (self)->check_connection_compatible (self, connection);
 }
 
+static void
+candidate_filter_init (NMDevice *self, NMSettingsCandidateFilter *filter)
+{
+	filter->types = NM_DEVICE_GET_CLASS (self)->compatible_connection_types;
+	filter->iface = nm_device_get_iface (self);
+}
+
+/**
+ * nm_device_get_candidate_connections:
+ * @self: an #NMDevice
+ * @out_len: (allow-none) (out): the number of returned connections
+ *
+ * Looks up the connections that might be compatible with @self.
+ * Every connection for which nm_device_check_connection_compatible()
+ * returns %TRUE is part of the result, but not every connection in
+ * the result is necessarily compatible.
+ *
+ * Returns: (transfer container): a %NULL terminated array of
+ *   connections. Free it with g_free().
+ */
+NMSettingsConnection **
+nm_device_get_candidate_connections (NMDevice *self, guint *out_len)
+{
+	NMSettingsCandidateFilter filter = { 0 };
+
+	g_return_val_if_fail (NM_IS_DEVICE (self), NULL);
+
+	NM_DEVICE_GET_CLASS (self)->candidate_filter_init (self, &filter);
+	return nm_settings_get_candidate_connections (NM_DEVICE_GET_PRIVATE (self)->settings,
+	                                              &filter, out_len);
+}
+
 gboolean
 nm_device_check_slave_connection_compatible (NMDevice *self, NMConnection *slave)
 {
@@ -4593,6 +4644,9 @@ ip4_config_merge_and_apply (NMDevice *self,
 	gboolean ignore_auto_dns = FALSE;
 	gboolean auto_method = FALSE;
 
+	if (commit)
+		priv->ext_ip4_config_need_capture = TRUE;
+
 	/* Merge all the configs into the composite config */
 	if (config) {
 		g_clear_object (&priv->dev_ip4_config);
@@ -4952,6 +5006,26 @@ dhcp4_get_timeout (NMDevice *self, NMSettingIP4Config *s_ip4)
 	return priv->dhcp_timeout;
 }
 
+/* Identifies the network that @connection is for, beyond the hardware
+ * address of the device. The DHCP client only reuses a lease on the
+ * same network. */
+static char *
+dhcp4_get_network_id (NMConnection *connection)
+{
+	NMSettingWireless *s_wireless;
+	GBytes *ssid;
+
+	s_wireless = nm_connection_get_setting_wireless (connection);
+	if (!s_wireless)
+		return NULL;
+
+	ssid = nm_setting_wireless_get_ssid (s_wireless);
+	if (!ssid || !g_bytes_get_size (ssid))
+		return NULL;
+
+	return nm_utils_bin2hexstr (g_bytes_get_data (ssid, NULL), g_bytes_get_size (ssid), -1);
+}
+
 static NMActStageReturn
 dhcp4_start (NMDevice *self,
              NMConnection *connection,
@@ -4962,6 +5036,7 @@ dhcp4_start (NMDevice *self,
 	const guint8 *hw_addr;
 	size_t hw_addr_len = 0;
 	GByteArray *tmp = NULL;
+	gs_free char *network_id = NULL;
 
 	s_ip4 = nm_connection_get_setting_ip4_config (connection);
 
@@ -4975,6 +5050,8 @@ dhcp4_start (NMDevice *self,
 		g_byte_array_append (tmp, hw_addr, hw_addr_len);
 	}
 
+	network_id = dhcp4_get_network_id (connection);
+
 	/* Begin DHCP on the interface */
 	g_warn_if_fail (priv->dhcp4.client == NULL);
 	priv->dhcp4.client = nm_dhcp_manager_start_ip4 (nm_dhcp_manager_get (),
@@ -4982,6 +5059,7 @@ dhcp4_start (NMDevice *self,
 	                                                nm_device_get_ip_ifindex (self),
 	                                                tmp,
 	                                                nm_connection_get_uuid (connection),
+	                                                network_id,
 	                                                nm_device_get_ip4_route_metric (self),
 	                                                nm_setting_ip_config_get_dhcp_send_hostname (s_ip4),
 	                                                nm_setting_ip_config_get_dhcp_hostname (s_ip4),
@@ -5338,6 +5416,9 @@ ip6_config_merge_and_apply (NMDevice *self,
 	gboolean auto_method = FALSE;
 	const char *token = NULL;
 
+	if (commit)
+		priv->ext_ip6_config_need_capture = TRUE;
+
 	/* Apply ignore-auto-routes and ignore-auto-dns settings */
 	connection = nm_device_get_applied_connection (self);
 	if (connection) {
@@ -7557,6 +7638,7 @@ _cleanup_ip4_pre (NMDevice *self, CleanupType cleanup_type)
 
 	if (nm_clear_g_source (&priv->queued_ip4_config_id))
 		_LOGD (LOGD_DEVICE, "clearing queued IP4 config change");
+	g_clear_pointer (&priv->ip4_deltas, g_array_unref);
 
 	dhcp4_cleanup (self, cleanup_type, FALSE);
 	arp_cleanup (self);
@@ -7573,6 +7655,7 @@ _cleanup_ip6_pre (NMDevice *self, CleanupType cleanup_type)
 
 	if (nm_clear_g_source (&priv->queued_ip6_config_id))
 		_LOGD (LOGD_DEVICE, "clearing queued IP6 config change");
+	g_clear_pointer (&priv->ip6_deltas, g_array_unref);
 
 	g_clear_object (&priv->dad6_ip6_config);
 	dhcp6_cleanup (self, cleanup_type, FALSE);
@@ -9167,8 +9250,7 @@ capture_lease_config (NMDevice *self,
                       NMIP6Config *ext_ip6_config,
                       NMIP6Config **out_ip6_config)
 {
-	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
-	NMSettingsConnection *const*connections;
+	gs_free NMSettingsConnection **connections = NULL;
 	guint i;
 	gboolean dhcp_used = FALSE;
 
@@ -9201,7 +9283,7 @@ capture_lease_config (NMDevice *self,
 	if (!dhcp_used)
 		return;
 
-	connections = nm_settings_get_connections (priv->settings, NULL);
+	connections = nm_device_get_candidate_connections (self, NULL);
 	for (i = 0; connections[i]; i++) {
 		NMConnection *candidate = (NMConnection *) connections[i];
 		const char *method;
@@ -9243,10 +9325,115 @@ _ip4_config_subtract (gpointer value, gpointer user_data)
 	nm_ip4_config_subtract (dst, src);
 }
 
+static void
+_ip_config_deltas_add (GArray **p_deltas,
+                       NMPObjectType obj_type,
+                       NMPlatformSignalChangeType change_type,
+                       gconstpointer platform_object)
+{
+	IPConfigDelta *delta;
+
+	if (!*p_deltas)
+		return;
+
+	/* Routes with source RTPROT_KERNEL are never captured: the platform's
+	 * route_get_all() skips them unless NM_PLATFORM_GET_ROUTE_FLAGS_WITH_RTPROT_KERNEL
+	 * is passed, which nm_ip4_config_capture() and nm_ip6_config_capture() don't. */
+	if (   (   obj_type == NMP_OBJECT_TYPE_IP4_ROUTE
+	        || obj_type == NMP_OBJECT_TYPE_IP6_ROUTE)
+	    && ((const NMPlatformIPRoute *) platform_object)->rt_source == NM_IP_CONFIG_SOURCE_RTPROT_KERNEL)
+		return;
+
+	if ((*p_deltas)->len >= IP_CONFIG_DELTAS_MAX) {
+		g_clear_pointer (p_deltas, g_array_unref);
+		return;
+	}
+
+	g_array_set_size (*p_deltas, (*p_deltas)->len + 1);
+	delta = &g_array_index (*p_deltas, IPConfigDelta, (*p_deltas)->len - 1);
+	delta->obj_type = obj_type;
+	delta->change_type = change_type;
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+		delta->ip4_address = *((const NMPlatformIP4Address *) platform_object);
+		break;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+		delta->ip4_route = *((const NMPlatformIP4Route *) platform_object);
+		break;
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+		delta->ip6_address = *((const NMPlatformIP6Address *) platform_object);
+		break;
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		delta->ip6_route = *((const NMPlatformIP6Route *) platform_object);
+		break;
+	default:
+		g_return_if_reached ();
+	}
+}
+
+static GPtrArray *
+_ip4_configs_get_internal (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	GPtrArray *configs;
+	GSList *iter;
+
+	configs = g_ptr_array_new ();
+	if (priv->con_ip4_config)
+		g_ptr_array_add (configs, priv->con_ip4_config);
+	if (priv->dev_ip4_config)
+		g_ptr_array_add (configs, priv->dev_ip4_config);
+	for (iter = priv->vpn4_configs; iter; iter = iter->next)
+		g_ptr_array_add (configs, iter->data);
+	if (priv->wwan_ip4_config)
+		g_ptr_array_add (configs, priv->wwan_ip4_config);
+	return configs;
+}
+
+/* Applies the platform changes in @deltas to ext_ip4_config and the
+ * internal configurations, with the same result as capturing the
+ * configuration anew and doing the intersect/subtract dance of
+ * update_ip4_config().
+ *
+ * Returns %FALSE if a change cannot be applied this way. The
+ * configurations must then be updated by capturing them, which
+ * is still correct after some of the changes were applied. */
+static gboolean
+ip4_config_apply_deltas (NMDevice *self, int ifindex, GArray *deltas)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gs_unref_ptrarray GPtrArray *internal = NULL;
+	guint i;
+
+	/* Slaves have no IP configuration */
+	if (nm_platform_link_get_master (NM_PLATFORM_GET, ifindex) > 0)
+		return FALSE;
+
+	internal = _ip4_configs_get_internal (self);
+
+	for (i = 0; i < deltas->len; i++) {
+		const IPConfigDelta *delta = &g_array_index (deltas, IPConfigDelta, i);
+		gboolean removed = delta->change_type == NM_PLATFORM_SIGNAL_REMOVED;
+
+		if (delta->obj_type == NMP_OBJECT_TYPE_IP4_ADDRESS) {
+			if (!nm_ip4_config_apply_address_change (priv->ext_ip4_config, internal,
+			                                         &delta->ip4_address, removed))
+				return FALSE;
+		} else {
+			if (!nm_ip4_config_apply_route_change (priv->ext_ip4_config, internal,
+			                                       &delta->ip4_route, removed))
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
 static void
 update_ip4_config (NMDevice *self, gboolean initial)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gs_unref_array GArray *deltas = NULL;
 	int ifindex;
 	gboolean capture_resolv_conf;
 
@@ -9263,16 +9450,30 @@ update_ip4_config (NMDevice *self, gboolean initial)
 		return;
 	}
 
+	deltas = priv->ip4_deltas;
+	priv->ip4_deltas = NULL;
+
 	ifindex = nm_device_get_ip_ifindex (self);
 	if (!ifindex)
 		return;
 
+	if (   !initial
+	    && deltas
+	    && priv->ext_ip4_config
+	    && !priv->ext_ip4_config_need_capture
+	    && ip4_config_apply_deltas (self, ifindex, deltas)) {
+		_LOGT (LOGD_DEVICE, "IP4 update applied %u changes", deltas->len);
+		ip4_config_merge_and_apply (self, NULL, FALSE, NULL);
+		return;
+	}
+
 	capture_resolv_conf =    initial
 	                      && nm_dns_manager_get_resolv_conf_explicit (nm_dns_manager_get ());
 
 	/* IPv4 */
 	g_clear_object (&priv->ext_ip4_config);
 	priv->ext_ip4_config = nm_ip4_config_capture (ifindex, capture_resolv_conf);
+	priv->ext_ip4_config_need_capture = FALSE;
 	if (priv->ext_ip4_config) {
 		if (initial) {
 			g_clear_object (&priv->dev_ip4_config);
@@ -9333,10 +9534,75 @@ _ip6_config_subtract (gpointer value, gpointer user_data)
 	nm_ip6_config_subtract (dst, src);
 }
 
+static GPtrArray *
+_ip6_configs_get_internal (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	GPtrArray *configs;
+	GSList *iter;
+
+	configs = g_ptr_array_new ();
+	if (priv->con_ip6_config)
+		g_ptr_array_add (configs, priv->con_ip6_config);
+	if (priv->ac_ip6_config)
+		g_ptr_array_add (configs, priv->ac_ip6_config);
+	if (priv->dhcp6.ip6_config)
+		g_ptr_array_add (configs, priv->dhcp6.ip6_config);
+	if (priv->wwan_ip6_config)
+		g_ptr_array_add (configs, priv->wwan_ip6_config);
+	for (iter = priv->vpn6_configs; iter; iter = iter->next)
+		g_ptr_array_add (configs, iter->data);
+	return configs;
+}
+
+/* See ip4_config_apply_deltas(). In addition, ext_ip6_config_captured
+ * is kept equal to what nm_ip6_config_capture() would return. */
+static gboolean
+ip6_config_apply_deltas (NMDevice *self, int ifindex, GArray *deltas)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gs_unref_ptrarray GPtrArray *internal = NULL;
+	gboolean addresses_changed = FALSE;
+	guint i;
+
+	/* Slaves have no IP configuration */
+	if (nm_platform_link_get_master (NM_PLATFORM_GET, ifindex) > 0)
+		return FALSE;
+
+	internal = _ip6_configs_get_internal (self);
+
+	for (i = 0; i < deltas->len; i++) {
+		const IPConfigDelta *delta = &g_array_index (deltas, IPConfigDelta, i);
+		gboolean removed = delta->change_type == NM_PLATFORM_SIGNAL_REMOVED;
+
+		if (delta->obj_type == NMP_OBJECT_TYPE_IP6_ADDRESS) {
+			if (!nm_ip6_config_apply_address_change (priv->ext_ip6_config,
+			                                         priv->ext_ip6_config_captured,
+			                                         internal, &delta->ip6_address, removed))
+				return FALSE;
+			if (!removed)
+				addresses_changed = TRUE;
+		} else {
+			if (!nm_ip6_config_apply_route_change (priv->ext_ip6_config,
+			                                       priv->ext_ip6_config_captured,
+			                                       internal, &delta->ip6_route, removed))
+				return FALSE;
+		}
+	}
+
+	if (addresses_changed) {
+		nm_ip6_config_addresses_sort (priv->ext_ip6_config_captured, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+		nm_ip6_config_addresses_sort (priv->ext_ip6_config, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	}
+
+	return TRUE;
+}
+
 static void
 update_ip6_config (NMDevice *self, gboolean initial)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gs_unref_array GArray *deltas = NULL;
 	int ifindex;
 	gboolean capture_resolv_conf;
 
@@ -9353,6 +9619,9 @@ update_ip6_config (NMDevice *self, gboolean initial)
 		return;
 	}
 
+	deltas = priv->ip6_deltas;
+	priv->ip6_deltas = NULL;
+
 	ifindex = nm_device_get_ip_ifindex (self);
 	if (!ifindex)
 		return;
@@ -9361,41 +9630,52 @@ update_ip6_config (NMDevice *self, gboolean initial)
 	                      && nm_dns_manager_get_resolv_conf_explicit (nm_dns_manager_get ());
 
 	/* IPv6 */
-	g_clear_object (&priv->ext_ip6_config);
-	g_clear_object (&priv->ext_ip6_config_captured);
-	priv->ext_ip6_config_captured = nm_ip6_config_capture (ifindex, capture_resolv_conf, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
-	if (priv->ext_ip6_config_captured) {
-
-		priv->ext_ip6_config = nm_ip6_config_new_cloned (priv->ext_ip6_config_captured);
-
-		/* This function was called upon external changes. Remove the configuration
-		 * (addresses,routes) that is no longer present externally from the internal
-		 * config. This way, we don't re-add addresses that were manually removed
-		 * by the user. */
-		if (priv->con_ip6_config)
-			nm_ip6_config_intersect (priv->con_ip6_config, priv->ext_ip6_config);
-		if (priv->ac_ip6_config)
-			nm_ip6_config_intersect (priv->ac_ip6_config, priv->ext_ip6_config);
-		if (priv->dhcp6.ip6_config)
-			nm_ip6_config_intersect (priv->dhcp6.ip6_config, priv->ext_ip6_config);
-		if (priv->wwan_ip6_config)
-			nm_ip6_config_intersect (priv->wwan_ip6_config, priv->ext_ip6_config);
-		g_slist_foreach (priv->vpn6_configs, _ip6_config_intersect, priv->ext_ip6_config);
-
-		/* Remove parts from ext_ip6_config to only contain the information that
-		 * was configured externally -- we already have the same configuration from
-		 * internal origins. */
-		if (priv->con_ip6_config)
-			nm_ip6_config_subtract (priv->ext_ip6_config, priv->con_ip6_config);
-		if (priv->ac_ip6_config)
-			nm_ip6_config_subtract (priv->ext_ip6_config, priv->ac_ip6_config);
-		if (priv->dhcp6.ip6_config)
-			nm_ip6_config_subtract (priv->ext_ip6_config, priv->dhcp6.ip6_config);
-		if (priv->wwan_ip6_config)
-			nm_ip6_config_subtract (priv->ext_ip6_config, priv->wwan_ip6_config);
-		g_slist_foreach (priv->vpn6_configs, _ip6_config_subtract, priv->ext_ip6_config);
-
+	if (   !initial
+	    && deltas
+	    && priv->ext_ip6_config
+	    && priv->ext_ip6_config_captured
+	    && !priv->ext_ip6_config_need_capture
+	    && ip6_config_apply_deltas (self, ifindex, deltas)) {
+		_LOGT (LOGD_DEVICE, "IP6 update applied %u changes", deltas->len);
 		ip6_config_merge_and_apply (self, FALSE, NULL);
+	} else {
+		g_clear_object (&priv->ext_ip6_config);
+		g_clear_object (&priv->ext_ip6_config_captured);
+		priv->ext_ip6_config_captured = nm_ip6_config_capture (ifindex, capture_resolv_conf, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+		priv->ext_ip6_config_need_capture = FALSE;
+		if (priv->ext_ip6_config_captured) {
+
+			priv->ext_ip6_config = nm_ip6_config_new_cloned (priv->ext_ip6_config_captured);
+
+			/* This function was called upon external changes. Remove the configuration
+			 * (addresses,routes) that is no longer present externally from the internal
+			 * config. This way, we don't re-add addresses that were manually removed
+			 * by the user. */
+			if (priv->con_ip6_config)
+				nm_ip6_config_intersect (priv->con_ip6_config, priv->ext_ip6_config);
+			if (priv->ac_ip6_config)
+				nm_ip6_config_intersect (priv->ac_ip6_config, priv->ext_ip6_config);
+			if (priv->dhcp6.ip6_config)
+				nm_ip6_config_intersect (priv->dhcp6.ip6_config, priv->ext_ip6_config);
+			if (priv->wwan_ip6_config)
+				nm_ip6_config_intersect (priv->wwan_ip6_config, priv->ext_ip6_config);
+			g_slist_foreach (priv->vpn6_configs, _ip6_config_intersect, priv->ext_ip6_config);
+
+			/* Remove parts from ext_ip6_config to only contain the information that
+			 * was configured externally -- we already have the same configuration from
+			 * internal origins. */
+			if (priv->con_ip6_config)
+				nm_ip6_config_subtract (priv->ext_ip6_config, priv->con_ip6_config);
+			if (priv->ac_ip6_config)
+				nm_ip6_config_subtract (priv->ext_ip6_config, priv->ac_ip6_config);
+			if (priv->dhcp6.ip6_config)
+				nm_ip6_config_subtract (priv->ext_ip6_config, priv->dhcp6.ip6_config);
+			if (priv->wwan_ip6_config)
+				nm_ip6_config_subtract (priv->ext_ip6_config, priv->wwan_ip6_config);
+			g_slist_foreach (priv->vpn6_configs, _ip6_config_subtract, priv->ext_ip6_config);
+
+			ip6_config_merge_and_apply (self, FALSE, NULL);
+		}
 	}
 
 	if (   priv->linklocal6_timeout_id
@@ -9528,8 +9808,10 @@ device_ipx_changed (NMPlatform *platform,
 	case NMP_OBJECT_TYPE_IP4_ROUTE:
 		if (!priv->queued_ip4_config_id) {
 			priv->queued_ip4_config_id = g_idle_add (queued_ip4_config_change, self);
+			priv->ip4_deltas = g_array_new (FALSE, FALSE, sizeof (IPConfigDelta));
 			_LOGD (LOGD_DEVICE, "queued IP4 config change");
 		}
+		_ip_config_deltas_add (&priv->ip4_deltas, obj_type, change_type, platform_object);
 		break;
 	case NMP_OBJECT_TYPE_IP6_ADDRESS:
 		addr = platform_object;
@@ -9545,8 +9827,10 @@ device_ipx_changed (NMPlatform *platform,
 	case NMP_OBJECT_TYPE_IP6_ROUTE:
 		if (!priv->queued_ip6_config_id) {
 			priv->queued_ip6_config_id = g_idle_add (queued_ip6_config_change, self);
+			priv->ip6_deltas = g_array_new (FALSE, FALSE, sizeof (IPConfigDelta));
 			_LOGD (LOGD_DEVICE, "queued IP6 config change");
 		}
+		_ip_config_deltas_add (&priv->ip6_deltas, obj_type, change_type, platform_object);
 		break;
 	default:
 		g_return_if_reached ();
@@ -10251,7 +10535,7 @@ void
 nm_device_recheck_available_connections (NMDevice *self)
 {
 	NMDevicePrivate *priv;
-	NMSettingsConnection *const*connections;
+	gs_free NMSettingsConnection **connections = NULL;
 	gboolean changed = FALSE;
 	GHashTableIter h_iter;
 	NMConnection *connection;
@@ -10269,7 +10553,9 @@ nm_device_recheck_available_connections (NMDevice *self)
 			g_hash_table_add (prune_list, connection);
 	}
 
-	connections = nm_settings_get_connections (priv->settings, NULL);
+	/* connections that are not candidates cannot be compatible, hence
+	 * they are also not available. */
+	connections = nm_device_get_candidate_connections (self, NULL);
 	for (i = 0; connections[i]; i++) {
 		connection = (NMConnection *) connections[i];
 
@@ -10352,15 +10638,21 @@ nm_device_get_best_connection (NMDevice *self,
 static void
 cp_connection_added_or_updated (NMDevice *self, NMConnection *connection)
 {
+	NMSettingsCandidateFilter filter = { 0 };
 	gboolean changed;
 
 	g_return_if_fail (NM_IS_DEVICE (self));
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (connection));
 
-	if (nm_device_check_connection_available (self,
-	                                          connection,
-	                                          _NM_DEVICE_CHECK_CON_AVAILABLE_FOR_USER_REQUEST,
-	                                          NULL))
+	NM_DEVICE_GET_CLASS (self)->candidate_filter_init (self, &filter);
+
+	if (   nm_settings_candidate_filter_matches (self->priv->settings,
+	                                             &filter,
+	                                             NM_SETTINGS_CONNECTION (connection))
+	    && nm_device_check_connection_available (self,
+	                                             connection,
+	                                             _NM_DEVICE_CHECK_CON_AVAILABLE_FOR_USER_REQUEST,
+	                                             NULL))
 		changed = available_connections_add (self, connection);
 	else
 		changed = available_connections_del (self, connection);
@@ -12018,7 +12310,6 @@ constructed (GObject *object)
 	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
 	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
 	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, G_CALLBACK (link_changed_cb), self);
 
 	priv->settings = g_object_ref (NM_SETTINGS_GET);
 	g_assert (priv->settings);
@@ -12052,7 +12343,6 @@ dispose (GObject *object)
 
 	platform = NM_PLATFORM_GET;
 	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (device_ipx_changed), self);
-	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (link_changed_cb), self);
 
 	g_slist_free_full (priv->arping.dad_list, (GDestroyNotify) nm_arping_manager_destroy);
 	priv->arping.dad_list = NULL;
@@ -12094,9 +12384,6 @@ dispose (GObject *object)
 
 	_clear_queued_act_request (priv);
 
-	nm_clear_g_source (&priv->device_link_changed_id);
-	nm_clear_g_source (&priv->device_ip_link_changed_id);
-
 	if (priv->lldp_listener) {
 		g_signal_handlers_disconnect_by_func (priv->lldp_listener,
 		                                      G_CALLBACK (lldp_neighbors_changed),
@@ -12128,6 +12415,10 @@ finalize (GObject *object)
 	g_free (priv->hw_addr_initial);
 	g_slist_free_full (priv->pending_actions, g_free);
 	g_slist_free_full (priv->dad6_failed_addrs, g_free);
+	if (priv->ip4_deltas)
+		g_array_unref (priv->ip4_deltas);
+	if (priv->ip6_deltas)
+		g_array_unref (priv->ip6_deltas);
 	g_clear_pointer (&priv->physical_port_id, g_free);
 	g_free (priv->udi);
 	g_free (priv->iface);
@@ -12438,6 +12729,7 @@ nm_device_class_init (NMDeviceClass *klass)
 	klass->spec_match_list = spec_match_list;
 	klass->can_auto_connect = can_auto_connect;
 	klass->check_connection_compatible = check_connection_compatible;
+	klass->candidate_filter_init = candidate_filter_init;
 	klass->check_connection_available = check_connection_available;
 	klass->can_unmanaged_external_down = can_unmanaged_external_down;
 	klass->realize_start_notify = realize_start_notify;
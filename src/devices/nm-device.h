@@ -143,6 +143,10 @@ typedef struct {
 	const char *connection_type;
 	const NMLinkType *link_types;
 
+	/* %NULL terminated list of the connection types that can be
+	 * compatible with the device, or %NULL to allow any type. */
+	const char *const*compatible_connection_types;
+
 	void (*state_changed) (NMDevice *device,
 	                       NMDeviceState new_state,
 	                       NMDeviceState old_state,
@@ -229,6 +233,13 @@ typedef struct {
 	 */
 	gboolean    (* check_connection_compatible) (NMDevice *self, NMConnection *connection);
 
+	/* Describes which connections can possibly be compatible with the device,
+	 * so that they can be looked up without checking every connection.
+	 * The filter must not exclude any connection that check_connection_compatible()
+	 * would accept. Implementations must chain up.
+	 */
+	void        (* candidate_filter_init) (NMDevice *self, NMSettingsCandidateFilter *filter);
+
 	/* Checks whether the connection is likely available to be activated,
 	 * including any live network information like scan lists.  The connection
 	 * is checked against the object defined by @specific_object, if given.
@@ -357,6 +368,8 @@ NMDeviceType    nm_device_get_device_type       (NMDevice *dev);
 NMLinkType      nm_device_get_link_type         (NMDevice *dev);
 NMMetered       nm_device_get_metered           (NMDevice *dev);
 
+void            nm_device_platform_link_changed (NMDevice *self, int ifindex);
+
 int             nm_device_get_priority          (NMDevice *dev);
 guint32         nm_device_get_ip4_route_metric  (NMDevice *dev);
 guint32         nm_device_get_ip6_route_metric  (NMDevice *dev);
@@ -417,6 +430,7 @@ gboolean nm_device_complete_connection (NMDevice *device,
                                         GError **error);
 
 gboolean nm_device_check_connection_compatible (NMDevice *device, NMConnection *connection);
+NMSettingsConnection **nm_device_get_candidate_connections (NMDevice *self, guint *out_len);
 gboolean nm_device_check_slave_connection_compatible (NMDevice *device, NMConnection *connection);
 
 gboolean nm_device_uses_assumed_connection (NMDevice *device);
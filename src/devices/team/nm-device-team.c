@@ -832,6 +832,7 @@ nm_device_team_class_init (NMDeviceTeamClass *klass)
 	g_type_class_add_private (object_class, sizeof (NMDeviceTeamPrivate));
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NM_SETTING_TEAM_SETTING_NAME, NM_LINK_TYPE_TEAM)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_TEAM_SETTING_NAME)
 
 	object_class->constructed = constructed;
 	object_class->dispose = dispose;
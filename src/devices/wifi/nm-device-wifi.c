@@ -671,6 +671,15 @@ check_connection_compatible (NMDevice *device, NMConnection *connection)
 	return TRUE;
 }
 
+static void
+candidate_filter_init (NMDevice *device, NMSettingsCandidateFilter *filter)
+{
+	NM_DEVICE_CLASS (nm_device_wifi_parent_class)->candidate_filter_init (device, filter);
+
+	filter->filter_hwaddr = TRUE;
+	filter->hwaddr = nm_device_get_permanent_hw_address (device, FALSE);
+}
+
 static NMAccessPoint *
 find_first_compatible_ap (NMDeviceWifi *self,
                           NMConnection *connection,
@@ -3136,6 +3145,7 @@ nm_device_wifi_class_init (NMDeviceWifiClass *klass)
 	NMDeviceClass *parent_class = NM_DEVICE_CLASS (klass);
 
 	NM_DEVICE_CLASS_DECLARE_TYPES (klass, NM_SETTING_WIRELESS_SETTING_NAME, NM_LINK_TYPE_WIFI)
+	NM_DEVICE_CLASS_DECLARE_CONNECTION_TYPES (klass, NM_SETTING_WIRELESS_SETTING_NAME)
 
 	object_class->constructed = constructed;
 	object_class->get_property = get_property;
@@ -3147,6 +3157,7 @@ nm_device_wifi_class_init (NMDeviceWifiClass *klass)
 	parent_class->can_auto_connect = can_auto_connect;
 	parent_class->is_available = is_available;
 	parent_class->check_connection_compatible = check_connection_compatible;
+	parent_class->candidate_filter_init = candidate_filter_init;
 	parent_class->check_connection_available = check_connection_available;
 	parent_class->complete_connection = complete_connection;
 	parent_class->set_enabled = set_enabled;
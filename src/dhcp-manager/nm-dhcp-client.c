@@ -43,6 +43,7 @@ typedef struct {
 	GByteArray * hwaddr;
 	gboolean     ipv6;
 	char *       uuid;
+	char *       network_id;
 	guint32      priority;
 	guint32      timeout;
 	GByteArray * duid;
@@ -76,6 +77,7 @@ enum {
 	PROP_HWADDR,
 	PROP_IPV6,
 	PROP_UUID,
+	PROP_NETWORK_ID,
 	PROP_PRIORITY,
 	PROP_TIMEOUT,
 	LAST_PROP
@@ -123,6 +125,14 @@ nm_dhcp_client_get_uuid (NMDhcpClient *self)
 	return NM_DHCP_CLIENT_GET_PRIVATE (self)->uuid;
 }
 
+const char *
+nm_dhcp_client_get_network_id (NMDhcpClient *self)
+{
+	g_return_val_if_fail (NM_IS_DHCP_CLIENT (self), NULL);
+
+	return NM_DHCP_CLIENT_GET_PRIVATE (self)->network_id;
+}
+
 const GByteArray *
 nm_dhcp_client_get_duid (NMDhcpClient *self)
 {
@@ -806,6 +816,9 @@ get_property (GObject *object, guint prop_id,
 	case PROP_UUID:
 		g_value_set_string (value, priv->uuid);
 		break;
+	case PROP_NETWORK_ID:
+		g_value_set_string (value, priv->network_id);
+		break;
 	case PROP_PRIORITY:
 		g_value_set_uint (value, priv->priority);
 		break;
@@ -846,6 +859,10 @@ set_property (GObject *object, guint prop_id,
 		/* construct-only */
 		priv->uuid = g_value_dup_string (value);
 		break;
+	case PROP_NETWORK_ID:
+		/* construct-only */
+		priv->network_id = g_value_dup_string (value);
+		break;
 	case PROP_PRIORITY:
 		/* construct-only */
 		priv->priority = g_value_get_uint (value);
@@ -877,6 +894,7 @@ dispose (GObject *object)
 	g_clear_pointer (&priv->hostname, g_free);
 	g_clear_pointer (&priv->fqdn, g_free);
 	g_clear_pointer (&priv->uuid, g_free);
+	g_clear_pointer (&priv->network_id, g_free);
 	g_clear_pointer (&priv->client_id, g_bytes_unref);
 
 	if (priv->hwaddr) {
@@ -941,6 +959,13 @@ nm_dhcp_client_class_init (NMDhcpClientClass *client_class)
 		                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
 		                      G_PARAM_STATIC_STRINGS));
 
+	g_object_class_install_property
+		(object_class, PROP_NETWORK_ID,
+		 g_param_spec_string (NM_DHCP_CLIENT_NETWORK_ID, "", "",
+		                      NULL,
+		                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+		                      G_PARAM_STATIC_STRINGS));
+
 	g_object_class_install_property
 		(object_class, PROP_PRIORITY,
 		 g_param_spec_uint (NM_DHCP_CLIENT_PRIORITY, "", "",
@@ -188,6 +188,7 @@ client_start (NMDhcpManager *self,
               int ifindex,
               const GByteArray *hwaddr,
               const char *uuid,
+              const char *network_id,
               guint32 priority,
               gboolean ipv6,
               const struct in6_addr *ipv6_ll_addr,
@@ -231,6 +232,7 @@ client_start (NMDhcpManager *self,
 	                       NM_DHCP_CLIENT_HWADDR, hwaddr,
 	                       NM_DHCP_CLIENT_IPV6, ipv6,
 	                       NM_DHCP_CLIENT_UUID, uuid,
+	                       NM_DHCP_CLIENT_NETWORK_ID, network_id,
 	                       NM_DHCP_CLIENT_PRIORITY, priority,
 	                       NM_DHCP_CLIENT_TIMEOUT, timeout ? timeout : DHCP_TIMEOUT,
 	                       NULL);
@@ -266,6 +268,7 @@ nm_dhcp_manager_start_ip4 (NMDhcpManager *self,
                            int ifindex,
                            const GByteArray *hwaddr,
                            const char *uuid,
+                           const char *network_id,
                            guint32 priority,
                            gboolean send_hostname,
                            const char *dhcp_hostname,
@@ -284,7 +287,7 @@ nm_dhcp_manager_start_ip4 (NMDhcpManager *self,
 		hostname = get_send_hostname (self, dhcp_hostname);
 		fqdn = dhcp_fqdn;
 	}
-	return client_start (self, iface, ifindex, hwaddr, uuid, priority, FALSE, NULL,
+	return client_start (self, iface, ifindex, hwaddr, uuid, network_id, priority, FALSE, NULL,
 	                     dhcp_client_id, timeout, dhcp_anycast_addr, hostname,
 	                     fqdn, FALSE, 0, last_ip_address);
 }
@@ -311,7 +314,7 @@ nm_dhcp_manager_start_ip6 (NMDhcpManager *self,
 
 	if (send_hostname)
 		hostname = get_send_hostname (self, dhcp_hostname);
-	return client_start (self, iface, ifindex, hwaddr, uuid, priority, TRUE,
+	return client_start (self, iface, ifindex, hwaddr, uuid, NULL, priority, TRUE,
 	                     ll_addr, NULL, timeout, dhcp_anycast_addr, hostname, NULL, info_only,
 	                     privacy, NULL);
 }
@@ -55,6 +55,7 @@ NMDhcpClient * nm_dhcp_manager_start_ip4     (NMDhcpManager *manager,
                                               int ifindex,
                                               const GByteArray *hwaddr,
                                               const char *uuid,
+                                              const char *network_id,
                                               guint32 priority,
                                               gboolean send_hostname,
                                               const char *dhcp_hostname,
@@ -404,6 +404,28 @@ get_leasefile_path (const char *iface, const char *uuid, gboolean ipv6)
 	                        iface);
 }
 
+/* The address of the last IPv4 lease on the interface and network,
+ * whatever connection it was for, together with the hardware address and
+ * the expiry. Used to request the address in INIT-REBOOT state when the
+ * connection has no lease of its own, for example because its UUID is
+ * generated anew.
+ *
+ * The network is identified by the hardware address and, for Wi-Fi, the
+ * SSID (see NM_DHCP_CLIENT_NETWORK_ID). The server identifier is not known
+ * before talking to a server. So on a wired interface that is plugged
+ * into another network, the server there rejects the address with a NAK,
+ * or the request times out, and the client falls back to DISCOVER.
+ *
+ * The files are not tied to connections. There is at most one per
+ * interface and network, overwritten by each lease. */
+static char *
+get_iface_leasefile_path (const char *iface, const char *network_id)
+{
+	if (network_id)
+		return g_strdup_printf (NMSTATEDIR "/internal-%s-%s.iface-lease", iface, network_id);
+	return g_strdup_printf (NMSTATEDIR "/internal-%s.iface-lease", iface);
+}
+
 static GSList *
 nm_dhcp_systemd_get_lease_ip_configs (const char *iface,
                                       int ifindex,
@@ -456,6 +478,31 @@ _save_client_id (NMDhcpSystemd *self,
 	}
 }
 
+static void
+save_iface_lease (NMDhcpSystemd *self, sd_dhcp_lease *lease)
+{
+	gs_free char *path = NULL;
+	struct in_addr address;
+	uint32_t lifetime = 0;
+	GError *error = NULL;
+
+	if (   sd_dhcp_lease_get_address (lease, &address) < 0
+	    || !address.s_addr)
+		return;
+	sd_dhcp_lease_get_lifetime (lease, &lifetime);
+
+	path = get_iface_leasefile_path (nm_dhcp_client_get_iface (NM_DHCP_CLIENT (self)),
+	                                 nm_dhcp_client_get_network_id (NM_DHCP_CLIENT (self)));
+	if (!nm_dhcp_utils_interface_lease_write (path,
+	                                          nm_dhcp_client_get_hw_addr (NM_DHCP_CLIENT (self)),
+	                                          address.s_addr,
+	                                          (gint64) time (NULL) + lifetime,
+	                                          &error)) {
+		_LOGD ("failed to save interface lease: %s", error->message);
+		g_clear_error (&error);
+	}
+}
+
 static void
 bound4_handle (NMDhcpSystemd *self)
 {
@@ -491,6 +538,7 @@ bound4_handle (NMDhcpSystemd *self)
 
 		add_requests_to_options (options, dhcp4_requests);
 		dhcp_lease_save (lease, priv->lease_file);
+		save_iface_lease (self, lease);
 
 		sd_dhcp_client_get_client_id(priv->client4, &type, &client_id, &client_id_len);
 		if (client_id)
@@ -628,6 +676,16 @@ ip4_start (NMDhcpClient *client, const char *dhcp_anycast_addr, const char *last
 		inet_pton (AF_INET, last_ip4_address, &last_addr);
 	else if (lease)
 		sd_dhcp_lease_get_address (lease, &last_addr);
+	else {
+		gs_free char *iface_lease_file = get_iface_leasefile_path (iface, nm_dhcp_client_get_network_id (client));
+
+		if (nm_dhcp_utils_interface_lease_read (iface_lease_file, hwaddr, time (NULL), &last_addr.s_addr)) {
+			char buf[INET_ADDRSTRLEN];
+
+			_LOGD ("request address %s of the last lease on the interface",
+			       inet_ntop (AF_INET, &last_addr, buf, sizeof (buf)));
+		}
+	}
 
 	if (last_addr.s_addr) {
 		r = sd_dhcp_client_set_request_address (priv->client4, &last_addr);
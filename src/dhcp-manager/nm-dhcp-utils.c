@@ -737,3 +737,102 @@ nm_dhcp_utils_client_id_string_to_bytes (const char *client_id)
 	return bytes;
 }
 
+/*****************************************************************************/
+
+#define INTERFACE_LEASE_GROUP "lease"
+
+/**
+ * nm_dhcp_utils_interface_lease_write:
+ * @filename: the file of the interface lease
+ * @hwaddr: (allow-none): the hardware address the lease was obtained with
+ * @address: the leased IPv4 address
+ * @expiry: the end of the lease, in seconds since the epoch
+ * @error: on return, a location to store any errors that may occur
+ *
+ * Remembers the last IPv4 lease on an interface. The file only contains
+ * what is needed to request the address again in INIT-REBOOT state.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_dhcp_utils_interface_lease_write (const char *filename,
+                                     const GByteArray *hwaddr,
+                                     in_addr_t address,
+                                     gint64 expiry,
+                                     GError **error)
+{
+	gs_unref_keyfile GKeyFile *keyfile = NULL;
+	gs_free char *data = NULL;
+	gsize len;
+	char buf[INET_ADDRSTRLEN];
+
+	g_return_val_if_fail (filename, FALSE);
+	g_return_val_if_fail (address, FALSE);
+
+	keyfile = g_key_file_new ();
+	g_key_file_set_string (keyfile, INTERFACE_LEASE_GROUP, "address",
+	                       inet_ntop (AF_INET, &address, buf, sizeof (buf)));
+	if (hwaddr && hwaddr->len) {
+		gs_free char *str = nm_utils_hwaddr_ntoa (hwaddr->data, hwaddr->len);
+
+		g_key_file_set_string (keyfile, INTERFACE_LEASE_GROUP, "hwaddr", str);
+	}
+	g_key_file_set_int64 (keyfile, INTERFACE_LEASE_GROUP, "expiry", expiry);
+
+	data = g_key_file_to_data (keyfile, &len, NULL);
+	return g_file_set_contents (filename, data, len, error);
+}
+
+/**
+ * nm_dhcp_utils_interface_lease_read:
+ * @filename: the file of the interface lease
+ * @hwaddr: (allow-none): the current hardware address of the interface
+ * @now: the current time, in seconds since the epoch
+ * @out_address: on return, the leased IPv4 address
+ *
+ * Reads the lease written by nm_dhcp_utils_interface_lease_write().
+ * The lease is only returned if it did not expire yet and was
+ * obtained with the same hardware address.
+ *
+ * Returns: %TRUE if there is a usable lease.
+ */
+gboolean
+nm_dhcp_utils_interface_lease_read (const char *filename,
+                                    const GByteArray *hwaddr,
+                                    gint64 now,
+                                    in_addr_t *out_address)
+{
+	gs_unref_keyfile GKeyFile *keyfile = NULL;
+	gs_free char *str_address = NULL;
+	gs_free char *str_hwaddr = NULL;
+	in_addr_t address;
+	gint64 expiry;
+
+	g_return_val_if_fail (filename, FALSE);
+	g_return_val_if_fail (out_address, FALSE);
+
+	keyfile = g_key_file_new ();
+	if (!g_key_file_load_from_file (keyfile, filename, G_KEY_FILE_NONE, NULL))
+		return FALSE;
+
+	str_hwaddr = g_key_file_get_string (keyfile, INTERFACE_LEASE_GROUP, "hwaddr", NULL);
+	if (hwaddr && hwaddr->len) {
+		if (   !str_hwaddr
+		    || !nm_utils_hwaddr_matches (str_hwaddr, -1, hwaddr->data, hwaddr->len))
+			return FALSE;
+	} else if (str_hwaddr)
+		return FALSE;
+
+	expiry = g_key_file_get_int64 (keyfile, INTERFACE_LEASE_GROUP, "expiry", NULL);
+	if (expiry <= now)
+		return FALSE;
+
+	str_address = g_key_file_get_string (keyfile, INTERFACE_LEASE_GROUP, "address", NULL);
+	if (   !str_address
+	    || inet_pton (AF_INET, str_address, &address) != 1
+	    || !address)
+		return FALSE;
+
+	*out_address = address;
+	return TRUE;
+}
@@ -20,6 +20,7 @@
 #define __NETWORKMANAGER_DHCP_UTILS_H__
 
 #include <stdlib.h>
+#include <netinet/in.h>
 
 #include <nm-ip4-config.h>
 #include <nm-ip6-config.h>
@@ -41,5 +42,16 @@ char *       nm_dhcp_utils_duid_to_string          (const GByteArray *duid);
 
 GBytes *     nm_dhcp_utils_client_id_string_to_bytes (const char *client_id);
 
+gboolean nm_dhcp_utils_interface_lease_write (const char *filename,
+                                              const GByteArray *hwaddr,
+                                              in_addr_t address,
+                                              gint64 expiry,
+                                              GError **error);
+
+gboolean nm_dhcp_utils_interface_lease_read (const char *filename,
+                                             const GByteArray *hwaddr,
+                                             gint64 now,
+                                             in_addr_t *out_address);
+
 #endif /* __NETWORKMANAGER_DHCP_UTILS_H__ */
 
@@ -22,6 +22,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "nm-utils.h"
 
@@ -715,6 +716,55 @@ test_client_id_from_string (void)
 	COMPARE_ID (endcolon, TRUE, endcolon, strlen (endcolon));
 }
 
+static void
+test_interface_lease (void)
+{
+	const guint8 mac1[] = { 0x52, 0x54, 0x00, 0x12, 0x34, 0x56 };
+	const guint8 mac2[] = { 0x52, 0x54, 0x00, 0x12, 0x34, 0x57 };
+	GByteArray *hwaddr1, *hwaddr2;
+	GError *error = NULL;
+	char *lease_file;
+	in_addr_t address = 0;
+	int fd;
+
+	hwaddr1 = g_byte_array_append (g_byte_array_new (), mac1, sizeof (mac1));
+	hwaddr2 = g_byte_array_append (g_byte_array_new (), mac2, sizeof (mac2));
+
+	fd = g_file_open_tmp (NULL, &lease_file, &error);
+	g_assert_no_error (error);
+	close (fd);
+
+	g_assert (nm_dhcp_utils_interface_lease_write (lease_file, hwaddr1,
+	                                               nmtst_inet4_from_string ("192.168.1.5"),
+	                                               1000, &error));
+	g_assert_no_error (error);
+
+	g_assert (nm_dhcp_utils_interface_lease_read (lease_file, hwaddr1, 999, &address));
+	g_assert_cmpint (address, ==, nmtst_inet4_from_string ("192.168.1.5"));
+
+	/* expired */
+	g_assert (!nm_dhcp_utils_interface_lease_read (lease_file, hwaddr1, 1000, &address));
+
+	/* obtained with another hardware address */
+	g_assert (!nm_dhcp_utils_interface_lease_read (lease_file, hwaddr2, 999, &address));
+	g_assert (!nm_dhcp_utils_interface_lease_read (lease_file, NULL, 999, &address));
+
+	g_assert (nm_dhcp_utils_interface_lease_write (lease_file, NULL,
+	                                               nmtst_inet4_from_string ("10.0.0.1"),
+	                                               2000, &error));
+	g_assert_no_error (error);
+	g_assert (!nm_dhcp_utils_interface_lease_read (lease_file, hwaddr1, 999, &address));
+	g_assert (nm_dhcp_utils_interface_lease_read (lease_file, NULL, 999, &address));
+	g_assert_cmpint (address, ==, nmtst_inet4_from_string ("10.0.0.1"));
+
+	unlink (lease_file);
+	g_assert (!nm_dhcp_utils_interface_lease_read (lease_file, NULL, 999, &address));
+	g_free (lease_file);
+
+	g_byte_array_unref (hwaddr1);
+	g_byte_array_unref (hwaddr2);
+}
+
 NMTST_DEFINE ();
 
 int main (int argc, char **argv)
@@ -742,6 +792,7 @@ int main (int argc, char **argv)
 	g_test_add_func ("/dhcp/ip4-prefix-classless", test_ip4_prefix_classless);
 	g_test_add_func ("/dhcp/client-id-from-string", test_client_id_from_string);
 	g_test_add_func ("/dhcp/vendor-option-metered", test_vendor_option_metered);
+	g_test_add_func ("/dhcp/interface-lease", test_interface_lease);
 
 	return g_test_run ();
 }
@@ -39,6 +39,7 @@
 #include "NetworkManagerUtils.h"
 #include "nm-manager.h"
 #include "nm-linux-platform.h"
+#include "nm-platform-utils.h"
 #include "nm-bus-manager.h"
 #include "nm-device.h"
 #include "nm-dhcp-manager.h"
@@ -46,6 +47,7 @@
 #include "nm-session-monitor.h"
 #include "nm-dispatcher.h"
 #include "nm-settings.h"
+#include "nm-settings-connection.h"
 #include "nm-auth-manager.h"
 #include "nm-core-internal.h"
 #include "nm-exported-object.h"
@@ -143,6 +145,58 @@ nm_main_config_reload (int signal)
 	nm_config_reload (nm_config_get (), reload_flags);
 }
 
+static void
+_setup_platform_route_filter (void)
+{
+	gs_free char *value = NULL;
+	gs_strfreev char **strv = NULL;
+	guint8 protocols[256];
+	guint i, len = 0;
+	int protocol;
+
+	value = nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
+	                                  NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                  NM_CONFIG_KEYFILE_KEY_IGNORE_ROUTE_PROTOCOLS,
+	                                  NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+	if (!value)
+		return;
+
+	strv = g_strsplit_set (value, ",; \t", -1);
+	for (i = 0; strv[i]; i++) {
+		if (!strv[i][0])
+			continue;
+		protocol = nmp_utils_rtprot_from_string (strv[i]);
+		if (protocol < 0) {
+			nm_log_warn (LOGD_CORE, "config: invalid route protocol \"%s\" in %s", strv[i],
+			             NM_CONFIG_KEYFILE_KEY_IGNORE_ROUTE_PROTOCOLS);
+			continue;
+		}
+		if (len < G_N_ELEMENTS (protocols))
+			protocols[len++] = protocol;
+	}
+
+	nm_linux_platform_set_route_protocols_ignore (NM_PLATFORM_GET, protocols, len);
+}
+
+static void
+_setup_bus_manager_properties_changed (void)
+{
+	gint64 max_latency, max_objects;
+
+	max_latency = _nm_utils_ascii_str_to_int64 (nm_config_data_get_value_cached (NM_CONFIG_GET_DATA_ORIG,
+	                                                                           NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                                                           NM_CONFIG_KEYFILE_KEY_DBUS_PROPERTIES_MAX_LATENCY,
+	                                                                           NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY),
+	                                            10, 0, 60000, NM_BUS_MANAGER_PROPERTIES_MAX_LATENCY_DEFAULT);
+	max_objects = _nm_utils_ascii_str_to_int64 (nm_config_data_get_value_cached (NM_CONFIG_GET_DATA_ORIG,
+	                                                                           NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                                                           NM_CONFIG_KEYFILE_KEY_DBUS_PROPERTIES_BATCH_SIZE,
+	                                                                           NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY),
+	                                            10, 0, G_MAXINT, NM_BUS_MANAGER_PROPERTIES_BATCH_SIZE_DEFAULT);
+
+	nm_bus_manager_set_properties_changed_limits (nm_bus_manager_get (), max_latency, max_objects);
+}
+
 static void
 manager_configure_quit (NMManager *manager, gpointer user_data)
 {
@@ -215,6 +269,7 @@ main (int argc, char *argv[])
 	char *bad_domains = NULL;
 	NMConfigCmdLineOptions *config_cli;
 	guint sd_id = 0;
+	gint64 rcvbuf_max;
 
 	nm_g_type_init ();
 
@@ -364,6 +419,8 @@ main (int argc, char *argv[])
 
 	nm_auth_manager_setup (nm_config_get_auth_polkit (config));
 
+	_setup_bus_manager_properties_changed ();
+
 	nm_manager_setup ();
 
 	if (!nm_bus_manager_get_connection (nm_bus_manager_get ())) {
@@ -378,6 +435,13 @@ main (int argc, char *argv[])
 
 	/* Set up platform interaction layer */
 	nm_linux_platform_setup ();
+	rcvbuf_max = _nm_utils_ascii_str_to_int64 (nm_config_data_get_value_cached (NM_CONFIG_GET_DATA_ORIG,
+	                                                                          NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                                                          NM_CONFIG_KEYFILE_KEY_NETLINK_RCVBUF_MAX,
+	                                                                          NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY),
+	                                           10, 0, G_MAXINT, 0);
+	nm_linux_platform_set_netlink_rcvbuf_max (NM_PLATFORM_GET, rcvbuf_max);
+	_setup_platform_route_filter ();
 
 	NM_UTILS_KEEP_ALIVE (config, NM_PLATFORM_GET, "NMConfig-depends-on-NMPlatform");
 
@@ -416,6 +480,10 @@ done:
 
 	nm_manager_stop (nm_manager_get ());
 
+	nm_dispatcher_shutdown ();
+
+	nm_settings_connection_flush_state_db ();
+
 	nm_config_state_set (config, TRUE, TRUE);
 
 	if (global_opt.pidfile && wrote_pidfile)
@@ -30,6 +30,13 @@
 #define POLKIT_OBJECT_PATH                  "/org/freedesktop/PolicyKit1/Authority"
 #define POLKIT_INTERFACE                    "org.freedesktop.PolicyKit1.Authority"
 
+/* Results of CheckAuthorization are cached per subject and action, until
+ * polkit announces a change of its configuration. Also, the authorization
+ * for a subject can depend on whether its session is active, which polkit
+ * doesn't announce. Hence, cached results are only used for a short time. */
+#define AUTH_CACHE_LIFETIME_MSEC            (10 * 1000)
+#define AUTH_CACHE_MAX_ENTRIES              1000
+
 
 #define _NMLOG_PREFIX_NAME    "auth"
 #define _NMLOG_DOMAIN         LOGD_CORE
@@ -68,6 +75,13 @@ typedef struct {
 	GCancellable *new_proxy_cancellable;
 	GSList *queued_calls;
 	GDBusProxy *proxy;
+
+	struct {
+		GHashTable *entries;
+		guint generation;
+		guint hits;
+		guint misses;
+	} cache;
 #endif
 } NMAuthManagerPrivate;
 
@@ -96,6 +110,20 @@ typedef enum {
 	POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION = (1<<0),
 } PolkitCheckAuthorizationFlags;
 
+typedef struct {
+	gulong pid;
+	gulong uid;
+	guint64 start_time;
+	char *action_id;
+	PolkitCheckAuthorizationFlags flags;
+} AuthCacheKey;
+
+typedef struct {
+	AuthCacheKey key;
+	gint64 expiry_msec;
+	gboolean is_authorized;
+} AuthCacheEntry;
+
 typedef struct {
 	guint call_id;
 	NMAuthManager *self;
@@ -103,13 +131,137 @@ typedef struct {
 	gchar *cancellation_id;
 	GVariant *dbus_parameters;
 	GCancellable *cancellable;
+	AuthCacheKey cache_key;
+	guint cache_generation;
 } CheckAuthData;
 
+static guint
+_auth_cache_key_hash (gconstpointer ptr)
+{
+	const AuthCacheKey *key = ptr;
+	guint h;
+
+	h = g_str_hash (key->action_id);
+	h = (h * 33) + (guint) key->pid;
+	h = (h * 33) + (guint) key->uid;
+	h = (h * 33) + (guint) key->start_time;
+	h = (h * 33) + (guint) key->flags;
+	return h;
+}
+
+static gboolean
+_auth_cache_key_equal (gconstpointer a, gconstpointer b)
+{
+	const AuthCacheKey *key_a = a;
+	const AuthCacheKey *key_b = b;
+
+	return    key_a->pid == key_b->pid
+	       && key_a->uid == key_b->uid
+	       && key_a->start_time == key_b->start_time
+	       && key_a->flags == key_b->flags
+	       && nm_streq (key_a->action_id, key_b->action_id);
+}
+
+static void
+_auth_cache_entry_free (gpointer data)
+{
+	AuthCacheEntry *entry = data;
+
+	g_free (entry->key.action_id);
+	g_slice_free (AuthCacheEntry, entry);
+}
+
+static void
+_auth_cache_clear (NMAuthManager *self)
+{
+	NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE (self);
+
+	/* results of calls that are still pending are no longer cached either. */
+	priv->cache.generation++;
+
+	if (g_hash_table_size (priv->cache.entries) > 0) {
+		_LOGD ("cache: flush %u entries (hits=%u, misses=%u)",
+		       g_hash_table_size (priv->cache.entries),
+		       priv->cache.hits, priv->cache.misses);
+		g_hash_table_remove_all (priv->cache.entries);
+	}
+}
+
+static const AuthCacheEntry *
+_auth_cache_lookup (NMAuthManager *self, const AuthCacheKey *key)
+{
+	NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE (self);
+	AuthCacheEntry *entry;
+
+	entry = g_hash_table_lookup (priv->cache.entries, key);
+	if (   entry
+	    && entry->expiry_msec <= nm_utils_get_monotonic_timestamp_ms ()) {
+		g_hash_table_remove (priv->cache.entries, &entry->key);
+		entry = NULL;
+	}
+	return entry;
+}
+
+static gboolean
+_auth_cache_expired_cb (gpointer key, gpointer value, gpointer user_data)
+{
+	return ((AuthCacheEntry *) value)->expiry_msec <= *((gint64 *) user_data);
+}
+
+static void
+_auth_cache_add (NMAuthManager *self, const AuthCacheKey *key, gboolean is_authorized)
+{
+	NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE (self);
+	AuthCacheEntry *entry;
+	gint64 now;
+
+	now = nm_utils_get_monotonic_timestamp_ms ();
+
+	if (g_hash_table_size (priv->cache.entries) >= AUTH_CACHE_MAX_ENTRIES) {
+		g_hash_table_foreach_remove (priv->cache.entries, _auth_cache_expired_cb, &now);
+		if (g_hash_table_size (priv->cache.entries) >= AUTH_CACHE_MAX_ENTRIES)
+			g_hash_table_remove_all (priv->cache.entries);
+	}
+
+	entry = g_slice_new (AuthCacheEntry);
+	entry->key = *key;
+	entry->key.action_id = g_strdup (key->action_id);
+	entry->expiry_msec = now + AUTH_CACHE_LIFETIME_MSEC;
+	entry->is_authorized = is_authorized;
+	g_hash_table_replace (priv->cache.entries, &entry->key, entry);
+}
+
+/**
+ * nm_auth_manager_get_cache_stats:
+ * @self: the #NMAuthManager
+ * @out_hits: (allow-none): the number of authorization checks answered
+ *   from the cache
+ * @out_misses: (allow-none): the number of authorization checks that
+ *   had to ask polkit
+ */
+void
+nm_auth_manager_get_cache_stats (NMAuthManager *self,
+                                 guint *out_hits,
+                                 guint *out_misses)
+{
+	NMAuthManagerPrivate *priv;
+
+	g_return_if_fail (NM_IS_AUTH_MANAGER (self));
+
+	priv = NM_AUTH_MANAGER_GET_PRIVATE (self);
+
+	if (out_hits)
+		*out_hits = priv->cache.hits;
+	if (out_misses)
+		*out_misses = priv->cache.misses;
+}
+
 static void
 _check_auth_data_free (CheckAuthData *data)
 {
 	if (data->dbus_parameters)
 		g_variant_unref (data->dbus_parameters);
+	g_free (data->cache_key.action_id);
 	g_object_unref (data->self);
 	g_object_unref (data->simple);
 	g_clear_object (&data->cancellable);
@@ -196,6 +348,8 @@ check_authorization_cb (GDBusProxy *proxy,
 		g_error_free (error);
 	} else {
 		CheckAuthorizationResult *result;
+		gs_unref_variant GVariant *details = NULL;
+		const char *temporary_authorization_id = NULL;
 
 		result = g_new0 (CheckAuthorizationResult, 1);
 
@@ -203,10 +357,25 @@ check_authorization_cb (GDBusProxy *proxy,
 		               "((bb@a{ss}))",
 		               &result->is_authorized,
 		               &result->is_challenge,
-		               NULL);
+		               &details);
 		g_variant_unref (value);
 
-		_LOGD ("call[%u]: CheckAuthorization succeeded: (is_authorized=%d, is_challenge=%d)", data->call_id, result->is_authorized, result->is_challenge);
+		g_variant_lookup (details, "polkit.temporary_authorization_id", "&s", &temporary_authorization_id);
+
+		_LOGD ("call[%u]: CheckAuthorization succeeded: (is_authorized=%d, is_challenge=%d%s)", data->call_id, result->is_authorized, result->is_challenge,
+		       temporary_authorization_id ? ", temporary" : "");
+
+		/* Only cache final answers. A challenge depends on the user interaction,
+		 * and a temporary authorization (auth_*_keep) expires or can be revoked
+		 * without polkit announcing it. The key of interactive calls is never
+		 * set, because a one-shot authentication (auth_admin, auth_self)
+		 * is answered without a temporary authorization. */
+		if (   data->cache_key.action_id
+		    && data->cache_generation == priv->cache.generation
+		    && !result->is_challenge
+		    && !temporary_authorization_id)
+			_auth_cache_add (self, &data->cache_key, result->is_authorized);
+
 		g_simple_async_result_set_op_res_gpointer (data->simple, result, g_free);
 	}
 
@@ -248,6 +417,9 @@ nm_auth_manager_polkit_authority_check_authorization (NMAuthManager *self,
 	GVariant *subject_value;
 	GVariant *details_value;
 	CheckAuthData *data;
+	AuthCacheKey cache_key;
+	const AuthCacheEntry *cache_entry;
+	gboolean use_cache;
 
 	g_return_if_fail (NM_IS_AUTH_MANAGER (self));
 	g_return_if_fail (NM_IS_AUTH_SUBJECT (subject));
@@ -263,6 +435,45 @@ nm_auth_manager_polkit_authority_check_authorization (NMAuthManager *self,
 	    ? POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION
 	    : POLKIT_CHECK_AUTHORIZATION_FLAGS_NONE;
 
+	cache_key.pid = nm_auth_subject_get_unix_process_pid (subject);
+	cache_key.uid = nm_auth_subject_get_unix_process_uid (subject);
+	cache_key.start_time = nm_auth_subject_get_unix_process_start_time (subject);
+	cache_key.action_id = (char *) action_id;
+	cache_key.flags = flags;
+
+	/* Only non-interactive calls use the cache. Without start time, the pid
+	 * could be reused by another process. */
+	use_cache =    flags == POLKIT_CHECK_AUTHORIZATION_FLAGS_NONE
+	            && cache_key.start_time != 0;
+
+	if (use_cache) {
+		cache_entry = _auth_cache_lookup (self, &cache_key);
+		if (cache_entry) {
+			GSimpleAsyncResult *simple;
+			CheckAuthorizationResult *result;
+
+			priv->cache.hits++;
+			_LOGD ("call[%u]: CheckAuthorization(%s), subject=%s (cached: is_authorized=%d)",
+			       ++priv->call_id_counter, action_id,
+			       nm_auth_subject_to_string (subject, subject_buf, sizeof (subject_buf)),
+			       cache_entry->is_authorized);
+
+			result = g_new0 (CheckAuthorizationResult, 1);
+			result->is_authorized = cache_entry->is_authorized;
+
+			simple = g_simple_async_result_new (G_OBJECT (self),
+			                                    callback,
+			                                    user_data,
+			                                    nm_auth_manager_polkit_authority_check_authorization);
+			g_simple_async_result_set_check_cancellable (simple, cancellable);
+			g_simple_async_result_set_op_res_gpointer (simple, result, g_free);
+			g_simple_async_result_complete_in_idle (simple);
+			g_object_unref (simple);
+			return;
+		}
+		priv->cache.misses++;
+	}
+
 	subject_value = nm_auth_subject_unix_process_to_polkit_gvariant (subject);
 	nm_assert (g_variant_is_floating (subject_value));
 
@@ -281,6 +492,11 @@ nm_auth_manager_polkit_authority_check_authorization (NMAuthManager *self,
 		data->cancellation_id = g_strdup_printf ("cancellation-id-%u", data->call_id);
 		data->cancellable = g_object_ref (cancellable);
 	}
+	if (use_cache) {
+		data->cache_key = cache_key;
+		data->cache_key.action_id = g_strdup (action_id);
+		data->cache_generation = priv->cache.generation;
+	}
 
 	data->dbus_parameters = g_variant_new ("(@(sa{sv})s@a{ss}us)",
 	                                       subject_value,
@@ -341,6 +557,10 @@ nm_auth_manager_polkit_authority_check_authorization_finish (NMAuthManager *self
 static void
 _emit_changed_signal (NMAuthManager *self)
 {
+	/* all reasons to emit the signal (a new or lost polkit daemon,
+	 * the "Changed" signal) also invalidate the cached results. */
+	_auth_cache_clear (self);
+
 	_LOGD ("emit changed signal");
 	g_signal_emit_by_name (self, NM_AUTH_MANAGER_SIGNAL_CHANGED);
 }
@@ -533,6 +753,12 @@ set_property (GObject *object, guint prop_id, const GValue *value, GParamSpec *p
 static void
 nm_auth_manager_init (NMAuthManager *self)
 {
+#if WITH_POLKIT
+	NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE (self);
+
+	priv->cache.entries = g_hash_table_new_full (_auth_cache_key_hash, _auth_cache_key_equal,
+	                                             NULL, _auth_cache_entry_free);
+#endif
 }
 
 static void
@@ -595,6 +821,11 @@ dispose (GObject *object)
 		g_signal_handlers_disconnect_by_data (priv->proxy, self);
 		g_clear_object (&priv->proxy);
 	}
+
+	if (priv->cache.entries) {
+		_LOGD ("cache: hits=%u, misses=%u", priv->cache.hits, priv->cache.misses);
+		g_clear_pointer (&priv->cache.entries, g_hash_table_unref);
+	}
 #endif
 
 	G_OBJECT_CLASS (nm_auth_manager_parent_class)->dispose (object);
@@ -70,6 +70,10 @@ gboolean nm_auth_manager_polkit_authority_check_authorization_finish (NMAuthMana
                                                                       gboolean *out_is_challenge,
                                                                       GError **error);
 
+void nm_auth_manager_get_cache_stats (NMAuthManager *self,
+                                     guint *out_hits,
+                                     guint *out_misses);
+
 #endif
 
 G_END_DECLS
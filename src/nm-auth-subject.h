@@ -60,6 +60,8 @@ gboolean nm_auth_subject_is_unix_process (NMAuthSubject *subject);
 
 gulong nm_auth_subject_get_unix_process_pid (NMAuthSubject *subject);
 
+guint64 nm_auth_subject_get_unix_process_start_time (NMAuthSubject *subject);
+
 const char *nm_auth_subject_get_unix_process_dbus_sender (NMAuthSubject *subject);
 
 
@@ -72,6 +72,17 @@ typedef struct {
 
 	gulong bus_closed_id;
 	guint reconnect_id;
+
+	/* exported objects with pending PropertiesChanged signals, in the
+	 * order they were scheduled. */
+	struct {
+		GQueue queue;
+		GHashTable *links;  /* NMExportedObject -> GList link in @queue */
+		guint idle_id;
+		guint timeout_id;
+		guint max_latency_msec;
+		guint max_objects;
+	} props;
 } NMBusManagerPrivate;
 
 static gboolean nm_bus_manager_init_bus (NMBusManager *self);
@@ -572,6 +583,11 @@ nm_bus_manager_init (NMBusManager *self)
 	NMBusManagerPrivate *priv = NM_BUS_MANAGER_GET_PRIVATE (self);
 
 	priv->obj_manager = g_dbus_object_manager_server_new (OBJECT_MANAGER_SERVER_BASE_PATH);
+
+	g_queue_init (&priv->props.queue);
+	priv->props.links = g_hash_table_new (g_direct_hash, g_direct_equal);
+	priv->props.max_latency_msec = NM_BUS_MANAGER_PROPERTIES_MAX_LATENCY_DEFAULT;
+	priv->props.max_objects = NM_BUS_MANAGER_PROPERTIES_BATCH_SIZE_DEFAULT;
 }
 
 static void
@@ -604,6 +620,11 @@ nm_bus_manager_dispose (GObject *object)
 
 	nm_clear_g_source (&priv->reconnect_id);
 
+	nm_clear_g_source (&priv->props.idle_id);
+	nm_clear_g_source (&priv->props.timeout_id);
+	g_queue_clear (&priv->props.queue);
+	g_clear_pointer (&priv->props.links, g_hash_table_unref);
+
 	G_OBJECT_CLASS (nm_bus_manager_parent_class)->dispose (object);
 }
 
@@ -874,6 +895,184 @@ nm_bus_manager_unregister_object (NMBusManager *self,
 	g_dbus_object_manager_server_unexport (priv->obj_manager, path);
 }
 
+/**************************************************************/
+
+static void _props_schedule (NMBusManager *self, gboolean overdue);
+
+static void
+_props_flush (NMBusManager *self)
+{
+	NMBusManagerPrivate *priv = NM_BUS_MANAGER_GET_PRIVATE (self);
+	NMExportedObject *object;
+	guint n = 0;
+
+	nm_clear_g_source (&priv->props.idle_id);
+	nm_clear_g_source (&priv->props.timeout_id);
+
+	while (   n < priv->props.max_objects
+	       && (object = g_queue_pop_head (&priv->props.queue))) {
+		g_hash_table_remove (priv->props.links, object);
+
+		/* emitting may cancel or schedule other objects, but the
+		 * queue is consistent at this point. */
+		g_object_ref (object);
+		_nm_exported_object_emit_properties_changed (object);
+		g_object_unref (object);
+		n++;
+	}
+
+	if (!g_queue_is_empty (&priv->props.queue)) {
+		_LOGT ("emitted PropertiesChanged for %u objects, %u remaining",
+		       n, g_queue_get_length (&priv->props.queue));
+		_props_schedule (self, TRUE);
+	}
+}
+
+static gboolean
+_props_idle_cb (gpointer user_data)
+{
+	NMBusManager *self = user_data;
+
+	NM_BUS_MANAGER_GET_PRIVATE (self)->props.idle_id = 0;
+	_props_flush (self);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+_props_timeout_cb (gpointer user_data)
+{
+	NMBusManager *self = user_data;
+
+	NM_BUS_MANAGER_GET_PRIVATE (self)->props.timeout_id = 0;
+	_props_flush (self);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_props_schedule (NMBusManager *self, gboolean overdue)
+{
+	NMBusManagerPrivate *priv = NM_BUS_MANAGER_GET_PRIVATE (self);
+
+	/* The idle source has a lower priority than the sources of netlink and
+	 * D-Bus requests, so a burst of changes doesn't delay processing them.
+	 * The timeout bounds the delay in case the main loop never gets idle. */
+	if (!priv->props.idle_id)
+		priv->props.idle_id = g_idle_add (_props_idle_cb, self);
+	if (!priv->props.timeout_id && priv->props.max_latency_msec > 0) {
+		if (overdue) {
+			/* The objects left over after a full batch may already have
+			 * waited up to max_latency_msec. Don't start the timeout again
+			 * but emit the next batch in the next main loop iteration. */
+			priv->props.timeout_id = g_idle_add_full (G_PRIORITY_DEFAULT, _props_timeout_cb, self, NULL);
+		} else
+			priv->props.timeout_id = g_timeout_add (priv->props.max_latency_msec, _props_timeout_cb, self);
+	}
+}
+
+/**
+ * nm_bus_manager_set_properties_changed_limits:
+ * @self: the #NMBusManager
+ * @max_latency_msec: the maximum delay of a PropertiesChanged signal
+ *   while the main loop is busy, or 0 to only emit when it is idle.
+ * @max_objects: the maximum number of objects that emit their
+ *   PropertiesChanged signal in one main loop iteration, or 0 for
+ *   no limit.
+ */
+void
+nm_bus_manager_set_properties_changed_limits (NMBusManager *self,
+                                              guint max_latency_msec,
+                                              guint max_objects)
+{
+	NMBusManagerPrivate *priv;
+
+	g_return_if_fail (NM_IS_BUS_MANAGER (self));
+
+	priv = NM_BUS_MANAGER_GET_PRIVATE (self);
+
+	priv->props.max_latency_msec = max_latency_msec;
+	priv->props.max_objects = max_objects ? max_objects : G_MAXUINT;
+
+	if (!g_queue_is_empty (&priv->props.queue)) {
+		nm_clear_g_source (&priv->props.timeout_id);
+		_props_schedule (self, FALSE);
+	}
+}
+
+/**
+ * nm_bus_manager_schedule_properties_changed:
+ * @self: the #NMBusManager
+ * @object: the exported object that has pending property changes
+ *
+ * Schedules @object to emit its PropertiesChanged signal. The signals
+ * of all scheduled objects are emitted together, with one idle source
+ * and one timeout source for all of them. Scheduling an object that is
+ * already scheduled does nothing; the object keeps its place in the queue.
+ *
+ * The bus manager doesn't take a reference on @object, it must be
+ * cancelled before it is destroyed.
+ */
+void
+nm_bus_manager_schedule_properties_changed (NMBusManager *self,
+                                            NMExportedObject *object)
+{
+	NMBusManagerPrivate *priv;
+
+	g_return_if_fail (NM_IS_BUS_MANAGER (self));
+	g_return_if_fail (NM_IS_EXPORTED_OBJECT (object));
+
+	priv = NM_BUS_MANAGER_GET_PRIVATE (self);
+
+	if (!priv->props.links) {
+		/* disposed. */
+		return;
+	}
+
+	if (g_hash_table_contains (priv->props.links, object))
+		return;
+
+	g_queue_push_tail (&priv->props.queue, object);
+	g_hash_table_insert (priv->props.links, object, priv->props.queue.tail);
+
+	_props_schedule (self, FALSE);
+}
+
+/**
+ * nm_bus_manager_cancel_properties_changed:
+ * @self: the #NMBusManager
+ * @object: the exported object
+ *
+ * Removes @object from the objects scheduled by
+ * nm_bus_manager_schedule_properties_changed(), if it is scheduled.
+ */
+void
+nm_bus_manager_cancel_properties_changed (NMBusManager *self,
+                                          NMExportedObject *object)
+{
+	NMBusManagerPrivate *priv;
+	GList *link;
+
+	g_return_if_fail (NM_IS_BUS_MANAGER (self));
+
+	priv = NM_BUS_MANAGER_GET_PRIVATE (self);
+
+	if (!priv->props.links)
+		return;
+
+	link = g_hash_table_lookup (priv->props.links, object);
+	if (!link)
+		return;
+
+	g_hash_table_remove (priv->props.links, object);
+	g_queue_delete_link (&priv->props.queue, link);
+
+	if (g_queue_is_empty (&priv->props.queue)) {
+		nm_clear_g_source (&priv->props.idle_id);
+		nm_clear_g_source (&priv->props.timeout_id);
+	}
+}
+
+/**************************************************************/
+
 const char *
 nm_bus_manager_connection_get_private_name (NMBusManager *self,
                                             GDBusConnection *connection)
@@ -35,6 +35,13 @@ G_BEGIN_DECLS
 #define NM_BUS_MANAGER_PRIVATE_CONNECTION_NEW           "private-connection-new"
 #define NM_BUS_MANAGER_PRIVATE_CONNECTION_DISCONNECTED  "private-connection-disconnected"
 
+/* Pending PropertiesChanged signals are emitted when the main loop is idle,
+ * but at the latest after NM_BUS_MANAGER_PROPERTIES_MAX_LATENCY_DEFAULT msec.
+ * At most NM_BUS_MANAGER_PROPERTIES_BATCH_SIZE_DEFAULT objects emit their
+ * signal per main loop iteration, the others wait for the next one. */
+#define NM_BUS_MANAGER_PROPERTIES_MAX_LATENCY_DEFAULT   200
+#define NM_BUS_MANAGER_PROPERTIES_BATCH_SIZE_DEFAULT    500
+
 struct _NMBusManager {
 	GObject parent;
 };
@@ -91,6 +98,16 @@ void nm_bus_manager_unregister_object (NMBusManager *self,
 GDBusObjectSkeleton *nm_bus_manager_get_registered_object (NMBusManager *self,
                                                            const char *path);
 
+void nm_bus_manager_set_properties_changed_limits (NMBusManager *self,
+                                                  guint max_latency_msec,
+                                                  guint max_objects);
+
+void nm_bus_manager_schedule_properties_changed (NMBusManager *self,
+                                                 NMExportedObject *object);
+
+void nm_bus_manager_cancel_properties_changed (NMBusManager *self,
+                                               NMExportedObject *object);
+
 void nm_bus_manager_private_server_register (NMBusManager *self,
                                              const char *path,
                                              const char *tag);
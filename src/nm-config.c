@@ -90,6 +90,7 @@ typedef struct {
 
 	char **plugins;
 	gboolean monitor_connection_files;
+	guint connection_load_threads;
 	gboolean auth_polkit;
 	char *dhcp_client;
 
@@ -275,6 +276,14 @@ nm_config_get_monitor_connection_files (NMConfig *config)
 	return NM_CONFIG_GET_PRIVATE (config)->monitor_connection_files;
 }
 
+guint
+nm_config_get_connection_load_threads (NMConfig *config)
+{
+	g_return_val_if_fail (config != NULL, 0);
+
+	return NM_CONFIG_GET_PRIVATE (config)->connection_load_threads;
+}
+
 gboolean
 nm_config_get_auth_polkit (NMConfig *config)
 {
@@ -2094,6 +2103,13 @@ init_sync (GInitable *initable, GCancellable *cancellable, GError **error)
 
 	priv->monitor_connection_files = nm_config_keyfile_get_boolean (keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "monitor-connection-files", FALSE);
 
+	{
+		gs_free char *value = NULL;
+
+		value = g_key_file_get_string (keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "connection-load-threads", NULL);
+		priv->connection_load_threads = _nm_utils_ascii_str_to_int64 (value, 10, 0, 64, 0);
+	}
+
 	priv->auth_polkit = nm_config_keyfile_get_boolean (keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "auth-polkit", NM_CONFIG_DEFAULT_AUTH_POLKIT);
 
 	priv->dhcp_client = nm_strstrip (g_key_file_get_string (keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "dhcp", NULL));
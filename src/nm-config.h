@@ -69,6 +69,10 @@
 #define NM_CONFIG_KEYFILE_KEY_IFNET_MANAGED                 "managed"
 #define NM_CONFIG_KEYFILE_KEY_IFUPDOWN_MANAGED              "managed"
 #define NM_CONFIG_KEYFILE_KEY_AUDIT                         "audit"
+#define NM_CONFIG_KEYFILE_KEY_NETLINK_RCVBUF_MAX            "netlink-rcvbuf-max"
+#define NM_CONFIG_KEYFILE_KEY_IGNORE_ROUTE_PROTOCOLS        "ignore-route-protocols"
+#define NM_CONFIG_KEYFILE_KEY_DBUS_PROPERTIES_MAX_LATENCY   "dbus-properties-max-latency"
+#define NM_CONFIG_KEYFILE_KEY_DBUS_PROPERTIES_BATCH_SIZE    "dbus-properties-batch-size"
 
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_IGNORE_CARRIER         "ignore-carrier"
 
@@ -122,6 +126,7 @@ NMConfigData *nm_config_get_data_orig (NMConfig *config);
 
 const char **nm_config_get_plugins (NMConfig *config);
 gboolean nm_config_get_monitor_connection_files (NMConfig *config);
+guint nm_config_get_connection_load_threads (NMConfig *config);
 gboolean nm_config_get_auth_polkit (NMConfig *config);
 const char *nm_config_get_dhcp_client (NMConfig *config);
 const char *nm_config_get_log_level (NMConfig *config);
@@ -367,6 +367,264 @@ nm_utils_array_remove_at_indexes (GArray *array, const guint *indexes_to_delete,
 	g_array_set_size (array, res_length);
 }
 
+/*****************************************************************************/
+
+/* Below this length, looking up an element in an array is done by scanning
+ * it, which is cheaper than building the hash index. */
+#define ARRAY_INDEX_MIN_LEN 16
+
+#define _array_elt(array, i) ((gpointer) &(array)->data[(gsize) (i) * g_array_get_element_size ((GArray *) (array))])
+
+/**
+ * nm_utils_array_find_indexed:
+ * @array: the #GArray to search
+ * @p_index: (inout): the hash index of @array, or %NULL
+ * @hash_func: hash function for the identity of the elements
+ * @equal_func: compares the identity of two elements
+ * @needle: element to search for
+ *
+ * Finds the first element in @array that is equal to @needle according
+ * to @equal_func. For larger arrays, a hash index is built on demand in
+ * @p_index. The index contains pointers into @array, so it must be kept up
+ * to date with nm_utils_array_append_indexed() and nm_utils_array_remove_indexed(),
+ * or cleared whenever elements are moved otherwise.
+ *
+ * Returns: the index of the element, or -1 if no such element exists.
+ */
+int
+nm_utils_array_find_indexed (const GArray *array,
+                             GHashTable **p_index,
+                             GHashFunc hash_func,
+                             GEqualFunc equal_func,
+                             gconstpointer needle)
+{
+	gconstpointer item;
+	guint i;
+
+	nm_assert (array);
+	nm_assert (p_index);
+
+	if (!*p_index) {
+		if (array->len < ARRAY_INDEX_MIN_LEN) {
+			for (i = 0; i < array->len; i++) {
+				if (equal_func (_array_elt (array, i), needle))
+					return (int) i;
+			}
+			return -1;
+		}
+
+		*p_index = g_hash_table_new (hash_func, equal_func);
+		for (i = 0; i < array->len; i++) {
+			item = _array_elt (array, i);
+			/* the index points to the first of equal elements. */
+			if (!g_hash_table_contains (*p_index, item))
+				g_hash_table_add (*p_index, (gpointer) item);
+		}
+	}
+
+	item = g_hash_table_lookup (*p_index, needle);
+	if (!item)
+		return -1;
+	return ((const char *) item - array->data) / g_array_get_element_size ((GArray *) array);
+}
+
+/**
+ * nm_utils_array_append_indexed:
+ * @array: the #GArray
+ * @p_index: (inout): the hash index of @array, or %NULL
+ * @item: the element to append
+ *
+ * Appends @item to @array and updates the index. If the array
+ * gets reallocated, the index is dropped.
+ */
+void
+nm_utils_array_append_indexed (GArray *array, GHashTable **p_index, gconstpointer item)
+{
+	const char *data_old = array->data;
+	gpointer item_new;
+
+	g_array_append_vals (array, item, 1);
+
+	if (!*p_index)
+		return;
+	if (array->data != data_old) {
+		g_clear_pointer (p_index, g_hash_table_unref);
+		return;
+	}
+
+	item_new = _array_elt (array, array->len - 1);
+	if (!g_hash_table_contains (*p_index, item_new))
+		g_hash_table_add (*p_index, item_new);
+}
+
+/**
+ * nm_utils_array_remove_indexed:
+ * @array: the #GArray
+ * @p_index: (inout): the hash index of @array, or %NULL
+ * @idx: the index of the element to remove
+ *
+ * Removes the element at @idx from @array. The following elements
+ * move, and their entries in the index are updated accordingly.
+ */
+void
+nm_utils_array_remove_indexed (GArray *array, GHashTable **p_index, guint idx)
+{
+	gs_unref_array GArray *moved = NULL;
+	gpointer item, found;
+	gboolean item_indexed, replaced = FALSE;
+	guint i, j;
+
+	g_return_if_fail (idx < array->len);
+
+	if (!*p_index) {
+		g_array_remove_index (array, idx);
+		return;
+	}
+
+	item = _array_elt (array, idx);
+	item_indexed = (g_hash_table_lookup (*p_index, item) == item);
+
+	/* The index points to the first of equal elements. Find the indexed
+	 * elements after @idx, and if @item was indexed, the next element
+	 * equal to it. They move down by one and must be indexed anew. */
+	for (i = idx + 1; i < array->len; i++) {
+		gpointer elt = _array_elt (array, i);
+
+		found = g_hash_table_lookup (*p_index, elt);
+		if (found == elt) {
+			if (!moved)
+				moved = g_array_new (FALSE, FALSE, sizeof (guint));
+			g_array_append_val (moved, i);
+			g_hash_table_remove (*p_index, elt);
+		} else if (   item_indexed
+		           && !replaced
+		           && found == item) {
+			if (!moved)
+				moved = g_array_new (FALSE, FALSE, sizeof (guint));
+			g_array_append_val (moved, i);
+			replaced = TRUE;
+		}
+	}
+	if (item_indexed)
+		g_hash_table_remove (*p_index, item);
+
+	g_array_remove_index (array, idx);
+
+	for (j = 0; moved && j < moved->len; j++)
+		g_hash_table_add (*p_index, _array_elt (array, g_array_index (moved, guint, j) - 1));
+}
+
+static gboolean
+_array_remove_flagged (GArray *array, GHashTable **p_index, const guint8 *remove)
+{
+	gs_unref_array GArray *to_delete = NULL;
+	guint i;
+
+	for (i = 0; i < array->len; i++) {
+		if (!remove[i])
+			continue;
+		if (!to_delete)
+			to_delete = g_array_new (FALSE, FALSE, sizeof (guint));
+		g_array_append_val (to_delete, i);
+	}
+	if (!to_delete)
+		return FALSE;
+
+	g_clear_pointer (p_index, g_hash_table_unref);
+	nm_utils_array_remove_at_indexes (array, &g_array_index (to_delete, guint, 0), to_delete->len);
+	return TRUE;
+}
+
+/**
+ * nm_utils_array_subtract_indexed:
+ * @dst: the #GArray to remove elements from
+ * @p_dst_index: (inout): the hash index of @dst, or %NULL
+ * @src: the elements to remove
+ * @hash_func: hash function for the identity of the elements
+ * @equal_func: compares the identity of two elements
+ *
+ * For each element of @src, removes the first equal element from @dst.
+ * This is the same as calling nm_utils_array_find_indexed() and
+ * nm_utils_array_remove_indexed() for each element of @src, but takes
+ * linear time.
+ *
+ * Returns: %TRUE if @dst changed.
+ */
+gboolean
+nm_utils_array_subtract_indexed (GArray *dst,
+                                 GHashTable **p_dst_index,
+                                 const GArray *src,
+                                 GHashFunc hash_func,
+                                 GEqualFunc equal_func)
+{
+	gs_free guint8 *remove = NULL;
+	guint i;
+	int idx;
+
+	if (!dst->len || !src->len)
+		return FALSE;
+
+	remove = g_new0 (guint8, dst->len);
+	for (i = 0; i < src->len; i++) {
+		gconstpointer needle = _array_elt (src, i);
+
+		idx = nm_utils_array_find_indexed (dst, p_dst_index, hash_func, equal_func, needle);
+
+		/* A previous element of @src already removed this one, continue
+		 * with the next equal element of @dst. */
+		while (idx >= 0 && remove[idx]) {
+			for (idx++; (guint) idx < dst->len; idx++) {
+				if (equal_func (_array_elt (dst, idx), needle))
+					break;
+			}
+			if ((guint) idx == dst->len)
+				idx = -1;
+		}
+		if (idx >= 0)
+			remove[idx] = TRUE;
+	}
+
+	return _array_remove_flagged (dst, p_dst_index, remove);
+}
+
+/**
+ * nm_utils_array_intersect_indexed:
+ * @dst: the #GArray to remove elements from
+ * @p_dst_index: (inout): the hash index of @dst, or %NULL
+ * @src: the elements to keep
+ * @p_src_index: (inout): the hash index of @src, or %NULL
+ * @hash_func: hash function for the identity of the elements
+ * @equal_func: compares the identity of two elements
+ *
+ * Removes all elements from @dst that have no equal element in @src.
+ *
+ * Returns: %TRUE if @dst changed.
+ */
+gboolean
+nm_utils_array_intersect_indexed (GArray *dst,
+                                  GHashTable **p_dst_index,
+                                  const GArray *src,
+                                  GHashTable **p_src_index,
+                                  GHashFunc hash_func,
+                                  GEqualFunc equal_func)
+{
+	gs_free guint8 *remove = NULL;
+	guint i;
+
+	if (!dst->len)
+		return FALSE;
+
+	remove = g_new0 (guint8, dst->len);
+	for (i = 0; i < dst->len; i++) {
+		if (nm_utils_array_find_indexed (src, p_src_index, hash_func, equal_func, _array_elt (dst, i)) < 0)
+			remove[i] = TRUE;
+	}
+
+	return _array_remove_flagged (dst, p_dst_index, remove);
+}
+
+/*****************************************************************************/
+
 int
 nm_spawn_process (const char *args, GError **error)
 {
@@ -381,6 +381,25 @@ char *nm_utils_hw_addr_gen_stable_eth (NMUtilsStableType stable_type,
 
 void nm_utils_array_remove_at_indexes (GArray *array, const guint *indexes_to_delete, gsize len);
 
+int nm_utils_array_find_indexed (const GArray *array,
+                                 GHashTable **p_index,
+                                 GHashFunc hash_func,
+                                 GEqualFunc equal_func,
+                                 gconstpointer needle);
+void nm_utils_array_append_indexed (GArray *array, GHashTable **p_index, gconstpointer item);
+void nm_utils_array_remove_indexed (GArray *array, GHashTable **p_index, guint idx);
+gboolean nm_utils_array_subtract_indexed (GArray *dst,
+                                          GHashTable **p_dst_index,
+                                          const GArray *src,
+                                          GHashFunc hash_func,
+                                          GEqualFunc equal_func);
+gboolean nm_utils_array_intersect_indexed (GArray *dst,
+                                           GHashTable **p_dst_index,
+                                           const GArray *src,
+                                           GHashTable **p_src_index,
+                                           GHashFunc hash_func,
+                                           GEqualFunc equal_func);
+
 void nm_utils_setpgid (gpointer unused);
 
 typedef enum {
@@ -41,6 +41,9 @@
 
 #define CALL_TIMEOUT (1000 * 60 * 10)  /* 10 minutes for all scripts */
 
+/* the maximum number of events sent with one ActionBatch call */
+#define BATCH_MAX_EVENTS 100
+
 #define _NMLOG_DOMAIN         LOGD_DISPATCH
 #define _NMLOG_PREFIX_NAME    "dispatcher"
 #define _NMLOG(level, ...) \
@@ -289,13 +292,37 @@ typedef struct {
 	DispatcherFunc callback;
 	gpointer user_data;
 	guint idle_id;
+
+	/* the arguments of the Action call, while the event is queued */
+	GVariant *args;
 } DispatchInfo;
 
+/* Asynchronous events without callback are not sent right away. Instead,
+ * the events of one main loop iteration are collected and sent with a
+ * single ActionBatch call. */
+static struct {
+	GPtrArray *queue;  /* list of DispatchInfo */
+	guint idle_id;
+
+	/* the number of ActionBatch calls waiting for the reply */
+	guint n_pending;
+
+	/* the running dispatcher does not know ActionBatch */
+	gboolean unsupported;
+
+	/* Without ActionBatch, the events are sent with Action one after
+	 * another. @serial_current is the event waiting for the reply. */
+	GQueue serial;
+	DispatchInfo *serial_current;
+} batch;
+
 static void
 dispatcher_info_free (DispatchInfo *info)
 {
 	if (info->idle_id)
 		g_source_remove (info->idle_id);
+	if (info->args)
+		g_variant_unref (info->args);
 	g_free (info);
 }
 
@@ -378,38 +405,266 @@ dispatcher_results_process (guint request_id, DispatcherAction action, GVariantI
 	}
 }
 
+static void
+dispatcher_call_failed (guint first_request_id, guint last_request_id, GError *error)
+{
+	char buf[64];
+
+	if (first_request_id != last_request_id)
+		nm_sprintf_buf (buf, "%u-%u", first_request_id, last_request_id);
+	else
+		nm_sprintf_buf (buf, "%u", first_request_id);
+
+	if (_nm_dbus_error_has_name (error, "org.freedesktop.systemd1.LoadFailed")) {
+		g_dbus_error_strip_remote_error (error);
+		_LOGW ("(%s) failed to call dispatcher scripts: %s",
+		       buf, error->message);
+	} else {
+		_LOGD ("(%s) failed to call dispatcher scripts: %s",
+		       buf, error->message);
+	}
+}
+
+static void
+dispatcher_info_complete (DispatchInfo *info)
+{
+	if (info->callback)
+		info->callback (info->request_id, info->user_data);
+
+	dispatcher_info_cleanup (info);
+}
+
+static void
+dispatcher_action_complete (DispatchInfo *info, GVariant *ret, GError *error)
+{
+	GVariantIter *results;
+
+	if (ret) {
+		g_variant_get (ret, "(a(sus))", &results);
+		dispatcher_results_process (info->request_id, info->action, results);
+		g_variant_iter_free (results);
+	} else
+		dispatcher_call_failed (info->request_id, info->request_id, error);
+
+	dispatcher_info_complete (info);
+}
+
 static void
 dispatcher_done_cb (GObject *proxy, GAsyncResult *result, gpointer user_data)
+{
+	gs_unref_variant GVariant *ret = NULL;
+	GError *error = NULL;
+
+	ret = _nm_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), result,
+	                                  G_VARIANT_TYPE ("(a(sus))"),
+	                                  &error);
+	dispatcher_action_complete (user_data, ret, error);
+	g_clear_error (&error);
+}
+
+static void
+dispatcher_send_action (DispatchInfo *info, GAsyncReadyCallback callback)
+{
+	GVariant *args = info->args;
+
+	info->args = NULL;
+	g_dbus_proxy_call (dispatcher_proxy, "Action",
+	                   args,
+	                   G_DBUS_CALL_FLAGS_NONE, CALL_TIMEOUT,
+	                   NULL, callback, info);
+	g_variant_unref (args);
+}
+
+static void dispatcher_serial_next (void);
+
+static void
+dispatcher_serial_done_cb (GObject *proxy, GAsyncResult *result, gpointer user_data)
 {
 	DispatchInfo *info = user_data;
-	GVariant *ret;
+
+	nm_assert (batch.serial_current == info);
+
+	batch.serial_current = NULL;
+	dispatcher_done_cb (proxy, result, info);
+	dispatcher_serial_next ();
+}
+
+static void
+dispatcher_serial_next (void)
+{
+	DispatchInfo *info;
+
+	if (batch.serial_current)
+		return;
+
+	info = g_queue_pop_head (&batch.serial);
+	if (info) {
+		batch.serial_current = info;
+		dispatcher_send_action (info, dispatcher_serial_done_cb);
+	}
+}
+
+static void
+dispatcher_serial_add (GPtrArray *infos)
+{
+	guint i;
+
+	for (i = 0; i < infos->len; i++)
+		g_queue_push_tail (&batch.serial, infos->pdata[i]);
+	dispatcher_serial_next ();
+}
+
+static GVariant *
+dispatcher_batch_args (GPtrArray *infos)
+{
+	GVariantBuilder events;
+	guint i;
+
+	g_variant_builder_init (&events, G_VARIANT_TYPE ("a(sa{sa{sv}}a{sv}a{sv}a{sv}a{sv}a{sv}a{sv}ssa{sv}a{sv}b)"));
+	for (i = 0; i < infos->len; i++) {
+		DispatchInfo *info = infos->pdata[i];
+
+		g_variant_builder_add_value (&events, info->args);
+	}
+	return g_variant_new ("(@a(sa{sa{sv}}a{sv}a{sv}a{sv}a{sv}a{sv}a{sv}ssa{sv}a{sv}b))",
+	                      g_variant_builder_end (&events));
+}
+
+static void
+dispatcher_batch_complete (GPtrArray *infos, GVariant *ret, GError *error)
+{
+	GVariantIter *batch_results = NULL;
 	GVariantIter *results;
+	guint i;
+
+	if (ret)
+		g_variant_get (ret, "(aa(sus))", &batch_results);
+	else {
+		dispatcher_call_failed (((DispatchInfo *) infos->pdata[0])->request_id,
+		                        ((DispatchInfo *) infos->pdata[infos->len - 1])->request_id,
+		                        error);
+	}
+
+	for (i = 0; i < infos->len; i++) {
+		DispatchInfo *info = infos->pdata[i];
+
+		if (batch_results && g_variant_iter_next (batch_results, "a(sus)", &results)) {
+			dispatcher_results_process (info->request_id, info->action, results);
+			g_variant_iter_free (results);
+		}
+		g_clear_pointer (&info->args, g_variant_unref);
+		dispatcher_info_complete (info);
+	}
+
+	if (batch_results)
+		g_variant_iter_free (batch_results);
+}
+
+static void dispatcher_batch_flush (void);
+
+static void
+dispatcher_batch_done_cb (GObject *proxy, GAsyncResult *result, gpointer user_data)
+{
+	gs_unref_ptrarray GPtrArray *infos = user_data;
+	gs_unref_variant GVariant *ret = NULL;
 	GError *error = NULL;
 
+	nm_assert (batch.n_pending > 0);
+
+	batch.n_pending--;
+
 	ret = _nm_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), result,
-	                                  G_VARIANT_TYPE ("(a(sus))"),
+	                                  G_VARIANT_TYPE ("(aa(sus))"),
 	                                  &error);
-	if (ret) {
-		g_variant_get (ret, "(a(sus))", &results);
-		dispatcher_results_process (info->request_id, info->action, results);
-		g_variant_iter_free (results);
-		g_variant_unref (ret);
-	} else {
-		if (_nm_dbus_error_has_name (error, "org.freedesktop.systemd1.LoadFailed")) {
-			g_dbus_error_strip_remote_error (error);
-			_LOGW ("(%u) failed to call dispatcher scripts: %s",
-			       info->request_id, error->message);
-		} else {
-			_LOGD ("(%u) failed to call dispatcher scripts: %s",
-			       info->request_id, error->message);
+	if (!ret && g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
+		/* An older dispatcher is still running. Fall back to sending
+		 * the events one by one, each after the reply to the previous,
+		 * like the dispatcher would process them. */
+		if (!batch.unsupported)
+			_LOGD ("dispatcher does not support batches: %s", error->message);
+		batch.unsupported = TRUE;
+		dispatcher_serial_add (infos);
+	} else
+		dispatcher_batch_complete (infos, ret, error);
+	g_clear_error (&error);
+
+	/* Events queued meanwhile wait for all batches sent before. */
+	if (batch.unsupported && !batch.n_pending)
+		dispatcher_batch_flush ();
+}
+
+static void
+dispatcher_batch_flush (void)
+{
+	GPtrArray *infos;
+
+	nm_clear_g_source (&batch.idle_id);
+
+	if (!batch.queue || !batch.queue->len)
+		return;
+
+	if (batch.unsupported) {
+		/* Batches that were sent before might still fall back to
+		 * Action. Their events come first. */
+		if (batch.n_pending)
+			return;
+		dispatcher_serial_add (batch.queue);
+		g_ptr_array_set_size (batch.queue, 0);
+		return;
+	}
+
+	infos = batch.queue;
+	batch.queue = NULL;
+
+	if (infos->len == 1 && !batch.n_pending) {
+		dispatcher_send_action (infos->pdata[0], dispatcher_done_cb);
+		g_ptr_array_unref (infos);
+		return;
+	}
+
+	_LOGD ("(%u-%u) sending %u events in one batch",
+	       ((DispatchInfo *) infos->pdata[0])->request_id,
+	       ((DispatchInfo *) infos->pdata[infos->len - 1])->request_id,
+	       infos->len);
+
+	/* The events are processed one after another, each with its own timeout. */
+	batch.n_pending++;
+	g_dbus_proxy_call (dispatcher_proxy, "ActionBatch",
+	                   dispatcher_batch_args (infos),
+	                   G_DBUS_CALL_FLAGS_NONE, CALL_TIMEOUT * infos->len,
+	                   NULL, dispatcher_batch_done_cb, infos);
+}
+
+static gboolean
+dispatcher_batch_idle_cb (gpointer user_data)
+{
+	batch.idle_id = 0;
+	dispatcher_batch_flush ();
+	return G_SOURCE_REMOVE;
+}
+
+static void
+dispatcher_batch_add (DispatchInfo *info)
+{
+	if (info->callback) {
+		/* The reply to a batch only comes after all its events are
+		 * done. Don't delay callers waiting for their event; send
+		 * it on its own, after the events queued before. */
+		dispatcher_batch_flush ();
+		if (!batch.unsupported) {
+			dispatcher_send_action (info, dispatcher_done_cb);
+			return;
 		}
-		g_clear_error (&error);
 	}
 
-	if (info->callback)
-		info->callback (info->request_id, info->user_data);
+	if (!batch.queue)
+		batch.queue = g_ptr_array_new ();
+	g_ptr_array_add (batch.queue, info);
 
-	dispatcher_info_cleanup (info);
+	if (info->callback || batch.queue->len >= BATCH_MAX_EVENTS)
+		dispatcher_batch_flush ();
+	else if (!batch.idle_id)
+		batch.idle_id = g_idle_add (dispatcher_batch_idle_cb, NULL);
 }
 
 static const char *action_table[] = {
@@ -583,6 +838,9 @@ _dispatcher_call (DispatcherAction action,
 		GVariant *ret;
 		GVariantIter *results;
 
+		/* Events queued before must reach the dispatcher first. */
+		dispatcher_batch_flush ();
+
 		ret = _nm_dbus_proxy_call_sync (dispatcher_proxy, "Action",
 		                                g_variant_new ("(s@a{sa{sv}}a{sv}a{sv}a{sv}a{sv}@a{sv}@a{sv}ssa{sv}a{sv}b)",
 		                                               action_to_string (action),
@@ -619,23 +877,21 @@ _dispatcher_call (DispatcherAction action,
 		info->request_id = reqid;
 		info->callback = callback;
 		info->user_data = user_data;
-		g_dbus_proxy_call (dispatcher_proxy, "Action",
-		                   g_variant_new ("(s@a{sa{sv}}a{sv}a{sv}a{sv}a{sv}@a{sv}@a{sv}ssa{sv}a{sv}b)",
-		                                  action_to_string (action),
-		                                  connection_dict,
-		                                  &connection_props,
-		                                  &device_props,
-		                                  &device_ip4_props,
-		                                  &device_ip6_props,
-		                                  device_dhcp4_props,
-		                                  device_dhcp6_props,
-		                                  nm_connectivity_state_to_string (connectivity_state),
-		                                  vpn_iface ? vpn_iface : "",
-		                                  &vpn_ip4_props,
-		                                  &vpn_ip6_props,
-		                                  nm_logging_enabled (LOGL_DEBUG, LOGD_DISPATCH)),
-		                   G_DBUS_CALL_FLAGS_NONE, CALL_TIMEOUT,
-		                   NULL, dispatcher_done_cb, info);
+		info->args = g_variant_ref_sink (g_variant_new ("(s@a{sa{sv}}a{sv}a{sv}a{sv}a{sv}@a{sv}@a{sv}ssa{sv}a{sv}b)",
+		                                                action_to_string (action),
+		                                                connection_dict,
+		                                                &connection_props,
+		                                                &device_props,
+		                                                &device_ip4_props,
+		                                                &device_ip6_props,
+		                                                device_dhcp4_props,
+		                                                device_dhcp6_props,
+		                                                nm_connectivity_state_to_string (connectivity_state),
+		                                                vpn_iface ? vpn_iface : "",
+		                                                &vpn_ip4_props,
+		                                                &vpn_ip6_props,
+		                                                nm_logging_enabled (LOGL_DEBUG, LOGD_DISPATCH)));
+		dispatcher_batch_add (info);
 		success = TRUE;
 	}
 
@@ -807,6 +1063,78 @@ nm_dispatcher_call_cancel (guint call_id)
 	}
 }
 
+/**
+ * nm_dispatcher_shutdown:
+ *
+ * Sends the events that are still queued, synchronously, so that they
+ * are not lost when NetworkManager quits. Events that were sent before
+ * are not waited for.
+ */
+void
+nm_dispatcher_shutdown (void)
+{
+	gs_unref_ptrarray GPtrArray *infos = NULL;
+	DispatchInfo *info;
+	GError *error = NULL;
+	guint i;
+
+	nm_clear_g_source (&batch.idle_id);
+
+	if (!dispatcher_proxy)
+		return;
+
+	infos = g_ptr_array_new ();
+	while ((info = g_queue_pop_head (&batch.serial)))
+		g_ptr_array_add (infos, info);
+	if (batch.queue) {
+		for (i = 0; i < batch.queue->len; i++)
+			g_ptr_array_add (infos, batch.queue->pdata[i]);
+		g_clear_pointer (&batch.queue, g_ptr_array_unref);
+	}
+
+	if (!infos->len)
+		return;
+
+	_LOGD ("(%u-%u) sending %u queued events before quitting",
+	       ((DispatchInfo *) infos->pdata[0])->request_id,
+	       ((DispatchInfo *) infos->pdata[infos->len - 1])->request_id,
+	       infos->len);
+
+	if (infos->len > 1 && !batch.unsupported) {
+		gs_unref_variant GVariant *ret = NULL;
+
+		ret = _nm_dbus_proxy_call_sync (dispatcher_proxy, "ActionBatch",
+		                                dispatcher_batch_args (infos),
+		                                G_VARIANT_TYPE ("(aa(sus))"),
+		                                G_DBUS_CALL_FLAGS_NONE, CALL_TIMEOUT * infos->len,
+		                                NULL, &error);
+		if (ret || !g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
+			dispatcher_batch_complete (infos, ret, error);
+			g_clear_error (&error);
+			return;
+		}
+		g_clear_error (&error);
+		batch.unsupported = TRUE;
+	}
+
+	for (i = 0; i < infos->len; i++) {
+		gs_unref_variant GVariant *ret = NULL;
+		GVariant *args;
+
+		info = infos->pdata[i];
+		args = info->args;
+		info->args = NULL;
+		ret = _nm_dbus_proxy_call_sync (dispatcher_proxy, "Action",
+		                                args,
+		                                G_VARIANT_TYPE ("(a(sus))"),
+		                                G_DBUS_CALL_FLAGS_NONE, CALL_TIMEOUT,
+		                                NULL, &error);
+		g_variant_unref (args);
+		dispatcher_action_complete (info, ret, error);
+		g_clear_error (&error);
+	}
+}
+
 static void
 dispatcher_dir_changed (GFileMonitor *monitor,
                         GFile *file,
@@ -862,6 +1190,13 @@ nm_dispatcher_init (void)
 	GError *error = NULL;
 
 	for (i = 0; i < G_N_ELEMENTS (monitors); i++) {
+		if (nm_utils_get_testing ()) {
+			/* Tests talk to a fake dispatcher that has scripts for
+			 * every action. */
+			monitors[i].has_scripts = TRUE;
+			continue;
+		}
+
 		file = g_file_new_for_path (monitors[i].dir);
 		monitors[i].monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, NULL);
 		if (monitors[i].monitor) {
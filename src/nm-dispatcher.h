@@ -83,4 +83,6 @@ void nm_dispatcher_call_cancel (guint call_id);
 
 void nm_dispatcher_init (void);
 
+void nm_dispatcher_shutdown (void);
+
 #endif /* __NETWORKMANAGER_DISPATCHER_H__ */
@@ -49,8 +49,6 @@ typedef struct {
 	InterfaceData *interfaces;
 	guint num_interfaces;
 
-	guint notify_idle_id;
-
 #ifdef _ASSERT_NO_EARLY_EXPORT
 	bool _constructed:1;
 #endif
@@ -67,6 +65,17 @@ typedef struct {
 GQuark nm_exported_object_class_info_quark (void);
 G_DEFINE_QUARK (NMExportedObjectClassInfo, nm_exported_object_class_info)
 
+/* How a GObject property of an object type is exported on D-Bus. For every
+ * type, the infos are looked up once and cached in a hash table by pspec. */
+typedef struct {
+	GParamSpec *pspec;
+	const char *dbus_property_name;     /* %NULL if the property is not exported */
+	const GVariantType *vtype;
+} PropertyInfo;
+
+GQuark nm_exported_object_property_infos_quark (void);
+G_DEFINE_QUARK (NMExportedObjectPropertyInfos, nm_exported_object_property_infos)
+
 /*****************************************************************************/
 
 #define _NMLOG_PREFIX_NAME                "exported-object"
@@ -688,6 +697,8 @@ nm_exported_object_unexport (NMExportedObject *self)
 	_LOGT ("unexport: \"%s\"", priv->path);
 
 	if (priv->bus_mgr) {
+		/* Since we remove all interfaces, a queued notification is obsolete. */
+		nm_bus_manager_cancel_properties_changed (priv->bus_mgr, self);
 		nm_bus_manager_unregister_object (priv->bus_mgr, (GDBusObjectSkeleton *) self);
 		g_object_remove_weak_pointer ((GObject *) priv->bus_mgr, (gpointer *) &priv->bus_mgr);
 		priv->bus_mgr = NULL;
@@ -699,11 +710,7 @@ nm_exported_object_unexport (NMExportedObject *self)
 
 	g_clear_pointer (&priv->path, g_free);
 
-	if (nm_clear_g_source (&priv->notify_idle_id)) {
-		/* We had a notification queued. Since we removed all interfaces,
-		 * the notification is obsolete and must be cleaned up. */
-		g_hash_table_remove_all (priv->pending_notifies);
-	}
+	g_hash_table_remove_all (priv->pending_notifies);
 }
 
 /*****************************************************************************/
@@ -766,20 +773,23 @@ nm_exported_object_class_set_quitting (void)
 
 /*****************************************************************************/
 
-typedef struct {
-	const char *property_name;
-	GVariant *variant;
-} PendingNotifiesItem;
-
 static int
 _sort_pending_notifies (gconstpointer a, gconstpointer b, gpointer       user_data)
 {
-	return strcmp (((const PendingNotifiesItem *) a)->property_name,
-	               ((const PendingNotifiesItem *) b)->property_name);
+	return strcmp ((*((const PropertyInfo **) a))->dbus_property_name,
+	               (*((const PropertyInfo **) b))->dbus_property_name);
 }
 
-static gboolean
-idle_emit_properties_changed (gpointer self)
+/**
+ * _nm_exported_object_emit_properties_changed:
+ * @self: an #NMExportedObject
+ *
+ * Emits the PropertiesChanged signal for the properties that changed
+ * since the last emission. Only to be called by #NMBusManager, which
+ * schedules the emission for all objects.
+ */
+void
+_nm_exported_object_emit_properties_changed (NMExportedObject *self)
 {
 	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
 	gs_unref_variant GVariant *variant = NULL;
@@ -787,30 +797,39 @@ idle_emit_properties_changed (gpointer self)
 	GHashTableIter hash_iter;
 	GVariantBuilder notifies;
 	guint i, n;
-	PendingNotifiesItem *values;
-
-	priv->notify_idle_id = 0;
-
+	const PropertyInfo **values;
 
 	n = g_hash_table_size (priv->pending_notifies);
-	g_return_val_if_fail (n > 0, FALSE);
+	g_return_if_fail (n > 0);
 
 	values = g_alloca (sizeof (values[0]) * n);
 
 	i = 0;
 	g_hash_table_iter_init (&hash_iter, priv->pending_notifies);
-	while (g_hash_table_iter_next (&hash_iter, (gpointer) &values[i].property_name, (gpointer) &values[i].variant))
+	while (g_hash_table_iter_next (&hash_iter, NULL, (gpointer) &values[i]))
 		i++;
 	nm_assert (i == n);
 
+	g_hash_table_remove_all (priv->pending_notifies);
+
 	g_qsort_with_data (values, n, sizeof (values[0]), _sort_pending_notifies, NULL);
 
+	/* The values are only serialized now, so that a property that changed
+	 * several times since the last emission is serialized once. */
 	g_variant_builder_init (&notifies, G_VARIANT_TYPE_VARDICT);
-	for (i = 0; i < n; i++)
-		g_variant_builder_add (&notifies, "{sv}", values[i].property_name, values[i].variant);
-	variant = g_variant_ref_sink (g_variant_builder_end (&notifies));
+	for (i = 0; i < n; i++) {
+		GValue value = G_VALUE_INIT;
+		GVariant *v;
 
-	g_hash_table_remove_all (priv->pending_notifies);
+		g_value_init (&value, values[i]->pspec->value_type);
+		g_object_get_property (G_OBJECT (self), values[i]->pspec->name, &value);
+		v = g_dbus_gvalue_to_gvariant (&value, values[i]->vtype);
+		g_value_unset (&value);
+
+		g_variant_builder_add (&notifies, "{sv}", values[i]->dbus_property_name, v);
+		g_variant_unref (v);
+	}
+	variant = g_variant_ref_sink (g_variant_builder_end (&notifies));
 
 	for (i = 0; i < priv->num_interfaces; i++) {
 		if (priv->interfaces[i].property_changed_signal_id != 0) {
@@ -818,7 +837,7 @@ idle_emit_properties_changed (gpointer self)
 			break;
 		}
 	}
-	g_return_val_if_fail (ifdata, FALSE);
+	g_return_if_fail (ifdata);
 
 	if (nm_logging_enabled (LOGL_DEBUG, LOGD_DBUS_PROPS)) {
 		gs_free char *notification = g_variant_print (variant, TRUE);
@@ -828,22 +847,29 @@ idle_emit_properties_changed (gpointer self)
 	}
 
 	g_signal_emit (ifdata->interface, ifdata->property_changed_signal_id, 0, variant);
-	return FALSE;
 }
 
-static void
-nm_exported_object_notify (GObject *object, GParamSpec *pspec)
+static const PropertyInfo *
+_property_info_get (GObject *object, GParamSpec *pspec)
 {
 	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (object);
 	NMExportedObjectClassInfo *classinfo;
+	GHashTable *infos;
+	PropertyInfo *info;
 	GType type;
 	const char *dbus_property_name = NULL;
-	GValue value = G_VALUE_INIT;
-	const GVariantType *vtype;
 	guint i, j;
 
-	if (priv->num_interfaces == 0)
-		return;
+	infos = g_type_get_qdata (G_OBJECT_TYPE (object), nm_exported_object_property_infos_quark ());
+	if (infos) {
+		info = g_hash_table_lookup (infos, pspec);
+		if (info)
+			return info;
+	} else {
+		/* like the class info, the cache lives as long as the type. */
+		infos = g_hash_table_new (g_direct_hash, g_direct_equal);
+		g_type_set_qdata (G_OBJECT_TYPE (object), nm_exported_object_property_infos_quark (), infos);
+	}
 
 	for (type = G_OBJECT_TYPE (object); type; type = g_type_parent (type)) {
 		classinfo = g_type_get_qdata (type, nm_exported_object_class_info_quark ());
@@ -854,39 +880,62 @@ nm_exported_object_notify (GObject *object, GParamSpec *pspec)
 		if (dbus_property_name)
 			break;
 	}
-	if (!dbus_property_name) {
-		nm_log_trace (LOGD_DBUS_PROPS, "ignoring notification for prop %s on type %s",
-		              pspec->name, G_OBJECT_TYPE_NAME (object));
-		return;
-	}
 
-	for (i = 0; i < priv->num_interfaces; i++) {
-		GDBusInterfaceSkeleton *skel = priv->interfaces[i].interface;
-		GDBusInterfaceInfo *iinfo;
-
-		iinfo = g_dbus_interface_skeleton_get_info (skel);
-		for (j = 0; iinfo->properties[j]; j++) {
-			if (nm_streq (iinfo->properties[j]->name, dbus_property_name)) {
-				vtype = G_VARIANT_TYPE (iinfo->properties[j]->signature);
-				goto vtype_found;
+	info = g_slice_new0 (PropertyInfo);
+	info->pspec = pspec;
+
+	if (dbus_property_name) {
+		for (i = 0; i < priv->num_interfaces; i++) {
+			GDBusInterfaceSkeleton *skel = priv->interfaces[i].interface;
+			GDBusInterfaceInfo *iinfo;
+
+			iinfo = g_dbus_interface_skeleton_get_info (skel);
+			for (j = 0; iinfo->properties[j]; j++) {
+				if (nm_streq (iinfo->properties[j]->name, dbus_property_name)) {
+					/* @dbus_property_name is inside classinfo and never freed, thus we
+					 * don't clone it. Also, pending notifies do a pointer, not string
+					 * comparison. */
+					info->dbus_property_name = dbus_property_name;
+					info->vtype = G_VARIANT_TYPE (iinfo->properties[j]->signature);
+					goto found;
+				}
 			}
 		}
+		g_slice_free (PropertyInfo, info);
+		g_return_val_if_reached (NULL);
 	}
-	g_return_if_reached ();
 
-vtype_found:
-	g_value_init (&value, pspec->value_type);
-	g_object_get_property (G_OBJECT (object), pspec->name, &value);
+found:
+	g_hash_table_insert (infos, pspec, info);
+	return info;
+}
 
-	/* @dbus_property_name is inside classinfo and never freed, thus we don't clone it.
-	 * Also, we do a pointer, not string comparison. */
-	g_hash_table_insert (priv->pending_notifies,
-	                     (gpointer) dbus_property_name,
-	                     g_dbus_gvalue_to_gvariant (&value, vtype));
-	g_value_unset (&value);
+static void
+nm_exported_object_notify (GObject *object, GParamSpec *pspec)
+{
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (object);
+	const PropertyInfo *info;
+
+	if (   priv->num_interfaces == 0
+	    || !priv->bus_mgr)
+		return;
+
+	info = _property_info_get (object, pspec);
+	if (!info)
+		return;
+	if (!info->dbus_property_name) {
+		nm_log_trace (LOGD_DBUS_PROPS, "ignoring notification for prop %s on type %s",
+		              pspec->name, G_OBJECT_TYPE_NAME (object));
+		return;
+	}
 
-	if (!priv->notify_idle_id)
-		priv->notify_idle_id = g_idle_add (idle_emit_properties_changed, object);
+	/* Only remember the property, its value is serialized when emitting
+	 * the signal. */
+	if (g_hash_table_size (priv->pending_notifies) == 0)
+		nm_bus_manager_schedule_properties_changed (priv->bus_mgr, (NMExportedObject *) object);
+	g_hash_table_insert (priv->pending_notifies,
+	                     (gpointer) info->dbus_property_name,
+	                     (gpointer) info);
 }
 
 /*****************************************************************************/
@@ -896,10 +945,7 @@ nm_exported_object_init (NMExportedObject *self)
 {
 	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
 
-	priv->pending_notifies = g_hash_table_new_full (g_direct_hash,
-	                                                g_direct_equal,
-	                                                NULL,
-	                                                (GDestroyNotify) g_variant_unref);
+	priv->pending_notifies = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 static void
@@ -935,8 +981,9 @@ nm_exported_object_dispose (GObject *object)
 	} else
 		g_clear_pointer (&priv->path, g_free);
 
+	if (priv->bus_mgr)
+		nm_bus_manager_cancel_properties_changed (priv->bus_mgr, (NMExportedObject *) object);
 	g_clear_pointer (&priv->pending_notifies, g_hash_table_destroy);
-	nm_clear_g_source (&priv->notify_idle_id);
 
 	G_OBJECT_CLASS (nm_exported_object_parent_class)->dispose (object);
 }
@@ -79,6 +79,8 @@ GDBusInterfaceSkeleton *nm_exported_object_get_interface_by_type (NMExportedObje
 void        _nm_exported_object_clear_and_unexport (NMExportedObject **location);
 #define nm_exported_object_clear_and_unexport(location) _nm_exported_object_clear_and_unexport ((NMExportedObject **) (location))
 
+void        _nm_exported_object_emit_properties_changed (NMExportedObject *self);
+
 G_END_DECLS
 
 #endif	/* NM_EXPORTED_OBJECT_H */
@@ -446,6 +446,7 @@ main (int argc, char *argv[])
 		                                          ifindex,
 		                                          hwaddr,
 		                                          global_opt.uuid,
+		                                          NULL,
 		                                          global_opt.priority_v4,
 		                                          !!global_opt.dhcp4_hostname,
 		                                          global_opt.dhcp4_hostname,
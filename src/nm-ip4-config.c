@@ -41,6 +41,9 @@ typedef struct {
 	gboolean has_gateway;
 	GArray *addresses;
 	GArray *routes;
+	/* hash indexes on the identity of @addresses and @routes, built on demand */
+	GHashTable *addresses_idx;
+	GHashTable *routes_idx;
 	GArray *nameservers;
 	GPtrArray *domains;
 	GPtrArray *searches;
@@ -205,6 +208,38 @@ routes_are_duplicate (const NMPlatformIP4Route *a, const NMPlatformIP4Route *b,
 	       (!consider_gateway_and_metric || (a->gateway == b->gateway && a->metric == b->metric));
 }
 
+static guint
+_address_id_hash (gconstpointer ptr)
+{
+	const NMPlatformIP4Address *a = ptr;
+	guint h;
+
+	h = a->address;
+	h = (h * 33) + a->plen;
+	h = (h * 33) + (a->peer_address & nm_utils_ip4_prefix_to_netmask (a->plen));
+	return h;
+}
+
+static gboolean
+_address_id_equal (gconstpointer a, gconstpointer b)
+{
+	return addresses_are_duplicate (a, b);
+}
+
+static guint
+_route_id_hash (gconstpointer ptr)
+{
+	const NMPlatformIP4Route *r = ptr;
+
+	return (((guint) r->network) * 33) + r->plen;
+}
+
+static gboolean
+_route_id_equal (gconstpointer a, gconstpointer b)
+{
+	return routes_are_duplicate (a, b, FALSE);
+}
+
 /*****************************************************************************/
 
 static gint
@@ -257,6 +292,7 @@ nm_ip4_config_addresses_sort (NMIP4Config *self)
 		memcpy (data_pre, priv->addresses->data, data_len);
 
 		g_array_sort (priv->addresses, _addresses_sort_cmp);
+		g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
 
 		changed = memcmp (data_pre, priv->addresses->data, data_len) != 0;
 		g_free (data_pre);
@@ -769,16 +805,11 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 static int
 _addresses_get_index (const NMIP4Config *self, const NMPlatformIP4Address *addr)
 {
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->addresses->len; i++) {
-		const NMPlatformIP4Address *a = &g_array_index (priv->addresses, NMPlatformIP4Address, i);
+	/* the index is only a cache, it's fine to build it for a const config. */
+	NMIP4ConfigPrivate *priv = (NMIP4ConfigPrivate *) NM_IP4_CONFIG_GET_PRIVATE (self);
 
-		if (addresses_are_duplicate (addr, a))
-			return (int) i;
-	}
-	return -1;
+	return nm_utils_array_find_indexed (priv->addresses, &priv->addresses_idx,
+	                                    _address_id_hash, _address_id_equal, addr);
 }
 
 static int
@@ -799,17 +830,10 @@ _nameservers_get_index (const NMIP4Config *self, guint32 ns)
 static int
 _routes_get_index (const NMIP4Config *self, const NMPlatformIP4Route *route)
 {
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
+	NMIP4ConfigPrivate *priv = (NMIP4ConfigPrivate *) NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	for (i = 0; i < priv->routes->len; i++) {
-		const NMPlatformIP4Route *r = &g_array_index (priv->routes, NMPlatformIP4Route, i);
-
-		if (   route->network == r->network
-		    && route->plen == r->plen)
-			return (int) i;
-	}
-	return -1;
+	return nm_utils_array_find_indexed (priv->routes, &priv->routes_idx,
+	                                    _route_id_hash, _route_id_equal, route);
 }
 
 static int
@@ -899,19 +923,24 @@ _wins_get_index (const NMIP4Config *self, guint32 wins_server)
 void
 nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 {
+	NMIP4ConfigPrivate *dst_priv;
+	const NMIP4ConfigPrivate *src_priv;
 	guint32 i;
 	gint idx;
 
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
+	dst_priv = NM_IP4_CONFIG_GET_PRIVATE (dst);
+	src_priv = NM_IP4_CONFIG_GET_PRIVATE (src);
+
 	g_object_freeze_notify (G_OBJECT (dst));
 
 	/* addresses */
-	for (i = 0; i < nm_ip4_config_get_num_addresses (src); i++) {
-		idx = _addresses_get_index (dst, nm_ip4_config_get_address (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_address (dst, idx);
+	if (nm_utils_array_subtract_indexed (dst_priv->addresses, &dst_priv->addresses_idx, src_priv->addresses,
+	                                     _address_id_hash, _address_id_equal)) {
+		_notify (dst, PROP_ADDRESS_DATA);
+		_notify (dst, PROP_ADDRESSES);
 	}
 
 	/* nameservers */
@@ -932,10 +961,10 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 	/* ignore route_metric */
 
 	/* routes */
-	for (i = 0; i < nm_ip4_config_get_num_routes (src); i++) {
-		idx = _routes_get_index (dst, nm_ip4_config_get_route (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_route (dst, idx);
+	if (nm_utils_array_subtract_indexed (dst_priv->routes, &dst_priv->routes_idx, src_priv->routes,
+	                                     _route_id_hash, _route_id_equal)) {
+		_notify (dst, PROP_ROUTE_DATA);
+		_notify (dst, PROP_ROUTES);
 	}
 
 	/* domains */
@@ -994,21 +1023,24 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 void
 nm_ip4_config_intersect (NMIP4Config *dst, const NMIP4Config *src)
 {
-	guint32 i;
-	gint idx;
+	NMIP4ConfigPrivate *dst_priv;
+	NMIP4ConfigPrivate *src_priv;
 
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
+	dst_priv = NM_IP4_CONFIG_GET_PRIVATE (dst);
+	/* the indexes of @src are only a cache, it's fine to build them. */
+	src_priv = (NMIP4ConfigPrivate *) NM_IP4_CONFIG_GET_PRIVATE (src);
+
 	g_object_freeze_notify (G_OBJECT (dst));
 
 	/* addresses */
-	for (i = 0; i < nm_ip4_config_get_num_addresses (dst); ) {
-		idx = _addresses_get_index (src, nm_ip4_config_get_address (dst, i));
-		if (idx < 0)
-			nm_ip4_config_del_address (dst, i);
-		else
-			i++;
+	if (nm_utils_array_intersect_indexed (dst_priv->addresses, &dst_priv->addresses_idx,
+	                                      src_priv->addresses, &src_priv->addresses_idx,
+	                                      _address_id_hash, _address_id_equal)) {
+		_notify (dst, PROP_ADDRESS_DATA);
+		_notify (dst, PROP_ADDRESSES);
 	}
 
 	/* ignore route_metric */
@@ -1022,12 +1054,11 @@ nm_ip4_config_intersect (NMIP4Config *dst, const NMIP4Config *src)
 	}
 
 	/* routes */
-	for (i = 0; i < nm_ip4_config_get_num_routes (dst); ) {
-		idx = _routes_get_index (src, nm_ip4_config_get_route (dst, i));
-		if (idx < 0)
-			nm_ip4_config_del_route (dst, i);
-		else
-			i++;
+	if (nm_utils_array_intersect_indexed (dst_priv->routes, &dst_priv->routes_idx,
+	                                      src_priv->routes, &src_priv->routes_idx,
+	                                      _route_id_hash, _route_id_equal)) {
+		_notify (dst, PROP_ROUTE_DATA);
+		_notify (dst, PROP_ROUTES);
 	}
 
 	/* ignore domains */
@@ -1492,6 +1523,7 @@ nm_ip4_config_reset_addresses (NMIP4Config *config)
 
 	if (priv->addresses->len != 0) {
 		g_array_set_size (priv->addresses, 0);
+		g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
 		_notify (config, PROP_ADDRESS_DATA);
 		_notify (config, PROP_ADDRESSES);
 	}
@@ -1516,39 +1548,38 @@ nm_ip4_config_add_address (NMIP4Config *config, const NMPlatformIP4Address *new)
 
 	g_return_if_fail (new != NULL);
 
-	for (i = 0; i < priv->addresses->len; i++ ) {
+	i = _addresses_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP4Address *item = &g_array_index (priv->addresses, NMPlatformIP4Address, i);
 
-		if (addresses_are_duplicate (item, new)) {
-			if (nm_platform_ip4_address_cmp (item, new) == 0)
-				return;
-
-			/* remember the old values. */
-			item_old = *item;
-			/* Copy over old item to get new lifetime, timestamp, preferred */
-			*item = *new;
-
-			/* But restore highest priority source */
-			item->addr_source = MAX (item_old.addr_source, new->addr_source);
-
-			/* for addresses that we read from the kernel, we keep the timestamps as defined
-			 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
-			 * with "what should be" and the kernel values are "what turned out after configuring it".
-			 *
-			 * For other sources, the longer lifetime wins. */
-			if (   (new->addr_source == NM_IP_CONFIG_SOURCE_KERNEL && new->addr_source != item_old.addr_source)
-			    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
-				item->timestamp = item_old.timestamp;
-				item->lifetime = item_old.lifetime;
-				item->preferred = item_old.preferred;
-			}
-			if (nm_platform_ip4_address_cmp (&item_old, item) == 0)
-				return;
-			goto NOTIFY;
+		if (nm_platform_ip4_address_cmp (item, new) == 0)
+			return;
+
+		/* remember the old values. */
+		item_old = *item;
+		/* Copy over old item to get new lifetime, timestamp, preferred */
+		*item = *new;
+
+		/* But restore highest priority source */
+		item->addr_source = MAX (item_old.addr_source, new->addr_source);
+
+		/* for addresses that we read from the kernel, we keep the timestamps as defined
+		 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
+		 * with "what should be" and the kernel values are "what turned out after configuring it".
+		 *
+		 * For other sources, the longer lifetime wins. */
+		if (   (new->addr_source == NM_IP_CONFIG_SOURCE_KERNEL && new->addr_source != item_old.addr_source)
+		    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
+			item->timestamp = item_old.timestamp;
+			item->lifetime = item_old.lifetime;
+			item->preferred = item_old.preferred;
 		}
+		if (nm_platform_ip4_address_cmp (&item_old, item) == 0)
+			return;
+		goto NOTIFY;
 	}
 
-	g_array_append_val (priv->addresses, *new);
+	nm_utils_array_append_indexed (priv->addresses, &priv->addresses_idx, new);
 NOTIFY:
 	_notify (config, PROP_ADDRESS_DATA);
 	_notify (config, PROP_ADDRESSES);
@@ -1561,7 +1592,7 @@ nm_ip4_config_del_address (NMIP4Config *config, guint i)
 
 	g_return_if_fail (i < priv->addresses->len);
 
-	g_array_remove_index (priv->addresses, i);
+	nm_utils_array_remove_indexed (priv->addresses, &priv->addresses_idx, i);
 	_notify (config, PROP_ADDRESS_DATA);
 	_notify (config, PROP_ADDRESSES);
 }
@@ -1589,6 +1620,52 @@ nm_ip4_config_address_exists (const NMIP4Config *config,
 	return _addresses_get_index (config, needle) >= 0;
 }
 
+gboolean
+nm_ip4_config_remove_address (NMIP4Config *config,
+                              const NMPlatformIP4Address *needle)
+{
+	int idx;
+
+	idx = _addresses_get_index (config, needle);
+	if (idx < 0)
+		return FALSE;
+	nm_ip4_config_del_address (config, idx);
+	return TRUE;
+}
+
+/**
+ * nm_ip4_config_replace_address:
+ * @config: the #NMIP4Config
+ * @new: the address
+ *
+ * Like nm_ip4_config_add_address(), but an existing address with the
+ * same basic properties is overwritten with @new as is, without merging
+ * the source and lifetimes. The address keeps its position.
+ */
+void
+nm_ip4_config_replace_address (NMIP4Config *config, const NMPlatformIP4Address *new)
+{
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (config);
+	NMPlatformIP4Address *item;
+	int i;
+
+	g_return_if_fail (new != NULL);
+
+	i = _addresses_get_index (config, new);
+	if (i < 0) {
+		nm_utils_array_append_indexed (priv->addresses, &priv->addresses_idx, new);
+		goto NOTIFY;
+	}
+
+	item = &g_array_index (priv->addresses, NMPlatformIP4Address, i);
+	if (nm_platform_ip4_address_cmp (item, new) == 0)
+		return;
+	*item = *new;
+NOTIFY:
+	_notify (config, PROP_ADDRESS_DATA);
+	_notify (config, PROP_ADDRESSES);
+}
+
 /******************************************************************/
 
 void
@@ -1598,6 +1675,7 @@ nm_ip4_config_reset_routes (NMIP4Config *config)
 
 	if (priv->routes->len != 0) {
 		g_array_set_size (priv->routes, 0);
+		g_clear_pointer (&priv->routes_idx, g_hash_table_unref);
 		_notify (config, PROP_ROUTE_DATA);
 		_notify (config, PROP_ROUTES);
 	}
@@ -1624,22 +1702,21 @@ nm_ip4_config_add_route (NMIP4Config *config, const NMPlatformIP4Route *new)
 	g_return_if_fail (new->plen > 0 && new->plen <= 32);
 	g_assert (priv->ifindex);
 
-	for (i = 0; i < priv->routes->len; i++ ) {
+	i = _routes_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP4Route *item = &g_array_index (priv->routes, NMPlatformIP4Route, i);
 
-		if (routes_are_duplicate (item, new, FALSE)) {
-			if (nm_platform_ip4_route_cmp (item, new) == 0)
-				return;
-			old_source = item->rt_source;
-			memcpy (item, new, sizeof (*item));
-			/* Restore highest priority source */
-			item->rt_source = MAX (old_source, new->rt_source);
-			item->ifindex = priv->ifindex;
-			goto NOTIFY;
-		}
+		if (nm_platform_ip4_route_cmp (item, new) == 0)
+			return;
+		old_source = item->rt_source;
+		memcpy (item, new, sizeof (*item));
+		/* Restore highest priority source */
+		item->rt_source = MAX (old_source, new->rt_source);
+		item->ifindex = priv->ifindex;
+		goto NOTIFY;
 	}
 
-	g_array_append_val (priv->routes, *new);
+	nm_utils_array_append_indexed (priv->routes, &priv->routes_idx, new);
 	g_array_index (priv->routes, NMPlatformIP4Route, priv->routes->len - 1).ifindex = priv->ifindex;
 NOTIFY:
 	_notify (config, PROP_ROUTE_DATA);
@@ -1653,7 +1730,7 @@ nm_ip4_config_del_route (NMIP4Config *config, guint i)
 
 	g_return_if_fail (i < priv->routes->len);
 
-	g_array_remove_index (priv->routes, i);
+	nm_utils_array_remove_indexed (priv->routes, &priv->routes_idx, i);
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
 }
@@ -1674,6 +1751,183 @@ nm_ip4_config_get_route (const NMIP4Config *config, guint i)
 	return &g_array_index (priv->routes, NMPlatformIP4Route, i);
 }
 
+gboolean
+nm_ip4_config_route_exists (const NMIP4Config *config,
+                            const NMPlatformIP4Route *needle)
+{
+	return _routes_get_index (config, needle) >= 0;
+}
+
+gboolean
+nm_ip4_config_remove_route (NMIP4Config *config,
+                            const NMPlatformIP4Route *needle)
+{
+	int idx;
+
+	idx = _routes_get_index (config, needle);
+	if (idx < 0)
+		return FALSE;
+	nm_ip4_config_del_route (config, idx);
+	return TRUE;
+}
+
+/**
+ * nm_ip4_config_replace_route:
+ * @config: the #NMIP4Config
+ * @new: the route
+ *
+ * Like nm_ip4_config_add_route(), but an existing route with the same
+ * basic properties is overwritten with @new as is, including its source.
+ * The route keeps its position.
+ */
+void
+nm_ip4_config_replace_route (NMIP4Config *config, const NMPlatformIP4Route *new)
+{
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (config);
+	NMPlatformIP4Route *item;
+	int i;
+
+	g_return_if_fail (new != NULL);
+	g_return_if_fail (new->plen > 0 && new->plen <= 32);
+	g_assert (priv->ifindex);
+
+	i = _routes_get_index (config, new);
+	if (i < 0) {
+		nm_utils_array_append_indexed (priv->routes, &priv->routes_idx, new);
+		item = &g_array_index (priv->routes, NMPlatformIP4Route, priv->routes->len - 1);
+	} else {
+		item = &g_array_index (priv->routes, NMPlatformIP4Route, i);
+		if (nm_platform_ip4_route_cmp (item, new) == 0)
+			return;
+		*item = *new;
+	}
+	item->ifindex = priv->ifindex;
+	_notify (config, PROP_ROUTE_DATA);
+	_notify (config, PROP_ROUTES);
+}
+
+/**
+ * nm_ip4_config_apply_address_change:
+ * @ext: the configuration of external origin
+ * @internal: (element-type NMIP4Config): the configurations of internal origin
+ * @address: the changed address
+ * @removed: whether @address was removed or added/changed
+ *
+ * Updates @ext and @internal for a change of @address on the platform, with
+ * the same result as capturing the configuration anew, intersecting each
+ * of @internal with it and subtracting @internal from it.
+ *
+ * Returns: %FALSE if the change cannot be applied this way. The
+ *   configurations must then be updated by capturing them.
+ */
+gboolean
+nm_ip4_config_apply_address_change (NMIP4Config *ext,
+                                    const GPtrArray *internal,
+                                    const NMPlatformIP4Address *address,
+                                    gboolean removed)
+{
+	gboolean is_internal = FALSE;
+	guint i;
+
+	if (removed) {
+		/* like nm_ip4_config_intersect(): the address is no longer
+		 * present externally, drop it from the internal configs. */
+		for (i = 0; i < internal->len; i++) {
+			NMIP4Config *config = internal->pdata[i];
+
+			if (   nm_ip4_config_remove_address (config, address)
+			    && !nm_ip4_config_get_num_addresses (config))
+				nm_ip4_config_unset_gateway (config);
+		}
+		if (   nm_ip4_config_remove_address (ext, address)
+		    && !nm_ip4_config_get_num_addresses (ext))
+			nm_ip4_config_unset_gateway (ext);
+		return TRUE;
+	}
+
+	/* like nm_ip4_config_subtract(): @ext only contains
+	 * addresses that are not configured internally. */
+	for (i = 0; i < internal->len && !is_internal; i++)
+		is_internal = nm_ip4_config_address_exists (internal->pdata[i], address);
+
+	if (is_internal) {
+		if (   nm_ip4_config_remove_address (ext, address)
+		    && !nm_ip4_config_get_num_addresses (ext))
+			nm_ip4_config_unset_gateway (ext);
+		return TRUE;
+	}
+
+	/* The gateway was unset together with the last address,
+	 * only capturing the configuration restores it. */
+	if (!nm_ip4_config_get_num_addresses (ext))
+		return FALSE;
+
+	nm_ip4_config_replace_address (ext, address);
+	return TRUE;
+}
+
+static gboolean
+_route_conflicts (const NMIP4Config *config, const NMPlatformIP4Route *route)
+{
+	const NMPlatformIP4Route *item;
+	int idx;
+
+	idx = _routes_get_index (config, route);
+	if (idx < 0)
+		return FALSE;
+	item = nm_ip4_config_get_route (config, idx);
+	return    item->metric != route->metric
+	       || item->gateway != route->gateway;
+}
+
+/**
+ * nm_ip4_config_apply_route_change:
+ * @ext: the configuration of external origin
+ * @internal: (element-type NMIP4Config): the configurations of internal origin
+ * @route: the changed route
+ * @removed: whether @route was removed or added/changed
+ *
+ * Like nm_ip4_config_apply_address_change(), for a route.
+ *
+ * Returns: %FALSE if the change cannot be applied this way.
+ */
+gboolean
+nm_ip4_config_apply_route_change (NMIP4Config *ext,
+                                  const GPtrArray *internal,
+                                  const NMPlatformIP4Route *route,
+                                  gboolean removed)
+{
+	gboolean is_internal = FALSE;
+	guint i;
+
+	/* The default route and the host route to the gateway determine
+	 * the gateway and route metric. After removing a route, another
+	 * one with the same destination but a different metric might
+	 * still exist. */
+	if (   NM_PLATFORM_IP_ROUTE_IS_DEFAULT (route)
+	    || (route->plen == 32 && !route->gateway)
+	    || removed)
+		return FALSE;
+
+	/* A configuration only holds one route per destination. If there
+	 * is already another one, which of them the captured configuration
+	 * contains depends on the order of the routes in the kernel. */
+	if (_route_conflicts (ext, route))
+		return FALSE;
+	for (i = 0; i < internal->len; i++) {
+		if (_route_conflicts (internal->pdata[i], route))
+			return FALSE;
+	}
+
+	for (i = 0; i < internal->len && !is_internal; i++)
+		is_internal = nm_ip4_config_route_exists (internal->pdata[i], route);
+	if (is_internal)
+		nm_ip4_config_remove_route (ext, route);
+	else
+		nm_ip4_config_replace_route (ext, route);
+	return TRUE;
+}
+
 const NMPlatformIP4Route *
 nm_ip4_config_get_direct_route_for_host (const NMIP4Config *config, guint32 host)
 {
@@ -2288,6 +2542,10 @@ finalize (GObject *object)
 
 	g_array_unref (priv->addresses);
 	g_array_unref (priv->routes);
+	if (priv->addresses_idx)
+		g_hash_table_unref (priv->addresses_idx);
+	if (priv->routes_idx)
+		g_hash_table_unref (priv->routes_idx);
 	g_array_unref (priv->nameservers);
 	g_ptr_array_unref (priv->domains);
 	g_ptr_array_unref (priv->searches);
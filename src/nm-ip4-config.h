@@ -88,6 +88,8 @@ void nm_ip4_config_del_address (NMIP4Config *config, guint i);
 guint nm_ip4_config_get_num_addresses (const NMIP4Config *config);
 const NMPlatformIP4Address *nm_ip4_config_get_address (const NMIP4Config *config, guint i);
 gboolean nm_ip4_config_address_exists (const NMIP4Config *config, const NMPlatformIP4Address *address);
+gboolean nm_ip4_config_remove_address (NMIP4Config *config, const NMPlatformIP4Address *address);
+void nm_ip4_config_replace_address (NMIP4Config *config, const NMPlatformIP4Address *address);
 gboolean nm_ip4_config_addresses_sort (NMIP4Config *config);
 
 /* Routes */
@@ -96,6 +98,18 @@ void nm_ip4_config_add_route (NMIP4Config *config, const NMPlatformIP4Route *rou
 void nm_ip4_config_del_route (NMIP4Config *config, guint i);
 guint32 nm_ip4_config_get_num_routes (const NMIP4Config *config);
 const NMPlatformIP4Route *nm_ip4_config_get_route (const NMIP4Config *config, guint32 i);
+gboolean nm_ip4_config_route_exists (const NMIP4Config *config, const NMPlatformIP4Route *route);
+gboolean nm_ip4_config_remove_route (NMIP4Config *config, const NMPlatformIP4Route *route);
+void nm_ip4_config_replace_route (NMIP4Config *config, const NMPlatformIP4Route *route);
+
+gboolean nm_ip4_config_apply_address_change (NMIP4Config *ext,
+                                             const GPtrArray *internal,
+                                             const NMPlatformIP4Address *address,
+                                             gboolean removed);
+gboolean nm_ip4_config_apply_route_change (NMIP4Config *ext,
+                                           const GPtrArray *internal,
+                                           const NMPlatformIP4Route *route,
+                                           gboolean removed);
 
 const NMPlatformIP4Route *nm_ip4_config_get_direct_route_for_host (const NMIP4Config *config, guint32 host);
 
@@ -40,6 +40,9 @@ typedef struct {
 	struct in6_addr gateway;
 	GArray *addresses;
 	GArray *routes;
+	/* hash indexes on the identity of @addresses and @routes, built on demand */
+	GHashTable *addresses_idx;
+	GHashTable *routes_idx;
 	GArray *nameservers;
 	GPtrArray *domains;
 	GPtrArray *searches;
@@ -198,6 +201,45 @@ routes_are_duplicate (const NMPlatformIP6Route *a, const NMPlatformIP6Route *b,
 	            && nm_utils_ip6_route_metric_normalize (a->metric) == nm_utils_ip6_route_metric_normalize (b->metric)));
 }
 
+static guint
+_in6_addr_hash (const struct in6_addr *addr)
+{
+	guint h = 0;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (addr->s6_addr); i++)
+		h = (h * 33) + addr->s6_addr[i];
+	return h;
+}
+
+static guint
+_address_id_hash (gconstpointer ptr)
+{
+	const NMPlatformIP6Address *a = ptr;
+
+	return _in6_addr_hash (&a->address);
+}
+
+static gboolean
+_address_id_equal (gconstpointer a, gconstpointer b)
+{
+	return addresses_are_duplicate (a, b);
+}
+
+static guint
+_route_id_hash (gconstpointer ptr)
+{
+	const NMPlatformIP6Route *r = ptr;
+
+	return (_in6_addr_hash (&r->network) * 33) + r->plen;
+}
+
+static gboolean
+_route_id_equal (gconstpointer a, gconstpointer b)
+{
+	return routes_are_duplicate (a, b, FALSE);
+}
+
 static gint
 _addresses_sort_cmp_get_prio (const struct in6_addr *addr)
 {
@@ -293,6 +335,7 @@ nm_ip6_config_addresses_sort (NMIP6Config *self, NMSettingIP6ConfigPrivacy use_t
 		memcpy (data_pre, priv->addresses->data, data_len);
 
 		g_array_sort_with_data (priv->addresses, _addresses_sort_cmp, GINT_TO_POINTER (use_temporary));
+		g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
 
 		changed = memcmp (data_pre, priv->addresses->data, data_len) != 0;
 		g_free (data_pre);
@@ -754,16 +797,11 @@ nm_ip6_config_destination_is_direct (const NMIP6Config *config, const struct in6
 static int
 _addresses_get_index (const NMIP6Config *self, const NMPlatformIP6Address *addr)
 {
-	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->addresses->len; i++) {
-		const NMPlatformIP6Address *a = &g_array_index (priv->addresses, NMPlatformIP6Address, i);
+	/* the index is only a cache, it's fine to build it for a const config. */
+	NMIP6ConfigPrivate *priv = (NMIP6ConfigPrivate *) NM_IP6_CONFIG_GET_PRIVATE (self);
 
-		if (addresses_are_duplicate (a, addr))
-			return (int) i;
-	}
-	return -1;
+	return nm_utils_array_find_indexed (priv->addresses, &priv->addresses_idx,
+	                                    _address_id_hash, _address_id_equal, addr);
 }
 
 static int
@@ -784,16 +822,10 @@ _nameservers_get_index (const NMIP6Config *self, const struct in6_addr *ns)
 static int
 _routes_get_index (const NMIP6Config *self, const NMPlatformIP6Route *route)
 {
-	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	guint i;
+	NMIP6ConfigPrivate *priv = (NMIP6ConfigPrivate *) NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	for (i = 0; i < priv->routes->len; i++) {
-		const NMPlatformIP6Route *r = &g_array_index (priv->routes, NMPlatformIP6Route, i);
-
-		if (routes_are_duplicate (route, r, FALSE))
-			return (int) i;
-	}
-	return -1;
+	return nm_utils_array_find_indexed (priv->routes, &priv->routes_idx,
+	                                    _route_id_hash, _route_id_equal, route);
 }
 
 static int
@@ -853,6 +885,8 @@ _dns_options_get_index (const NMIP6Config *self, const char *option)
 void
 nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 {
+	NMIP6ConfigPrivate *dst_priv;
+	const NMIP6ConfigPrivate *src_priv;
 	guint i;
 	gint idx;
 	const struct in6_addr *dst_tmp, *src_tmp;
@@ -860,13 +894,16 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
+	dst_priv = NM_IP6_CONFIG_GET_PRIVATE (dst);
+	src_priv = NM_IP6_CONFIG_GET_PRIVATE (src);
+
 	g_object_freeze_notify (G_OBJECT (dst));
 
 	/* addresses */
-	for (i = 0; i < nm_ip6_config_get_num_addresses (src); i++) {
-		idx = _addresses_get_index (dst, nm_ip6_config_get_address (src, i));
-		if (idx >= 0)
-			nm_ip6_config_del_address (dst, idx);
+	if (nm_utils_array_subtract_indexed (dst_priv->addresses, &dst_priv->addresses_idx, src_priv->addresses,
+	                                     _address_id_hash, _address_id_equal)) {
+		_notify (dst, PROP_ADDRESS_DATA);
+		_notify (dst, PROP_ADDRESSES);
 	}
 
 	/* nameservers */
@@ -888,10 +925,10 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 	/* ignore route_metric */
 
 	/* routes */
-	for (i = 0; i < nm_ip6_config_get_num_routes (src); i++) {
-		idx = _routes_get_index (dst, nm_ip6_config_get_route (src, i));
-		if (idx >= 0)
-			nm_ip6_config_del_route (dst, idx);
+	if (nm_utils_array_subtract_indexed (dst_priv->routes, &dst_priv->routes_idx, src_priv->routes,
+	                                     _route_id_hash, _route_id_equal)) {
+		_notify (dst, PROP_ROUTE_DATA);
+		_notify (dst, PROP_ROUTES);
 	}
 
 	/* domains */
@@ -928,22 +965,25 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 void
 nm_ip6_config_intersect (NMIP6Config *dst, const NMIP6Config *src)
 {
-	guint i;
-	gint idx;
+	NMIP6ConfigPrivate *dst_priv;
+	NMIP6ConfigPrivate *src_priv;
 	const struct in6_addr *dst_tmp, *src_tmp;
 
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
+	dst_priv = NM_IP6_CONFIG_GET_PRIVATE (dst);
+	/* the indexes of @src are only a cache, it's fine to build them. */
+	src_priv = (NMIP6ConfigPrivate *) NM_IP6_CONFIG_GET_PRIVATE (src);
+
 	g_object_freeze_notify (G_OBJECT (dst));
 
 	/* addresses */
-	for (i = 0; i < nm_ip6_config_get_num_addresses (dst); ) {
-		idx = _addresses_get_index (src, nm_ip6_config_get_address (dst, i));
-		if (idx < 0)
-			nm_ip6_config_del_address (dst, i);
-		else
-			i++;
+	if (nm_utils_array_intersect_indexed (dst_priv->addresses, &dst_priv->addresses_idx,
+	                                      src_priv->addresses, &src_priv->addresses_idx,
+	                                      _address_id_hash, _address_id_equal)) {
+		_notify (dst, PROP_ADDRESS_DATA);
+		_notify (dst, PROP_ADDRESSES);
 	}
 
 	/* ignore route_metric */
@@ -960,12 +1000,11 @@ nm_ip6_config_intersect (NMIP6Config *dst, const NMIP6Config *src)
 	}
 
 	/* routes */
-	for (i = 0; i < nm_ip6_config_get_num_routes (dst); ) {
-		idx = _routes_get_index (src, nm_ip6_config_get_route (dst, i));
-		if (idx < 0)
-			nm_ip6_config_del_route (dst, i);
-		else
-			i++;
+	if (nm_utils_array_intersect_indexed (dst_priv->routes, &dst_priv->routes_idx,
+	                                      src_priv->routes, &src_priv->routes_idx,
+	                                      _route_id_hash, _route_id_equal)) {
+		_notify (dst, PROP_ROUTE_DATA);
+		_notify (dst, PROP_ROUTES);
 	}
 
 	/* ignore domains */
@@ -1301,6 +1340,7 @@ nm_ip6_config_reset_addresses (NMIP6Config *config)
 
 	if (priv->addresses->len != 0) {
 		g_array_set_size (priv->addresses, 0);
+		g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
 		_notify (config, PROP_ADDRESS_DATA);
 		_notify (config, PROP_ADDRESSES);
 	}
@@ -1325,39 +1365,38 @@ nm_ip6_config_add_address (NMIP6Config *config, const NMPlatformIP6Address *new)
 
 	g_return_if_fail (new != NULL);
 
-	for (i = 0; i < priv->addresses->len; i++ ) {
+	i = _addresses_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP6Address *item = &g_array_index (priv->addresses, NMPlatformIP6Address, i);
 
-		if (addresses_are_duplicate (item, new)) {
-			if (nm_platform_ip6_address_cmp (item, new) == 0)
-				return;
-
-			/* remember the old values. */
-			item_old = *item;
-			/* Copy over old item to get new lifetime, timestamp, preferred */
-			*item = *new;
-
-			/* But restore highest priority source */
-			item->addr_source = MAX (item_old.addr_source, new->addr_source);
-
-			/* for addresses that we read from the kernel, we keep the timestamps as defined
-			 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
-			 * with "what should be" and the kernel values are "what turned out after configuring it".
-			 *
-			 * For other sources, the longer lifetime wins. */
-			if (   (new->addr_source == NM_IP_CONFIG_SOURCE_KERNEL && new->addr_source != item_old.addr_source)
-			    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
-				item->timestamp = item_old.timestamp;
-				item->lifetime = item_old.lifetime;
-				item->preferred = item_old.preferred;
-			}
-			if (nm_platform_ip6_address_cmp (&item_old, item) == 0)
-				return;
-			goto NOTIFY;
+		if (nm_platform_ip6_address_cmp (item, new) == 0)
+			return;
+
+		/* remember the old values. */
+		item_old = *item;
+		/* Copy over old item to get new lifetime, timestamp, preferred */
+		*item = *new;
+
+		/* But restore highest priority source */
+		item->addr_source = MAX (item_old.addr_source, new->addr_source);
+
+		/* for addresses that we read from the kernel, we keep the timestamps as defined
+		 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
+		 * with "what should be" and the kernel values are "what turned out after configuring it".
+		 *
+		 * For other sources, the longer lifetime wins. */
+		if (   (new->addr_source == NM_IP_CONFIG_SOURCE_KERNEL && new->addr_source != item_old.addr_source)
+		    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
+			item->timestamp = item_old.timestamp;
+			item->lifetime = item_old.lifetime;
+			item->preferred = item_old.preferred;
 		}
+		if (nm_platform_ip6_address_cmp (&item_old, item) == 0)
+			return;
+		goto NOTIFY;
 	}
 
-	g_array_append_val (priv->addresses, *new);
+	nm_utils_array_append_indexed (priv->addresses, &priv->addresses_idx, new);
 NOTIFY:
 	_notify (config, PROP_ADDRESS_DATA);
 	_notify (config, PROP_ADDRESSES);
@@ -1370,7 +1409,7 @@ nm_ip6_config_del_address (NMIP6Config *config, guint i)
 
 	g_return_if_fail (i < priv->addresses->len);
 
-	g_array_remove_index (priv->addresses, i);
+	nm_utils_array_remove_indexed (priv->addresses, &priv->addresses_idx, i);
 	_notify (config, PROP_ADDRESS_DATA);
 	_notify (config, PROP_ADDRESSES);
 }
@@ -1398,6 +1437,52 @@ nm_ip6_config_address_exists (const NMIP6Config *config,
 	return _addresses_get_index (config, needle) >= 0;
 }
 
+gboolean
+nm_ip6_config_remove_address (NMIP6Config *config,
+                              const NMPlatformIP6Address *needle)
+{
+	int idx;
+
+	idx = _addresses_get_index (config, needle);
+	if (idx < 0)
+		return FALSE;
+	nm_ip6_config_del_address (config, idx);
+	return TRUE;
+}
+
+/**
+ * nm_ip6_config_replace_address:
+ * @config: the #NMIP6Config
+ * @new: the address
+ *
+ * Like nm_ip6_config_add_address(), but an existing address with the
+ * same basic properties is overwritten with @new as is, without merging
+ * the source and lifetimes. The address keeps its position.
+ */
+void
+nm_ip6_config_replace_address (NMIP6Config *config, const NMPlatformIP6Address *new)
+{
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (config);
+	NMPlatformIP6Address *item;
+	int i;
+
+	g_return_if_fail (new != NULL);
+
+	i = _addresses_get_index (config, new);
+	if (i < 0) {
+		nm_utils_array_append_indexed (priv->addresses, &priv->addresses_idx, new);
+		goto NOTIFY;
+	}
+
+	item = &g_array_index (priv->addresses, NMPlatformIP6Address, i);
+	if (nm_platform_ip6_address_cmp (item, new) == 0)
+		return;
+	*item = *new;
+NOTIFY:
+	_notify (config, PROP_ADDRESS_DATA);
+	_notify (config, PROP_ADDRESSES);
+}
+
 const NMPlatformIP6Address *
 nm_ip6_config_get_address_first_nontentative (const NMIP6Config *config, gboolean linklocal)
 {
@@ -1471,6 +1556,7 @@ nm_ip6_config_reset_routes (NMIP6Config *config)
 
 	if (priv->routes->len != 0) {
 		g_array_set_size (priv->routes, 0);
+		g_clear_pointer (&priv->routes_idx, g_hash_table_unref);
 		_notify (config, PROP_ROUTE_DATA);
 		_notify (config, PROP_ROUTES);
 	}
@@ -1497,22 +1583,21 @@ nm_ip6_config_add_route (NMIP6Config *config, const NMPlatformIP6Route *new)
 	g_return_if_fail (new->plen > 0 && new->plen <= 128);
 	g_assert (priv->ifindex);
 
-	for (i = 0; i < priv->routes->len; i++ ) {
+	i = _routes_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP6Route *item = &g_array_index (priv->routes, NMPlatformIP6Route, i);
 
-		if (routes_are_duplicate (item, new, FALSE)) {
-			if (nm_platform_ip6_route_cmp (item, new) == 0)
-				return;
-			old_source = item->rt_source;
-			*item = *new;
-			/* Restore highest priority source */
-			item->rt_source = MAX (old_source, new->rt_source);
-			item->ifindex = priv->ifindex;
-			goto NOTIFY;
-		}
+		if (nm_platform_ip6_route_cmp (item, new) == 0)
+			return;
+		old_source = item->rt_source;
+		*item = *new;
+		/* Restore highest priority source */
+		item->rt_source = MAX (old_source, new->rt_source);
+		item->ifindex = priv->ifindex;
+		goto NOTIFY;
 	}
 
-	g_array_append_val (priv->routes, *new);
+	nm_utils_array_append_indexed (priv->routes, &priv->routes_idx, new);
 	g_array_index (priv->routes, NMPlatformIP6Route, priv->routes->len - 1).ifindex = priv->ifindex;
 NOTIFY:
 	_notify (config, PROP_ROUTE_DATA);
@@ -1526,7 +1611,7 @@ nm_ip6_config_del_route (NMIP6Config *config, guint i)
 
 	g_return_if_fail (i < priv->routes->len);
 
-	g_array_remove_index (priv->routes, i);
+	nm_utils_array_remove_indexed (priv->routes, &priv->routes_idx, i);
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
 }
@@ -1547,6 +1632,184 @@ nm_ip6_config_get_route (const NMIP6Config *config, guint i)
 	return &g_array_index (priv->routes, NMPlatformIP6Route, i);
 }
 
+gboolean
+nm_ip6_config_route_exists (const NMIP6Config *config,
+                            const NMPlatformIP6Route *needle)
+{
+	return _routes_get_index (config, needle) >= 0;
+}
+
+gboolean
+nm_ip6_config_remove_route (NMIP6Config *config,
+                            const NMPlatformIP6Route *needle)
+{
+	int idx;
+
+	idx = _routes_get_index (config, needle);
+	if (idx < 0)
+		return FALSE;
+	nm_ip6_config_del_route (config, idx);
+	return TRUE;
+}
+
+/**
+ * nm_ip6_config_replace_route:
+ * @config: the #NMIP6Config
+ * @new: the route
+ *
+ * Like nm_ip6_config_add_route(), but an existing route with the same
+ * basic properties is overwritten with @new as is, including its source.
+ * The route keeps its position.
+ */
+void
+nm_ip6_config_replace_route (NMIP6Config *config, const NMPlatformIP6Route *new)
+{
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (config);
+	NMPlatformIP6Route *item;
+	int i;
+
+	g_return_if_fail (new != NULL);
+	g_return_if_fail (new->plen > 0 && new->plen <= 128);
+	g_assert (priv->ifindex);
+
+	i = _routes_get_index (config, new);
+	if (i < 0) {
+		nm_utils_array_append_indexed (priv->routes, &priv->routes_idx, new);
+		item = &g_array_index (priv->routes, NMPlatformIP6Route, priv->routes->len - 1);
+	} else {
+		item = &g_array_index (priv->routes, NMPlatformIP6Route, i);
+		if (nm_platform_ip6_route_cmp (item, new) == 0)
+			return;
+		*item = *new;
+	}
+	item->ifindex = priv->ifindex;
+	_notify (config, PROP_ROUTE_DATA);
+	_notify (config, PROP_ROUTES);
+}
+
+/**
+ * nm_ip6_config_apply_address_change:
+ * @ext: the configuration of external origin
+ * @captured: the configuration as captured from the platform
+ * @internal: (element-type NMIP6Config): the configurations of internal origin
+ * @address: the changed address
+ * @removed: whether @address was removed or added/changed
+ *
+ * Updates @captured, @ext and @internal for a change of @address on the
+ * platform, with the same result as capturing the configuration anew,
+ * intersecting each of @internal with it and subtracting @internal from
+ * a copy of it. Afterwards, the addresses of @captured and @ext must
+ * be sorted.
+ *
+ * Returns: %FALSE if the change cannot be applied this way. The
+ *   configurations must then be updated by capturing them.
+ */
+gboolean
+nm_ip6_config_apply_address_change (NMIP6Config *ext,
+                                    NMIP6Config *captured,
+                                    const GPtrArray *internal,
+                                    const NMPlatformIP6Address *address,
+                                    gboolean removed)
+{
+	gboolean is_internal = FALSE;
+	guint i;
+
+	if (removed) {
+		nm_ip6_config_remove_address (captured, address);
+
+		/* like nm_ip6_config_intersect() */
+		for (i = 0; i < internal->len; i++) {
+			NMIP6Config *config = internal->pdata[i];
+
+			if (   nm_ip6_config_remove_address (config, address)
+			    && !nm_ip6_config_get_num_addresses (config))
+				nm_ip6_config_set_gateway (config, NULL);
+		}
+		if (   nm_ip6_config_remove_address (ext, address)
+		    && !nm_ip6_config_get_num_addresses (ext))
+			nm_ip6_config_set_gateway (ext, NULL);
+		return TRUE;
+	}
+
+	nm_ip6_config_replace_address (captured, address);
+
+	/* like nm_ip6_config_subtract() */
+	for (i = 0; i < internal->len && !is_internal; i++)
+		is_internal = nm_ip6_config_address_exists (internal->pdata[i], address);
+
+	if (is_internal) {
+		if (   nm_ip6_config_remove_address (ext, address)
+		    && !nm_ip6_config_get_num_addresses (ext))
+			nm_ip6_config_set_gateway (ext, NULL);
+		return TRUE;
+	}
+
+	/* The gateway was unset together with the last address,
+	 * only capturing the configuration restores it. */
+	if (!nm_ip6_config_get_num_addresses (ext))
+		return FALSE;
+
+	nm_ip6_config_replace_address (ext, address);
+	return TRUE;
+}
+
+static gboolean
+_route_conflicts (const NMIP6Config *config, const NMPlatformIP6Route *route)
+{
+	const NMPlatformIP6Route *item;
+	int idx;
+
+	idx = _routes_get_index (config, route);
+	if (idx < 0)
+		return FALSE;
+	item = nm_ip6_config_get_route (config, idx);
+	return    item->metric != route->metric
+	       || !IN6_ARE_ADDR_EQUAL (&item->gateway, &route->gateway);
+}
+
+/**
+ * nm_ip6_config_apply_route_change:
+ * @ext: the configuration of external origin
+ * @captured: the configuration as captured from the platform
+ * @internal: (element-type NMIP6Config): the configurations of internal origin
+ * @route: the changed route
+ * @removed: whether @route was removed or added/changed
+ *
+ * Like nm_ip6_config_apply_address_change(), for a route.
+ *
+ * Returns: %FALSE if the change cannot be applied this way.
+ */
+gboolean
+nm_ip6_config_apply_route_change (NMIP6Config *ext,
+                                  NMIP6Config *captured,
+                                  const GPtrArray *internal,
+                                  const NMPlatformIP6Route *route,
+                                  gboolean removed)
+{
+	gboolean is_internal = FALSE;
+	guint i;
+
+	/* See nm_ip4_config_apply_route_change(). */
+	if (   NM_PLATFORM_IP_ROUTE_IS_DEFAULT (route)
+	    || (route->plen == 128 && IN6_IS_ADDR_UNSPECIFIED (&route->gateway))
+	    || removed)
+		return FALSE;
+
+	/* @captured has all routes of @ext and @internal. */
+	if (_route_conflicts (captured, route))
+		return FALSE;
+
+	nm_ip6_config_replace_route (captured, route);
+
+	for (i = 0; i < internal->len && !is_internal; i++)
+		is_internal = nm_ip6_config_route_exists (internal->pdata[i], route);
+	if (is_internal)
+		nm_ip6_config_remove_route (ext, route);
+	else
+		nm_ip6_config_replace_route (ext, route);
+	return TRUE;
+}
+
 const NMPlatformIP6Route *
 nm_ip6_config_get_direct_route_for_host (const NMIP6Config *config, const struct in6_addr *host)
 {
@@ -2015,6 +2278,10 @@ finalize (GObject *object)
 
 	g_array_unref (priv->addresses);
 	g_array_unref (priv->routes);
+	if (priv->addresses_idx)
+		g_hash_table_unref (priv->addresses_idx);
+	if (priv->routes_idx)
+		g_hash_table_unref (priv->routes_idx);
 	g_array_unref (priv->nameservers);
 	g_ptr_array_unref (priv->domains);
 	g_ptr_array_unref (priv->searches);
@@ -89,6 +89,8 @@ guint nm_ip6_config_get_num_addresses (const NMIP6Config *config);
 const NMPlatformIP6Address *nm_ip6_config_get_address (const NMIP6Config *config, guint i);
 const NMPlatformIP6Address *nm_ip6_config_get_address_first_nontentative (const NMIP6Config *config, gboolean linklocal);
 gboolean nm_ip6_config_address_exists (const NMIP6Config *config, const NMPlatformIP6Address *address);
+gboolean nm_ip6_config_remove_address (NMIP6Config *config, const NMPlatformIP6Address *address);
+void nm_ip6_config_replace_address (NMIP6Config *config, const NMPlatformIP6Address *address);
 gboolean nm_ip6_config_addresses_sort (NMIP6Config *config, NMSettingIP6ConfigPrivacy use_temporary);
 gboolean nm_ip6_config_has_any_dad_pending (const NMIP6Config *self,
                                             const NMIP6Config *candidates);
@@ -99,6 +101,20 @@ void nm_ip6_config_add_route (NMIP6Config *config, const NMPlatformIP6Route *rou
 void nm_ip6_config_del_route (NMIP6Config *config, guint i);
 guint32 nm_ip6_config_get_num_routes (const NMIP6Config *config);
 const NMPlatformIP6Route *nm_ip6_config_get_route (const NMIP6Config *config, guint32 i);
+gboolean nm_ip6_config_route_exists (const NMIP6Config *config, const NMPlatformIP6Route *route);
+gboolean nm_ip6_config_remove_route (NMIP6Config *config, const NMPlatformIP6Route *route);
+void nm_ip6_config_replace_route (NMIP6Config *config, const NMPlatformIP6Route *route);
+
+gboolean nm_ip6_config_apply_address_change (NMIP6Config *ext,
+                                             NMIP6Config *captured,
+                                             const GPtrArray *internal,
+                                             const NMPlatformIP6Address *address,
+                                             gboolean removed);
+gboolean nm_ip6_config_apply_route_change (NMIP6Config *ext,
+                                           NMIP6Config *captured,
+                                           const GPtrArray *internal,
+                                           const NMPlatformIP6Route *route,
+                                           gboolean removed);
 
 const NMPlatformIP6Route *nm_ip6_config_get_direct_route_for_host (const NMIP6Config *config, const struct in6_addr *host);
 const NMPlatformIP6Address *nm_ip6_config_get_subnet_for_host (const NMIP6Config *config, const struct in6_addr *host);
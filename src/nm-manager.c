@@ -106,6 +106,40 @@ typedef struct {
 	NMMetered metered;
 
 	GSList *devices;
+
+	struct {
+		/* NMDevice -> DeviceIndexKeys */
+		GHashTable *keys;
+
+		/* ifindex, IP ifindex, D-Bus path, interface name, IP interface
+		 * name and permanent MAC address -> GPtrArray of NMDevice, in the
+		 * order the devices were indexed. Multiple devices can share a key,
+		 * for example a realized and an unrealized device with the
+		 * same interface name. */
+		GHashTable *by_ifindex;
+		GHashTable *by_ip_ifindex;
+		GHashTable *by_path;
+		GHashTable *by_iface;
+		GHashTable *by_ip_iface;
+		GHashTable *by_perm_hw_addr;
+	} device_index;
+
+	struct {
+		/* link changes from platform that are not yet processed,
+		 * in the order they were first seen. */
+		GArray *queue;
+
+		/* ifindex -> position in @queue plus one */
+		GHashTable *queue_idx;
+		guint idle_id;
+
+		/* statistics, to see how well changes are coalesced */
+		guint64 n_signals;
+		guint64 n_signals_batched;
+		guint64 n_processed;
+		guint64 n_batches;
+	} platform_link;
+
 	NMState state;
 	NMConfig *config;
 	NMConnectivity *connectivity;
@@ -421,7 +455,7 @@ find_ac_for_connection (NMManager *manager, NMConnection *connection)
 }
 
 /* Filter out connections that are already active.
- * nm_settings_get_connections_sorted() returns sorted list. We need to preserve the
+ * The settings iterate the connections in sorted order. We need to preserve the
  * order so that we didn't change auto-activation order (recent timestamps
  * are first).
  * Caller is responsible for freeing the returned list with g_slist_free().
@@ -430,18 +464,16 @@ GSList *
 nm_manager_get_activatable_connections (NMManager *manager)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (manager);
-	GSList *all_connections = nm_settings_get_connections_sorted (priv->settings);
-	GSList *connections = NULL, *iter;
+	GSList *connections = NULL;
+	NMSettingsIter iter;
 	NMSettingsConnection *connection;
 
-	for (iter = all_connections; iter; iter = iter->next) {
-		connection = iter->data;
-
+	nm_settings_iter_init (&iter, priv->settings);
+	while (nm_settings_iter_next (&iter, &connection)) {
 		if (!find_ac_for_connection (manager, NM_CONNECTION (connection)))
 			connections = g_slist_prepend (connections, connection);
 	}
 
-	g_slist_free (all_connections);
 	return g_slist_reverse (connections);
 }
 
@@ -578,16 +610,195 @@ impl_manager_reload (NMManager *self,
 
 /************************************************************************/
 
+typedef struct {
+	/* the values under which a device is indexed. The device does not
+	 * always notify about changes right away (for example, notifications
+	 * are frozen while realizing), so lookups must check the values
+	 * of the device again. */
+	int ifindex;
+	int ip_ifindex;
+	char *path;
+	char *iface;
+	char *ip_iface;
+	char *perm_hw_addr;
+} DeviceIndexKeys;
+
+static void
+_device_index_keys_free (DeviceIndexKeys *keys)
+{
+	g_free (keys->path);
+	g_free (keys->iface);
+	g_free (keys->ip_iface);
+	g_free (keys->perm_hw_addr);
+	g_slice_free (DeviceIndexKeys, keys);
+}
+
+static char *
+_device_index_hwaddr_key (const char *hwaddr)
+{
+	char *key;
+	gsize len;
+
+	if (!hwaddr)
+		return NULL;
+
+	key = nm_utils_hwaddr_canonical (hwaddr, -1);
+	if (!key)
+		return NULL;
+
+	/* nm_utils_hwaddr_matches() only compares the last 8 bytes of
+	 * InfiniBand addresses. */
+	len = strlen (key);
+	if (len == INFINIBAND_ALEN * 3 - 1)
+		memmove (key, &key[len - (8 * 3 - 1)], 8 * 3);
+	return key;
+}
+
+static void
+_device_index_add (GHashTable *index, gconstpointer key, gboolean key_is_str, NMDevice *device)
+{
+	GPtrArray *devices;
+
+	devices = g_hash_table_lookup (index, key);
+	if (!devices) {
+		devices = g_ptr_array_new ();
+		g_hash_table_insert (index,
+		                     key_is_str ? g_strdup (key) : (gpointer) key,
+		                     devices);
+	}
+	g_ptr_array_add (devices, device);
+}
+
+static void
+_device_index_remove (GHashTable *index, gconstpointer key, NMDevice *device)
+{
+	GPtrArray *devices;
+
+	devices = g_hash_table_lookup (index, key);
+	if (!devices || !g_ptr_array_remove (devices, device))
+		g_return_if_reached ();
+	if (devices->len == 0)
+		g_hash_table_remove (index, key);
+}
+
+static void
+_device_index_update_int (GHashTable *index, int *p_key, int key, NMDevice *device)
+{
+	if (*p_key == key)
+		return;
+
+	_device_index_remove (index, GINT_TO_POINTER (*p_key), device);
+	*p_key = key;
+	_device_index_add (index, GINT_TO_POINTER (*p_key), FALSE, device);
+}
+
+static void
+_device_index_update_str (GHashTable *index, char **p_key, char *key, NMDevice *device)
+{
+	/* takes ownership of @key */
+	if (!g_strcmp0 (*p_key, key)) {
+		g_free (key);
+		return;
+	}
+
+	if (*p_key)
+		_device_index_remove (index, *p_key, device);
+	g_free (*p_key);
+	*p_key = key;
+	if (*p_key)
+		_device_index_add (index, *p_key, TRUE, device);
+}
+
+static void
+_device_index_update (NMManager *self, NMDevice *device)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	DeviceIndexKeys *keys;
+
+	keys = g_hash_table_lookup (priv->device_index.keys, device);
+	if (!keys) {
+		keys = g_slice_new0 (DeviceIndexKeys);
+		g_hash_table_insert (priv->device_index.keys, device, keys);
+		_device_index_add (priv->device_index.by_ifindex, GINT_TO_POINTER (keys->ifindex), FALSE, device);
+		_device_index_add (priv->device_index.by_ip_ifindex, GINT_TO_POINTER (keys->ip_ifindex), FALSE, device);
+	}
+
+	_device_index_update_int (priv->device_index.by_ifindex, &keys->ifindex,
+	                          nm_device_get_ifindex (device), device);
+	_device_index_update_int (priv->device_index.by_ip_ifindex, &keys->ip_ifindex,
+	                          nm_device_get_ip_ifindex (device), device);
+
+	_device_index_update_str (priv->device_index.by_path, &keys->path,
+	                          g_strdup (nm_exported_object_get_path (NM_EXPORTED_OBJECT (device))),
+	                          device);
+	_device_index_update_str (priv->device_index.by_iface, &keys->iface,
+	                          g_strdup (nm_device_get_iface (device)),
+	                          device);
+	_device_index_update_str (priv->device_index.by_ip_iface, &keys->ip_iface,
+	                          g_strdup (nm_device_get_ip_iface (device)),
+	                          device);
+	_device_index_update_str (priv->device_index.by_perm_hw_addr, &keys->perm_hw_addr,
+	                          _device_index_hwaddr_key (nm_device_get_permanent_hw_address (device, FALSE)),
+	                          device);
+}
+
+static void
+_device_index_remove_device (NMManager *self, NMDevice *device)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	DeviceIndexKeys *keys;
+
+	keys = g_hash_table_lookup (priv->device_index.keys, device);
+	if (!keys)
+		return;
+
+	_device_index_remove (priv->device_index.by_ifindex, GINT_TO_POINTER (keys->ifindex), device);
+	_device_index_remove (priv->device_index.by_ip_ifindex, GINT_TO_POINTER (keys->ip_ifindex), device);
+	if (keys->path)
+		_device_index_remove (priv->device_index.by_path, keys->path, device);
+	if (keys->iface)
+		_device_index_remove (priv->device_index.by_iface, keys->iface, device);
+	if (keys->ip_iface)
+		_device_index_remove (priv->device_index.by_ip_iface, keys->ip_iface, device);
+	if (keys->perm_hw_addr)
+		_device_index_remove (priv->device_index.by_perm_hw_addr, keys->perm_hw_addr, device);
+	g_hash_table_remove (priv->device_index.keys, device);
+}
+
+static NMDevice *const*
+_device_index_lookup (GHashTable *index, gconstpointer key, guint *out_len)
+{
+	GPtrArray *devices;
+
+	devices = g_hash_table_lookup (index, key);
+	if (!devices) {
+		*out_len = 0;
+		return NULL;
+	}
+	*out_len = devices->len;
+	return (NMDevice *const*) devices->pdata;
+}
+
+static void
+device_index_changed (NMDevice *device,
+                      GParamSpec *pspec,
+                      NMManager *self)
+{
+	_device_index_update (self, device);
+}
+
 static NMDevice *
 nm_manager_get_device_by_path (NMManager *manager, const char *path)
 {
-	GSList *iter;
+	NMDevice *const*devices;
+	guint i, len;
 
 	g_return_val_if_fail (path != NULL, NULL);
 
-	for (iter = NM_MANAGER_GET_PRIVATE (manager)->devices; iter; iter = iter->next) {
-		if (!strcmp (nm_exported_object_get_path (NM_EXPORTED_OBJECT (iter->data)), path))
-			return NM_DEVICE (iter->data);
+	devices = _device_index_lookup (NM_MANAGER_GET_PRIVATE (manager)->device_index.by_path, path, &len);
+	for (i = 0; i < len; i++) {
+		if (!g_strcmp0 (nm_exported_object_get_path (NM_EXPORTED_OBJECT (devices[i])), path))
+			return devices[i];
 	}
 	return NULL;
 }
@@ -595,32 +806,40 @@ nm_manager_get_device_by_path (NMManager *manager, const char *path)
 NMDevice *
 nm_manager_get_device_by_ifindex (NMManager *manager, int ifindex)
 {
-	GSList *iter;
+	NMDevice *const*devices;
+	guint i, len;
 
-	for (iter = NM_MANAGER_GET_PRIVATE (manager)->devices; iter; iter = iter->next) {
-		NMDevice *device = NM_DEVICE (iter->data);
-
-		if (nm_device_get_ifindex (device) == ifindex)
-			return device;
+	devices = _device_index_lookup (NM_MANAGER_GET_PRIVATE (manager)->device_index.by_ifindex,
+	                                GINT_TO_POINTER (ifindex), &len);
+	for (i = 0; i < len; i++) {
+		if (nm_device_get_ifindex (devices[i]) == ifindex)
+			return devices[i];
 	}
-
 	return NULL;
 }
 
 static NMDevice *
 find_device_by_permanent_hw_addr (NMManager *manager, const char *hwaddr)
 {
-	GSList *iter;
+	NMDevice *const*devices;
+	gs_free char *key = NULL;
 	const char *device_addr;
+	guint i, len;
 
 	g_return_val_if_fail (hwaddr != NULL, NULL);
 
-	if (nm_utils_hwaddr_valid (hwaddr, -1)) {
-		for (iter = NM_MANAGER_GET_PRIVATE (manager)->devices; iter; iter = iter->next) {
-			device_addr = nm_device_get_permanent_hw_address (NM_DEVICE (iter->data), FALSE);
-			if (device_addr && nm_utils_hwaddr_matches (hwaddr, -1, device_addr, -1))
-				return NM_DEVICE (iter->data);
-		}
+	if (!nm_utils_hwaddr_valid (hwaddr, -1))
+		return NULL;
+
+	key = _device_index_hwaddr_key (hwaddr);
+	if (!key)
+		return NULL;
+
+	devices = _device_index_lookup (NM_MANAGER_GET_PRIVATE (manager)->device_index.by_perm_hw_addr, key, &len);
+	for (i = 0; i < len; i++) {
+		device_addr = nm_device_get_permanent_hw_address (devices[i], FALSE);
+		if (device_addr && nm_utils_hwaddr_matches (hwaddr, -1, device_addr, -1))
+			return devices[i];
 	}
 	return NULL;
 }
@@ -628,12 +847,14 @@ find_device_by_permanent_hw_addr (NMManager *manager, const char *hwaddr)
 static NMDevice *
 find_device_by_ip_iface (NMManager *self, const gchar *iface)
 {
-	GSList *iter;
+	NMDevice *const*devices;
+	guint i, len;
 
 	g_return_val_if_fail (iface != NULL, NULL);
 
-	for (iter = NM_MANAGER_GET_PRIVATE (self)->devices; iter; iter = g_slist_next (iter)) {
-		NMDevice *candidate = iter->data;
+	devices = _device_index_lookup (NM_MANAGER_GET_PRIVATE (self)->device_index.by_ip_iface, iface, &len);
+	for (i = 0; i < len; i++) {
+		NMDevice *candidate = devices[i];
 
 		if (   nm_device_is_real (candidate)
 		    && g_strcmp0 (nm_device_get_ip_iface (candidate), iface) == 0)
@@ -665,12 +886,14 @@ find_device_by_iface (NMManager *self,
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
 	NMDevice *fallback = NULL;
-	GSList *iter;
+	NMDevice *const*devices;
+	guint i, len;
 
 	g_return_val_if_fail (iface != NULL, NULL);
 
-	for (iter = priv->devices; iter; iter = iter->next) {
-		NMDevice *candidate = iter->data;
+	devices = _device_index_lookup (priv->device_index.by_iface, iface, &len);
+	for (i = 0; i < len; i++) {
+		NMDevice *candidate = devices[i];
 
 		if (strcmp (nm_device_get_iface (candidate), iface))
 			continue;
@@ -945,6 +1168,31 @@ settings_startup_complete_changed (NMSettings *settings,
 	check_if_startup_complete (self);
 }
 
+static void
+settings_loading_changed (NMSettings *settings,
+                          GParamSpec *pspec,
+                          NMManager *self)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	GSList *devices, *iter;
+
+	if (nm_settings_get_loading (settings))
+		return;
+
+	/* Finish the devices that _device_realize_finish() left unmanaged
+	 * while the connections were loading. */
+	devices = g_slist_copy (priv->devices);
+	g_slist_foreach (devices, (GFunc) g_object_ref, NULL);
+	for (iter = devices; iter; iter = iter->next) {
+		NMDevice *device = iter->data;
+
+		if (   nm_device_get_state (device) == NM_DEVICE_STATE_UNMANAGED
+		    && nm_device_get_managed (device, FALSE))
+			_device_manage_realized (self, device);
+	}
+	g_slist_free_full (devices, g_object_unref);
+}
+
 static void
 remove_device (NMManager *self,
                NMDevice *device,
@@ -980,6 +1228,7 @@ remove_device (NMManager *self,
 
 	nm_settings_device_removed (priv->settings, device, quitting);
 	priv->devices = g_slist_remove (priv->devices, device);
+	_device_index_remove_device (self, device);
 
 	if (nm_device_is_real (device)) {
 		gboolean unconfigure_ip_config = !quitting || unmanage;
@@ -1156,7 +1405,8 @@ system_create_virtual_device (NMManager *self, NMConnection *connection)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
 	NMDeviceFactory *factory;
-	gs_free_slist GSList *connections = NULL;
+	NMSettingsIter settings_iter;
+	NMSettingsConnection *candidate_con;
 	GSList *iter;
 	gs_free char *iface = NULL;
 	NMDevice *device = NULL, *parent = NULL;
@@ -1227,15 +1477,14 @@ system_create_virtual_device (NMManager *self, NMConnection *connection)
 	}
 
 	/* Create backing resources if the device has any autoconnect connections */
-	connections = nm_settings_get_connections_sorted (priv->settings);
-	for (iter = connections; iter; iter = g_slist_next (iter)) {
-		NMConnection *candidate = iter->data;
+	nm_settings_iter_init (&settings_iter, priv->settings);
+	while (nm_settings_iter_next (&settings_iter, &candidate_con)) {
 		NMSettingConnection *s_con;
 
-		if (!nm_device_check_connection_compatible (device, candidate))
+		if (!nm_device_check_connection_compatible (device, NM_CONNECTION (candidate_con)))
 			continue;
 
-		s_con = nm_connection_get_setting_connection (candidate);
+		s_con = nm_connection_get_setting_connection (NM_CONNECTION (candidate_con));
 		g_assert (s_con);
 		if (!nm_setting_connection_get_autoconnect (s_con))
 			continue;
@@ -1258,13 +1507,14 @@ static void
 retry_connections_for_parent_device (NMManager *self, NMDevice *device)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
-	GSList *connections, *iter;
+	NMSettingsIter iter;
+	NMSettingsConnection *candidate_con;
 
 	g_return_if_fail (device);
 
-	connections = nm_settings_get_connections_sorted (priv->settings);
-	for (iter = connections; iter; iter = g_slist_next (iter)) {
-		NMConnection *candidate = iter->data;
+	nm_settings_iter_init (&iter, priv->settings);
+	while (nm_settings_iter_next (&iter, &candidate_con)) {
+		NMConnection *candidate = NM_CONNECTION (candidate_con);
 		gs_free_error GError *error = NULL;
 		gs_free char *ifname = NULL;
 		NMDevice *parent;
@@ -1279,8 +1529,6 @@ retry_connections_for_parent_device (NMManager *self, NMDevice *device)
 			}
 		}
 	}
-
-	g_slist_free (connections);
 }
 
 static void
@@ -1787,6 +2035,14 @@ recheck_assume_connection (NMManager *self, NMDevice *device)
 	if (nm_device_get_is_nm_owned (device))
 		return FALSE;
 
+	/* Until all connections are loaded, a generated connection might
+	 * shadow the profile on disk. settings_loading_changed() rechecks. */
+	if (nm_settings_get_loading (NM_MANAGER_GET_PRIVATE (self)->settings)) {
+		_LOGD (LOGD_DEVICE, "(%s): can't assume; connections are still loading",
+		       nm_device_get_iface (device));
+		return FALSE;
+	}
+
 	if (!nm_device_get_managed (device, FALSE))
 		return FALSE;
 
@@ -1839,15 +2095,22 @@ device_ip_iface_changed (NMDevice *device,
                          NMManager *self)
 {
 	const char *ip_iface = nm_device_get_ip_iface (device);
-	GSList *iter;
+	NMDevice *const*devices;
+	guint i, len;
+
+	_device_index_update (self, device);
+
+	if (!ip_iface)
+		return;
 
 	/* Remove NMDevice objects that are actually child devices of others,
 	 * when the other device finally knows its IP interface name.  For example,
 	 * remove the PPP interface that's a child of a WWAN device, since it's
 	 * not really a standalone NMDevice.
 	 */
-	for (iter = NM_MANAGER_GET_PRIVATE (self)->devices; iter; iter = iter->next) {
-		NMDevice *candidate = NM_DEVICE (iter->data);
+	devices = _device_index_lookup (NM_MANAGER_GET_PRIVATE (self)->device_index.by_iface, ip_iface, &len);
+	for (i = 0; i < len; i++) {
+		NMDevice *candidate = devices[i];
 
 		if (   candidate != device
 		    && g_strcmp0 (nm_device_get_iface (candidate), ip_iface) == 0
@@ -1863,6 +2126,8 @@ device_iface_changed (NMDevice *device,
                       GParamSpec *pspec,
                       NMManager *self)
 {
+	_device_index_update (self, device);
+
 	/* Virtual connections may refer to the new device name as
 	 * parent device, retry to activate them.
 	 */
@@ -1875,11 +2140,27 @@ device_realized (NMDevice *device,
                  GParamSpec *pspec,
                  NMManager *self)
 {
+	_device_index_update (self, device);
+
 	/* Emit D-Bus signals */
 	g_signal_emit (self, signals[DEVICE_ADDED], 0, device);
 	_notify (self, PROP_DEVICES);
 }
 
+static void
+_device_manage_realized (NMManager *self, NMDevice *device)
+{
+	if (recheck_assume_connection (self, device))
+		return;
+
+	/* if we failed to assume a connection for the managed device, but the device
+	 * is still unavailable. Set UNAVAILABLE state again, this time with NOW_MANAGED. */
+	nm_device_state_changed (device,
+	                         NM_DEVICE_STATE_UNAVAILABLE,
+	                         NM_DEVICE_STATE_REASON_NOW_MANAGED);
+	nm_device_emit_recheck_auto_activate (device);
+}
+
 static void
 _device_realize_finish (NMManager *self, NMDevice *device, const NMPlatformLink *plink)
 {
@@ -1891,15 +2172,13 @@ _device_realize_finish (NMManager *self, NMDevice *device, const NMPlatformLink
 	if (!nm_device_get_managed (device, FALSE))
 		return;
 
-	if (recheck_assume_connection (self, device))
+	/* Leave the device unmanaged and its configuration untouched until
+	 * the connections are loaded. settings_loading_changed() continues
+	 * from here. */
+	if (nm_settings_get_loading (NM_MANAGER_GET_PRIVATE (self)->settings))
 		return;
 
-	/* if we failed to assume a connection for the managed device, but the device
-	 * is still unavailable. Set UNAVAILABLE state again, this time with NOW_MANAGED. */
-	nm_device_state_changed (device,
-	                         NM_DEVICE_STATE_UNAVAILABLE,
-	                         NM_DEVICE_STATE_REASON_NOW_MANAGED);
-	nm_device_emit_recheck_auto_activate (device);
+	_device_manage_realized (self, device);
 }
 
 /**
@@ -1977,6 +2256,14 @@ add_device (NMManager *self, NMDevice *device, GError **error)
 	                  G_CALLBACK (device_realized),
 	                  self);
 
+	g_signal_connect (device, "notify::" NM_DEVICE_IFINDEX,
+	                  G_CALLBACK (device_index_changed),
+	                  self);
+
+	g_signal_connect (device, "notify::" NM_DEVICE_PERM_HW_ADDRESS,
+	                  G_CALLBACK (device_index_changed),
+	                  self);
+
 	if (priv->startup) {
 		g_signal_connect (device, "notify::" NM_DEVICE_HAS_PENDING_ACTION,
 		                  G_CALLBACK (device_has_pending_action_changed),
@@ -2005,6 +2292,7 @@ add_device (NMManager *self, NMDevice *device, GError **error)
 	                               manager_sleeping (self));
 
 	dbus_path = nm_exported_object_export (NM_EXPORTED_OBJECT (device));
+	_device_index_update (self, device);
 	_LOGI (LOGD_DEVICE, "(%s): new %s device (%s)", iface, type_desc, dbus_path);
 
 	nm_settings_device_added (priv->settings, device);
@@ -2090,16 +2378,22 @@ platform_link_added (NMManager *self,
 	NMDeviceFactory *factory;
 	NMDevice *device = NULL;
 	gboolean nm_plugin_missing = FALSE;
-	GSList *iter;
+	NMDevice *const*devices;
+	gs_free NMDevice **candidates = NULL;
+	guint i, len;
 
 	g_return_if_fail (ifindex > 0);
 
 	if (nm_manager_get_device_by_ifindex (self, ifindex))
 		return;
 
-	/* Let unrealized devices try to realize themselves with the link */
-	for (iter = NM_MANAGER_GET_PRIVATE (self)->devices; iter; iter = iter->next) {
-		NMDevice *candidate = iter->data;
+	/* Let unrealized devices try to realize themselves with the link. Realizing
+	 * a device changes the index, so iterate over a copy. */
+	devices = _device_index_lookup (NM_MANAGER_GET_PRIVATE (self)->device_index.by_iface, plink->name, &len);
+	if (len)
+		candidates = g_memdup (devices, sizeof (NMDevice *) * len);
+	for (i = 0; i < len; i++) {
+		NMDevice *candidate = candidates[i];
 		gboolean compatible = TRUE;
 		gs_free_error GError *error = NULL;
 
@@ -2112,7 +2406,9 @@ platform_link_added (NMManager *self,
 			 */
 			return;
 		} else if (nm_device_realize_start (candidate, plink, &compatible, &error)) {
-			/* Success */
+			/* Success. Notifications of the device are frozen until
+			 * the realization finishes, update the index right away. */
+			_device_index_update (self, candidate);
 			_device_realize_finish (self, candidate, plink);
 			return;
 		}
@@ -2175,52 +2471,125 @@ platform_link_added (NMManager *self,
 	}
 }
 
+typedef enum {
+	PLATFORM_LINK_PENDING_ADDED_OR_REMOVED  = (1LL << 0),
+	PLATFORM_LINK_PENDING_CHANGED           = (1LL << 1),
+} PlatformLinkPendingFlags;
+
 typedef struct {
-	NMManager *self;
 	int ifindex;
-} PlatformLinkCbData;
+	PlatformLinkPendingFlags flags;
+} PlatformLinkPending;
 
-static gboolean
-_platform_link_cb_idle (PlatformLinkCbData *data)
+static void
+platform_link_removed (NMManager *self, int ifindex)
+{
+	NMDevice *device;
+	GError *error = NULL;
+
+	device = nm_manager_get_device_by_ifindex (self, ifindex);
+	if (!device)
+		return;
+
+	if (nm_device_is_software (device)) {
+		/* Our software devices stick around until their connection is removed */
+		if (!nm_device_unrealize (device, FALSE, &error)) {
+			_LOGW (LOGD_DEVICE, "(%s): failed to unrealize: %s",
+			       nm_device_get_iface (device),
+			       error->message);
+			g_clear_error (&error);
+			remove_device (self, device, FALSE, TRUE);
+		}
+	} else {
+		/* Hardware and external devices always get removed when their kernel link is gone */
+		remove_device (self, device, FALSE, TRUE);
+	}
+}
+
+static void
+platform_link_changed (NMManager *self, int ifindex)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_unref_ptrarray GPtrArray *targets = NULL;
+	NMDevice *const*devices;
+	guint i, len;
+
+	/* Collect the devices first, handling the change might add or
+	 * remove devices. */
+	targets = g_ptr_array_new_with_free_func (g_object_unref);
+
+	devices = _device_index_lookup (priv->device_index.by_ifindex, GINT_TO_POINTER (ifindex), &len);
+	for (i = 0; i < len; i++)
+		g_ptr_array_add (targets, g_object_ref (devices[i]));
+
+	devices = _device_index_lookup (priv->device_index.by_ip_ifindex, GINT_TO_POINTER (ifindex), &len);
+	for (i = 0; i < len; i++) {
+		if (nm_device_get_ifindex (devices[i]) != ifindex)
+			g_ptr_array_add (targets, g_object_ref (devices[i]));
+	}
+
+	for (i = 0; i < targets->len; i++)
+		nm_device_platform_link_changed (targets->pdata[i], ifindex);
+}
+
+static void
+platform_link_process (NMManager *self, const PlatformLinkPending *pending)
 {
-	NMManager *self = data->self;
 	const NMPlatformLink *l;
 
-	if (!self)
-		goto out;
+	if (NM_FLAGS_HAS (pending->flags, PLATFORM_LINK_PENDING_ADDED_OR_REMOVED)) {
+		/* Only the current state of the link matters. If it was added and removed
+		 * again in the meantime, there is nothing to do. */
+		l = nm_platform_link_get (NM_PLATFORM_GET, pending->ifindex);
+		if (l) {
+			NMPlatformLink pllink;
 
-	g_object_remove_weak_pointer (G_OBJECT (self), (gpointer *) &data->self);
+			pllink = *l; /* make a copy of the link instance */
+			platform_link_added (self, pending->ifindex, &pllink);
+		} else
+			platform_link_removed (self, pending->ifindex);
+	}
 
-	l = nm_platform_link_get (NM_PLATFORM_GET, data->ifindex);
-	if (l) {
-		NMPlatformLink pllink;
+	if (NM_FLAGS_HAS (pending->flags, PLATFORM_LINK_PENDING_CHANGED))
+		platform_link_changed (self, pending->ifindex);
+}
 
-		pllink = *l; /* make a copy of the link instance */
-		platform_link_added (self, data->ifindex, &pllink);
-	} else {
-		NMDevice *device;
-		GError *error = NULL;
+static gboolean
+platform_link_process_pending (gpointer user_data)
+{
+	NMManager *self = user_data;
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_unref_array GArray *queue = NULL;
+	guint64 n_signals;
+	guint i;
 
-		device = nm_manager_get_device_by_ifindex (self, data->ifindex);
-		if (device) {
-			if (nm_device_is_software (device)) {
-				/* Our software devices stick around until their connection is removed */
-				if (!nm_device_unrealize (device, FALSE, &error)) {
-					_LOGW (LOGD_DEVICE, "(%s): failed to unrealize: %s",
-					       nm_device_get_iface (device),
-					       error->message);
-					g_clear_error (&error);
-					remove_device (self, device, FALSE, TRUE);
-				}
-			} else {
-				/* Hardware and external devices always get removed when their kernel link is gone */
-				remove_device (self, device, FALSE, TRUE);
-			}
-		}
+	/* Only process the changes queued so far. Handling them can cause
+	 * new changes, those are queued anew and handled by the next idle
+	 * run, so that a link that keeps changing can't starve the mainloop. */
+	queue = priv->platform_link.queue;
+	priv->platform_link.queue = g_array_new (FALSE, FALSE, sizeof (PlatformLinkPending));
+	g_hash_table_remove_all (priv->platform_link.queue_idx);
+	n_signals = priv->platform_link.n_signals - priv->platform_link.n_signals_batched;
+	priv->platform_link.n_signals_batched = priv->platform_link.n_signals;
+	priv->platform_link.idle_id = 0;
+
+	for (i = 0; i < queue->len; i++)
+		platform_link_process (self, &g_array_index (queue, PlatformLinkPending, i));
+
+	priv->platform_link.n_processed += queue->len;
+	priv->platform_link.n_batches++;
+
+	if (n_signals > queue->len) {
+		_LOGD (LOGD_DEVICE, "platform: coalesced %llu link signals into %u changes "
+		       "(total: %llu signals, %llu changes, %llu batches)",
+		       (unsigned long long) n_signals, queue->len,
+		       (unsigned long long) priv->platform_link.n_signals,
+		       (unsigned long long) priv->platform_link.n_processed,
+		       (unsigned long long) priv->platform_link.n_batches);
+	} else {
+		_LOGT (LOGD_DEVICE, "platform: processed %u link changes", queue->len);
 	}
 
-out:
-	g_slice_free (PlatformLinkCbData, data);
 	return G_SOURCE_REMOVE;
 }
 
@@ -2232,20 +2601,47 @@ platform_link_cb (NMPlatform *platform,
                   NMPlatformSignalChangeType change_type,
                   gpointer user_data)
 {
-	PlatformLinkCbData *data;
+	NMManager *self = NM_MANAGER (user_data);
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	PlatformLinkPending *pending;
+	guint idx;
+
+	if (ifindex <= 0)
+		return;
+
+	priv->platform_link.n_signals++;
+
+	/* Only remember what kind of changes happened to the link. When
+	 * processing it, the link is looked up again, so that repeated
+	 * changes to the same link are handled once. */
+	idx = GPOINTER_TO_UINT (g_hash_table_lookup (priv->platform_link.queue_idx,
+	                                             GINT_TO_POINTER (ifindex)));
+	if (idx == 0) {
+		g_array_set_size (priv->platform_link.queue, priv->platform_link.queue->len + 1);
+		idx = priv->platform_link.queue->len;
+		pending = &g_array_index (priv->platform_link.queue, PlatformLinkPending, idx - 1);
+		pending->ifindex = ifindex;
+		pending->flags = 0;
+		g_hash_table_insert (priv->platform_link.queue_idx,
+		                     GINT_TO_POINTER (ifindex),
+		                     GUINT_TO_POINTER (idx));
+	} else
+		pending = &g_array_index (priv->platform_link.queue, PlatformLinkPending, idx - 1);
 
 	switch (change_type) {
 	case NM_PLATFORM_SIGNAL_ADDED:
 	case NM_PLATFORM_SIGNAL_REMOVED:
-		data = g_slice_new (PlatformLinkCbData);
-		data->self = NM_MANAGER (user_data);
-		data->ifindex = ifindex;
-		g_object_add_weak_pointer (G_OBJECT (data->self), (gpointer *) &data->self);
-		g_idle_add ((GSourceFunc) _platform_link_cb_idle, data);
+		pending->flags |= PLATFORM_LINK_PENDING_ADDED_OR_REMOVED;
+		break;
+	case NM_PLATFORM_SIGNAL_CHANGED:
+		pending->flags |= PLATFORM_LINK_PENDING_CHANGED;
 		break;
 	default:
 		break;
 	}
+
+	if (!priv->platform_link.idle_id)
+		priv->platform_link.idle_id = g_idle_add (platform_link_process_pending, self);
 }
 
 static void
@@ -2683,7 +3079,8 @@ find_slaves (NMManager *manager,
              NMDevice *device)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (manager);
-	GSList *all_connections, *iter;
+	NMSettingsIter iter;
+	NMSettingsConnection *candidate;
 	GSList *slaves = NULL;
 	NMSettingConnection *s_con;
 	const char *master;
@@ -2699,19 +3096,17 @@ find_slaves (NMManager *manager,
 	 * even if a slave was already active, it might be deactivated during
 	 * master reactivation.
 	 */
-	all_connections = nm_settings_get_connections_sorted (priv->settings);
-	for (iter = all_connections; iter; iter = iter->next) {
+	nm_settings_iter_init (&iter, priv->settings);
+	while (nm_settings_iter_next (&iter, &candidate)) {
 		NMSettingsConnection *master_connection = NULL;
 		NMDevice *master_device = NULL;
-		NMConnection *candidate = iter->data;
 
-		find_master (manager, candidate, NULL, &master_connection, &master_device, NULL, NULL);
+		find_master (manager, NM_CONNECTION (candidate), NULL, &master_connection, &master_device, NULL, NULL);
 		if (   (master_connection && master_connection == connection)
 		    || (master_device && master_device == device)) {
 			slaves = g_slist_prepend (slaves, candidate);
 		}
 	}
-	g_slist_free (all_connections);
 
 	return g_slist_reverse (slaves);
 }
@@ -4594,7 +4989,8 @@ gboolean
 nm_manager_start (NMManager *self, GError **error)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
-	GSList *iter, *connections;
+	NMSettingsIter iter;
+	NMSettingsConnection *connection;
 	guint i;
 
 	if (!nm_settings_start (priv->settings, error))
@@ -4646,10 +5042,9 @@ nm_manager_start (NMManager *self, GError **error)
 	 * connection-added signals thus devices have to be created manually.
 	 */
 	_LOGD (LOGD_CORE, "creating virtual devices...");
-	connections = nm_settings_get_connections_sorted (priv->settings);
-	for (iter = connections; iter; iter = iter->next)
-		connection_changed (self, NM_CONNECTION (iter->data));
-	g_slist_free (connections);
+	nm_settings_iter_init (&iter, priv->settings);
+	while (nm_settings_iter_next (&iter, &connection))
+		connection_changed (self, NM_CONNECTION (connection));
 
 	priv->devices_inited = TRUE;
 
@@ -5316,6 +5711,8 @@ constructed (GObject *object)
 	priv->settings = nm_settings_new ();
 	g_signal_connect (priv->settings, "notify::" NM_SETTINGS_STARTUP_COMPLETE,
 	                  G_CALLBACK (settings_startup_complete_changed), self);
+	g_signal_connect (priv->settings, "notify::" NM_SETTINGS_LOADING,
+	                  G_CALLBACK (settings_loading_changed), self);
 	g_signal_connect (priv->settings, "notify::" NM_SETTINGS_UNMANAGED_SPECS,
 	                  G_CALLBACK (system_unmanaged_devices_changed_cb), self);
 	g_signal_connect (priv->settings, "notify::" NM_SETTINGS_HOSTNAME,
@@ -5406,6 +5803,17 @@ nm_manager_init (NMManager *self)
 	priv->state = NM_STATE_DISCONNECTED;
 	priv->startup = TRUE;
 
+	priv->device_index.keys = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) _device_index_keys_free);
+
+	priv->platform_link.queue = g_array_new (FALSE, FALSE, sizeof (PlatformLinkPending));
+	priv->platform_link.queue_idx = g_hash_table_new (g_direct_hash, g_direct_equal);
+	priv->device_index.by_ifindex = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
+	priv->device_index.by_ip_ifindex = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
+	priv->device_index.by_path = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->device_index.by_iface = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->device_index.by_ip_iface = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->device_index.by_perm_hw_addr = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+
 	priv->dbus_mgr = g_object_ref (nm_bus_manager_get ());
 	g_signal_connect (priv->dbus_mgr,
 	                  NM_BUS_MANAGER_DBUS_CONNECTION_CHANGED,
@@ -5639,6 +6047,7 @@ dispose (GObject *object)
 
 	if (priv->settings) {
 		g_signal_handlers_disconnect_by_func (priv->settings, settings_startup_complete_changed, manager);
+		g_signal_handlers_disconnect_by_func (priv->settings, settings_loading_changed, manager);
 		g_signal_handlers_disconnect_by_func (priv->settings, system_unmanaged_devices_changed_cb, manager);
 		g_signal_handlers_disconnect_by_func (priv->settings, system_hostname_changed_cb, manager);
 		g_signal_handlers_disconnect_by_func (priv->settings, connection_added_cb, manager);
@@ -5658,6 +6067,20 @@ dispose (GObject *object)
 	sleep_devices_clear (manager);
 	g_clear_pointer (&priv->sleep_devices, g_hash_table_unref);
 
+	if (nm_platform_try_get ())
+		g_signal_handlers_disconnect_by_func (nm_platform_try_get (), G_CALLBACK (platform_link_cb), manager);
+	nm_clear_g_source (&priv->platform_link.idle_id);
+	g_clear_pointer (&priv->platform_link.queue, g_array_unref);
+	g_clear_pointer (&priv->platform_link.queue_idx, g_hash_table_unref);
+
+	g_clear_pointer (&priv->device_index.keys, g_hash_table_unref);
+	g_clear_pointer (&priv->device_index.by_ifindex, g_hash_table_unref);
+	g_clear_pointer (&priv->device_index.by_ip_ifindex, g_hash_table_unref);
+	g_clear_pointer (&priv->device_index.by_path, g_hash_table_unref);
+	g_clear_pointer (&priv->device_index.by_iface, g_hash_table_unref);
+	g_clear_pointer (&priv->device_index.by_ip_iface, g_hash_table_unref);
+	g_clear_pointer (&priv->device_index.by_perm_hw_addr, g_hash_table_unref);
+
 	if (priv->sleep_monitor) {
 		g_signal_handlers_disconnect_by_func (priv->sleep_monitor, sleeping_cb, manager);
 		g_clear_object (&priv->sleep_monitor);
@@ -28,38 +28,360 @@ struct NMMultiIndex {
 	NMMultiIndexFuncEqual equal_fcn;
 	NMMultiIndexFuncClone clone_fcn;
 	GHashTable *hash;
+
+	/* the reverse index, mapping a value to the ids (that is, the keys of
+	 * @hash) under which the value is stored. If @reverse_fcn is set, the
+	 * ids are kept inline in the values and @reverse is %NULL. */
+	NMMultiIndexFuncReverse reverse_fcn;
+	GHashTable *reverse;
 };
 
 typedef struct {
 	/* when storing the first item for a multi-index id, we don't yet create
-	 * the hashtable @index. Instead we store it inplace to @value0. Note that
-	 * &values_data->value0 is a NULL terminated array with one item that is
+	 * the array @values. Instead we store it inplace to @value0. Note that
+	 * &values_data->value0 is a NULL terminated array with one item (because
+	 * @slots, which follows directly, is %NULL in that case) that is
 	 * suitable to be returned directly from nm_multi_index_lookup(). */
 	union {
 		gpointer value0;
 		gpointer *values;
 	};
-	GHashTable *index;
+
+	/* For sets larger than VALUES_DATA_LINEAR_MAX, an open addressing hash
+	 * table (with linear probing) of size @slots_mask+1. Each slot contains
+	 * the index into @values plus one, zero marks an empty slot. */
+	guint32 *slots;
+
+	/* if @alloc is zero, the set consists only of @value0. Otherwise, @values
+	 * is a dense, NULL terminated array of @len values with space for @alloc
+	 * values (plus the terminating %NULL). */
+	guint len;
+	guint alloc;
+	guint slots_mask;
 } ValuesData;
 
+/* up to this many values, the set is searched linearly. */
+#define VALUES_DATA_LINEAR_MAX 8
+
+typedef struct {
+	/* a NULL terminated array of @len ids, suitable to be returned directly
+	 * from nm_multi_index_lookup_ids_by_value(). The ids are owned by
+	 * NMMultiIndex:hash. A value is usually only part of a few ids, so
+	 * the array is searched linearly. */
+	const NMMultiIndexId **ids;
+	guint len;
+	guint alloc;
+} ReverseData;
+
 /******************************************************************************************/
 
 static void
 _values_data_destroy (ValuesData *values_data)
 {
-	if (values_data->index) {
+	if (values_data->alloc) {
 		g_free (values_data->values);
-		g_hash_table_unref (values_data->index);
+		g_free (values_data->slots);
 	}
 	g_slice_free (ValuesData, values_data);
 }
 
+static void
+_reverse_data_destroy (ReverseData *reverse_data)
+{
+	g_free (reverse_data->ids);
+	g_slice_free (ReverseData, reverse_data);
+}
+
+/* Returns: the %NULL terminated array of the ids under which @value
+ * is stored, or %NULL if @value is not in @index. */
+static const NMMultiIndexId **
+_reverse_get (const NMMultiIndex *index, gconstpointer value, guint *out_len)
+{
+	ReverseData *reverse_data;
+
+	if (index->reverse_fcn) {
+		const NMMultiIndexId **ids;
+		guint alloc, len;
+
+		ids = index->reverse_fcn (value, &alloc);
+		for (len = 0; len < alloc && ids[len]; len++)
+			;
+		nm_assert (!ids[len]);
+		NM_SET_OUT (out_len, len);
+		return len ? ids : NULL;
+	}
+
+	reverse_data = g_hash_table_lookup (index->reverse, value);
+	NM_SET_OUT (out_len, reverse_data ? reverse_data->len : 0);
+	return reverse_data ? reverse_data->ids : NULL;
+}
+
+static void
+_reverse_add (NMMultiIndex *index, gconstpointer value, const NMMultiIndexId *id)
+{
+	ReverseData *reverse_data;
+
+	if (index->reverse_fcn) {
+		const NMMultiIndexId **ids;
+		guint alloc, len;
+
+		/* the slots after the used ones are always %NULL, so the
+		 * array stays %NULL terminated. */
+		ids = index->reverse_fcn (value, &alloc);
+		for (len = 0; len < alloc && ids[len]; len++)
+			;
+		g_return_if_fail (len < alloc);
+		ids[len] = id;
+		return;
+	}
+
+	reverse_data = g_hash_table_lookup (index->reverse, value);
+	if (!reverse_data) {
+		reverse_data = g_slice_new (ReverseData);
+		reverse_data->len = 0;
+		reverse_data->alloc = 4;
+		reverse_data->ids = g_new (const NMMultiIndexId *, reverse_data->alloc + 1);
+		g_hash_table_insert (index->reverse, (gpointer) value, reverse_data);
+	} else if (reverse_data->len == reverse_data->alloc) {
+		reverse_data->alloc *= 2;
+		reverse_data->ids = g_renew (const NMMultiIndexId *, reverse_data->ids, reverse_data->alloc + 1);
+	}
+
+	reverse_data->ids[reverse_data->len++] = id;
+	reverse_data->ids[reverse_data->len] = NULL;
+}
+
+static void
+_reverse_remove (NMMultiIndex *index, gconstpointer value, const NMMultiIndexId *id)
+{
+	ReverseData *reverse_data;
+	guint i;
+
+	if (index->reverse_fcn) {
+		const NMMultiIndexId **ids;
+		guint len;
+
+		ids = _reverse_get (index, value, &len);
+		nm_assert (ids);
+
+		for (i = 0; i < len; i++) {
+			if (ids[i] == id)
+				break;
+		}
+		nm_assert (i < len);
+
+		ids[i] = ids[len - 1];
+		ids[len - 1] = NULL;
+		return;
+	}
+
+	reverse_data = g_hash_table_lookup (index->reverse, value);
+	nm_assert (reverse_data);
+
+	for (i = 0; i < reverse_data->len; i++) {
+		if (reverse_data->ids[i] == id)
+			break;
+	}
+	nm_assert (i < reverse_data->len);
+
+	if (reverse_data->len == 1) {
+		g_hash_table_remove (index->reverse, value);
+		return;
+	}
+
+	reverse_data->len--;
+	reverse_data->ids[i] = reverse_data->ids[reverse_data->len];
+	reverse_data->ids[reverse_data->len] = NULL;
+}
+
+/******************************************************************************************/
+
+static inline guint
+_values_data_hash (gconstpointer value)
+{
+	guint64 v = (guint64) ((gsize) value);
+	guint h;
+
+	/* the values are pointers, so the lowest bits carry little information.
+	 * Mix all bits, because the slot is selected by masking the lowest bits. */
+	h = (guint) (v ^ (v >> 32));
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+#define VALUES_DATA_NOT_FOUND G_MAXUINT
+
+static guint
+_values_data_find (const ValuesData *values_data, gconstpointer value, guint *out_slot)
+{
+	guint i, idx;
+
+	if (!values_data->alloc)
+		return value == values_data->value0 ? 0 : VALUES_DATA_NOT_FOUND;
+
+	if (!values_data->slots) {
+		for (i = 0; i < values_data->len; i++) {
+			if (values_data->values[i] == value)
+				return i;
+		}
+		return VALUES_DATA_NOT_FOUND;
+	}
+
+	for (i = _values_data_hash (value) & values_data->slots_mask; ; i = (i + 1) & values_data->slots_mask) {
+		idx = values_data->slots[i];
+		if (idx == 0)
+			return VALUES_DATA_NOT_FOUND;
+		if (values_data->values[idx - 1] == value) {
+			NM_SET_OUT (out_slot, i);
+			return idx - 1;
+		}
+	}
+}
+
+static gboolean
+_values_data_contains (const ValuesData *values_data, gconstpointer value)
+{
+	return _values_data_find (values_data, value, NULL) != VALUES_DATA_NOT_FOUND;
+}
+
+static void
+_values_data_slots_insert (ValuesData *values_data, guint idx)
+{
+	guint i;
+
+	nm_assert (values_data->slots);
+	nm_assert (idx < values_data->len);
+
+	i = _values_data_hash (values_data->values[idx]) & values_data->slots_mask;
+	while (values_data->slots[i] != 0)
+		i = (i + 1) & values_data->slots_mask;
+	values_data->slots[i] = idx + 1;
+}
+
+static void
+_values_data_slots_remove (ValuesData *values_data, guint slot)
+{
+	const guint mask = values_data->slots_mask;
+	guint i = slot;
+	guint j = slot;
+	guint k;
+
+	/* backward shift deletion: move following entries of the probe
+	 * sequence into the hole, so that no tombstones are needed. */
+	for (;;) {
+		values_data->slots[i] = 0;
+		for (;;) {
+			j = (j + 1) & mask;
+			if (values_data->slots[j] == 0)
+				return;
+			k = _values_data_hash (values_data->values[values_data->slots[j] - 1]) & mask;
+
+			/* the entry at @j can stay, if its home slot @k lies
+			 * cyclically in (i, j]. */
+			if (i <= j
+			    ? (i < k && k <= j)
+			    : (i < k || k <= j))
+				continue;
+			break;
+		}
+		values_data->slots[i] = values_data->slots[j];
+		i = j;
+	}
+}
+
+static void
+_values_data_slots_rebuild (ValuesData *values_data, guint n_slots)
+{
+	guint i;
+
+	nm_assert (n_slots > 0 && (n_slots & (n_slots - 1)) == 0);
+	nm_assert (values_data->len * 2 <= n_slots);
+
+	g_free (values_data->slots);
+	values_data->slots = g_new0 (guint32, n_slots);
+	values_data->slots_mask = n_slots - 1;
+	for (i = 0; i < values_data->len; i++)
+		_values_data_slots_insert (values_data, i);
+}
+
 static gboolean
-_values_data_contains (ValuesData *values_data, gconstpointer value)
+_values_data_add (ValuesData *values_data, gconstpointer value)
 {
-	return values_data->index
-	       ? g_hash_table_contains (values_data->index, value)
-	       : value == values_data->value0;
+	if (_values_data_contains (values_data, value))
+		return FALSE;
+
+	if (!values_data->alloc) {
+		gpointer value0 = values_data->value0;
+
+		values_data->alloc = 4;
+		values_data->values = g_new (gpointer, values_data->alloc + 1);
+		values_data->values[0] = value0;
+		values_data->len = 1;
+	} else if (values_data->len == values_data->alloc) {
+		values_data->alloc *= 2;
+		values_data->values = g_renew (gpointer, values_data->values, values_data->alloc + 1);
+	}
+
+	values_data->values[values_data->len++] = (gpointer) value;
+	values_data->values[values_data->len] = NULL;
+
+	if (values_data->slots) {
+		/* keep the load factor at most 0.5 */
+		if (values_data->len * 2 > values_data->slots_mask + 1)
+			_values_data_slots_rebuild (values_data, (values_data->slots_mask + 1) * 2);
+		else
+			_values_data_slots_insert (values_data, values_data->len - 1);
+	} else if (values_data->len > VALUES_DATA_LINEAR_MAX)
+		_values_data_slots_rebuild (values_data, 4 * VALUES_DATA_LINEAR_MAX);
+	return TRUE;
+}
+
+static gboolean
+_values_data_remove (ValuesData *values_data, gconstpointer value)
+{
+	guint idx, last, idx_last, slot = 0, slot_last = 0;
+
+	/* removing the last value is handled by the caller, by dropping
+	 * the entire ValuesData. */
+	nm_assert (values_data->alloc && values_data->len > 1);
+
+	idx = _values_data_find (values_data, value, &slot);
+	if (idx == VALUES_DATA_NOT_FOUND)
+		return FALSE;
+
+	last = values_data->len - 1;
+	if (values_data->slots) {
+		_values_data_slots_remove (values_data, slot);
+		if (idx != last) {
+			/* point the slot of the value that moves into the hole to its new index. */
+			idx_last = _values_data_find (values_data, values_data->values[last], &slot_last);
+			nm_assert (idx_last == last);
+			values_data->slots[slot_last] = idx + 1;
+		}
+	}
+
+	/* fill the hole with the last value, to keep @values dense. */
+	values_data->values[idx] = values_data->values[last];
+	values_data->values[last] = NULL;
+	values_data->len = last;
+
+	if (values_data->slots) {
+		if (values_data->len <= VALUES_DATA_LINEAR_MAX / 2)
+			g_clear_pointer (&values_data->slots, g_free);
+		else if (   values_data->len * 8 < values_data->slots_mask + 1
+		         && values_data->slots_mask + 1 > 4 * VALUES_DATA_LINEAR_MAX)
+			_values_data_slots_rebuild (values_data, (values_data->slots_mask + 1) / 2);
+	}
+	if (   values_data->len * 4 <= values_data->alloc
+	    && values_data->alloc > 4) {
+		values_data->alloc /= 2;
+		values_data->values = g_renew (gpointer, values_data->values, values_data->alloc + 1);
+	}
+	return TRUE;
 }
 
 static void
@@ -67,36 +389,20 @@ _values_data_get_data (ValuesData *values_data,
                        void *const**out_data,
                        guint *out_len)
 {
-	guint i, len;
-	gpointer *values;
-	GHashTableIter iter;
-
 	nm_assert (values_data);
 
-	if (!values_data->index) {
+	if (!values_data->alloc) {
+		nm_assert (!values_data->slots);
 		NM_SET_OUT (out_data, &values_data->value0);
 		NM_SET_OUT (out_len, 1);
 		return;
 	}
 
-	nm_assert (values_data->index && g_hash_table_size (values_data->index) > 0);
-
-	if (!values_data->values) {
-		len = g_hash_table_size (values_data->index);
-		values = g_new (gpointer, len + 1);
-
-		g_hash_table_iter_init (&iter, values_data->index);
-		for (i = 0; g_hash_table_iter_next (&iter, &values[i], NULL); i++)
-			nm_assert (i < len);
-		nm_assert (i == len);
-		values[i] = NULL;
-
-		values_data->values = values;
-		NM_SET_OUT (out_len, len);
-	} else if (out_len)
-		NM_SET_OUT (out_len, g_hash_table_size (values_data->index));
+	nm_assert (values_data->len > 0);
+	nm_assert (values_data->values[values_data->len] == NULL);
 
 	NM_SET_OUT (out_data, values_data->values);
+	NM_SET_OUT (out_len, values_data->len);
 }
 
 /******************************************************************************************/
@@ -151,27 +457,36 @@ const NMMultiIndexId *
 nm_multi_index_lookup_first_by_value (const NMMultiIndex *index,
                                       gconstpointer value)
 {
-	GHashTableIter iter;
-	const NMMultiIndexId *id;
-	ValuesData *values_data;
+	const NMMultiIndexId **ids;
 
 	g_return_val_if_fail (index, NULL);
 	g_return_val_if_fail (value, NULL);
 
-	/* reverse-lookup needs to iterate over all hash tables. It should
-	 * still be fairly quick, if the number of hash tables is small.
-	 * There is no O(1) reverse lookup implemented, because this access
-	 * pattern is not what NMMultiIndex is here for.
-	 * You are supposed to use NMMultiIndex by always knowing which @id
-	 * a @value has.
-	 */
+	ids = _reverse_get (index, value, NULL);
+	return ids ? ids[0] : NULL;
+}
 
-	g_hash_table_iter_init (&iter, index->hash);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &id, (gpointer *) &values_data)) {
-		if (_values_data_contains (values_data, value))
-			return id;
-	}
-	return NULL;
+/**
+ * nm_multi_index_lookup_ids_by_value():
+ * @index:
+ * @value: the value to look up
+ * @out_len: (allow-none): output the number of ids
+ *   that are returned.
+ *
+ * Returns: (transfer none): %NULL if @value is not in @index
+ *   or a %NULL terminated array of the ids under which @value
+ *   is stored, in no particular order. The array is only valid until
+ *   the next modification of @index.
+ */
+const NMMultiIndexId *const*
+nm_multi_index_lookup_ids_by_value (const NMMultiIndex *index,
+                                    gconstpointer value,
+                                    guint *out_len)
+{
+	g_return_val_if_fail (index, NULL);
+	g_return_val_if_fail (value, NULL);
+
+	return _reverse_get (index, value, out_len);
 }
 
 void
@@ -189,11 +504,25 @@ nm_multi_index_foreach (const NMMultiIndex *index,
 	g_return_if_fail (index);
 	g_return_if_fail (foreach_func);
 
+	if (value) {
+		const NMMultiIndexId **ids;
+		guint i, n;
+
+		ids = _reverse_get (index, value, &n);
+		for (i = 0; i < n; i++) {
+			id = ids[i];
+			values_data = g_hash_table_lookup (index->hash, id);
+			nm_assert (values_data && _values_data_contains (values_data, value));
+
+			_values_data_get_data (values_data, &values, &len);
+			if (!foreach_func (id, values, len, user_data))
+				return;
+		}
+		return;
+	}
+
 	g_hash_table_iter_init (&iter, index->hash);
 	while (g_hash_table_iter_next (&iter, (gpointer *) &id, (gpointer *) &values_data)) {
-		if (value && !_values_data_contains (values_data, value))
-			continue;
-
 		_values_data_get_data (values_data, &values, &len);
 		if (!foreach_func (id, values, len, user_data))
 			return;
@@ -208,9 +537,12 @@ nm_multi_index_iter_init (NMMultiIndexIter *iter,
 	g_return_if_fail (index);
 	g_return_if_fail (iter);
 
-	g_hash_table_iter_init (&iter->_iter, index->hash);
 	iter->_index = index;
 	iter->_value = value;
+	if (value)
+		iter->_ids = _reverse_get (index, value, NULL);
+	else
+		g_hash_table_iter_init (&iter->_iter, index->hash);
 }
 
 gboolean
@@ -224,17 +556,20 @@ nm_multi_index_iter_next (NMMultiIndexIter *iter,
 
 	g_return_val_if_fail (iter, FALSE);
 
-	while (g_hash_table_iter_next (&iter->_iter, (gpointer *) &id, (gpointer *) &values_data)) {
-		if (   !iter->_value
-		    || _values_data_contains (values_data, iter->_value)) {
-			if (out_values || out_len)
-				_values_data_get_data (values_data, out_values, out_len);
-			if (out_id)
-				*out_id = id;
-			return TRUE;
-		}
-	}
-	return FALSE;
+	if (iter->_value) {
+		if (!iter->_ids || !iter->_ids[0])
+			return FALSE;
+		id = *(iter->_ids++);
+		values_data = g_hash_table_lookup (iter->_index->hash, id);
+		nm_assert (values_data && _values_data_contains (values_data, iter->_value));
+	} else if (!g_hash_table_iter_next (&iter->_iter, (gpointer *) &id, (gpointer *) &values_data))
+		return FALSE;
+
+	if (out_values || out_len)
+		_values_data_get_data (values_data, out_values, out_len);
+	if (out_id)
+		*out_id = id;
+	return TRUE;
 }
 
 /******************************************************************************************/
@@ -251,15 +586,12 @@ nm_multi_index_id_iter_init (NMMultiIndexIdIter *iter,
 	g_return_if_fail (id);
 
 	values_data = g_hash_table_lookup (index->hash, id);
-	if (!values_data)
-		iter->_state = 2;
-	else if (values_data->index) {
-		iter->_state = 1;
-		g_hash_table_iter_init (&iter->_iter, values_data->index);
-	} else {
-		iter->_state = 0;
-		iter->_value = values_data->value0;
-	}
+	iter->_idx = 0;
+	if (!values_data) {
+		iter->_values = NULL;
+		iter->_len = 0;
+	} else
+		_values_data_get_data (values_data, &iter->_values, &iter->_len);
 }
 
 gboolean
@@ -268,19 +600,10 @@ nm_multi_index_id_iter_next (NMMultiIndexIdIter *iter,
 {
 	g_return_val_if_fail (iter, FALSE);
 
-	switch (iter->_state) {
-	case 0:
-		iter->_state = 2;
-		NM_SET_OUT (out_value, iter->_value);
-		return TRUE;
-	case 1:
-		return g_hash_table_iter_next (&iter->_iter, out_value, NULL);
-	case 2:
-		iter->_state = 3;
+	if (iter->_idx >= iter->_len)
 		return FALSE;
-	default:
-		g_return_val_if_reached (FALSE);
-	}
+	NM_SET_OUT (out_value, iter->_values[iter->_idx++]);
+	return TRUE;
 }
 
 /******************************************************************************************/
@@ -291,9 +614,9 @@ _do_add (NMMultiIndex *index,
          gconstpointer value)
 {
 	ValuesData *values_data;
+	const NMMultiIndexId *id_key;
 
-	values_data = g_hash_table_lookup (index->hash, id);
-	if (!values_data) {
+	if (!g_hash_table_lookup_extended (index->hash, id, (gpointer *) &id_key, (gpointer *) &values_data)) {
 		NMMultiIndexId *id_new;
 
 		/* Contrary to GHashTable, we don't take ownership of the @id that was
@@ -313,20 +636,10 @@ _do_add (NMMultiIndex *index,
 		values_data->value0 = (gpointer) value;
 
 		g_hash_table_insert (index->hash, id_new, values_data);
-	} else {
-		if (!values_data->index) {
-			if (values_data->value0 == value)
-				return FALSE;
-			values_data->index = g_hash_table_new (NULL, NULL);
-			g_hash_table_replace (values_data->index, (gpointer) value, (gpointer) value);
-			g_hash_table_replace (values_data->index, values_data->value0, values_data->value0);
-			values_data->values = NULL;
-		} else {
-			if (!nm_g_hash_table_replace (values_data->index, (gpointer) value, (gpointer) value))
-				return FALSE;
-			g_clear_pointer (&values_data->values, g_free);
-		}
-	}
+		id_key = id_new;
+	} else if (!_values_data_add (values_data, value))
+		return FALSE;
+	_reverse_add (index, value, id_key);
 	return TRUE;
 }
 
@@ -336,22 +649,20 @@ _do_remove (NMMultiIndex *index,
             gconstpointer value)
 {
 	ValuesData *values_data;
+	const NMMultiIndexId *id_key;
 
-	values_data = g_hash_table_lookup (index->hash, id);
-	if (!values_data)
+	if (!g_hash_table_lookup_extended (index->hash, id, (gpointer *) &id_key, (gpointer *) &values_data))
 		return FALSE;
 
-	if (values_data->index) {
-		if (!g_hash_table_remove (values_data->index, value))
+	if (!values_data->alloc || values_data->len == 1) {
+		if (!_values_data_contains (values_data, value))
 			return FALSE;
-		if (g_hash_table_size (values_data->index) == 0)
-			g_hash_table_remove (index->hash, id);
-		else
-			g_clear_pointer (&values_data->values, g_free);
+		_reverse_remove (index, value, id_key);
+		g_hash_table_remove (index->hash, id);
 	} else {
-		if (values_data->value0 != value)
+		if (!_values_data_remove (values_data, value))
 			return FALSE;
-		g_hash_table_remove (index->hash, id);
+		_reverse_remove (index, value, id_key);
 	}
 
 	return TRUE;
@@ -439,11 +750,22 @@ nm_multi_index_get_num_groups (const NMMultiIndex *index)
 	return g_hash_table_size (index->hash);
 }
 
+/**
+ * nm_multi_index_new:
+ * @hash_fcn:
+ * @equal_fcn:
+ * @clone_fcn:
+ * @destroy_fcn:
+ * @reverse_fcn: (allow-none): if set, the ids under which a value is
+ *   stored are kept inside the value. Otherwise, they are tracked in
+ *   a separate hash table, which costs an allocation per value.
+ */
 NMMultiIndex *
 nm_multi_index_new (NMMultiIndexFuncHash hash_fcn,
                     NMMultiIndexFuncEqual equal_fcn,
                     NMMultiIndexFuncClone clone_fcn,
-                    NMMultiIndexFuncDestroy destroy_fcn)
+                    NMMultiIndexFuncDestroy destroy_fcn,
+                    NMMultiIndexFuncReverse reverse_fcn)
 {
 	NMMultiIndex *index;
 
@@ -455,11 +777,20 @@ nm_multi_index_new (NMMultiIndexFuncHash hash_fcn,
 	index = g_new (NMMultiIndex, 1);
 	index->equal_fcn = equal_fcn;
 	index->clone_fcn = clone_fcn;
+	index->reverse_fcn = reverse_fcn;
 
 	index->hash = g_hash_table_new_full ((GHashFunc) hash_fcn,
 	                                     (GEqualFunc) equal_fcn,
 	                                     (GDestroyNotify) destroy_fcn,
 	                                     (GDestroyNotify) _values_data_destroy);
+	if (reverse_fcn)
+		index->reverse = NULL;
+	else {
+		index->reverse = g_hash_table_new_full (g_direct_hash,
+		                                        g_direct_equal,
+		                                        NULL,
+		                                        (GDestroyNotify) _reverse_data_destroy);
+	}
 	return index;
 }
 
@@ -467,6 +798,26 @@ void
 nm_multi_index_free (NMMultiIndex *index)
 {
 	g_return_if_fail (index);
+
+	if (index->reverse_fcn) {
+		GHashTableIter iter;
+		ValuesData *values_data;
+		void *const*values;
+		guint i, len, alloc;
+
+		/* the values might outlive @index, clear the ids that they
+		 * carry inline. */
+		g_hash_table_iter_init (&iter, index->hash);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &values_data)) {
+			_values_data_get_data (values_data, &values, &len);
+			for (i = 0; i < len; i++) {
+				const NMMultiIndexId **ids = index->reverse_fcn (values[i], &alloc);
+
+				memset (ids, 0, alloc * sizeof (ids[0]));
+			}
+		}
+	} else
+		g_hash_table_unref (index->reverse);
 	g_hash_table_unref (index->hash);
 	g_free (index);
 }
@@ -36,14 +36,13 @@ typedef struct {
 	GHashTableIter _iter;
 	const NMMultiIndex *_index;
 	gconstpointer _value;
+	const NMMultiIndexId *const*_ids;
 } NMMultiIndexIter;
 
 typedef struct {
-	union {
-		GHashTableIter _iter;
-		gpointer _value;
-	};
-	guint _state;
+	void *const*_values;
+	guint _len;
+	guint _idx;
 } NMMultiIndexIdIter;
 
 typedef gboolean (*NMMultiIndexFuncEqual) (const NMMultiIndexId *id_a, const NMMultiIndexId *id_b);
@@ -51,13 +50,20 @@ typedef guint (*NMMultiIndexFuncHash) (const NMMultiIndexId *id);
 typedef NMMultiIndexId *(*NMMultiIndexFuncClone) (const NMMultiIndexId *id);
 typedef void (*NMMultiIndexFuncDestroy) (NMMultiIndexId *id);
 
+/* Returns the storage inside @value for the ids under which @value is
+ * stored: an array with room for @out_alloc ids plus a terminating %NULL.
+ * The storage must be zeroed when @value is added for the first time, and
+ * @value can only be part of one NMMultiIndex at a time. */
+typedef const NMMultiIndexId **(*NMMultiIndexFuncReverse) (gconstpointer value, guint *out_alloc);
+
 typedef gboolean (*NMMultiIndexFuncForeach) (const NMMultiIndexId *id, void *const* values, guint len, gpointer user_data);
 
 
 NMMultiIndex *nm_multi_index_new (NMMultiIndexFuncHash hash_fcn,
                                   NMMultiIndexFuncEqual equal_fcn,
                                   NMMultiIndexFuncClone clone_fcn,
-                                  NMMultiIndexFuncDestroy destroy_fcn);
+                                  NMMultiIndexFuncDestroy destroy_fcn,
+                                  NMMultiIndexFuncReverse reverse_fcn);
 
 void nm_multi_index_free (NMMultiIndex *index);
 
@@ -87,6 +93,10 @@ gboolean nm_multi_index_contains (const NMMultiIndex *index,
 const NMMultiIndexId *nm_multi_index_lookup_first_by_value (const NMMultiIndex *index,
                                                              gconstpointer value);
 
+const NMMultiIndexId *const*nm_multi_index_lookup_ids_by_value (const NMMultiIndex *index,
+                                                                 gconstpointer value,
+                                                                 guint *out_len);
+
 void nm_multi_index_foreach (const NMMultiIndex *index,
                              gconstpointer value,
                              NMMultiIndexFuncForeach foreach_func,
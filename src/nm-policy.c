@@ -854,49 +854,58 @@ static void
 reset_autoconnect_all (NMPolicy *self, NMDevice *device)
 {
 	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
-	GSList *connections, *iter;
+	NMSettingsIter iter;
+	NMSettingsConnection *connection;
 
 	if (device) {
+		gs_free NMSettingsConnection **connections = NULL;
+		guint i;
+
 		_LOGD (LOGD_DEVICE, "re-enabling autoconnect for all connections on %s",
 		       nm_device_get_iface (device));
-	} else
-		_LOGD (LOGD_DEVICE, "re-enabling autoconnect for all connections");
 
-	connections = nm_settings_get_connections_sorted (priv->settings);
-	for (iter = connections; iter; iter = g_slist_next (iter)) {
-		if (!device || nm_device_check_connection_compatible (device, iter->data)) {
-			nm_settings_connection_reset_autoconnect_retries (iter->data);
-			nm_settings_connection_set_autoconnect_blocked_reason (iter->data, NM_DEVICE_STATE_REASON_NONE);
+		connections = nm_device_get_candidate_connections (device, NULL);
+		for (i = 0; connections[i]; i++) {
+			if (nm_device_check_connection_compatible (device, NM_CONNECTION (connections[i]))) {
+				nm_settings_connection_reset_autoconnect_retries (connections[i]);
+				nm_settings_connection_set_autoconnect_blocked_reason (connections[i], NM_DEVICE_STATE_REASON_NONE);
+			}
 		}
+		return;
+	}
+
+	_LOGD (LOGD_DEVICE, "re-enabling autoconnect for all connections");
+
+	nm_settings_iter_init (&iter, priv->settings);
+	while (nm_settings_iter_next (&iter, &connection)) {
+		nm_settings_connection_reset_autoconnect_retries (connection);
+		nm_settings_connection_set_autoconnect_blocked_reason (connection, NM_DEVICE_STATE_REASON_NONE);
 	}
-	g_slist_free (connections);
 }
 
 static void
 reset_autoconnect_for_failed_secrets (NMPolicy *self)
 {
 	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
-	GSList *connections, *iter;
+	NMSettingsIter iter;
+	NMSettingsConnection *connection;
 
 	_LOGD (LOGD_DEVICE, "re-enabling autoconnect for all connections with failed secrets");
 
-	connections = nm_settings_get_connections_sorted (priv->settings);
-	for (iter = connections; iter; iter = g_slist_next (iter)) {
-		NMSettingsConnection *connection = NM_SETTINGS_CONNECTION (iter->data);
-
+	nm_settings_iter_init (&iter, priv->settings);
+	while (nm_settings_iter_next (&iter, &connection)) {
 		if (nm_settings_connection_get_autoconnect_blocked_reason (connection) == NM_DEVICE_STATE_REASON_NO_SECRETS) {
 			nm_settings_connection_reset_autoconnect_retries (connection);
 			nm_settings_connection_set_autoconnect_blocked_reason (connection, NM_DEVICE_STATE_REASON_NONE);
 		}
 	}
-	g_slist_free (connections);
 }
 
 static void
 block_autoconnect_for_device (NMPolicy *self, NMDevice *device)
 {
-	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
-	GSList *connections, *iter;
+	gs_free NMSettingsConnection **connections = NULL;
+	guint i;
 
 	_LOGD (LOGD_DEVICE, "blocking autoconnect for all connections on %s",
 	       nm_device_get_iface (device));
@@ -908,14 +917,13 @@ block_autoconnect_for_device (NMPolicy *self, NMDevice *device)
 	if (!nm_device_is_software (device))
 		return;
 
-	connections = nm_settings_get_connections_sorted (priv->settings);
-	for (iter = connections; iter; iter = g_slist_next (iter)) {
-		if (nm_device_check_connection_compatible (device, iter->data)) {
-			nm_settings_connection_set_autoconnect_blocked_reason (NM_SETTINGS_CONNECTION (iter->data),
+	connections = nm_device_get_candidate_connections (device, NULL);
+	for (i = 0; connections[i]; i++) {
+		if (nm_device_check_connection_compatible (device, NM_CONNECTION (connections[i]))) {
+			nm_settings_connection_set_autoconnect_blocked_reason (connections[i],
 			                                                       NM_DEVICE_STATE_REASON_USER_REQUESTED);
 		}
 	}
-	g_slist_free (connections);
 }
 
 static void
@@ -943,6 +951,11 @@ schedule_activate_check (NMPolicy *self, NMDevice *device)
 	if (nm_manager_get_state (priv->manager) == NM_STATE_ASLEEP)
 		return;
 
+	/* a better connection for the device might not be loaded yet.
+	 * settings_loading_changed() checks all devices afterwards. */
+	if (nm_settings_get_loading (priv->settings))
+		return;
+
 	if (!nm_device_get_enabled (device))
 		return;
 
@@ -983,7 +996,8 @@ reset_connections_retries (gpointer user_data)
 {
 	NMPolicy *self = (NMPolicy *) user_data;
 	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
-	GSList *connections, *iter;
+	NMSettingsIter iter;
+	NMSettingsConnection *connection;
 	gint32 con_stamp, min_stamp, now;
 	gboolean changed = FALSE;
 
@@ -991,10 +1005,8 @@ reset_connections_retries (gpointer user_data)
 
 	min_stamp = 0;
 	now = nm_utils_get_monotonic_timestamp_s ();
-	connections = nm_settings_get_connections_sorted (priv->settings);
-	for (iter = connections; iter; iter = g_slist_next (iter)) {
-		NMSettingsConnection *connection = NM_SETTINGS_CONNECTION (iter->data);
-
+	nm_settings_iter_init (&iter, priv->settings);
+	while (nm_settings_iter_next (&iter, &connection)) {
 		con_stamp = nm_settings_connection_get_autoconnect_retry_time (connection);
 		if (con_stamp == 0)
 			continue;
@@ -1005,7 +1017,6 @@ reset_connections_retries (gpointer user_data)
 		} else if (min_stamp == 0 || min_stamp > con_stamp)
 			min_stamp = con_stamp;
 	}
-	g_slist_free (connections);
 
 	/* Schedule the handler again if there are some stamps left */
 	if (min_stamp != 0)
@@ -1023,8 +1034,8 @@ activate_slave_connections (NMPolicy *self, NMDevice *device)
 {
 	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
 	const char *master_device, *master_uuid_settings = NULL, *master_uuid_applied = NULL;
-	gs_free_slist GSList *connections = NULL;
-	GSList *iter;
+	NMSettingsIter iter;
+	NMSettingsConnection *slave;
 	NMActRequest *req;
 	gboolean internal_activation = FALSE;
 
@@ -1050,27 +1061,23 @@ activate_slave_connections (NMPolicy *self, NMDevice *device)
 		internal_activation = subject && nm_auth_subject_is_internal (subject);
 	}
 
-	if (!internal_activation)
-		connections = nm_settings_get_connections_sorted (priv->settings);
-
-	for (iter = connections; iter; iter = g_slist_next (iter)) {
-		NMConnection *slave;
-		NMSettingConnection *s_slave_con;
-		const char *slave_master;
-
-		slave = NM_CONNECTION (iter->data);
-		g_assert (slave);
+	if (!internal_activation) {
+		nm_settings_iter_init (&iter, priv->settings);
+		while (nm_settings_iter_next (&iter, &slave)) {
+			NMSettingConnection *s_slave_con;
+			const char *slave_master;
 
-		s_slave_con = nm_connection_get_setting_connection (slave);
-		g_assert (s_slave_con);
-		slave_master = nm_setting_connection_get_master (s_slave_con);
-		if (!slave_master)
-			continue;
+			s_slave_con = nm_connection_get_setting_connection (NM_CONNECTION (slave));
+			g_assert (s_slave_con);
+			slave_master = nm_setting_connection_get_master (s_slave_con);
+			if (!slave_master)
+				continue;
 
-		if (   !g_strcmp0 (slave_master, master_device)
-		    || !g_strcmp0 (slave_master, master_uuid_applied)
-		    || !g_strcmp0 (slave_master, master_uuid_settings))
-			nm_settings_connection_reset_autoconnect_retries (NM_SETTINGS_CONNECTION (slave));
+			if (   !g_strcmp0 (slave_master, master_device)
+			    || !g_strcmp0 (slave_master, master_uuid_applied)
+			    || !g_strcmp0 (slave_master, master_uuid_settings))
+				nm_settings_connection_reset_autoconnect_retries (slave);
+		}
 	}
 
 	schedule_activate_all (self);
@@ -1630,6 +1637,18 @@ schedule_activate_all (NMPolicy *self)
 	priv->schedule_activate_all_id = g_idle_add (schedule_activate_all_cb, self);
 }
 
+static void
+settings_loading_changed (NMSettings *settings,
+                          GParamSpec *pspec,
+                          gpointer user_data)
+{
+	NMPolicyPrivate *priv = user_data;
+	NMPolicy *self = priv->self;
+
+	if (!nm_settings_get_loading (settings))
+		schedule_activate_all (self);
+}
+
 static void
 connection_added (NMSettings *settings,
                   NMSettingsConnection *connection,
@@ -1915,6 +1934,7 @@ constructed (GObject *object)
 	g_signal_connect (priv->settings, NM_SETTINGS_SIGNAL_CONNECTION_REMOVED,            (GCallback) connection_removed, priv);
 	g_signal_connect (priv->settings, NM_SETTINGS_SIGNAL_CONNECTION_VISIBILITY_CHANGED, (GCallback) connection_visibility_changed, priv);
 	g_signal_connect (priv->settings, NM_SETTINGS_SIGNAL_AGENT_REGISTERED,              (GCallback) secret_agent_registered, priv);
+	g_signal_connect (priv->settings, "notify::" NM_SETTINGS_LOADING,                   (GCallback) settings_loading_changed, priv);
 
 	G_OBJECT_CLASS (nm_policy_parent_class)->constructed (object);
 }
@@ -35,6 +35,7 @@
 #include <linux/if_link.h>
 #include <linux/if_tun.h>
 #include <linux/if_tunnel.h>
+#include <linux/sock_diag.h>
 #include <netlink/netlink.h>
 #include <netlink/object.h>
 #include <netlink/cache.h>
@@ -66,6 +67,10 @@
 
 #define IFQDISCSIZ                      32
 
+#ifndef SO_MEMINFO
+#define SO_MEMINFO                      55
+#endif
+
 /*********************************************************************************************/
 
 #ifndef IFLA_PROMISCUITY
@@ -114,6 +119,14 @@
 #define IP6_FLOWINFO_TCLASS_SHIFT       20
 #define IP6_FLOWINFO_FLOWLABEL_MASK     0x000FFFFF
 
+#ifndef SOL_NETLINK
+#define SOL_NETLINK                     270
+#endif
+
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK          12
+#endif
+
 /*********************************************************************************************/
 
 #define _NMLOG_PREFIX_NAME                "platform-linux"
@@ -242,6 +255,7 @@ static void do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActi
 static void cache_pre_hook (NMPCache *cache, const NMPObject *old, const NMPObject *new, NMPCacheOpsType ops_type, gpointer user_data);
 static void cache_prune_candidates_prune (NMPlatform *platform);
 static gboolean event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks);
+static void resync_dump_wait (NMPlatform *platform);
 static void _assert_netns_current (NMPlatform *platform);
 
 /*****************************************************************************/
@@ -1719,9 +1733,23 @@ errout:
 	return obj_result;
 }
 
+typedef struct {
+	/* bitmap of the rtm_protocol values of routes that we don't cache. */
+	guint32 ignore_protocols[256 / 32];
+	bool enabled:1;
+} RouteFilter;
+
+static inline gboolean
+_route_filter_ignores_protocol (const RouteFilter *route_filter, guint8 protocol)
+{
+	return    route_filter
+	       && route_filter->enabled
+	       && NM_FLAGS_HAS (route_filter->ignore_protocols[protocol / 32], 1u << (protocol % 32));
+}
+
 /* Copied and heavily modified from libnl3's rtnl_route_parse() and parse_multipath(). */
 static NMPObject *
-_new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
+_new_from_nl_route (const RouteFilter *route_filter, struct nlmsghdr *nlh, gboolean id_only)
 {
 	static struct nla_policy policy[RTA_MAX+1] = {
 		[RTA_IIF]       = { .type = NLA_U32 },
@@ -1762,6 +1790,16 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 	    || rtm->rtm_tos != 0)
 		goto errout;
 
+	/* routes of other routing daemons are never managed by us. Drop
+	 * them before parsing, so that they never make it into the cache. */
+	if (_route_filter_ignores_protocol (route_filter, rtm->rtm_protocol))
+		goto errout;
+
+	/* tables beyond 255 are only given via RTA_TABLE, with rtm_table
+	 * set to RT_TABLE_COMPAT. All other tables can be rejected early. */
+	if (!NM_IN_SET (rtm->rtm_table, RT_TABLE_MAIN, RT_TABLE_COMPAT))
+		goto errout;
+
 	err = nlmsg_parse (nlh, sizeof (struct rtmsg), tb, RTA_MAX, policy);
 	if (err < 0)
 		goto errout;
@@ -1925,21 +1963,15 @@ errout:
  *   be correctly detected.
  * @cache: (allow-none): for certain objects, the netlink message doesn't contain all the information.
  *   If a cache is given, the object is completed with information from the cache.
- * @nlh: the netlink message header
+ * @route_filter: (allow-none): routes that should be ignored.
+ * @msghdr: the netlink message header
  * @id_only: whether only to create an empty object with only the ID fields set.
  *
  * Returns: %NULL or a newly created NMPObject instance.
  **/
 static NMPObject *
-nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_msg *msg, gboolean id_only)
+nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, const RouteFilter *route_filter, struct nlmsghdr *msghdr, gboolean id_only)
 {
-	struct nlmsghdr *msghdr;
-
-	if (nlmsg_get_proto (msg) != NETLINK_ROUTE)
-		return NULL;
-
-	msghdr = nlmsg_hdr (msg);
-
 	switch (msghdr->nlmsg_type) {
 	case RTM_NEWLINK:
 	case RTM_DELLINK:
@@ -1953,7 +1985,7 @@ nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_m
 	case RTM_NEWROUTE:
 	case RTM_DELROUTE:
 	case RTM_GETROUTE:
-		return _new_from_nl_route (msghdr, id_only);
+		return _new_from_nl_route (route_filter, msghdr, id_only);
 	default:
 		return NULL;
 	}
@@ -2343,14 +2375,11 @@ static int _support_kernel_extended_ifa_flags = -1;
 #define _support_kernel_extended_ifa_flags_still_undecided() (G_UNLIKELY (_support_kernel_extended_ifa_flags == -1))
 
 static void
-_support_kernel_extended_ifa_flags_detect (struct nl_msg *msg)
+_support_kernel_extended_ifa_flags_detect (struct nlmsghdr *msg_hdr)
 {
-	struct nlmsghdr *msg_hdr;
-
 	if (!_support_kernel_extended_ifa_flags_still_undecided ())
 		return;
 
-	msg_hdr = nlmsg_hdr (msg);
 	if (msg_hdr->nlmsg_type != RTM_NEWADDR)
 		return;
 
@@ -2388,6 +2417,25 @@ typedef struct {
 	gint *out_refresh_all_in_progess;
 } DelayedActionWaitForNlResponseData;
 
+typedef struct {
+	NMPObject *obj_id;
+	WaitForNlResponseResult seq_result;
+	bool is_delete:1;
+	bool sent:1;
+} BatchRequestData;
+
+/* most datagrams fit into 32 KiB, also for dumps. But a single message
+ * can be larger, for example a link with many SR-IOV VFs. The receive
+ * buffers grow on demand. */
+#define NL_RECV_BUFFER_SIZE_INITIAL (32 * 1024)
+#define NL_RECV_N_BUFFERS           8
+
+/* the kernel receive queue for the event socket starts with NL_RCVBUF_SIZE_INITIAL
+ * and grows (doubling) under pressure, up to a ceiling which defaults to
+ * NL_RCVBUF_SIZE_MAX_DEFAULT. */
+#define NL_RCVBUF_SIZE_INITIAL     (8 * 1024 * 1024)
+#define NL_RCVBUF_SIZE_MAX_DEFAULT (64 * 1024 * 1024)
+
 typedef struct _NMLinuxPlatformPrivate NMLinuxPlatformPrivate;
 
 struct _NMLinuxPlatformPrivate {
@@ -2422,8 +2470,83 @@ struct _NMLinuxPlatformPrivate {
 		gint is_handling;
 	} delayed_action;
 
+	struct {
+		/* one buffer of @buf_size for each of the NL_RECV_N_BUFFERS
+		 * datagrams, reused for every recvmmsg() call. */
+		guint8 *buf;
+		guint buf_size;
+
+		/* the size of the largest datagram that got truncated. The buffers
+		 * grow before the next read. */
+		guint buf_size_needed;
+		struct mmsghdr msgs[NL_RECV_N_BUFFERS];
+		struct iovec iov[NL_RECV_N_BUFFERS];
+		struct sockaddr_nl nla[NL_RECV_N_BUFFERS];
+		union {
+			struct cmsghdr align;
+			char buf[CMSG_SPACE (sizeof (struct ucred))];
+		} control[NL_RECV_N_BUFFERS];
+	} recv;
+
+	NMLinuxPlatformNetlinkStats nl_stats;
+
+	struct {
+		/* the receive buffer size we last requested. The kernel doubles it
+		 * for book keeping overhead. */
+		guint size;
+
+		/* the ceiling up to which we grow @size. */
+		guint size_max;
+
+		/* whether the receive queue was more than half full during
+		 * the current wakeup. */
+		bool pressure:1;
+		bool meminfo_checked:1;
+		bool meminfo_unsupported:1;
+	} rcvbuf;
+
+	RouteFilter route_filter;
+
+	struct {
+		/* nesting level of nm_platform_batch_begin(). */
+		gint depth;
+
+		/* number of requests sent since we last collected the
+		 * responses. */
+		guint n_in_flight;
+
+		/* list of BatchRequestData, evaluated on commit. */
+		GPtrArray *list;
+	} batch;
+
 	GHashTable *prune_candidates;
 
+	struct {
+		/* after an overrun, the object types still to be dumped again. They
+		 * are handled one at a time, lowest bit (links) first. */
+		DelayedActionType pending;
+
+		/* the object type whose dump is in flight (or just completed). */
+		DelayedActionType current;
+
+		/* the sequence number of the dump in flight, or zero. */
+		guint32 seq_number;
+
+		/* the result of the dump of @current, once it completed. */
+		WaitForNlResponseResult seq_result;
+		bool dump_intr:1;
+
+		/* how often the dump of @current was interrupted in a row. */
+		guint8 n_dump_intr;
+
+		/* the objects of type @current that were in the cache when the
+		 * dump started and were not seen since. */
+		GHashTable *prune_candidates;
+
+		guint idle_id;
+		gint64 start_ns;
+	} resync;
+
 	GHashTable *wifi_data;
 };
 
@@ -3192,24 +3315,19 @@ cache_prune_candidates_drop (NMPlatform *platform, const NMPObject *obj)
 			_LOGt ("cache-prune: drop-one: %s", nmp_object_to_string (obj, NMP_OBJECT_TO_STRING_ALL, NULL, 0));
 		g_hash_table_remove (priv->prune_candidates, obj);
 	}
+	if (priv->resync.prune_candidates)
+		g_hash_table_remove (priv->resync.prune_candidates, obj);
 }
 
 static void
-cache_prune_candidates_prune (NMPlatform *platform)
+_cache_prune_candidates_prune (NMPlatform *platform, GHashTable *prune_candidates)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	GHashTable *prune_candidates;
 	GHashTableIter iter;
 	const NMPObject *obj;
 	gboolean was_visible;
 	NMPCacheOpsType cache_op;
 
-	if (!priv->prune_candidates)
-		return;
-
-	prune_candidates = priv->prune_candidates;
-	priv->prune_candidates = NULL;
-
 	g_hash_table_iter_init (&iter, prune_candidates);
 	while (g_hash_table_iter_next (&iter, (gpointer *)&obj, NULL)) {
 		nm_auto_nmpobj NMPObject *obj_cache = NULL;
@@ -3218,7 +3336,21 @@ cache_prune_candidates_prune (NMPlatform *platform)
 		cache_op = nmp_cache_remove (priv->cache, obj, TRUE, &obj_cache, &was_visible, cache_pre_hook, platform);
 		do_emit_signal (platform, obj_cache, cache_op, was_visible);
 	}
+}
+
+static void
+cache_prune_candidates_prune (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	GHashTable *prune_candidates;
+
+	if (!priv->prune_candidates)
+		return;
 
+	prune_candidates = priv->prune_candidates;
+	priv->prune_candidates = NULL;
+
+	_cache_prune_candidates_prune (platform, prune_candidates);
 	g_hash_table_unref (prune_candidates);
 }
 
@@ -3495,10 +3627,9 @@ cache_post (NMPlatform *platform,
 /******************************************************************/
 
 static int
-_nl_send_auto_with_seq (NMPlatform *platform,
-                        struct nl_msg *nlmsg,
-                        WaitForNlResponseResult *out_seq_result,
-                        gint *out_refresh_all_in_progess)
+_nl_send_auto_with_seq_nowait (NMPlatform *platform,
+                               struct nl_msg *nlmsg,
+                               guint32 *out_seq)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	guint32 seq;
@@ -3513,13 +3644,28 @@ _nl_send_auto_with_seq (NMPlatform *platform,
 
 	if (nle >= 0) {
 		nle = 0;
-		delayed_action_schedule_WAIT_FOR_NL_RESPONSE (platform, seq, out_seq_result, out_refresh_all_in_progess);
+		*out_seq = seq;
 	} else
 		_LOGD ("netlink: send: failed sending message: %s (%d)", nl_geterror (nle), nle);
 
 	return nle;
 }
 
+static int
+_nl_send_auto_with_seq (NMPlatform *platform,
+                        struct nl_msg *nlmsg,
+                        WaitForNlResponseResult *out_seq_result,
+                        gint *out_refresh_all_in_progess)
+{
+	guint32 seq;
+	int nle;
+
+	nle = _nl_send_auto_with_seq_nowait (platform, nlmsg, &seq);
+	if (nle >= 0)
+		delayed_action_schedule_WAIT_FOR_NL_RESPONSE (platform, seq, out_seq_result, out_refresh_all_in_progess);
+	return nle;
+}
+
 static void
 do_request_link_no_delayed_actions (NMPlatform *platform, int ifindex, const char *name)
 {
@@ -3557,6 +3703,68 @@ do_request_link (NMPlatform *platform, int ifindex, const char *name)
 	delayed_action_handle_all (platform, FALSE);
 }
 
+static struct nl_msg *
+_nl_msg_new_dump (NMPlatform *platform, NMPObjectType obj_type)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	const NMPClass *klass = nmp_class_from_type (obj_type);
+	struct nl_msg *nlmsg;
+	union {
+		struct rtgenmsg gmsg;
+		struct ifinfomsg ifi;
+		struct ifaddrmsg ifa;
+		struct rtmsg rtm;
+	} hdr;
+	gsize hdr_len;
+
+	/* reimplement
+	 *   nl_rtgen_request (sk, klass->rtm_gettype, klass->addr_family, NLM_F_DUMP);
+	 * because we need the sequence number.
+	 *
+	 * Contrary to nl_rtgen_request(), send the full header for the type. With
+	 * NETLINK_GET_STRICT_CHK, the kernel rejects dump requests with a
+	 * truncated header. Older kernels only look at the address family, which
+	 * is the first field for all header types. */
+	memset (&hdr, 0, sizeof (hdr));
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_LINK:
+		hdr.ifi.ifi_family = klass->addr_family;
+		hdr_len = sizeof (hdr.ifi);
+		break;
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+		hdr.ifa.ifa_family = klass->addr_family;
+		hdr_len = sizeof (hdr.ifa);
+		break;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		hdr.rtm.rtm_family = klass->addr_family;
+		if (priv->route_filter.enabled) {
+			/* we only cache unicast routes of the main table. With strict
+			 * checking, the kernel applies this filter already while dumping,
+			 * so that routes of other tables are never sent to us. */
+			hdr.rtm.rtm_table = RT_TABLE_MAIN;
+			hdr.rtm.rtm_type = RTN_UNICAST;
+		}
+		hdr_len = sizeof (hdr.rtm);
+		break;
+	default:
+		hdr.gmsg.rtgen_family = klass->addr_family;
+		hdr_len = sizeof (hdr.gmsg);
+		break;
+	}
+
+	nlmsg = nlmsg_alloc_simple (klass->rtm_gettype, NLM_F_DUMP);
+	if (!nlmsg)
+		return NULL;
+
+	if (nlmsg_append (nlmsg, &hdr, hdr_len, NLMSG_ALIGNTO) < 0) {
+		nlmsg_free (nlmsg);
+		return NULL;
+	}
+	return nlmsg;
+}
+
 static void
 do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType action_type)
 {
@@ -3566,18 +3774,16 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 	nm_assert (!NM_FLAGS_ANY (action_type, ~DELAYED_ACTION_TYPE_REFRESH_ALL));
 	action_type &= DELAYED_ACTION_TYPE_REFRESH_ALL;
 
+	/* the socket runs only one dump at a time. */
+	resync_dump_wait (platform);
+
 	FOR_EACH_DELAYED_ACTION (iflags, action_type) {
 		cache_prune_candidates_record_all (platform, delayed_action_refresh_to_object_type (iflags));
 	}
 
 	FOR_EACH_DELAYED_ACTION (iflags, action_type) {
 		NMPObjectType obj_type = delayed_action_refresh_to_object_type (iflags);
-		const NMPClass *klass = nmp_class_from_type (obj_type);
 		nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
-		struct rtgenmsg gmsg = {
-			.rtgen_family = klass->addr_family,
-		};
-		int nle;
 		gint *out_refresh_all_in_progess;
 
 		out_refresh_all_in_progess = &priv->delayed_action.refresh_all_in_progess[delayed_action_refresh_all_to_idx (iflags)];
@@ -3595,18 +3801,10 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 
 		event_handler_read_netlink (platform, FALSE);
 
-		/* reimplement
-		 *   nl_rtgen_request (sk, klass->rtm_gettype, klass->addr_family, NLM_F_DUMP);
-		 * because we need the sequence number.
-		 */
-		nlmsg = nlmsg_alloc_simple (klass->rtm_gettype, NLM_F_DUMP);
+		nlmsg = _nl_msg_new_dump (platform, obj_type);
 		if (!nlmsg)
 			continue;
 
-		nle = nlmsg_append (nlmsg, &gmsg, sizeof (gmsg), NLMSG_ALIGNTO);
-		if (nle < 0)
-			continue;
-
 		if (_nl_send_auto_with_seq (platform, nlmsg, NULL, out_refresh_all_in_progess) < 0) {
 			nm_assert (*out_refresh_all_in_progess > 0);
 			*out_refresh_all_in_progess -= 1;
@@ -3621,6 +3819,197 @@ do_request_one_type (NMPlatform *platform, NMPObjectType obj_type)
 	delayed_action_handle_all (platform, FALSE);
 }
 
+/******************************************************************
+ * Incremental resync after an overrun of the netlink socket.
+ *
+ * Instead of dumping all object types at once and blocking until the
+ * dumps are complete, dump one object type after the other (links
+ * first, routes last). The dump is not waited for: the messages are
+ * handled by the regular event handler as they come in, which only
+ * reads a limited number of datagrams per main loop iteration while
+ * the dump is in flight. Objects that were cached before the dump
+ * started and were not seen by the time the dump completes get pruned.
+ ******************************************************************/
+
+/* how many times event_handler_read_netlink() calls recvmmsg() while a
+ * resync dump is in flight before yielding to the mainloop. */
+#define RESYNC_READ_BUDGET 32
+
+/* how often a dump interrupted by concurrent changes is retried. After
+ * that, the dump is taken as it is, without pruning. Objects it missed
+ * are still updated by their change notifications, only objects removed
+ * while the notifications were lost can stay in the cache until the
+ * next resync. */
+#define RESYNC_DUMP_INTR_MAX 5
+
+static gboolean resync_step_cb (gpointer user_data);
+static void _nl_stats_log (NMPlatform *platform, const char *reason);
+
+static void
+resync_stage_clear (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	priv->resync.current = DELAYED_ACTION_TYPE_NONE;
+	priv->resync.seq_number = 0;
+	priv->resync.seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	priv->resync.dump_intr = FALSE;
+	g_clear_pointer (&priv->resync.prune_candidates, g_hash_table_unref);
+}
+
+static void
+resync_start (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (priv->resync.seq_number) {
+		/* the dump in flight lost messages too. The kernel doesn't accept
+		 * another dump before it completes, so keep tracking it, but don't
+		 * prune based on it. The type gets dumped again. */
+		_LOGD ("resync: restart after the dump in flight");
+		priv->resync.dump_intr = TRUE;
+	} else {
+		if (priv->resync.current)
+			_LOGD ("resync: restart");
+		else if (!priv->resync.pending)
+			priv->resync.start_ns = nm_utils_get_monotonic_timestamp_ns ();
+		resync_stage_clear (platform);
+		priv->resync.n_dump_intr = 0;
+	}
+
+	priv->resync.pending = DELAYED_ACTION_TYPE_REFRESH_ALL;
+
+	if (!priv->resync.idle_id)
+		priv->resync.idle_id = g_idle_add (resync_step_cb, platform);
+}
+
+static void
+resync_stage_done (NMPlatform *platform, WaitForNlResponseResult seq_result)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	nm_assert (priv->resync.current);
+	nm_assert (priv->resync.seq_number);
+
+	priv->resync.seq_number = 0;
+	priv->resync.seq_result = seq_result;
+
+	/* prune and continue with the next type on idle, not while parsing
+	 * the netlink messages. */
+	if (!priv->resync.idle_id)
+		priv->resync.idle_id = g_idle_add (resync_step_cb, platform);
+}
+
+/* A netlink socket runs only one dump at a time, the kernel rejects
+ * another dump request with EBUSY. Before requesting a dump synchronously,
+ * read the remainder of the resync dump in flight. */
+static void
+resync_dump_wait (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	WaitForNlResponseResult seq_result;
+	guint32 seq_number;
+
+	while ((seq_number = priv->resync.seq_number)) {
+		_LOGT ("resync: wait for dump %s (seq %u) to complete",
+		       delayed_action_to_string (priv->resync.current), seq_number);
+
+		/* the wait completes with the first response, so we wait until
+		 * resync_stage_done() saw the end of the dump. */
+		seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+		delayed_action_schedule_WAIT_FOR_NL_RESPONSE (platform, seq_number, &seq_result, NULL);
+		event_handler_read_netlink (platform, TRUE);
+
+		if (   priv->resync.seq_number == seq_number
+		    && NM_IN_SET (seq_result,
+		                  WAIT_FOR_NL_RESPONSE_RESULT_FAILED_POLL,
+		                  WAIT_FOR_NL_RESPONSE_RESULT_FAILED_TIMEOUT,
+		                  WAIT_FOR_NL_RESPONSE_RESULT_FAILED_DISPOSING)) {
+			/* the kernel doesn't continue the dump. Give up on it, the
+			 * resync retries the type. */
+			_LOGD ("resync: dump %s does not complete",
+			       delayed_action_to_string (priv->resync.current));
+			resync_stage_done (platform, seq_result);
+		}
+	}
+}
+
+static gboolean
+resync_step_cb (gpointer user_data)
+{
+	NMPlatform *platform = user_data;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	DelayedActionType iflags;
+	NMPObjectType obj_type;
+
+	priv->resync.idle_id = 0;
+
+	if (priv->resync.current) {
+		if (priv->resync.seq_number) {
+			/* still in flight. We get scheduled again, once it completes. */
+			return G_SOURCE_REMOVE;
+		}
+
+		if (   priv->resync.seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+		    && !priv->resync.dump_intr) {
+			_LOGD ("resync: %s complete, prune %u objects",
+			       delayed_action_to_string (priv->resync.current),
+			       priv->resync.prune_candidates ? g_hash_table_size (priv->resync.prune_candidates) : 0);
+			if (priv->resync.prune_candidates)
+				_cache_prune_candidates_prune (platform, priv->resync.prune_candidates);
+			priv->resync.n_dump_intr = 0;
+		} else if (   priv->resync.seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+		           && ++priv->resync.n_dump_intr > RESYNC_DUMP_INTR_MAX) {
+			_LOGD ("resync: %s interrupted %u times, accept it without pruning",
+			       delayed_action_to_string (priv->resync.current),
+			       (guint) priv->resync.n_dump_intr);
+			priv->resync.n_dump_intr = 0;
+		} else {
+			_LOGD ("resync: %s failed, retry",
+			       delayed_action_to_string (priv->resync.current));
+			priv->resync.pending |= priv->resync.current;
+		}
+		resync_stage_clear (platform);
+	}
+
+	if (!priv->resync.pending) {
+		priv->nl_stats.n_resyncs++;
+		_LOGI ("resync: platform cache resynchronized in %"G_GINT64_FORMAT" msec",
+		       (nm_utils_get_monotonic_timestamp_ns () - priv->resync.start_ns) / (NM_UTILS_NS_PER_SECOND / 1000));
+		_nl_stats_log (platform, "resync");
+		return G_SOURCE_REMOVE;
+	}
+
+	/* the lowest bit has the highest priority. */
+	iflags = priv->resync.pending & ~(priv->resync.pending - 1);
+	obj_type = delayed_action_refresh_to_object_type (iflags);
+
+	priv->resync.current = iflags;
+	priv->resync.pending &= ~iflags;
+	priv->resync.prune_candidates = nmp_cache_lookup_all_to_hash (priv->cache,
+	                                                              nmp_cache_id_init_object_type (NMP_CACHE_ID_STATIC, obj_type, FALSE),
+	                                                              NULL);
+
+	_LOGD ("resync: dump %s (%u objects cached)",
+	       delayed_action_to_string (iflags),
+	       priv->resync.prune_candidates ? g_hash_table_size (priv->resync.prune_candidates) : 0);
+
+	nlmsg = _nl_msg_new_dump (platform, obj_type);
+	if (   !nlmsg
+	    || _nl_send_auto_with_seq_nowait (platform, nlmsg, &priv->resync.seq_number) < 0) {
+		/* fall back to the blocking refresh of the remaining types. */
+		_LOGW ("resync: failed to request dump. Refresh remaining object types at once");
+		iflags |= priv->resync.pending;
+		priv->resync.pending = DELAYED_ACTION_TYPE_NONE;
+		resync_stage_clear (platform);
+		delayed_action_schedule (platform, iflags, NULL);
+		delayed_action_handle_all (platform, FALSE);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
 static void
 event_seq_check_refresh_all (NMPlatform *platform, guint32 seq_number)
 {
@@ -3689,21 +4078,18 @@ event_seq_check (NMPlatform *platform, guint32 seq_number, WaitForNlResponseResu
 }
 
 static void
-event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_events)
+event_valid_msg (NMPlatform *platform, struct nlmsghdr *msghdr, gboolean handle_events)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	nm_auto_nmpobj NMPObject *obj = NULL;
 	nm_auto_nmpobj NMPObject *obj_cache = NULL;
 	NMPCacheOpsType cache_op;
-	struct nlmsghdr *msghdr;
 	char buf_nlmsg_type[16];
 	gboolean id_only = FALSE;
 	gboolean was_visible;
 
-	msghdr = nlmsg_hdr (msg);
-
 	if (_support_kernel_extended_ifa_flags_still_undecided () && msghdr->nlmsg_type == RTM_NEWADDR)
-		_support_kernel_extended_ifa_flags_detect (msg);
+		_support_kernel_extended_ifa_flags_detect (msghdr);
 
 	if (!handle_events)
 		return;
@@ -3714,7 +4100,7 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 		id_only = TRUE;
 	}
 
-	obj = nmp_object_new_from_nl (platform, priv->cache, msg, id_only);
+	obj = nmp_object_new_from_nl (platform, priv->cache, &priv->route_filter, msghdr, id_only);
 	if (!obj) {
 		_LOGT ("event-notification: %s, seq %u: ignore",
 		       _nl_nlmsg_type_to_str (msghdr->nlmsg_type, buf_nlmsg_type, sizeof (buf_nlmsg_type)),
@@ -3931,22 +4317,109 @@ do_add_link_with_lookup (NMPlatform *platform,
 	return !!obj;
 }
 
+static void
+_do_add_addrroute_log (NMPlatform *platform, const NMPObject *obj_id, WaitForNlResponseResult seq_result)
+{
+	char s_buf[256];
+
+	_NMLOG (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+	            ? LOGL_DEBUG
+	            : LOGL_ERR,
+	        "do-add-%s[%s]: %s",
+	        NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
+	        nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+	        wait_for_nl_response_to_string (seq_result, s_buf, sizeof (s_buf)));
+}
+
+static void
+_do_delete_object_log (NMPlatform *platform, const NMPObject *obj_id, WaitForNlResponseResult seq_result)
+{
+	char s_buf[256];
+	gboolean success = TRUE;
+	const char *log_detail = "";
+
+	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
+		/* ok */
+	} else if (NM_IN_SET (-((int) seq_result), ESRCH, ENOENT))
+		log_detail = ", meaning the object was already removed";
+	else if (   NM_IN_SET (-((int) seq_result), ENXIO)
+	         && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP6_ADDRESS)) {
+		/* On RHEL7 kernel, deleting a non existing address fails with ENXIO */
+		log_detail = ", meaning the address was already removed";
+	} else if (   NM_IN_SET (-((int) seq_result), EADDRNOTAVAIL)
+	           && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS))
+		log_detail = ", meaning the address was already removed";
+	else
+		success = FALSE;
+
+	_NMLOG (success ? LOGL_DEBUG : LOGL_ERR,
+	        "do-delete-%s[%s]: %s%s",
+	        NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
+	        nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+	        wait_for_nl_response_to_string (seq_result, s_buf, sizeof (s_buf)),
+	        log_detail);
+}
+
+static BatchRequestData *
+batch_request_new (NMPlatform *platform, const NMPObject *obj_id, gboolean is_delete)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	BatchRequestData *data;
+
+	if (priv->batch.depth == 0)
+		return NULL;
+
+	data = g_slice_new0 (BatchRequestData);
+	data->obj_id = nmp_object_clone (obj_id, TRUE);
+	data->is_delete = is_delete;
+	g_ptr_array_add (priv->batch.list, data);
+	return data;
+}
+
+static void
+batch_request_free (BatchRequestData *data)
+{
+	nmp_object_unref (data->obj_id);
+	g_slice_free (BatchRequestData, data);
+}
+
+/* upper limit of requests that we send before reading the responses. The
+ * responses (and the notifications about the changes) pile up in the receive
+ * buffer of the socket, we don't want to overrun it. */
+#define BATCH_MAX_IN_FLIGHT 256
+
+static void
+batch_request_sent (NMPlatform *platform, BatchRequestData *data)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	data->sent = TRUE;
+	if (++priv->batch.n_in_flight >= BATCH_MAX_IN_FLIGHT) {
+		priv->batch.n_in_flight = 0;
+		delayed_action_handle_all (platform, FALSE);
+	}
+}
+
 static gboolean
 do_add_addrroute (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	BatchRequestData *batch_data;
 	int nle;
-	char s_buf[256];
 	const NMPObject *obj;
 
 	nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id),
 	                      NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS,
 	                      NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE));
 
-	event_handler_read_netlink (platform, FALSE);
+	batch_data = batch_request_new (platform, obj_id, FALSE);
+	if (!batch_data)
+		event_handler_read_netlink (platform, FALSE);
 
-	nle = _nl_send_auto_with_seq (platform, nlmsg, &seq_result, NULL);
+	nle = _nl_send_auto_with_seq (platform, nlmsg,
+	                              batch_data ? &batch_data->seq_result : &seq_result,
+	                              NULL);
 	if (nle < 0) {
 		_LOGE ("do-add-%s[%s]: failure sending netlink request \"%s\" (%d)",
 		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
@@ -3955,17 +4428,17 @@ do_add_addrroute (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 		return FALSE;
 	}
 
+	if (batch_data) {
+		/* the result is evaluated by batch_commit(). */
+		batch_request_sent (platform, batch_data);
+		return TRUE;
+	}
+
 	delayed_action_handle_all (platform, FALSE);
 
 	nm_assert (seq_result);
 
-	_NMLOG (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
-	            ? LOGL_DEBUG
-	            : LOGL_ERR,
-	        "do-add-%s[%s]: %s",
-	        NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
-	        nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
-	        wait_for_nl_response_to_string (seq_result, s_buf, sizeof (s_buf)));
+	_do_add_addrroute_log (platform, obj_id, seq_result);
 
 	/* In rare cases, the object is not yet ready as we received the ACK from
 	 * kernel. Need to refetch.
@@ -3992,46 +4465,38 @@ do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	BatchRequestData *batch_data;
 	int nle;
-	char s_buf[256];
-	gboolean success = TRUE;
-	const char *log_detail = "";
 
-	event_handler_read_netlink (platform, FALSE);
+	batch_data = batch_request_new (platform, obj_id, TRUE);
+	if (!batch_data)
+		event_handler_read_netlink (platform, FALSE);
 
-	nle = _nl_send_auto_with_seq (platform, nlmsg, &seq_result, NULL);
+	nle = _nl_send_auto_with_seq (platform, nlmsg,
+	                              batch_data ? &batch_data->seq_result : &seq_result,
+	                              NULL);
 	if (nle < 0) {
 		_LOGE ("do-delete-%s[%s]: failure sending netlink request \"%s\" (%d)",
 		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
 		       nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
 		       nl_geterror (nle), -nle);
+		if (batch_data) {
+			/* batch_commit() checks whether the object is still in the cache. */
+			return TRUE;
+		}
 		goto out;
 	}
 
+	if (batch_data) {
+		batch_request_sent (platform, batch_data);
+		return TRUE;
+	}
+
 	delayed_action_handle_all (platform, FALSE);
 
 	nm_assert (seq_result);
 
-	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
-		/* ok */
-	} else if (NM_IN_SET (-((int) seq_result), ESRCH, ENOENT))
-		log_detail = ", meaning the object was already removed";
-	else if (   NM_IN_SET (-((int) seq_result), ENXIO)
-	         && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP6_ADDRESS)) {
-		/* On RHEL7 kernel, deleting a non existing address fails with ENXIO */
-		log_detail = ", meaning the address was already removed";
-	} else if (   NM_IN_SET (-((int) seq_result), EADDRNOTAVAIL)
-	           && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS))
-		log_detail = ", meaning the address was already removed";
-	else
-		success = FALSE;
-
-	_NMLOG (success ? LOGL_DEBUG : LOGL_ERR,
-	        "do-delete-%s[%s]: %s%s",
-	        NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
-	        nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
-	        wait_for_nl_response_to_string (seq_result, s_buf, sizeof (s_buf)),
-	        log_detail);
+	_do_delete_object_log (platform, obj_id, seq_result);
 
 out:
 	if (!nmp_cache_lookup_obj (priv->cache, obj_id))
@@ -4043,6 +4508,80 @@ out:
 	return !!nmp_cache_lookup_obj (priv->cache, obj_id);
 }
 
+static void
+batch_begin (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (priv->batch.depth++ > 0)
+		return;
+
+	/* drain the socket once, instead of before every request. */
+	event_handler_read_netlink (platform, FALSE);
+}
+
+static gboolean
+batch_commit (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType refresh = DELAYED_ACTION_TYPE_NONE;
+	gboolean success = TRUE;
+	BatchRequestData *data;
+	const NMPObject *obj;
+	guint i;
+
+	g_return_val_if_fail (priv->batch.depth > 0, FALSE);
+
+	if (--priv->batch.depth > 0)
+		return TRUE;
+
+	priv->batch.n_in_flight = 0;
+
+	if (priv->batch.list->len == 0)
+		return TRUE;
+
+	/* collect the responses for all requests with one read of the socket. */
+	delayed_action_handle_all (platform, FALSE);
+
+	for (i = 0; i < priv->batch.list->len; i++) {
+		data = priv->batch.list->pdata[i];
+
+		if (data->sent) {
+			nm_assert (data->seq_result);
+			if (data->is_delete)
+				_do_delete_object_log (platform, data->obj_id, data->seq_result);
+			else
+				_do_add_addrroute_log (platform, data->obj_id, data->seq_result);
+		}
+
+		/* like for the unbatched requests, refetch if the cache does not
+		 * match the expected result. But only once per object type. */
+		obj = nmp_cache_lookup_obj (priv->cache, data->obj_id);
+		if (data->is_delete ? !!obj : !obj)
+			refresh |= delayed_action_refresh_from_object_type (NMP_OBJECT_GET_TYPE (data->obj_id));
+	}
+
+	if (refresh != DELAYED_ACTION_TYPE_NONE) {
+		do_request_all_no_delayed_actions (platform, refresh);
+		delayed_action_handle_all (platform, FALSE);
+	}
+
+	for (i = 0; i < priv->batch.list->len; i++) {
+		data = priv->batch.list->pdata[i];
+
+		obj = nmp_cache_lookup_obj (priv->cache, data->obj_id);
+		if (data->is_delete) {
+			if (obj)
+				success = FALSE;
+		} else if (   !obj
+		           || data->seq_result != WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK)
+			success = FALSE;
+	}
+
+	g_ptr_array_set_size (priv->batch.list, 0);
+	return success;
+}
+
 static NMPlatformError
 do_change_link (NMPlatform *platform,
                 int ifindex,
@@ -5864,128 +6403,89 @@ event_handler (GIOChannel *channel,
 
 /*****************************************************************************/
 
-/* copied from libnl3's recvmsgs() */
+static const struct ucred *
+_nl_recv_get_creds (struct msghdr *msghdr)
+{
+	struct cmsghdr *cmsg;
+
+	for (cmsg = CMSG_FIRSTHDR (msghdr); cmsg; cmsg = CMSG_NXTHDR (msghdr, cmsg)) {
+		if (   cmsg->cmsg_level == SOL_SOCKET
+		    && cmsg->cmsg_type == SCM_CREDENTIALS
+		    && cmsg->cmsg_len >= CMSG_LEN (sizeof (struct ucred)))
+			return (const struct ucred *) CMSG_DATA (cmsg);
+	}
+	return NULL;
+}
+
+/* handle the messages of one received datagram. Based on libnl3's recvmsgs(),
+ * but parses the messages in place. */
 static int
-event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
+event_handler_recvmsgs_datagram (NMPlatform *platform,
+                                 struct mmsghdr *mmsg,
+                                 gboolean handle_events,
+                                 gboolean *interrupted)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	struct nl_sock *sk = priv->nlh;
-	int n, err = 0, multipart = 0, interrupted = 0;
+	const struct ucred *creds;
 	struct nlmsghdr *hdr;
 	WaitForNlResponseResult seq_result;
-
-	/*
-	nla is passed on to not only to nl_recv() but may also be passed
-	to a function pointer provided by the caller which may or may not
-	initialize the variable. Thomas Graf.
-	*/
-	struct sockaddr_nl nla = {0};
-	nm_auto_free struct ucred *creds = NULL;
-	nm_auto_free unsigned char *buf = NULL;
-
-continue_reading:
-	g_clear_pointer (&buf, free);
-	g_clear_pointer (&creds, free);
-	errno = 0;
-	n = nl_recv (sk, &nla, &buf, &creds);
-
-	if (n <= 0) {
-		/* workaround libnl3 <= 3.2.15 returning danling pointers in case nl_recv()
-		 * fails. Fixed by libnl3 69468517d0de1675d80f24661ff57a5dbac7275c. */
-		buf = NULL;
-		creds = NULL;
-	}
-
-	switch (n) {
-	case 0:
-		/* Work around a libnl bug fixed in 3.2.22 (375a6294) */
-		if (errno == EAGAIN) {
-			/* EAGAIN is equal to EWOULDBLOCK. If it would not be, we'd have to
-			 * workaround libnl3 mapping EWOULDBLOCK to -NLE_FAILURE. */
-			G_STATIC_ASSERT (EAGAIN == EWOULDBLOCK);
-			n = -NLE_AGAIN;
-		}
-		break;
-	case -NLE_NOMEM:
-		if (errno == ENOBUFS) {
-			/* we are very much interested in a overrun of the receive buffer.
-			 * nl_recv() maps all kinds of errors to NLE_NOMEM, so check also
-			 * for errno explicitly. And if so, hack our own return code to signal
-			 * the overrun. */
-			n = -_NLE_NM_NOBUFS;
-		}
-		break;
+	int n, err = 0;
+
+	n = mmsg->msg_len;
+	priv->nl_stats.n_bytes += n;
+
+	if (NM_FLAGS_HAS (mmsg->msg_hdr.msg_flags, MSG_TRUNC)) {
+		/* we peek the size of the first datagram of a batch, but one of
+		 * the following datagrams was larger than our buffers. Thanks to
+		 * MSG_TRUNC, @n is its real size. Its content is lost, which is no
+		 * different from an overrun. The buffers grow before the next read,
+		 * so that the resync can receive it. */
+		_LOGD ("netlink: recvmsg: datagram of %d bytes truncated to %u bytes", n, priv->recv.buf_size);
+		priv->recv.buf_size_needed = MAX (priv->recv.buf_size_needed, (guint) n);
+		return -_NLE_NM_NOBUFS;
 	}
 
-	if (n <= 0)
-		return n;
+	creds = _nl_recv_get_creds (&mmsg->msg_hdr);
+	if (!creds || creds->pid) {
+		if (creds)
+			_LOGT ("netlink: recvmsg: received non-kernel message (pid %d)", creds->pid);
+		else
+			_LOGT ("netlink: recvmsg: received message without credentials");
+		return 0;
+	}
 
-	hdr = (struct nlmsghdr *) buf;
+	hdr = (struct nlmsghdr *) mmsg->msg_hdr.msg_iov->iov_base;
 	while (nlmsg_ok (hdr, n)) {
-		nm_auto_nlmsg struct nl_msg *msg = NULL;
 		gboolean abort_parsing = FALSE;
 		gboolean process_valid_msg = FALSE;
 		guint32 seq_number;
 
-		msg = nlmsg_convert (hdr);
-		if (!msg) {
-			err = -NLE_NOMEM;
-			goto out;
-		}
-
-		nlmsg_set_proto (msg, NETLINK_ROUTE);
-		nlmsg_set_src (msg, &nla);
-
-		if (!creds || creds->pid) {
-			if (creds)
-				_LOGT ("netlink: recvmsg: received non-kernel message (pid %d)", creds->pid);
-			else
-				_LOGT ("netlink: recvmsg: received message without credentials");
-			err = 0;
-			goto stop;
-		}
+		priv->nl_stats.n_messages++;
 
 		_LOGt ("netlink: recvmsg: new message type %d, seq %u",
 		       hdr->nlmsg_type, hdr->nlmsg_seq);
 
-		if (creds)
-			nlmsg_set_creds (msg, creds);
-
-		if (hdr->nlmsg_flags & NLM_F_MULTI)
-			multipart = 1;
-
 		if (hdr->nlmsg_flags & NLM_F_DUMP_INTR) {
 			/*
 			 * We have to continue reading to clear
 			 * all messages until a NLMSG_DONE is
 			 * received and report the inconsistency.
 			 */
-			interrupted = 1;
-		}
-
-		/* Other side wishes to see an ack for this message */
-		if (hdr->nlmsg_flags & NLM_F_ACK) {
-			/* FIXME: implement */
+			*interrupted = TRUE;
+			if (   priv->resync.seq_number
+			    && hdr->nlmsg_seq == priv->resync.seq_number)
+				priv->resync.dump_intr = TRUE;
 		}
 
 		seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_UNKNOWN;
 
 		if (hdr->nlmsg_type == NLMSG_DONE) {
-			/* messages terminates a multipart message, this is
-			 * usually the end of a message and therefore we slip
-			 * out of the loop by default. the user may overrule
-			 * this action by skipping this packet. */
-			multipart = 0;
+			/* messages terminates a multipart message. */
 			seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		} else if (hdr->nlmsg_type == NLMSG_NOOP) {
-			/* Message to be ignored, the default action is to
-			 * skip this message if no callback is specified. The
-			 * user may overrule this action by returning
-			 * NL_PROCEED. */
+			/* Message to be ignored. */
 		} else if (hdr->nlmsg_type == NLMSG_OVERRUN) {
-			/* Data got lost, report back to user. The default action is to
-			 * quit parsing. The user may overrule this action by retuning
-			 * NL_SKIP or NL_PROCEED (dangerous) */
+			/* Data got lost, report back to user. */
 			err = -NLE_MSG_OVERFLOW;
 			abort_parsing = TRUE;
 		} else if (hdr->nlmsg_type == NLMSG_ERROR) {
@@ -5993,10 +6493,7 @@ continue_reading:
 			struct nlmsgerr *e = nlmsg_data (hdr);
 
 			if (hdr->nlmsg_len < nlmsg_size (sizeof (*e))) {
-				/* Truncated error message, the default action
-				 * is to stop parsing. The user may overrule
-				 * this action by returning NL_SKIP or
-				 * NL_PROCEED (dangerous) */
+				/* Truncated error message, stop parsing. */
 				err = -NLE_MSG_TRUNC;
 				abort_parsing = TRUE;
 			} else if (e->error) {
@@ -6006,14 +6503,14 @@ continue_reading:
 				_LOGD ("netlink: recvmsg: error message from kernel: %s (%d) for request %d",
 				       strerror (errsv),
 				       errsv,
-				       nlmsg_hdr (msg)->nlmsg_seq);
+				       hdr->nlmsg_seq);
 				seq_result = -errsv;
 			} else
 				seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		} else
 			process_valid_msg = TRUE;
 
-		seq_number = nlmsg_hdr (msg)->nlmsg_seq;
+		seq_number = hdr->nlmsg_seq;
 
 		/* check whether the seq number is different from before, and
 		 * whether the previous number (@nlh_seq_last_seen) is a pending
@@ -6026,36 +6523,153 @@ continue_reading:
 
 		if (process_valid_msg) {
 			/* Valid message (not checking for MULTIPART bit to
-			 * get along with broken kernels. NL_SKIP has no
-			 * effect on this.  */
-
-			event_valid_msg (platform, msg, handle_events);
+			 * get along with broken kernels. */
+			event_valid_msg (platform, hdr, handle_events);
 
 			seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		}
 
 		event_seq_check (platform, seq_number, seq_result);
 
+		if (   priv->resync.seq_number
+		    && seq_number == priv->resync.seq_number
+		    && NM_IN_SET (hdr->nlmsg_type, NLMSG_DONE, NLMSG_ERROR))
+			resync_stage_done (platform, seq_result);
+
 		if (abort_parsing)
-			goto stop;
+			break;
 
-		err = 0;
 		hdr = nlmsg_next (hdr, &n);
 	}
 
-	if (multipart) {
-		/* Multipart message not yet complete, continue reading */
-		goto continue_reading;
+	return err;
+}
+
+static void
+_nl_recv_buf_grow (NMPlatform *platform, guint size)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint buf_size = priv->recv.buf_size;
+
+	if (size <= buf_size)
+		return;
+
+	while (buf_size < size)
+		buf_size *= 2;
+
+	_LOGD ("netlink: grow receive buffers to %u bytes for a datagram of %u bytes", buf_size, size);
+
+	/* the messages of the previous read are already handled. */
+	g_free (priv->recv.buf);
+	priv->recv.buf = g_malloc (NL_RECV_N_BUFFERS * buf_size);
+	priv->recv.buf_size = buf_size;
+}
+
+static int
+_nl_recv_errno_to_nle (int errsv)
+{
+	switch (errsv) {
+	case EAGAIN:
+		return -NLE_AGAIN;
+	case ENOBUFS:
+		/* we are very much interested in a overrun of the receive buffer. */
+		return -_NLE_NM_NOBUFS;
+	default:
+		return -nl_syserr2nlerr (errsv);
+	}
+}
+
+/* Read the pending datagrams from the netlink socket with one recvmmsg() call
+ * into the preallocated receive buffers. Unlike nl_recv(), this does not allocate
+ * memory per datagram and does not copy the messages. */
+static int
+event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int fd = nl_socket_get_fd (priv->nlh);
+	gboolean interrupted = FALSE;
+	int n_msgs, i, r, err;
+	ssize_t n_peek;
+
+continue_reading:
+	err = 0;
+
+	/* like libnl and iproute2, peek the size of the next datagram, so that
+	 * it never gets truncated. With MSG_TRUNC, netlink returns the real size
+	 * and not what fits into the (empty) buffer. */
+	n_peek = recv (fd, NULL, 0, MSG_PEEK | MSG_TRUNC | MSG_DONTWAIT);
+	if (n_peek < 0) {
+		int errsv = errno;
+
+		if (errsv == EINTR)
+			goto continue_reading;
+		return _nl_recv_errno_to_nle (errsv);
+	}
+	_nl_recv_buf_grow (platform, MAX ((guint) n_peek, priv->recv.buf_size_needed));
+	priv->recv.buf_size_needed = 0;
+
+	for (i = 0; i < NL_RECV_N_BUFFERS; i++) {
+		struct msghdr *msghdr = &priv->recv.msgs[i].msg_hdr;
+
+		priv->recv.iov[i].iov_base = &priv->recv.buf[i * priv->recv.buf_size];
+		priv->recv.iov[i].iov_len = priv->recv.buf_size;
+
+		msghdr->msg_name = &priv->recv.nla[i];
+		msghdr->msg_namelen = sizeof (priv->recv.nla[i]);
+		msghdr->msg_iov = &priv->recv.iov[i];
+		msghdr->msg_iovlen = 1;
+		msghdr->msg_control = &priv->recv.control[i];
+		msghdr->msg_controllen = sizeof (priv->recv.control[i]);
+		msghdr->msg_flags = 0;
+		priv->recv.msgs[i].msg_len = 0;
+	}
+
+	n_msgs = recvmmsg (fd, priv->recv.msgs, NL_RECV_N_BUFFERS, MSG_DONTWAIT | MSG_TRUNC, NULL);
+	if (n_msgs < 0) {
+		int errsv = errno;
+
+		if (errsv == EINTR)
+			goto continue_reading;
+		return _nl_recv_errno_to_nle (errsv);
+	}
+
+	priv->nl_stats.n_datagrams += n_msgs;
+
+	if (   n_msgs == NL_RECV_N_BUFFERS
+	    && !priv->rcvbuf.meminfo_checked
+	    && !priv->rcvbuf.meminfo_unsupported) {
+		guint32 meminfo[SK_MEMINFO_RCVBUF + 1];
+		socklen_t len = sizeof (meminfo);
+
+		/* a full batch means there may be more queued. Once per wakeup, ask
+		 * the kernel how full the receive queue is. Both values are in the
+		 * kernel's accounting, which includes the overhead per datagram. */
+		priv->rcvbuf.meminfo_checked = TRUE;
+		if (getsockopt (fd, SOL_SOCKET, SO_MEMINFO, meminfo, &len) < 0) {
+			_LOGD ("netlink: SO_MEMINFO not supported, grow receive buffer only on overruns");
+			priv->rcvbuf.meminfo_unsupported = TRUE;
+		} else if (   len >= sizeof (meminfo)
+		           && meminfo[SK_MEMINFO_RMEM_ALLOC] >= meminfo[SK_MEMINFO_RCVBUF] / 2)
+			priv->rcvbuf.pressure = TRUE;
 	}
-stop:
+
+	for (i = 0; i < n_msgs; i++) {
+		r = event_handler_recvmsgs_datagram (platform, &priv->recv.msgs[i], handle_events, &interrupted);
+
+		/* on error, still handle the remaining datagrams. They are already
+		 * read from the socket and would be lost otherwise. */
+		if (r < 0 && (err == 0 || r == -_NLE_NM_NOBUFS))
+			err = r;
+	}
+
 	if (!handle_events) {
 		/* when we don't handle events, we want to drain all messages from the socket
 		 * without handling the messages (but still check for sequence numbers).
 		 * Repeat reading. */
 		goto continue_reading;
 	}
-out:
-	if (interrupted)
+
+	if (interrupted && err == 0)
 		err = -NLE_DUMP_INTR;
 	return err;
 }
@@ -6063,7 +6677,73 @@ out:
 /*****************************************************************************/
 
 static gboolean
-event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
+_nl_rcvbuf_set (NMPlatform *platform, guint size)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int fd = nl_socket_get_fd (priv->nlh);
+	int val = size;
+	socklen_t len = sizeof (val);
+
+	/* SO_RCVBUF is capped by net.core.rmem_max. We usually have CAP_NET_ADMIN,
+	 * so try to force the size first. */
+	if (   setsockopt (fd, SOL_SOCKET, SO_RCVBUFFORCE, &val, sizeof (val)) < 0
+	    && setsockopt (fd, SOL_SOCKET, SO_RCVBUF, &val, sizeof (val)) < 0) {
+		int errsv = errno;
+
+		_LOGW ("netlink: failure to set receive buffer size to %u: %s", size, strerror (errsv));
+		return FALSE;
+	}
+
+	priv->rcvbuf.size = size;
+
+	if (getsockopt (fd, SOL_SOCKET, SO_RCVBUF, &val, &len) == 0 && val > 0)
+		priv->nl_stats.rcvbuf_size = val;
+	else
+		priv->nl_stats.rcvbuf_size = size;
+	return TRUE;
+}
+
+static void
+_nl_stats_log (NMPlatform *platform, const char *reason)
+{
+	NMLinuxPlatformNetlinkStats *stats = &NM_LINUX_PLATFORM_GET_PRIVATE (platform)->nl_stats;
+
+	_LOGD ("netlink: stats after %s: %llu overruns, %llu resyncs, receive buffer %u bytes (max %u, grown %u times), "
+	       "%llu wakeups, %llu datagrams, %llu messages, %llu bytes",
+	       reason,
+	       (unsigned long long) stats->n_overruns,
+	       (unsigned long long) stats->n_resyncs,
+	       stats->rcvbuf_size,
+	       stats->rcvbuf_size_max,
+	       stats->n_rcvbuf_grows,
+	       (unsigned long long) stats->n_wakeups,
+	       (unsigned long long) stats->n_datagrams,
+	       (unsigned long long) stats->n_messages,
+	       (unsigned long long) stats->n_bytes);
+}
+
+static gboolean
+_nl_rcvbuf_grow (NMPlatform *platform, const char *reason)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint size;
+
+	if (priv->rcvbuf.size >= priv->rcvbuf.size_max)
+		return FALSE;
+
+	size = MIN (priv->rcvbuf.size * 2, priv->rcvbuf.size_max);
+	if (!_nl_rcvbuf_set (platform, size))
+		return FALSE;
+
+	priv->nl_stats.n_rcvbuf_grows++;
+	_LOGD ("netlink: grow receive buffer to %u bytes (kernel reports %u, max %u) due to %s",
+	       priv->rcvbuf.size, priv->nl_stats.rcvbuf_size, priv->rcvbuf.size_max, reason);
+	_nl_stats_log (platform, reason);
+	return TRUE;
+}
+
+static gboolean
+event_handler_read_netlink_impl (NMPlatform *platform, gboolean wait_for_acks)
 {
 	nm_auto_pop_netns NMPNetns *netns = NULL;
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
@@ -6073,6 +6753,7 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 	gint64 now_ns;
 	int timeout_ms;
 	guint i;
+	guint n_reads = 0;
 	struct {
 		guint32 seq_number;
 		gint64 timeout_abs_ns;
@@ -6085,6 +6766,14 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 
 		while (TRUE) {
 
+			if (   !wait_for_acks
+			    && priv->resync.seq_number
+			    && ++n_reads > RESYNC_READ_BUDGET) {
+				/* a resync dump is streaming in. Yield to the mainloop,
+				 * the event source fires again for the remaining messages. */
+				goto after_read;
+			}
+
 			nle = event_handler_recvmsgs (platform, TRUE);
 
 			if (nle < 0)
@@ -6095,16 +6784,14 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 					_LOGD ("netlink: read: uncritical failure to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
 					break;
 				case -_NLE_NM_NOBUFS:
-					_LOGI ("netlink: read: too many netlink events. Need to resynchronize platform cache");
+					priv->nl_stats.n_overruns++;
+					_LOGI ("netlink: read: too many netlink events. Need to resynchronize platform cache (overruns: %llu, receive buffer: %u bytes)",
+					       (unsigned long long) priv->nl_stats.n_overruns, priv->nl_stats.rcvbuf_size);
+					if (!_nl_rcvbuf_grow (platform, "overrun"))
+						_nl_stats_log (platform, "overrun");
 					event_handler_recvmsgs (platform, FALSE);
 					delayed_action_wait_for_nl_response_complete_all (platform, WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
-					delayed_action_schedule (platform,
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
-					                         NULL);
+					resync_start (platform);
 					break;
 				default:
 					_LOGE ("netlink: read: failed to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
@@ -6174,6 +6861,159 @@ after_read:
 	}
 }
 
+static gboolean
+event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	NMLinuxPlatformNetlinkStats *stats = &priv->nl_stats;
+	guint64 n_datagrams = stats->n_datagrams;
+	guint64 n_messages = stats->n_messages;
+	guint64 n_bytes = stats->n_bytes;
+	gboolean any;
+
+	priv->rcvbuf.meminfo_checked = FALSE;
+	priv->rcvbuf.pressure = FALSE;
+
+	any = event_handler_read_netlink_impl (platform, wait_for_acks);
+
+	if (stats->n_datagrams != n_datagrams) {
+		stats->n_wakeups++;
+		stats->last_datagrams = stats->n_datagrams - n_datagrams;
+		stats->last_messages = stats->n_messages - n_messages;
+		stats->last_bytes = stats->n_bytes - n_bytes;
+		_LOGt ("netlink: read: %u datagrams, %u messages, %u bytes",
+		       stats->last_datagrams, stats->last_messages, stats->last_bytes);
+	}
+
+	/* the receive queue was more than half full. Grow it before we
+	 * lose events. */
+	if (priv->rcvbuf.pressure) {
+		priv->rcvbuf.pressure = FALSE;
+		_nl_rcvbuf_grow (platform, "pressure");
+	}
+	return any;
+}
+
+void
+nm_linux_platform_get_netlink_stats (NMPlatform *platform, NMLinuxPlatformNetlinkStats *out_stats)
+{
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (platform));
+	g_return_if_fail (out_stats);
+
+	*out_stats = NM_LINUX_PLATFORM_GET_PRIVATE (platform)->nl_stats;
+}
+
+/**
+ * nm_linux_platform_set_netlink_rcvbuf_max:
+ * @platform: the #NMLinuxPlatform instance
+ * @size_max: the ceiling in bytes up to which the receive buffer of
+ *   the netlink event socket may grow. Zero selects the default.
+ *
+ * The ceiling is never lower than the initial size of the buffer
+ * (NL_RCVBUF_SIZE_INITIAL, 8 MiB), smaller values are raised to that.
+ * If the current receive buffer is already larger than @size_max,
+ * it gets shrunk.
+ */
+void
+nm_linux_platform_set_netlink_rcvbuf_max (NMPlatform *platform, guint size_max)
+{
+	NMLinuxPlatformPrivate *priv;
+
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (platform));
+
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (size_max == 0)
+		size_max = NL_RCVBUF_SIZE_MAX_DEFAULT;
+	size_max = MAX (size_max, NL_RCVBUF_SIZE_INITIAL);
+
+	priv->rcvbuf.size_max = size_max;
+	priv->nl_stats.rcvbuf_size_max = size_max;
+
+	if (priv->rcvbuf.size > size_max)
+		_nl_rcvbuf_set (platform, size_max);
+}
+
+static gboolean
+_route_protocol_is_managed (guint8 protocol)
+{
+	/* the protocols that we use for our own routes (see
+	 * nmp_utils_ip_config_source_coerce_to_rtprot()) or that the kernel
+	 * uses for routes we care about. */
+	return NM_IN_SET (protocol,
+	                  RTPROT_UNSPEC,
+	                  RTPROT_REDIRECT,
+	                  RTPROT_KERNEL,
+	                  RTPROT_BOOT,
+	                  RTPROT_STATIC,
+	                  RTPROT_RA,
+	                  RTPROT_DHCP);
+}
+
+/**
+ * nm_linux_platform_set_route_protocols_ignore:
+ * @platform: the #NMLinuxPlatform instance
+ * @protocols: (allow-none): the rtm_protocol values of routes
+ *   that should not be cached.
+ * @len: the number of entries in @protocols
+ *
+ * Routes of other routing daemons (for example with protocol "bgp"
+ * or "zebra") are never managed by NetworkManager. Ignoring them keeps
+ * them out of the platform cache. In that mode, route dumps also only
+ * request the main table, which the kernel filters on its side if it
+ * supports strict checking of dump requests.
+ *
+ * Protocols that NetworkManager uses for its own routes cannot be ignored.
+ * Routes that are already cached are pruned by re-reading the routes.
+ */
+void
+nm_linux_platform_set_route_protocols_ignore (NMPlatform *platform,
+                                              const guint8 *protocols,
+                                              guint len)
+{
+	NMLinuxPlatformPrivate *priv;
+	RouteFilter route_filter = { };
+	guint i;
+	int val;
+
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (platform));
+	g_return_if_fail (protocols || !len);
+
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	for (i = 0; i < len; i++) {
+		if (_route_protocol_is_managed (protocols[i])) {
+			_LOGW ("route-filter: cannot ignore routes with protocol %u", (guint) protocols[i]);
+			continue;
+		}
+		route_filter.ignore_protocols[protocols[i] / 32] |= (1u << (protocols[i] % 32));
+		route_filter.enabled = TRUE;
+	}
+
+	if (   route_filter.enabled == priv->route_filter.enabled
+	    && !memcmp (route_filter.ignore_protocols, priv->route_filter.ignore_protocols, sizeof (route_filter.ignore_protocols)))
+		return;
+
+	if (route_filter.enabled != priv->route_filter.enabled) {
+		val = route_filter.enabled;
+		if (setsockopt (nl_socket_get_fd (priv->nlh), SOL_NETLINK, NETLINK_GET_STRICT_CHK, &val, sizeof (val)) < 0) {
+			_LOGD ("route-filter: kernel does not support strict checking of dump requests (%s)",
+			       g_strerror (errno));
+		}
+	}
+
+	priv->route_filter = route_filter;
+	_LOGD ("route-filter: %s", route_filter.enabled ? "ignore routes of foreign protocols" : "disabled");
+
+	/* re-read the routes, to prune the ones that are ignored now (or to
+	 * fetch the ones that were ignored before). */
+	delayed_action_schedule (platform,
+	                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
+	                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
+	                         NULL);
+	delayed_action_handle_all (platform, FALSE);
+}
+
 /******************************************************************/
 
 static void
@@ -6308,6 +7148,12 @@ nm_linux_platform_init (NMLinuxPlatform *self)
 	priv->delayed_action.list_master_connected = g_ptr_array_new ();
 	priv->delayed_action.list_refresh_link = g_ptr_array_new ();
 	priv->delayed_action.list_wait_for_nl_response = g_array_new (FALSE, TRUE, sizeof (DelayedActionWaitForNlResponseData));
+	priv->batch.list = g_ptr_array_new_with_free_func ((GDestroyNotify) batch_request_free);
+	priv->recv.buf_size = NL_RECV_BUFFER_SIZE_INITIAL;
+	priv->recv.buf = g_malloc (NL_RECV_N_BUFFERS * priv->recv.buf_size);
+	priv->rcvbuf.size = NL_RCVBUF_SIZE_INITIAL;
+	priv->rcvbuf.size_max = NL_RCVBUF_SIZE_MAX_DEFAULT;
+	priv->nl_stats.rcvbuf_size_max = NL_RCVBUF_SIZE_MAX_DEFAULT;
 	priv->wifi_data = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) wifi_utils_deinit);
 
 	if (use_udev)
@@ -6348,9 +7194,11 @@ constructed (GObject *_object)
 	nle = nl_socket_set_nonblocking (priv->nlh);
 	g_assert (!nle);
 
-	/* use 8 MB for receive socket kernel queue. */
-	nle = nl_socket_set_buffer_size (priv->nlh, 8*1024*1024, 0);
+	/* start with 8 MB for receive socket kernel queue. It grows on demand,
+	 * see _nl_rcvbuf_grow(). */
+	nle = nl_socket_set_buffer_size (priv->nlh, NL_RCVBUF_SIZE_INITIAL, 0);
 	g_assert (!nle);
+	_nl_rcvbuf_set (platform, NL_RCVBUF_SIZE_INITIAL);
 
 	nle = nl_socket_add_memberships (priv->nlh,
 	                                 RTNLGRP_LINK,
@@ -6425,6 +7273,10 @@ dispose (GObject *object)
 
 	g_clear_pointer (&priv->prune_candidates, g_hash_table_unref);
 
+	nm_clear_g_source (&priv->resync.idle_id);
+	priv->resync.pending = DELAYED_ACTION_TYPE_NONE;
+	resync_stage_clear (platform);
+
 	if (priv->udev_client) {
 		g_signal_handlers_disconnect_by_func (priv->udev_client, G_CALLBACK (handle_udev_event), platform);
 		g_clear_object (&priv->udev_client);
@@ -6444,6 +7296,9 @@ nm_linux_platform_finalize (GObject *object)
 	g_ptr_array_unref (priv->delayed_action.list_refresh_link);
 	g_array_unref (priv->delayed_action.list_wait_for_nl_response);
 
+	g_ptr_array_unref (priv->batch.list);
+	g_free (priv->recv.buf);
+
 	/* Free netlink resources */
 	g_source_remove (priv->event_id);
 	g_io_channel_unref (priv->event_channel);
@@ -6572,5 +7427,8 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->check_support_user_ipv6ll = check_support_user_ipv6ll;
 
 	platform_class->process_events = process_events;
+
+	platform_class->batch_begin = batch_begin;
+	platform_class->batch_commit = batch_commit;
 }
 
@@ -54,6 +54,40 @@ void nm_linux_platform_setup (void);
 
 struct _NMPCacheId;
 
+typedef struct {
+	/* totals since the platform instance was created. */
+	guint64 n_wakeups;
+	guint64 n_datagrams;
+	guint64 n_messages;
+	guint64 n_bytes;
+
+	/* what was read during the last wakeup. */
+	guint last_datagrams;
+	guint last_messages;
+	guint last_bytes;
+
+	/* how often the kernel dropped events because the receive queue
+	 * was full (or a datagram didn't fit into our buffers), and how
+	 * often a resynchronization of the whole cache completed. Several
+	 * overruns during one resynchronization only restart it. */
+	guint64 n_overruns;
+	guint64 n_resyncs;
+
+	/* the current receive buffer size of the event socket as reported
+	 * by the kernel, its configured ceiling and how often it grew. */
+	guint rcvbuf_size;
+	guint rcvbuf_size_max;
+	guint n_rcvbuf_grows;
+} NMLinuxPlatformNetlinkStats;
+
+void nm_linux_platform_get_netlink_stats (NMPlatform *platform, NMLinuxPlatformNetlinkStats *out_stats);
+
+void nm_linux_platform_set_netlink_rcvbuf_max (NMPlatform *platform, guint size_max);
+
+void nm_linux_platform_set_route_protocols_ignore (NMPlatform *platform,
+                                                   const guint8 *protocols,
+                                                   guint len);
+
 const NMPlatformObject *const *nm_linux_platform_lookup (NMPlatform *platform,
                                                          const struct _NMPCacheId *cache_id,
                                                          guint *out_len);
@@ -511,6 +511,55 @@ nmp_utils_ip_config_source_coerce_from_rtprot (NMIPConfigSource source)
 	}
 }
 
+/**
+ * nmp_utils_rtprot_from_string:
+ * @str: the name of a route protocol, like "bgp", or its number
+ *
+ * Returns: the rtm_protocol value for @str, or -1 if @str is
+ *   not a valid route protocol. The names are the same as
+ *   in iproute2's rt_protos file.
+ */
+int
+nmp_utils_rtprot_from_string (const char *str)
+{
+	static const struct {
+		const char *name;
+		guint8 rtprot;
+	} names[] = {
+		{ "unspec",     0 },
+		{ "redirect",   1 },
+		{ "kernel",     2 },
+		{ "boot",       3 },
+		{ "static",     4 },
+		{ "gated",      8 },
+		{ "ra",         9 },
+		{ "mrt",       10 },
+		{ "zebra",     11 },
+		{ "bird",      12 },
+		{ "dnrouted",  13 },
+		{ "xorp",      14 },
+		{ "ntk",       15 },
+		{ "dhcp",      16 },
+		{ "mrouted",   17 },
+		{ "babel",     42 },
+		{ "bgp",      186 },
+		{ "isis",     187 },
+		{ "ospf",     188 },
+		{ "rip",      189 },
+		{ "eigrp",    192 },
+	};
+	guint i;
+
+	if (!str || !str[0])
+		return -1;
+
+	for (i = 0; i < G_N_ELEMENTS (names); i++) {
+		if (!g_ascii_strcasecmp (str, names[i].name))
+			return names[i].rtprot;
+	}
+	return _nm_utils_ascii_str_to_int64 (str, 10, 0, 0xFF, -1);
+}
+
 const char *
 nmp_utils_ip_config_source_to_string (NMIPConfigSource source, char *buf, gsize len)
 {
@@ -254,6 +254,45 @@ nm_platform_process_events (NMPlatform *self)
 		klass->process_events (self);
 }
 
+/**
+ * nm_platform_batch_begin:
+ * @self: platform instance
+ *
+ * Start a batch of address and route changes. Until the matching
+ * nm_platform_batch_commit(), the add and delete functions only
+ * queue their requests and don't wait for the result. They return
+ * %TRUE unless the request could not be sent.
+ *
+ * Batches can be nested, only the outermost commit completes them.
+ */
+void
+nm_platform_batch_begin (NMPlatform *self)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	if (klass->batch_begin)
+		klass->batch_begin (self);
+}
+
+/**
+ * nm_platform_batch_commit:
+ * @self: platform instance
+ *
+ * Complete a batch started with nm_platform_batch_begin(). This
+ * collects the results of all queued requests at once.
+ *
+ * Returns: %TRUE if all queued requests succeeded.
+ */
+gboolean
+nm_platform_batch_commit (NMPlatform *self)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	if (klass->batch_commit)
+		return klass->batch_commit (self);
+	return TRUE;
+}
+
 /******************************************************************/
 
 /**
@@ -2663,48 +2702,123 @@ nm_platform_ip6_address_get (NMPlatform *self, int ifindex, struct in6_addr addr
 	return klass->ip6_address_get (self, ifindex, address, plen);
 }
 
-static gboolean
-array_contains_ip4_address (const GArray *addresses, const NMPlatformIP4Address *address, gint32 now)
+static GPtrArray *
+_ip_address_get_prune_list (NMPlatform *self,
+                            NMPObjectType obj_type,
+                            int ifindex,
+                            const GArray *known_addresses,
+                            gboolean keep_link_local)
 {
-	guint len = addresses ? addresses->len : 0;
+	const NMPClass *klass = nmp_class_from_type (obj_type);
+	gs_unref_array GArray *addresses = NULL;
+	gs_unref_hashtable GHashTable *known_idx = NULL;
+	gs_free NMPObject *known_objs = NULL;
+	GPtrArray *result = NULL;
+	gint32 now = nm_utils_get_monotonic_timestamp_s ();
 	guint i;
 
-	for (i = 0; i < len; i++) {
-		NMPlatformIP4Address *candidate = &g_array_index (addresses, NMPlatformIP4Address, i);
+	nm_assert (NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS));
+
+	if (obj_type == NMP_OBJECT_TYPE_IP4_ADDRESS)
+		addresses = nm_platform_ip4_address_get_all (self, ifindex);
+	else
+		addresses = nm_platform_ip6_address_get_all (self, ifindex);
+	if (!addresses || addresses->len == 0)
+		return NULL;
 
-		if (   candidate->address == address->address
-		    && candidate->plen == address->plen
-		    && ((candidate->peer_address ^ address->peer_address) & nm_utils_ip4_prefix_to_netmask (address->plen)) == 0) {
+	/* Index the known addresses by their object-id, so that each platform address
+	 * is looked up in constant time. The known addresses might lack the ifindex,
+	 * set it, so that they compare equal to the platform's addresses. */
+	if (known_addresses && known_addresses->len > 0) {
+		known_objs = g_new (NMPObject, known_addresses->len);
+		known_idx = g_hash_table_new ((GHashFunc) nmp_object_id_hash,
+		                              (GEqualFunc) nmp_object_id_equal);
+		for (i = 0; i < known_addresses->len; i++) {
+			const NMPlatformIPAddress *a = (const NMPlatformIPAddress *) &known_addresses->data[i * klass->sizeof_public];
+			NMPObject *obj = &known_objs[i];
 			guint32 lifetime, preferred;
 
-			if (nm_utils_lifetime_get (candidate->timestamp, candidate->lifetime, candidate->preferred,
-			                           now, &lifetime, &preferred))
-				return TRUE;
+			if (!nm_utils_lifetime_get (a->timestamp, a->lifetime, a->preferred,
+			                            now, &lifetime, &preferred))
+				continue;
+
+			nmp_object_stackinit (obj, obj_type, (const NMPlatformObject *) a);
+			obj->object.ifindex = ifindex;
+
+			/* with duplicates, the last one wins as it's also the last one added. */
+			g_hash_table_add (known_idx, obj);
 		}
 	}
 
-	return FALSE;
-}
+	for (i = 0; i < addresses->len; i++) {
+		const NMPlatformIPAddress *a = (const NMPlatformIPAddress *) &addresses->data[i * klass->sizeof_public];
+		const NMPObject *known = NULL;
+		NMPObject obj_id;
 
-static gboolean
-array_contains_ip6_address (const GArray *addresses, const NMPlatformIP6Address *address, gint32 now)
-{
-	guint len = addresses ? addresses->len : 0;
-	guint i;
+		/* Leave link local address management to the kernel */
+		if (   keep_link_local
+		    && obj_type == NMP_OBJECT_TYPE_IP6_ADDRESS
+		    && IN6_IS_ADDR_LINKLOCAL (&((const NMPlatformIP6Address *) a)->address))
+			continue;
 
-	for (i = 0; i < len; i++) {
-		NMPlatformIP6Address *candidate = &g_array_index (addresses, NMPlatformIP6Address, i);
+		if (known_idx) {
+			nmp_object_stackinit (&obj_id, obj_type, (const NMPlatformObject *) a);
+			known = g_hash_table_lookup (known_idx, &obj_id);
+		}
 
-		if (IN6_ARE_ADDR_EQUAL (&candidate->address, &address->address) && candidate->plen == address->plen) {
-			guint32 lifetime, preferred;
+		/* for IPv6 the prefix length is not part of the id, but a differing
+		 * prefix length still means that the address must be replaced. */
+		if (   known
+		    && known->ip_address.plen == a->plen)
+			continue;
 
-			if (nm_utils_lifetime_get (candidate->timestamp, candidate->lifetime, candidate->preferred,
-			                           now, &lifetime, &preferred))
-				return TRUE;
-		}
+		if (!result)
+			result = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+		g_ptr_array_add (result, nmp_object_new (obj_type, (const NMPlatformObject *) a));
 	}
 
-	return FALSE;
+	return result;
+}
+
+/**
+ * nm_platform_ip4_address_get_prune_list:
+ * @self: platform instance
+ * @ifindex: Interface index
+ * @known_addresses: (allow-none): List of addresses
+ *
+ * Determine which of the addresses currently configured on @ifindex
+ * are not (or no longer) in @known_addresses. The cost is linear in the
+ * number of addresses.
+ *
+ * Returns: (transfer full): %NULL if nothing is to be removed or a
+ *   #GPtrArray of #NMPObject instances of the addresses to remove.
+ */
+GPtrArray *
+nm_platform_ip4_address_get_prune_list (NMPlatform *self, int ifindex, const GArray *known_addresses)
+{
+	_CHECK_SELF (self, klass, NULL);
+
+	return _ip_address_get_prune_list (self, NMP_OBJECT_TYPE_IP4_ADDRESS, ifindex, known_addresses, FALSE);
+}
+
+/**
+ * nm_platform_ip6_address_get_prune_list:
+ * @self: platform instance
+ * @ifindex: Interface index
+ * @known_addresses: (allow-none): List of addresses
+ * @keep_link_local: Don't consider link-local addresses
+ *
+ * Like nm_platform_ip4_address_get_prune_list(), for IPv6.
+ *
+ * Returns: (transfer full): %NULL if nothing is to be removed or a
+ *   #GPtrArray of #NMPObject instances of the addresses to remove.
+ */
+GPtrArray *
+nm_platform_ip6_address_get_prune_list (NMPlatform *self, int ifindex, const GArray *known_addresses, gboolean keep_link_local)
+{
+	_CHECK_SELF (self, klass, NULL);
+
+	return _ip_address_get_prune_list (self, NMP_OBJECT_TYPE_IP6_ADDRESS, ifindex, known_addresses, keep_link_local);
 }
 
 /**
@@ -2726,22 +2840,25 @@ array_contains_ip6_address (const GArray *addresses, const NMPlatformIP6Address
 gboolean
 nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, GPtrArray **out_added_addresses)
 {
-	GArray *addresses;
-	NMPlatformIP4Address *address;
+	gs_unref_ptrarray GPtrArray *prune = NULL;
+	gs_unref_ptrarray GPtrArray *added = NULL;
+	const NMPlatformIP4Address *address;
 	gint32 now = nm_utils_get_monotonic_timestamp_s ();
+	gboolean success = TRUE;
 	int i;
 
 	_CHECK_SELF (self, klass, FALSE);
 
 	/* Delete unknown addresses */
-	addresses = nm_platform_ip4_address_get_all (self, ifindex);
-	for (i = 0; i < addresses->len; i++) {
-		address = &g_array_index (addresses, NMPlatformIP4Address, i);
-
-		if (!array_contains_ip4_address (known_addresses, address, now))
+	prune = nm_platform_ip4_address_get_prune_list (self, ifindex, known_addresses);
+	if (prune) {
+		nm_platform_batch_begin (self);
+		for (i = 0; i < prune->len; i++) {
+			address = &((const NMPObject *) prune->pdata[i])->ip4_address;
 			nm_platform_ip4_address_delete (self, ifindex, address->address, address->plen, address->peer_address);
+		}
+		nm_platform_batch_commit (self);
 	}
-	g_array_free (addresses, TRUE);
 
 	if (out_added_addresses)
 		*out_added_addresses = NULL;
@@ -2750,6 +2867,7 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 		return TRUE;
 
 	/* Add missing addresses */
+	nm_platform_batch_begin (self);
 	for (i = 0; i < known_addresses->len; i++) {
 		const NMPlatformIP4Address *known_address = &g_array_index (known_addresses, NMPlatformIP4Address, i);
 		guint32 lifetime, preferred;
@@ -2760,17 +2878,35 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 
 		if (!nm_platform_ip4_address_add (self, ifindex, known_address->address, known_address->plen,
 		                                  known_address->peer_address, lifetime, preferred,
-		                                  0, known_address->label))
-			return FALSE;
+		                                  0, known_address->label)) {
+			success = FALSE;
+			break;
+		}
 
 		if (out_added_addresses) {
-			if (!*out_added_addresses)
-				*out_added_addresses = g_ptr_array_new ();
-			g_ptr_array_add (*out_added_addresses, (gpointer) known_address);
+			if (!added)
+				added = g_ptr_array_new ();
+			g_ptr_array_add (added, (gpointer) known_address);
 		}
 	}
 
-	return TRUE;
+	if (!nm_platform_batch_commit (self)) {
+		success = FALSE;
+
+		/* the requests were only queued. Don't report the addresses
+		 * that the kernel rejected when the batch was committed. */
+		for (i = 0; added && i < added->len; ) {
+			address = added->pdata[i];
+			if (nm_platform_ip4_address_get (self, ifindex, address->address, address->plen, address->peer_address))
+				i++;
+			else
+				g_ptr_array_remove_index (added, i);
+		}
+	}
+
+	if (out_added_addresses && added && added->len > 0)
+		*out_added_addresses = g_steal_pointer (&added);
+	return success;
 }
 
 /**
@@ -2789,29 +2925,28 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 gboolean
 nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, gboolean keep_link_local)
 {
-	GArray *addresses;
-	NMPlatformIP6Address *address;
+	gs_unref_ptrarray GPtrArray *prune = NULL;
+	const NMPlatformIP6Address *address;
 	gint32 now = nm_utils_get_monotonic_timestamp_s ();
+	gboolean success = TRUE;
 	int i;
 
 	/* Delete unknown addresses */
-	addresses = nm_platform_ip6_address_get_all (self, ifindex);
-	for (i = 0; i < addresses->len; i++) {
-		address = &g_array_index (addresses, NMPlatformIP6Address, i);
-
-		/* Leave link local address management to the kernel */
-		if (keep_link_local && IN6_IS_ADDR_LINKLOCAL (&address->address))
-			continue;
-
-		if (!array_contains_ip6_address (known_addresses, address, now))
+	prune = nm_platform_ip6_address_get_prune_list (self, ifindex, known_addresses, keep_link_local);
+	if (prune) {
+		nm_platform_batch_begin (self);
+		for (i = 0; i < prune->len; i++) {
+			address = &((const NMPObject *) prune->pdata[i])->ip6_address;
 			nm_platform_ip6_address_delete (self, ifindex, address->address, address->plen);
+		}
+		nm_platform_batch_commit (self);
 	}
-	g_array_free (addresses, TRUE);
 
 	if (!known_addresses)
 		return TRUE;
 
 	/* Add missing addresses */
+	nm_platform_batch_begin (self);
 	for (i = 0; i < known_addresses->len; i++) {
 		const NMPlatformIP6Address *known_address = &g_array_index (known_addresses, NMPlatformIP6Address, i);
 		guint32 lifetime, preferred;
@@ -2822,11 +2957,15 @@ nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known
 
 		if (!nm_platform_ip6_address_add (self, ifindex, known_address->address,
 		                                  known_address->plen, known_address->peer_address,
-		                                  lifetime, preferred, known_address->n_ifa_flags))
-			return FALSE;
+		                                  lifetime, preferred, known_address->n_ifa_flags)) {
+			success = FALSE;
+			break;
+		}
 	}
 
-	return TRUE;
+	if (!nm_platform_batch_commit (self))
+		success = FALSE;
+	return success;
 }
 
 gboolean
@@ -202,6 +202,194 @@ nmp_class_from_type (NMPObjectType obj_type)
 	return &_nmp_classes[obj_type - 1];
 }
 
+/******************************************************************
+ * Slab pools for NMPObject.
+ *
+ * With many routes in the cache, allocating each object separately
+ * has a notable overhead and poor locality. Instead, each object type
+ * has a pool of slabs. A slab is aligned to its size, so that the slab
+ * header can be found from the object pointer. Empty slabs are returned
+ * to the system, except one per pool to avoid trashing.
+ *
+ * Objects that can be cached are followed by the ids under which NMPCache
+ * indexes them (see _nmp_object_get_cache_ids()), so that the reverse
+ * index of NMMultiIndex needs no separate allocation per object.
+ *
+ * The pools are not thread safe. NMPObject instances are only used
+ * on the main thread.
+ ******************************************************************/
+
+#define NMP_SLAB_SIZE   ((gsize) 16384)
+
+typedef struct _NMPSlab NMPSlab;
+
+struct _NMPSlab {
+	/* list of the slabs of a pool that have unused objects. */
+	NMPSlab *next;
+	NMPSlab *prev;
+
+	/* the free objects are linked by their first pointer. */
+	gpointer free_list;
+	guint n_used;
+	guint n_objects;
+};
+
+typedef struct {
+	NMPSlab *partial;
+	gsize obj_size;
+	gsize cache_ids_offset;
+	guint n_slabs;
+	guint n_used;
+} NMPObjectPool;
+
+static NMPObjectPool _nmp_object_pools[NMP_OBJECT_TYPE_MAX];
+
+#define NMP_SLAB_HEADER_SIZE  (((sizeof (NMPSlab) + 15) / 16) * 16)
+
+static NMPObjectPool *
+_nmp_object_pool_get (const NMPClass *klass)
+{
+	NMPObjectPool *pool = &_nmp_object_pools[klass->obj_type - 1];
+
+	if (G_UNLIKELY (!pool->obj_size)) {
+		pool->obj_size = klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object);
+		pool->obj_size = ((pool->obj_size + sizeof (gpointer) - 1) / sizeof (gpointer)) * sizeof (gpointer);
+		pool->cache_ids_offset = pool->obj_size;
+		if (klass->max_cache_ids)
+			pool->obj_size += (klass->max_cache_ids + 1) * sizeof (gpointer);
+		nm_assert (pool->obj_size <= (NMP_SLAB_SIZE - NMP_SLAB_HEADER_SIZE) / 4);
+	}
+	return pool;
+}
+
+static void
+_nmp_slab_link (NMPObjectPool *pool, NMPSlab *slab)
+{
+	slab->prev = NULL;
+	slab->next = pool->partial;
+	if (pool->partial)
+		pool->partial->prev = slab;
+	pool->partial = slab;
+}
+
+static void
+_nmp_slab_unlink (NMPObjectPool *pool, NMPSlab *slab)
+{
+	if (slab->prev)
+		slab->prev->next = slab->next;
+	else
+		pool->partial = slab->next;
+	if (slab->next)
+		slab->next->prev = slab->prev;
+	slab->next = NULL;
+	slab->prev = NULL;
+}
+
+static NMPSlab *
+_nmp_slab_new (NMPObjectPool *pool)
+{
+	NMPSlab *slab;
+	gpointer mem;
+	char *p;
+	guint i;
+
+	if (posix_memalign (&mem, NMP_SLAB_SIZE, NMP_SLAB_SIZE) != 0)
+		g_error ("%s: failed to allocate %"G_GSIZE_FORMAT" bytes", G_STRLOC, NMP_SLAB_SIZE);
+
+	slab = mem;
+	slab->n_used = 0;
+	slab->n_objects = (NMP_SLAB_SIZE - NMP_SLAB_HEADER_SIZE) / pool->obj_size;
+	slab->free_list = NULL;
+
+	p = &((char *) mem)[NMP_SLAB_HEADER_SIZE];
+	for (i = slab->n_objects; i > 0; i--) {
+		gpointer obj = &p[(i - 1) * pool->obj_size];
+
+		*((gpointer *) obj) = slab->free_list;
+		slab->free_list = obj;
+	}
+
+	pool->n_slabs++;
+	_nmp_slab_link (pool, slab);
+	return slab;
+}
+
+static gpointer
+_nmp_object_pool_alloc0 (NMPObjectPool *pool)
+{
+	NMPSlab *slab;
+	gpointer obj;
+
+	slab = pool->partial ?: _nmp_slab_new (pool);
+
+	obj = slab->free_list;
+	slab->free_list = *((gpointer *) obj);
+	slab->n_used++;
+	pool->n_used++;
+	if (!slab->free_list)
+		_nmp_slab_unlink (pool, slab);
+
+	memset (obj, 0, pool->obj_size);
+	return obj;
+}
+
+static void
+_nmp_object_pool_free (NMPObjectPool *pool, gpointer obj)
+{
+	NMPSlab *slab = (NMPSlab *) (((gsize) obj) & ~(NMP_SLAB_SIZE - 1));
+
+	nm_assert (slab->n_used > 0);
+
+	if (!slab->free_list)
+		_nmp_slab_link (pool, slab);
+	*((gpointer *) obj) = slab->free_list;
+	slab->free_list = obj;
+	slab->n_used--;
+	pool->n_used--;
+
+	if (   slab->n_used == 0
+	    && (slab->next || slab->prev)) {
+		/* keep the last slab of the pool around. */
+		_nmp_slab_unlink (pool, slab);
+		pool->n_slabs--;
+		free (slab);
+	}
+}
+
+/**
+ * nmp_object_pool_get_stats:
+ * @obj_type: the object type
+ * @out_n_objects: (allow-none): the number of allocated objects
+ * @out_n_bytes: (allow-none): the number of bytes allocated for
+ *   the pool of @obj_type.
+ */
+void
+nmp_object_pool_get_stats (NMPObjectType obj_type, guint *out_n_objects, gsize *out_n_bytes)
+{
+	const NMPObjectPool *pool;
+
+	g_return_if_fail (obj_type > NMP_OBJECT_TYPE_UNKNOWN && obj_type <= NMP_OBJECT_TYPE_MAX);
+
+	pool = &_nmp_object_pools[obj_type - 1];
+	NM_SET_OUT (out_n_objects, pool->n_used);
+	NM_SET_OUT (out_n_bytes, pool->n_slabs * NMP_SLAB_SIZE);
+}
+
+/* The NMMultiIndexFuncReverse of NMPCache:idx_multi. The ids follow
+ * the object data and are zeroed by _nmp_object_pool_alloc0(). */
+static const NMMultiIndexId **
+_nmp_object_get_cache_ids (gconstpointer value, guint *out_alloc)
+{
+	const NMPObject *obj = NMP_OBJECT_UP_CAST (value);
+	const NMPClass *klass = NMP_OBJECT_GET_CLASS (obj);
+
+	nm_assert (!NMP_OBJECT_IS_STACKINIT (obj));
+	nm_assert (klass->max_cache_ids > 0);
+
+	*out_alloc = klass->max_cache_ids;
+	return (const NMMultiIndexId **) &((char *) obj)[_nmp_object_pool_get (klass)->cache_ids_offset];
+}
+
 /******************************************************************/
 
 NMPObject *
@@ -231,7 +419,7 @@ nmp_object_unref (NMPObject *obj)
 			nm_assert (!obj->is_cached);
 			if (klass->cmd_obj_dispose)
 				klass->cmd_obj_dispose (obj);
-			g_slice_free1 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object), obj);
+			_nmp_object_pool_free (_nmp_object_pool_get (klass), obj);
 		}
 	}
 }
@@ -259,7 +447,7 @@ _nmp_object_new_from_class (const NMPClass *klass)
 	nm_assert (klass->sizeof_data > 0);
 	nm_assert (klass->sizeof_public > 0 && klass->sizeof_public <= klass->sizeof_data);
 
-	obj = g_slice_alloc0 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object));
+	obj = _nmp_object_pool_alloc0 (_nmp_object_pool_get (klass));
 	obj->_class = klass;
 	obj->_ref_count = 1;
 	_LOGt (obj, "new");
@@ -1211,6 +1399,8 @@ _vt_cmd_obj_init_cache_id_ipx_address (const NMPObject *obj, NMPCacheIdType id_t
 	return TRUE;
 }
 
+/* a visible route is either a default route or not, so a route is indexed
+ * by at most 6 of these ids (NMPClass:max_cache_ids). */
 static const guint8 _supported_cache_ids_ip4_route[] = {
 	NMP_CACHE_ID_TYPE_OBJECT_TYPE,
 	NMP_CACHE_ID_TYPE_OBJECT_TYPE_VISIBLE_ONLY,
@@ -1627,34 +1817,67 @@ _nmp_cache_update_remove (NMPCache *cache, NMPObject *obj)
 	nm_assert (obj->is_cached);
 	_nmp_cache_update_cache (cache, obj, TRUE);
 	obj->is_cached = FALSE;
+	nm_assert (!nm_multi_index_lookup_first_by_value (cache->idx_multi, &obj->object));
+
+	/* @obj is possibly a dangling pointer after this. */
 	if (!g_hash_table_remove (cache->idx_main, obj))
 		g_assert_not_reached ();
-
-	/* @obj is possibly a dangling pointer at this point. No problem, multi-index doesn't dereference. */
-	nm_assert (!nm_multi_index_lookup_first_by_value (cache->idx_multi, &obj->object));
 }
 
+/* Bring the multi index in sync with the (modified) content of the cached @obj.
+ *
+ * The ids under which @obj is currently indexed are found via the reverse
+ * index of NMMultiIndex, so they don't need to be recomputed from the previous
+ * content. Ids that didn't change are not touched, thus an update that only
+ * modifies attributes (like statistics, flags or lifetimes) does not need any
+ * hashing. */
 static void
-_nmp_cache_update_update (NMPCache *cache, NMPObject *obj, const NMPObject *new)
+_nmp_cache_update_reindex (NMPCache *cache, NMPObject *obj)
 {
+	const NMPCacheId *cache_ids_old[__NMP_CACHE_ID_TYPE_MAX] = { NULL };
+	const NMMultiIndexId *const*ids;
 	const guint8 *id_type;
+	guint i, len;
 
-	nm_assert (NMP_OBJECT_GET_CLASS (obj) == NMP_OBJECT_GET_CLASS (new));
 	nm_assert (obj->is_cached);
-	nm_assert (!new->is_cached);
+
+	ids = nm_multi_index_lookup_ids_by_value (cache->idx_multi, &obj->object, &len);
+	for (i = 0; i < len; i++) {
+		const NMPCacheId *cache_id = (const NMPCacheId *) ids[i];
+
+		nm_assert (cache_id->_id_type < __NMP_CACHE_ID_TYPE_MAX);
+		nm_assert (!cache_ids_old[cache_id->_id_type]);
+		cache_ids_old[cache_id->_id_type] = cache_id;
+	}
 
 	for (id_type = NMP_OBJECT_GET_CLASS (obj)->supported_cache_ids; *id_type; id_type++) {
-		NMPCacheId cache_id_storage_obj, cache_id_storage_new;
-		const NMPCacheId *cache_id_obj, *cache_id_new;
+		NMPCacheId cache_id_storage;
+		const NMPCacheId *cache_id_old, *cache_id_new;
 
-		if (!_nmp_object_init_cache_id (obj, *id_type, &cache_id_storage_obj, &cache_id_obj))
+		if (!_nmp_object_init_cache_id (obj, *id_type, &cache_id_storage, &cache_id_new))
 			continue;
-		if (!_nmp_object_init_cache_id (new, *id_type, &cache_id_storage_new, &cache_id_new))
-			g_assert_not_reached ();
-		if (!nm_multi_index_move (cache->idx_multi, (NMMultiIndexId *) cache_id_obj, (NMMultiIndexId *) cache_id_new, &obj->object))
+
+		cache_id_old = cache_ids_old[*id_type];
+		if (   cache_id_old
+		    && cache_id_new
+		    && nmp_cache_id_equal (cache_id_old, cache_id_new))
+			continue;
+
+		if (!nm_multi_index_move (cache->idx_multi, (NMMultiIndexId *) cache_id_old, (NMMultiIndexId *) cache_id_new, &obj->object))
 			g_assert_not_reached ();
 	}
+}
+
+static void
+_nmp_cache_update_update (NMPCache *cache, NMPObject *obj, const NMPObject *new)
+{
+	nm_assert (NMP_OBJECT_GET_CLASS (obj) == NMP_OBJECT_GET_CLASS (new));
+	nm_assert (obj->is_cached);
+	nm_assert (!new->is_cached);
+
+	/* update the cached instance in place. */
 	nmp_object_copy (obj, new, FALSE);
+	_nmp_cache_update_reindex (cache, obj);
 }
 
 NMPCacheOpsType
@@ -1805,23 +2028,16 @@ nmp_cache_update_netlink (NMPCache *cache, NMPObject *obj, NMPObject **out_obj,
 		_nmp_cache_update_add (cache, obj);
 		return NMP_CACHE_OPS_ADDED;
 	} else if (old == obj) {
-		/* updating a cached object inplace is not supported because the object contributes to hash-key
-		 * for NMMultiIndex. Modifying an object that is inside NMMultiIndex means that these
-		 * keys change.
-		 * The problem is, that for a given object NMMultiIndex does not support (efficient)
-		 * reverse lookup to get all the NMPCacheIds to which it belongs. If that would be implemented,
-		 * it would be possible to implement inplace-update.
+		/* The cache updates its instances in place (see _nmp_cache_update_update()),
+		 * using the reverse index of NMMultiIndex to find the ids under which
+		 * the object is indexed.
 		 *
-		 * There is an un-optimized reverse lookup via nm_multi_index_iter_init(), but we don't want
-		 * that because we might have a large number of indexes to search.
+		 * However, the caller must not modify a cached object and pass it
+		 * back here. The @pre_hook needs to see the previous and the new
+		 * content, and we need to compare them to find out whether anything
+		 * changed at all. Instead, create a new instance from netlink.
 		 *
-		 * We could add efficient reverse lookup by adding a reverse index to NMMultiIndex. But that
-		 * also adds some cost to support an (uncommon?) usage pattern.
-		 *
-		 * Instead we just don't support it, instead we expect the user to
-		 * create a new instance from netlink.
-		 *
-		 * TL;DR: a cached object must never be modified.
+		 * TL;DR: a cached object must never be modified by the user.
 		 */
 		g_assert_not_reached ();
 	} else {
@@ -2003,7 +2219,8 @@ nmp_cache_new (gboolean use_udev)
 	cache->idx_multi = nm_multi_index_new ((NMMultiIndexFuncHash) nmp_cache_id_hash,
 	                                       (NMMultiIndexFuncEqual) nmp_cache_id_equal,
 	                                       (NMMultiIndexFuncClone) nmp_cache_id_clone,
-	                                       (NMMultiIndexFuncDestroy) nmp_cache_id_destroy);
+	                                       (NMMultiIndexFuncDestroy) nmp_cache_id_destroy,
+	                                       _nmp_object_get_cache_ids);
 	cache->use_udev = !!use_udev;
 	return cache;
 }
@@ -2049,6 +2266,7 @@ ASSERT_nmp_cache_is_consistent (const NMPCache *cache)
 	g_hash_table_iter_init (&iter_hash, cache->idx_main);
 	while (g_hash_table_iter_next (&iter_hash, (gpointer *) &obj, NULL)) {
 		const guint8 *id_type;
+		guint n_ids = 0;
 
 		g_assert (NMP_OBJECT_IS_VALID (obj));
 		g_assert (nmp_object_is_alive (obj));
@@ -2059,7 +2277,12 @@ ASSERT_nmp_cache_is_consistent (const NMPCache *cache)
 			if (!cache_id)
 				continue;
 			g_assert (nm_multi_index_contains (cache->idx_multi, &cache_id->base, &obj->object));
+			n_ids++;
 		}
+
+		nm_multi_index_lookup_ids_by_value (cache->idx_multi, &obj->object, &len);
+		g_assert_cmpint (len, ==, n_ids);
+		g_assert_cmpint (len, <=, NMP_OBJECT_GET_CLASS (obj)->max_cache_ids);
 	}
 
 	nm_multi_index_iter_init (&iter_multi, cache->idx_multi, NULL);
@@ -2101,6 +2324,7 @@ const NMPClass _nmp_classes[NMP_OBJECT_TYPE_MAX] = {
 		.signal_type_id                     = NM_PLATFORM_SIGNAL_ID_LINK,
 		.signal_type                        = NM_PLATFORM_SIGNAL_LINK_CHANGED,
 		.supported_cache_ids                = _supported_cache_ids_link,
+		.max_cache_ids                      = 3,
 		.cmd_obj_init_cache_id              = _vt_cmd_obj_init_cache_id_link,
 		.cmd_obj_cmp                        = _vt_cmd_obj_cmp_link,
 		.cmd_obj_copy                       = _vt_cmd_obj_copy_link,
@@ -2126,6 +2350,7 @@ const NMPClass _nmp_classes[NMP_OBJECT_TYPE_MAX] = {
 		.signal_type_id                     = NM_PLATFORM_SIGNAL_ID_IP4_ADDRESS,
 		.signal_type                        = NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED,
 		.supported_cache_ids                = _supported_cache_ids_ipx_address,
+		.max_cache_ids                      = 3,
 		.cmd_obj_init_cache_id              = _vt_cmd_obj_init_cache_id_ipx_address,
 		.cmd_obj_stackinit_id               = _vt_cmd_obj_stackinit_id_ip4_address,
 		.cmd_obj_is_alive                   = _vt_cmd_obj_is_alive_ipx_address,
@@ -2146,6 +2371,7 @@ const NMPClass _nmp_classes[NMP_OBJECT_TYPE_MAX] = {
 		.signal_type_id                     = NM_PLATFORM_SIGNAL_ID_IP6_ADDRESS,
 		.signal_type                        = NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED,
 		.supported_cache_ids                = _supported_cache_ids_ipx_address,
+		.max_cache_ids                      = 3,
 		.cmd_obj_init_cache_id              = _vt_cmd_obj_init_cache_id_ipx_address,
 		.cmd_obj_stackinit_id               = _vt_cmd_obj_stackinit_id_ip6_address,
 		.cmd_obj_is_alive                   = _vt_cmd_obj_is_alive_ipx_address,
@@ -2166,6 +2392,7 @@ const NMPClass _nmp_classes[NMP_OBJECT_TYPE_MAX] = {
 		.signal_type_id                     = NM_PLATFORM_SIGNAL_ID_IP4_ROUTE,
 		.signal_type                        = NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED,
 		.supported_cache_ids                = _supported_cache_ids_ip4_route,
+		.max_cache_ids                      = 6,
 		.cmd_obj_init_cache_id              = _vt_cmd_obj_init_cache_id_ipx_route,
 		.cmd_obj_stackinit_id               = _vt_cmd_obj_stackinit_id_ip4_route,
 		.cmd_obj_is_alive                   = _vt_cmd_obj_is_alive_ipx_route,
@@ -2186,6 +2413,7 @@ const NMPClass _nmp_classes[NMP_OBJECT_TYPE_MAX] = {
 		.signal_type_id                     = NM_PLATFORM_SIGNAL_ID_IP6_ROUTE,
 		.signal_type                        = NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED,
 		.supported_cache_ids                = _supported_cache_ids_ip6_route,
+		.max_cache_ids                      = 6,
 		.cmd_obj_init_cache_id              = _vt_cmd_obj_init_cache_id_ipx_route,
 		.cmd_obj_stackinit_id               = _vt_cmd_obj_stackinit_id_ip6_route,
 		.cmd_obj_is_alive                   = _vt_cmd_obj_is_alive_ipx_route,
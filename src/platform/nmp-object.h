@@ -153,6 +153,11 @@ typedef struct {
 
 	const guint8 *supported_cache_ids;
 
+	/* the maximum number of @supported_cache_ids under which an object can
+	 * be indexed at the same time. The cache keeps these ids inline, after
+	 * the object data. */
+	guint8 max_cache_ids;
+
 	/* Only for NMPObjectLnk* types. */
 	NMLinkType lnk_link_type;
 
@@ -364,6 +369,7 @@ const NMPClass *nmp_class_from_type (NMPObjectType obj_type);
 
 NMPObject *nmp_object_ref (NMPObject *object);
 void nmp_object_unref (NMPObject *object);
+void nmp_object_pool_get_stats (NMPObjectType obj_type, guint *out_n_objects, gsize *out_n_bytes);
 NMPObject *nmp_object_new (NMPObjectType obj_type, const NMPlatformObject *plob);
 NMPObject *nmp_object_new_link (int ifindex);
 
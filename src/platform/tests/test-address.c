@@ -354,6 +354,110 @@ test_ip4_address_peer_zero (void)
 
 /*****************************************************************************/
 
+#define SYNC_N_ADDRESSES 64
+
+static void
+test_ip4_address_sync (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+	gs_unref_array GArray *known = NULL;
+	GArray *addrs;
+	NMPlatformIP4Address a;
+	int i;
+
+	g_assert (ifindex > 0);
+	g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, ifindex, NULL));
+
+	known = g_array_new (FALSE, FALSE, sizeof (NMPlatformIP4Address));
+	for (i = 0; i < SYNC_N_ADDRESSES; i++) {
+		memset (&a, 0, sizeof (a));
+		a.ifindex = ifindex;
+		a.address = htonl (0x0a300000 + i + 1);
+		a.peer_address = a.address;
+		a.plen = 16;
+		a.lifetime = NM_PLATFORM_LIFETIME_PERMANENT;
+		a.preferred = NM_PLATFORM_LIFETIME_PERMANENT;
+		g_array_append_val (known, a);
+	}
+
+	/* all addresses are added in one batch. */
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known, NULL));
+	addrs = nm_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (addrs->len, ==, SYNC_N_ADDRESSES);
+	g_array_unref (addrs);
+
+	/* drop every other address, the remaining ones must stay. */
+	for (i = SYNC_N_ADDRESSES - 1; i >= 0; i -= 2)
+		g_array_remove_index (known, i);
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known, NULL));
+	addrs = nm_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (addrs->len, ==, SYNC_N_ADDRESSES / 2);
+	g_array_unref (addrs);
+	for (i = 0; i < known->len; i++) {
+		const NMPlatformIP4Address *k = &g_array_index (known, NMPlatformIP4Address, i);
+
+		g_assert (nm_platform_ip4_address_get (NM_PLATFORM_GET, ifindex, k->address, k->plen, k->peer_address));
+	}
+
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, NULL, NULL));
+	addrs = nm_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (addrs->len, ==, 0);
+	g_array_unref (addrs);
+}
+
+static void
+test_ip4_address_prune_benchmark (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+	const guint n_addresses = nmtst_test_quick () ? 2000 : 10000;
+	const guint n_rounds = 10;
+	gs_unref_array GArray *known = NULL;
+	GPtrArray *prune;
+	NMPlatformIP4Address a;
+	gint64 start_time, time;
+	guint i;
+
+	if (!NM_IS_FAKE_PLATFORM (NM_PLATFORM_GET)) {
+		g_test_skip ("Benchmark only runs with the fake platform");
+		return;
+	}
+
+	known = g_array_new (FALSE, FALSE, sizeof (NMPlatformIP4Address));
+	for (i = 0; i < n_addresses; i++) {
+		memset (&a, 0, sizeof (a));
+		a.address = htonl (0x0a400000 + i + 1);
+		a.peer_address = a.address;
+		a.plen = 10;
+		a.lifetime = NM_PLATFORM_LIFETIME_PERMANENT;
+		a.preferred = NM_PLATFORM_LIFETIME_PERMANENT;
+		g_assert (nm_platform_ip4_address_add (NM_PLATFORM_GET, ifindex, a.address, a.plen, a.peer_address,
+		                                       a.lifetime, a.preferred, 0, NULL));
+
+		/* every fourth address is unknown and must be pruned. */
+		if (i % 4 != 0)
+			g_array_append_val (known, a);
+	}
+
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+	for (i = 0; i < n_rounds; i++) {
+		prune = nm_platform_ip4_address_get_prune_list (NM_PLATFORM_GET, ifindex, known);
+		g_assert (prune);
+		g_assert_cmpint (prune->len, ==, (n_addresses + 3) / 4);
+		g_ptr_array_unref (prune);
+	}
+	time = nm_utils_get_monotonic_timestamp_ns () - start_time;
+
+	_LOGI (">>> prune list of %u addresses computed %u times in %ld.%09ld seconds",
+	       n_addresses, n_rounds,
+	       (long) (time / NM_UTILS_NS_PER_SECOND), (long) (time % NM_UTILS_NS_PER_SECOND));
+
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known, NULL));
+	prune = nm_platform_ip4_address_get_prune_list (NM_PLATFORM_GET, ifindex, known);
+	g_assert (!prune);
+}
+
+/*****************************************************************************/
+
 void
 _nmtstp_init_tests (int *argc, char ***argv)
 {
@@ -422,4 +526,7 @@ _nmtstp_setup_tests (void)
 
 	_g_test_add_func ("/address/ipv4/peer", test_ip4_address_peer);
 	_g_test_add_func ("/address/ipv4/peer/zero", test_ip4_address_peer_zero);
+
+	_g_test_add_func ("/address/ipv4/sync", test_ip4_address_sync);
+	_g_test_add_func ("/address/ipv4/prune-benchmark", test_ip4_address_prune_benchmark);
 }
@@ -20,10 +20,12 @@
 
 #include "nm-default.h"
 
+#include <unistd.h>
 #include <linux/rtnetlink.h>
 
 #include "nm-platform-utils.h"
 #include "nm-linux-platform.h"
+#include "nmp-netns.h"
 
 #include "nm-test-utils-core.h"
 
@@ -53,6 +55,134 @@ test_link_get_all (void)
 
 /******************************************************************/
 
+static void
+test_netlink_stats (void)
+{
+	gs_unref_object NMPlatform *platform = NULL;
+	NMLinuxPlatformNetlinkStats stats;
+
+	platform = nm_linux_platform_new (NM_PLATFORM_NETNS_SUPPORT_DEFAULT);
+
+	/* populating the cache reads the dumps from netlink. */
+	nm_linux_platform_get_netlink_stats (platform, &stats);
+	g_assert_cmpint (stats.n_wakeups, >, 0);
+	g_assert_cmpint (stats.n_datagrams, >, 0);
+	g_assert_cmpint (stats.n_messages, >=, stats.n_datagrams);
+	g_assert_cmpint (stats.n_bytes, >=, stats.n_messages * sizeof (struct nlmsghdr));
+	g_assert_cmpint (stats.last_datagrams, >, 0);
+	g_assert_cmpint (stats.last_datagrams, <=, stats.n_datagrams);
+}
+
+static void
+test_netlink_rcvbuf (void)
+{
+	gs_unref_object NMPlatform *platform = NULL;
+	NMLinuxPlatformNetlinkStats stats;
+
+	platform = nm_linux_platform_new (NM_PLATFORM_NETNS_SUPPORT_DEFAULT);
+
+	nm_linux_platform_get_netlink_stats (platform, &stats);
+	g_assert_cmpint (stats.rcvbuf_size, >, 0);
+	g_assert_cmpint (stats.rcvbuf_size_max, >=, 8 * 1024 * 1024);
+	g_assert_cmpint (stats.n_overruns, ==, 0);
+	g_assert_cmpint (stats.n_resyncs, ==, 0);
+
+	/* the ceiling cannot go below the initial size of 8 MiB. */
+	nm_linux_platform_set_netlink_rcvbuf_max (platform, 1024 * 1024);
+	nm_linux_platform_get_netlink_stats (platform, &stats);
+	g_assert_cmpint (stats.rcvbuf_size_max, ==, 8 * 1024 * 1024);
+	g_assert_cmpint (stats.rcvbuf_size, <=, 2 * 8 * 1024 * 1024);
+
+	/* a ceiling above the minimum is taken as is. */
+	nm_linux_platform_set_netlink_rcvbuf_max (platform, 16 * 1024 * 1024);
+	nm_linux_platform_get_netlink_stats (platform, &stats);
+	g_assert_cmpint (stats.rcvbuf_size_max, ==, 16 * 1024 * 1024);
+
+	/* zero selects the default again. */
+	nm_linux_platform_set_netlink_rcvbuf_max (platform, 0);
+	nm_linux_platform_get_netlink_stats (platform, &stats);
+	g_assert_cmpint (stats.rcvbuf_size_max, >=, 8 * 1024 * 1024);
+}
+
+static void
+test_rtprot_from_string (void)
+{
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("kernel"), ==, RTPROT_KERNEL);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("zebra"), ==, RTPROT_ZEBRA);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("BIRD"), ==, RTPROT_BIRD);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("bgp"), ==, 186);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("186"), ==, 186);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("255"), ==, 255);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("256"), ==, -1);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("foo"), ==, -1);
+	g_assert_cmpint (nmp_utils_rtprot_from_string (""), ==, -1);
+}
+
+static void
+test_route_protocols_ignore (void)
+{
+	gs_unref_object NMPlatform *platform = NULL;
+	gs_unref_object NMPNetns *netns = NULL;
+	const guint8 protocols[] = { RTPROT_ZEBRA, RTPROT_BIRD, 186 };
+	const NMPlatformLink *plink = NULL;
+	in_addr_t network_zebra = nmtst_inet4_from_string ("198.51.100.0");
+	in_addr_t network_static = nmtst_inet4_from_string ("203.0.113.0");
+	const NMPlatformIP4Route *r;
+	GArray *routes;
+	guint i;
+	int ifindex;
+
+	if (geteuid () != 0) {
+		g_test_skip ("Creating a network namespace requires root");
+		return;
+	}
+
+	/* the platform instance stays bound to the namespace it was created in. */
+	netns = nmp_netns_new ();
+	g_assert (NMP_IS_NETNS (netns));
+	platform = nm_linux_platform_new (TRUE);
+	nmp_netns_pop (netns);
+
+	g_assert (nm_platform_link_dummy_add (platform, "dummy-rtprot", &plink) == NM_PLATFORM_ERROR_SUCCESS);
+	g_assert (plink);
+	ifindex = plink->ifindex;
+	g_assert (nm_platform_link_set_up (platform, ifindex, NULL));
+
+	/* a route of a routing daemon is cached, as long as it is not ignored. */
+	g_assert (nm_platform_ip4_route_add (platform, ifindex, NM_IP_CONFIG_SOURCE_RTPROT_UNSPEC + RTPROT_ZEBRA,
+	                                     network_zebra, 24, INADDR_ANY, 0, 100, 0));
+	r = nm_platform_ip4_route_get (platform, ifindex, network_zebra, 24, 100);
+	g_assert (r);
+	g_assert_cmpint (nmp_utils_ip_config_source_coerce_to_rtprot (r->rt_source), ==, RTPROT_ZEBRA);
+
+	g_assert (nm_platform_ip4_route_add (platform, ifindex, NM_IP_CONFIG_SOURCE_RTPROT_STATIC,
+	                                     network_static, 24, INADDR_ANY, 0, 100, 0));
+
+	/* ignoring the protocol prunes it from the cache, but keeps the others. */
+	nm_linux_platform_set_route_protocols_ignore (platform, protocols, G_N_ELEMENTS (protocols));
+
+	g_assert (!nm_platform_ip4_route_get (platform, ifindex, network_zebra, 24, 100));
+	g_assert (nm_platform_ip4_route_get (platform, ifindex, network_static, 24, 100));
+
+	routes = nm_platform_ip4_route_get_all (platform, 0,
+	                                        NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT |
+	                                        NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT |
+	                                        NM_PLATFORM_GET_ROUTE_FLAGS_WITH_RTPROT_KERNEL);
+	for (i = 0; i < routes->len; i++) {
+		r = &g_array_index (routes, NMPlatformIP4Route, i);
+		g_assert (!NM_IN_SET (nmp_utils_ip_config_source_coerce_to_rtprot (r->rt_source), RTPROT_ZEBRA, RTPROT_BIRD, 186));
+	}
+	g_array_unref (routes);
+
+	/* the route is still in the kernel, so it is back after disabling the filter. */
+	nm_linux_platform_set_route_protocols_ignore (platform, NULL, 0);
+	g_assert (nm_platform_ip4_route_get (platform, ifindex, network_zebra, 24, 100));
+
+	g_assert (nm_platform_link_delete (platform, ifindex));
+}
+
+/******************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -62,6 +192,10 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/general/init_linux_platform", test_init_linux_platform);
 	g_test_add_func ("/general/link_get_all", test_link_get_all);
+	g_test_add_func ("/general/netlink_stats", test_netlink_stats);
+	g_test_add_func ("/general/netlink_rcvbuf", test_netlink_rcvbuf);
+	g_test_add_func ("/general/rtprot_from_string", test_rtprot_from_string);
+	g_test_add_func ("/general/route_protocols_ignore", test_route_protocols_ignore);
 
 	return g_test_run ();
 }
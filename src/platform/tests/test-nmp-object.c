@@ -382,6 +382,137 @@ test_cache_link (void)
 	nmp_cache_free (cache);
 }
 
+static void
+test_cache_link_rename (void)
+{
+	NMPCache *cache;
+	NMPObject *obj1, *obj2;
+	gboolean was_visible;
+	NMPCacheId cache_id_storage;
+	const NMPlatformObject *const *objects;
+	guint len;
+
+	cache = nmp_cache_new (FALSE);
+
+	obj1 = nmp_object_new (NMP_OBJECT_TYPE_LINK, (NMPlatformObject *) &pl_link_2);
+	obj1->_link.netlink.is_in_netlink = TRUE;
+	_nmp_cache_update_netlink (cache, obj1, &obj2, &was_visible, NMP_CACHE_OPS_ADDED);
+	ASSERT_nmp_cache_is_consistent (cache);
+	_assert_cache_multi_lookup_contains (cache, nmp_cache_id_init_link_by_ifname (&cache_id_storage, "eth0"), obj2, TRUE);
+	nmp_object_unref (obj1);
+	nmp_object_unref (obj2);
+
+	/* renaming the link moves the cached instance to the new ifname index. */
+	obj1 = nmp_object_new (NMP_OBJECT_TYPE_LINK, (NMPlatformObject *) &pl_link_2);
+	obj1->_link.netlink.is_in_netlink = TRUE;
+	strcpy (obj1->link.name, "eth1");
+	_nmp_cache_update_netlink (cache, obj1, &obj2, &was_visible, NMP_CACHE_OPS_UPDATED);
+	ASSERT_nmp_cache_is_consistent (cache);
+	_assert_cache_multi_lookup_contains (cache, nmp_cache_id_init_link_by_ifname (&cache_id_storage, "eth1"), obj2, TRUE);
+	objects = nmp_cache_lookup_multi (cache, nmp_cache_id_init_link_by_ifname (&cache_id_storage, "eth0"), &len);
+	g_assert (!objects);
+	g_assert_cmpint (len, ==, 0);
+	nmp_object_unref (obj1);
+	nmp_object_unref (obj2);
+
+	nmp_cache_free (cache);
+}
+
+static NMPObject *
+_address_new (guint i, guint32 preferred)
+{
+	NMPObject *obj;
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_IP4_ADDRESS, NULL);
+	obj->ip4_address.ifindex = 1 + (i % 10);
+	obj->ip4_address.address = htonl (0x0a000000 + i);
+	obj->ip4_address.peer_address = obj->ip4_address.address;
+	obj->ip4_address.plen = 8;
+	obj->ip4_address.timestamp = 1;
+	obj->ip4_address.lifetime = NM_PLATFORM_LIFETIME_PERMANENT;
+	obj->ip4_address.preferred = preferred;
+	return obj;
+}
+
+static void
+test_cache_update_benchmark (void)
+{
+	const guint n_addresses = nmtst_test_quick () ? 1000 : 10000;
+	const guint n_rounds = 20;
+	NMPCache *cache;
+	NMPObject *obj1, *obj2;
+	gboolean was_visible;
+	NMPCacheOpsType ops_type;
+	gint64 start_time, time;
+	guint i, r;
+
+	cache = nmp_cache_new (FALSE);
+
+	for (i = 0; i < n_addresses; i++) {
+		obj1 = _address_new (i, NM_PLATFORM_LIFETIME_PERMANENT);
+		ops_type = nmp_cache_update_netlink (cache, obj1, NULL, NULL, NULL, NULL);
+		g_assert_cmpint (ops_type, ==, NMP_CACHE_OPS_ADDED);
+		nmp_object_unref (obj1);
+	}
+
+	/* only change the preferred lifetime. That updates the cached instances in place
+	 * without touching the multi index. */
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+	for (r = 0; r < n_rounds; r++) {
+		for (i = 0; i < n_addresses; i++) {
+			obj1 = _address_new (i, 1000 + r);
+			ops_type = nmp_cache_update_netlink (cache, obj1, &obj2, &was_visible, NULL, NULL);
+			g_assert_cmpint (ops_type, ==, NMP_CACHE_OPS_UPDATED);
+			g_assert (obj2 != obj1);
+			nmp_object_unref (obj1);
+			nmp_object_unref (obj2);
+		}
+	}
+	time = nm_utils_get_monotonic_timestamp_ns () - start_time;
+
+	g_test_message ("cache: %u updates of %u addresses in %ld.%09ld seconds (%.0f updates per second)",
+	                n_rounds * n_addresses, n_addresses,
+	                (long) (time / NM_UTILS_NS_PER_SECOND), (long) (time % NM_UTILS_NS_PER_SECOND),
+	                (double) (n_rounds * n_addresses) * NM_UTILS_NS_PER_SECOND / MAX (time, 1));
+
+	ASSERT_nmp_cache_is_consistent (cache);
+	nmp_cache_free (cache);
+}
+
+static void
+test_cache_object_pool (void)
+{
+	const guint n_addresses = nmtst_test_quick () ? 1000 : 10000;
+	NMPCache *cache;
+	NMPObject *obj1;
+	guint n_objects_before, n_objects;
+	gsize n_bytes;
+	guint i;
+
+	nmp_object_pool_get_stats (NMP_OBJECT_TYPE_IP4_ADDRESS, &n_objects_before, NULL);
+
+	cache = nmp_cache_new (FALSE);
+	for (i = 0; i < n_addresses; i++) {
+		obj1 = _address_new (i, NM_PLATFORM_LIFETIME_PERMANENT);
+		nmp_cache_update_netlink (cache, obj1, NULL, NULL, NULL, NULL);
+		nmp_object_unref (obj1);
+	}
+
+	nmp_object_pool_get_stats (NMP_OBJECT_TYPE_IP4_ADDRESS, &n_objects, &n_bytes);
+	g_assert_cmpint (n_objects, ==, n_objects_before + n_addresses);
+	g_assert_cmpint (n_bytes, >, 0);
+
+	g_test_message ("pool: %u IPv4 address objects use %lu bytes (%.1f bytes per object)",
+	                n_objects, (unsigned long) n_bytes,
+	                (double) n_bytes / MAX (n_objects, 1));
+
+	ASSERT_nmp_cache_is_consistent (cache);
+	nmp_cache_free (cache);
+
+	nmp_object_pool_get_stats (NMP_OBJECT_TYPE_IP4_ADDRESS, &n_objects, NULL);
+	g_assert_cmpint (n_objects, ==, n_objects_before);
+}
+
 /******************************************************************/
 
 NMTST_DEFINE ();
@@ -410,6 +541,9 @@ main (int argc, char **argv)
 	}
 
 	g_test_add_func ("/nmp-object/cache_link", test_cache_link);
+	g_test_add_func ("/nmp-object/cache_link_rename", test_cache_link_rename);
+	g_test_add_func ("/nmp-object/cache_update_benchmark", test_cache_update_benchmark);
+	g_test_add_func ("/nmp-object/cache_object_pool", test_cache_object_pool);
 
 	result = g_test_run ();
 
@@ -84,6 +84,7 @@ enum {
 	UPDATED,
 	REMOVED,
 	UPDATED_INTERNAL,
+	TIMESTAMP_CHANGED,
 	LAST_SIGNAL
 };
 static guint signals[LAST_SIGNAL] = { 0 };
@@ -132,6 +133,130 @@ typedef struct {
 
 /*******************************************************************/
 
+/* The timestamps and seen-bssids databases are loaded once and kept in memory.
+ * Modifications are written back to disk after STATE_DB_FLUSH_DELAY_S
+ * seconds, so that several updates in a row only cause one write. */
+
+#define STATE_DB_FLUSH_DELAY_S 5
+
+typedef enum {
+	STATE_DB_TIMESTAMPS,
+	STATE_DB_SEEN_BSSIDS,
+	_STATE_DB_NUM,
+} StateDBType;
+
+typedef struct {
+	const char *filename;
+	const char *group;
+	GKeyFile *keyfile;
+	guint flush_id;
+	bool dirty:1;
+} StateDB;
+
+static StateDB state_dbs[_STATE_DB_NUM] = {
+	[STATE_DB_TIMESTAMPS] = {
+		.filename = SETTINGS_TIMESTAMPS_FILE,
+		.group = "timestamps",
+	},
+	[STATE_DB_SEEN_BSSIDS] = {
+		.filename = SETTINGS_SEEN_BSSIDS_FILE,
+		.group = "seen-bssids",
+	},
+};
+
+static GKeyFile *
+_state_db_get (StateDBType type)
+{
+	StateDB *db = &state_dbs[type];
+	NMSettingsConnection *self = NULL;
+	GError *error = NULL;
+
+	if (G_UNLIKELY (!db->keyfile)) {
+		db->keyfile = g_key_file_new ();
+		if (type == STATE_DB_SEEN_BSSIDS)
+			g_key_file_set_list_separator (db->keyfile, ',');
+		if (!g_key_file_load_from_file (db->keyfile, db->filename, G_KEY_FILE_KEEP_COMMENTS, &error)) {
+			if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+				_LOGW ("error parsing %s file '%s': %s", db->group, db->filename, error->message);
+			g_clear_error (&error);
+		}
+	}
+	return db->keyfile;
+}
+
+static void
+_state_db_flush (StateDBType type)
+{
+	StateDB *db = &state_dbs[type];
+	NMSettingsConnection *self = NULL;
+	gs_free char *data = NULL;
+	gsize len;
+	GError *error = NULL;
+
+	nm_clear_g_source (&db->flush_id);
+
+	if (!db->dirty)
+		return;
+	db->dirty = FALSE;
+
+	/* g_file_set_contents() replaces the file atomically. */
+	data = g_key_file_to_data (db->keyfile, &len, NULL);
+	if (!g_file_set_contents (db->filename, data, len, &error)) {
+		_LOGW ("error saving %s to file '%s': %s", db->group, db->filename, error->message);
+		g_error_free (error);
+	}
+}
+
+static gboolean
+_state_db_flush_cb (gpointer user_data)
+{
+	StateDBType type = GPOINTER_TO_INT (user_data);
+
+	state_dbs[type].flush_id = 0;
+	_state_db_flush (type);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_state_db_schedule_flush (StateDBType type)
+{
+	StateDB *db = &state_dbs[type];
+
+	db->dirty = TRUE;
+	if (!db->flush_id)
+		db->flush_id = g_timeout_add_seconds (STATE_DB_FLUSH_DELAY_S, _state_db_flush_cb, GINT_TO_POINTER (type));
+}
+
+static void
+_state_db_remove (StateDBType type, const char *uuid)
+{
+	GKeyFile *keyfile;
+
+	if (!uuid)
+		return;
+
+	keyfile = _state_db_get (type);
+	if (g_key_file_remove_key (keyfile, state_dbs[type].group, uuid, NULL))
+		_state_db_schedule_flush (type);
+}
+
+/**
+ * nm_settings_connection_flush_state_db:
+ *
+ * Writes pending modifications of the timestamps and seen-bssids
+ * databases to disk. Must be called before shutdown.
+ */
+void
+nm_settings_connection_flush_state_db (void)
+{
+	guint i;
+
+	for (i = 0; i < _STATE_DB_NUM; i++)
+		_state_db_flush (i);
+}
+
+/*******************************************************************/
+
 static void
 _emit_updated (NMSettingsConnection *self, gboolean by_user)
 {
@@ -691,42 +816,6 @@ nm_settings_connection_delete (NMSettingsConnection *self,
 	}
 }
 
-static void
-remove_entry_from_db (NMSettingsConnection *self, const char* db_name)
-{
-	GKeyFile *key_file;
-	const char *db_file;
-
-	if (strcmp (db_name, "timestamps") == 0)
-		db_file = SETTINGS_TIMESTAMPS_FILE;
-	else if (strcmp (db_name, "seen-bssids") == 0)
-		db_file = SETTINGS_SEEN_BSSIDS_FILE;
-	else
-		return;
-
-	key_file = g_key_file_new ();
-	if (g_key_file_load_from_file (key_file, db_file, G_KEY_FILE_KEEP_COMMENTS, NULL)) {
-		const char *connection_uuid;
-		char *data;
-		gsize len;
-		GError *error = NULL;
-
-		connection_uuid = nm_settings_connection_get_uuid (self);
-
-		g_key_file_remove_key (key_file, db_name, connection_uuid, NULL);
-		data = g_key_file_to_data (key_file, &len, &error);
-		if (data) {
-			g_file_set_contents (db_file, data, len, &error);
-			g_free (data);
-		}
-		if (error) {
-			_LOGW ("error writing %s file '%s': %s", db_name, db_file, error->message);
-			g_error_free (error);
-		}
-	}
-	g_key_file_free (key_file);
-}
-
 static void
 do_delete (NMSettingsConnection *self,
            NMSettingsConnectionDeleteFunc callback,
@@ -747,10 +836,10 @@ do_delete (NMSettingsConnection *self,
 	g_object_unref (for_agents);
 
 	/* Remove timestamp from timestamps database file */
-	remove_entry_from_db (self, "timestamps");
+	_state_db_remove (STATE_DB_TIMESTAMPS, nm_settings_connection_get_uuid (self));
 
 	/* Remove connection from seen-bssids database file */
-	remove_entry_from_db (self, "seen-bssids");
+	_state_db_remove (STATE_DB_SEEN_BSSIDS, nm_settings_connection_get_uuid (self));
 
 	nm_settings_connection_signal_remove (self);
 
@@ -2188,43 +2277,30 @@ nm_settings_connection_update_timestamp (NMSettingsConnection *self,
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 	const char *connection_uuid;
-	GKeyFile *timestamps_file;
-	char *data, *tmp;
-	gsize len;
-	GError *error = NULL;
+	char buf[30];
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
 	/* Update timestamp in private storage */
-	priv->timestamp = timestamp;
-	priv->timestamp_set = TRUE;
+	if (!priv->timestamp_set || priv->timestamp != timestamp) {
+		priv->timestamp = timestamp;
+		priv->timestamp_set = TRUE;
+		g_signal_emit (self, signals[TIMESTAMP_CHANGED], 0);
+	}
 
 	if (flush_to_disk == FALSE)
 		return;
 
-	/* Save timestamp to timestamps database file */
-	timestamps_file = g_key_file_new ();
-	if (!g_key_file_load_from_file (timestamps_file, SETTINGS_TIMESTAMPS_FILE, G_KEY_FILE_KEEP_COMMENTS, &error)) {
-		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
-			_LOGW ("error parsing timestamps file '%s': %s", SETTINGS_TIMESTAMPS_FILE, error->message);
-		g_clear_error (&error);
-	}
-
+	/* Save timestamp to timestamps database. It is written to disk shortly after. */
 	connection_uuid = nm_settings_connection_get_uuid (self);
-	tmp = g_strdup_printf ("%" G_GUINT64_FORMAT, timestamp);
-	g_key_file_set_value (timestamps_file, "timestamps", connection_uuid, tmp);
-	g_free (tmp);
-
-	data = g_key_file_to_data (timestamps_file, &len, &error);
-	if (data) {
-		g_file_set_contents (SETTINGS_TIMESTAMPS_FILE, data, len, &error);
-		g_free (data);
-	}
-	if (error) {
-		_LOGW ("error saving timestamp to file '%s': %s", SETTINGS_TIMESTAMPS_FILE, error->message);
-		g_error_free (error);
-	}
-	g_key_file_free (timestamps_file);
+	if (!connection_uuid)
+		return;
+	g_snprintf (buf, sizeof (buf), "%" G_GUINT64_FORMAT, timestamp);
+	g_key_file_set_value (_state_db_get (STATE_DB_TIMESTAMPS),
+	                      state_dbs[STATE_DB_TIMESTAMPS].group,
+	                      connection_uuid,
+	                      buf);
+	_state_db_schedule_flush (STATE_DB_TIMESTAMPS);
 }
 
 /**
@@ -2240,17 +2316,17 @@ nm_settings_connection_read_and_fill_timestamp (NMSettingsConnection *self)
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 	const char *connection_uuid;
 	guint64 timestamp = 0;
-	GKeyFile *timestamps_file;
 	GError *err = NULL;
 	char *tmp_str;
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
-	/* Get timestamp from database file */
-	timestamps_file = g_key_file_new ();
-	g_key_file_load_from_file (timestamps_file, SETTINGS_TIMESTAMPS_FILE, G_KEY_FILE_KEEP_COMMENTS, NULL);
+	/* Get timestamp from database */
 	connection_uuid = nm_settings_connection_get_uuid (self);
-	tmp_str = g_key_file_get_value (timestamps_file, "timestamps", connection_uuid, &err);
+	tmp_str = g_key_file_get_value (_state_db_get (STATE_DB_TIMESTAMPS),
+	                                state_dbs[STATE_DB_TIMESTAMPS].group,
+	                                connection_uuid,
+	                                &err);
 	if (tmp_str) {
 		timestamp = g_ascii_strtoull (tmp_str, NULL, 10);
 		g_free (tmp_str);
@@ -2264,7 +2340,6 @@ nm_settings_connection_read_and_fill_timestamp (NMSettingsConnection *self)
 		_LOGD ("failed to read connection timestamp: %s", err->message);
 		g_clear_error (&err);
 	}
-	g_key_file_free (timestamps_file);
 }
 
 /**
@@ -2328,11 +2403,8 @@ nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 	const char *connection_uuid;
-	GKeyFile *seen_bssids_file;
-	char *data, *bssid_str;
+	char *bssid_str;
 	const char **list;
-	gsize len;
-	GError *error = NULL;
 	GHashTableIter iter;
 	guint n;
 
@@ -2352,33 +2424,15 @@ nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &bssid_str))
 		list[n++] = bssid_str;
 
-	/* Save BSSID to seen-bssids file */
-	seen_bssids_file = g_key_file_new ();
-	g_key_file_set_list_separator (seen_bssids_file, ',');
-	if (!g_key_file_load_from_file (seen_bssids_file, SETTINGS_SEEN_BSSIDS_FILE, G_KEY_FILE_KEEP_COMMENTS, &error)) {
-		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
-			_LOGW ("error parsing seen-bssids file '%s': %s",
-			       SETTINGS_SEEN_BSSIDS_FILE, error->message);
-		}
-		g_clear_error (&error);
-	}
-
+	/* Save BSSID to seen-bssids database. It is written to disk shortly after. */
 	connection_uuid = nm_settings_connection_get_uuid (self);
-	g_key_file_set_string_list (seen_bssids_file, "seen-bssids", connection_uuid, list, n);
-	g_free (list);
-
-	data = g_key_file_to_data (seen_bssids_file, &len, &error);
-	if (data) {
-		g_file_set_contents (SETTINGS_SEEN_BSSIDS_FILE, data, len, &error);
-		g_free (data);
-	}
-	g_key_file_free (seen_bssids_file);
-
-	if (error) {
-		_LOGW ("error saving seen-bssids to file '%s': %s",
-		       SETTINGS_SEEN_BSSIDS_FILE, error->message);
-		g_error_free (error);
+	if (connection_uuid) {
+		g_key_file_set_string_list (_state_db_get (STATE_DB_SEEN_BSSIDS),
+		                            state_dbs[STATE_DB_SEEN_BSSIDS].group,
+		                            connection_uuid, list, n);
+		_state_db_schedule_flush (STATE_DB_SEEN_BSSIDS);
 	}
+	g_free (list);
 }
 
 /**
@@ -2393,19 +2447,17 @@ nm_settings_connection_read_and_fill_seen_bssids (NMSettingsConnection *self)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 	const char *connection_uuid;
-	GKeyFile *seen_bssids_file;
 	char **tmp_strv = NULL;
 	gsize i, len = 0;
 	NMSettingWireless *s_wifi;
 
-	/* Get seen BSSIDs from database file */
-	seen_bssids_file = g_key_file_new ();
-	g_key_file_set_list_separator (seen_bssids_file, ',');
-	if (g_key_file_load_from_file (seen_bssids_file, SETTINGS_SEEN_BSSIDS_FILE, G_KEY_FILE_KEEP_COMMENTS, NULL)) {
-		connection_uuid = nm_settings_connection_get_uuid (self);
-		tmp_strv = g_key_file_get_string_list (seen_bssids_file, "seen-bssids", connection_uuid, &len, NULL);
+	/* Get seen BSSIDs from database */
+	connection_uuid = nm_settings_connection_get_uuid (self);
+	if (connection_uuid) {
+		tmp_strv = g_key_file_get_string_list (_state_db_get (STATE_DB_SEEN_BSSIDS),
+		                                       state_dbs[STATE_DB_SEEN_BSSIDS].group,
+		                                       connection_uuid, &len, NULL);
 	}
-	g_key_file_free (seen_bssids_file);
 
 	/* Update connection's seen-bssids */
 	if (tmp_strv) {
@@ -2823,6 +2875,16 @@ nm_settings_connection_class_init (NMSettingsConnectionClass *class)
 	                  g_cclosure_marshal_VOID__VOID,
 	                  G_TYPE_NONE, 0);
 
+	/* internal signal, emitted when the timestamp changes. */
+	signals[TIMESTAMP_CHANGED] =
+	    g_signal_new (NM_SETTINGS_CONNECTION_TIMESTAMP_CHANGED,
+	                  G_TYPE_FROM_CLASS (class),
+	                  G_SIGNAL_RUN_FIRST,
+	                  0,
+	                  NULL, NULL,
+	                  g_cclosure_marshal_VOID__VOID,
+	                  G_TYPE_NONE, 0);
+
 	nm_exported_object_class_add_interface (NM_EXPORTED_OBJECT_CLASS (class),
 	                                        NMDBUS_TYPE_SETTINGS_CONNECTION_SKELETON,
 	                                        "Update", impl_settings_connection_update,
@@ -45,6 +45,7 @@ G_BEGIN_DECLS
 
 /* Internal signals */
 #define NM_SETTINGS_CONNECTION_UPDATED_INTERNAL "updated-internal"
+#define NM_SETTINGS_CONNECTION_TIMESTAMP_CHANGED "timestamp-changed"
 
 /* Properties */
 #define NM_SETTINGS_CONNECTION_VISIBLE  "visible"
@@ -203,6 +204,8 @@ void nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 
 void nm_settings_connection_read_and_fill_seen_bssids (NMSettingsConnection *self);
 
+void nm_settings_connection_flush_state_db (void);
+
 int nm_settings_connection_get_autoconnect_retries (NMSettingsConnection *self);
 void nm_settings_connection_set_autoconnect_retries (NMSettingsConnection *self,
                                                      int retries);
@@ -85,6 +85,14 @@ nm_settings_plugin_default_init (NMSettingsPluginInterface *g_iface)
 	              g_cclosure_marshal_VOID__VOID,
 	              G_TYPE_NONE, 0);
 
+	g_signal_new (NM_SETTINGS_PLUGIN_LOADING_FINISHED,
+	              iface_type,
+	              G_SIGNAL_RUN_FIRST,
+	              G_STRUCT_OFFSET (NMSettingsPluginInterface, loading_finished),
+	              NULL, NULL,
+	              g_cclosure_marshal_VOID__VOID,
+	              G_TYPE_NONE, 0);
+
 	initialized = TRUE;
 }
 
@@ -179,3 +187,21 @@ nm_settings_plugin_add_connection (NMSettingsPlugin *config,
 	                     "Plugin does not support adding connections");
 	return NULL;
 }
+
+/**
+ * nm_settings_plugin_get_loading:
+ * @config: the #NMSettingsPlugin
+ *
+ * Returns: %TRUE if the plugin is still loading connections in the
+ * background. In that case, it emits the "loading-finished" signal
+ * once it is done.
+ */
+gboolean
+nm_settings_plugin_get_loading (NMSettingsPlugin *config)
+{
+	g_return_val_if_fail (config != NULL, FALSE);
+
+	if (NM_SETTINGS_PLUGIN_GET_INTERFACE (config)->get_loading)
+		return NM_SETTINGS_PLUGIN_GET_INTERFACE (config)->get_loading (config);
+	return FALSE;
+}
@@ -46,6 +46,7 @@ GObject * nm_settings_plugin_factory (void);
 #define NM_SETTINGS_PLUGIN_UNMANAGED_SPECS_CHANGED "unmanaged-specs-changed"
 #define NM_SETTINGS_PLUGIN_UNRECOGNIZED_SPECS_CHANGED "unrecognized-specs-changed"
 #define NM_SETTINGS_PLUGIN_CONNECTION_ADDED "connection-added"
+#define NM_SETTINGS_PLUGIN_LOADING_FINISHED "loading-finished"
 
 typedef enum {
 	NM_SETTINGS_PLUGIN_CAP_NONE = 0x00000000,
@@ -125,6 +126,13 @@ typedef struct {
 	                                          gboolean save_to_disk,
 	                                          GError **error);
 
+	/* Returns TRUE while the plugin still loads connections in the
+	 * background after get_connections(). The remaining connections
+	 * are announced via the connection-added signal, followed by
+	 * loading-finished.
+	 */
+	gboolean (*get_loading) (NMSettingsPlugin *config);
+
 	/* Signals */
 
 	/* Emitted when a new connection has been found by the plugin */
@@ -136,6 +144,9 @@ typedef struct {
 
 	/* Emitted when the list of devices with unrecognized connections changes */
 	void (*unrecognized_specs_changed) (NMSettingsPlugin *config);
+
+	/* Emitted when the plugin finished loading connections in the background */
+	void (*loading_finished) (NMSettingsPlugin *config);
 } NMSettingsPluginInterface;
 
 GType nm_settings_plugin_get_type (void);
@@ -156,6 +167,8 @@ NMSettingsConnection *nm_settings_plugin_add_connection (NMSettingsPlugin *confi
                                                          gboolean save_to_disk,
                                                          GError **error);
 
+gboolean nm_settings_plugin_get_loading (NMSettingsPlugin *config);
+
 G_END_DECLS
 
 #endif	/* NM_SETTINGS_PLUGIN_H */
@@ -137,6 +137,8 @@ static void connection_ready_changed (NMSettingsConnection *conn,
                                       GParamSpec *pspec,
                                       gpointer user_data);
 
+static void device_realized (NMDevice *device, GParamSpec *pspec, NMSettings *self);
+
 G_DEFINE_TYPE (NMSettings, nm_settings, NM_TYPE_EXPORTED_OBJECT);
 
 typedef struct {
@@ -150,12 +152,50 @@ typedef struct {
 	gboolean connections_loaded;
 	GHashTable *connections;
 	NMSettingsConnection **connections_cached_list;
+
+	struct {
+		/* NMSettingsConnection -> IndexKeys */
+		GHashTable *keys;
+
+		/* UUID -> NMSettingsConnection. The table owns its keys, so that
+		 * an entry stays valid when another connection with the same UUID
+		 * drops its IndexKeys. */
+		GHashTable *by_uuid;
+
+		/* id, interface-name and connection type -> GPtrArray of
+		 * NMSettingsConnection. These values are not unique. */
+		GHashTable *by_id;
+		GHashTable *by_iface;
+		GHashTable *by_type;
+
+		/* candidate key -> GPtrArray of NMSettingsConnection. See
+		 * _candidate_key_get() for what the keys look like. */
+		GHashTable *by_candidate;
+	} index;
+
+	struct {
+		/* all connections, sorted by connection_sort(). The list is kept
+		 * up to date when connections are added, removed, updated or
+		 * their timestamp changes, so that it never needs a full sort. */
+		NMSettingsConnection **list;
+		guint len;
+		guint alloc;
+
+		/* NMSettingsConnection -> its position in @list */
+		GHashTable *idx;
+	} sorted;
+
 	GSList *unmanaged_specs;
 	GSList *unrecognized_specs;
 
 	gboolean started;
 	gboolean startup_complete;
 
+	/* devices that were realized while plugins were still loading
+	 * connections. Their default wired connection is only considered
+	 * once all connections are known. */
+	GSList *default_wired_pending;
+
 	struct {
 		char *value;
 		GFileMonitor *monitor;
@@ -186,8 +226,303 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMSettings,
 	PROP_CAN_MODIFY,
 	PROP_CONNECTIONS,
 	PROP_STARTUP_COMPLETE,
+	PROP_LOADING,
 );
 
+/*****************************************************************************/
+
+typedef struct {
+	/* the values under which a connection is indexed. We keep our own copies,
+	 * because the settings of the connection can be replaced at any time
+	 * and we only learn about that afterwards. */
+	char *uuid;
+	char *id;
+	char *iface;
+	char *type;
+	char *candidate;
+	char *candidate_any;
+} IndexKeys;
+
+static void
+_index_keys_free (IndexKeys *keys)
+{
+	g_free (keys->uuid);
+	g_free (keys->id);
+	g_free (keys->iface);
+	g_free (keys->type);
+	g_free (keys->candidate);
+	g_free (keys->candidate_any);
+	g_slice_free (IndexKeys, keys);
+}
+
+static void
+_index_uuid_remove (GHashTable *index, const char *uuid, NMSettingsConnection *connection)
+{
+	/* only drop the entry if it still refers to @connection. */
+	if (uuid && g_hash_table_lookup (index, uuid) == connection)
+		g_hash_table_remove (index, uuid);
+}
+
+static void
+_index_multi_add (GHashTable *index, const char *key, NMSettingsConnection *connection)
+{
+	GPtrArray *connections;
+
+	if (!key)
+		return;
+
+	connections = g_hash_table_lookup (index, key);
+	if (!connections) {
+		connections = g_ptr_array_new ();
+		g_hash_table_insert (index, g_strdup (key), connections);
+	}
+	g_ptr_array_add (connections, connection);
+}
+
+static void
+_index_multi_remove (GHashTable *index, const char *key, NMSettingsConnection *connection)
+{
+	GPtrArray *connections;
+
+	if (!key)
+		return;
+
+	connections = g_hash_table_lookup (index, key);
+	if (!connections || !g_ptr_array_remove_fast (connections, connection))
+		g_return_if_reached ();
+	if (connections->len == 0)
+		g_hash_table_remove (index, key);
+}
+
+static void
+_index_multi_update (GHashTable *index, char **p_key, const char *key, NMSettingsConnection *connection)
+{
+	if (!g_strcmp0 (*p_key, key))
+		return;
+
+	_index_multi_remove (index, *p_key, connection);
+	g_free (*p_key);
+	*p_key = g_strdup (key);
+	_index_multi_add (index, *p_key, connection);
+}
+
+static NMSettingsConnection *const*
+_index_multi_lookup (GHashTable *index, const char *key, guint *out_len)
+{
+	GPtrArray *connections;
+
+	connections = g_hash_table_lookup (index, key);
+	if (!connections) {
+		*out_len = 0;
+		return NULL;
+	}
+	*out_len = connections->len;
+	return (NMSettingsConnection *const*) connections->pdata;
+}
+
+/* Each connection is put into exactly one candidate bucket of its type,
+ * depending on what it is locked to (in order of precedence):
+ *
+ *   "$TYPE\ni\n$IFACE"   the interface-name
+ *   "$TYPE\np\n$PARENT"  the parent interface name or UUID
+ *   "$TYPE\nm\n$HWADDR"  the MAC address
+ *   "$TYPE\na"           nothing
+ *
+ * Connections locked to a parent or a MAC address are also put into
+ * the bucket "$TYPE\nP" or "$TYPE\nM" respectively, for devices that
+ * don't match on these properties. */
+static char *
+_candidate_key (const char *type, char kind, const char *value)
+{
+	if (value)
+		return g_strdup_printf ("%s\n%c\n%s", type, kind, value);
+	return g_strdup_printf ("%s\n%c", type, kind);
+}
+
+static char *
+_candidate_hwaddr (const char *hwaddr)
+{
+	char *canonical;
+
+	canonical = nm_utils_hwaddr_canonical (hwaddr, -1);
+	return canonical ?: g_strdup (hwaddr);
+}
+
+static const char *
+_candidate_get_parent (NMConnection *connection)
+{
+	NMSettingVlan *s_vlan;
+	NMSettingMacvlan *s_macvlan;
+	NMSettingVxlan *s_vxlan;
+	NMSettingIPTunnel *s_ip_tunnel;
+
+	if ((s_vlan = nm_connection_get_setting_vlan (connection)))
+		return nm_setting_vlan_get_parent (s_vlan);
+	if ((s_macvlan = nm_connection_get_setting_macvlan (connection)))
+		return nm_setting_macvlan_get_parent (s_macvlan);
+	if ((s_vxlan = nm_connection_get_setting_vxlan (connection)))
+		return nm_setting_vxlan_get_parent (s_vxlan);
+	if ((s_ip_tunnel = nm_connection_get_setting_ip_tunnel (connection)))
+		return nm_setting_ip_tunnel_get_parent (s_ip_tunnel);
+	return NULL;
+}
+
+static const char *
+_candidate_get_hwaddr (NMConnection *connection)
+{
+	NMSettingWired *s_wired;
+	NMSettingWireless *s_wireless;
+	NMSettingInfiniband *s_infiniband;
+
+	if ((s_wired = nm_connection_get_setting_wired (connection)))
+		return nm_setting_wired_get_mac_address (s_wired);
+	if ((s_wireless = nm_connection_get_setting_wireless (connection)))
+		return nm_setting_wireless_get_mac_address (s_wireless);
+	if ((s_infiniband = nm_connection_get_setting_infiniband (connection)))
+		return nm_setting_infiniband_get_mac_address (s_infiniband);
+	return NULL;
+}
+
+static void
+_candidate_key_get (NMConnection *connection,
+                    const char *type,
+                    const char *iface,
+                    char **out_key,
+                    char **out_key_any)
+{
+	const char *value;
+
+	*out_key = NULL;
+	*out_key_any = NULL;
+
+	if (!type)
+		return;
+
+	if (iface) {
+		*out_key = _candidate_key (type, 'i', iface);
+		return;
+	}
+
+	value = _candidate_get_parent (connection);
+	if (value) {
+		*out_key = _candidate_key (type, 'p', value);
+		*out_key_any = _candidate_key (type, 'P', NULL);
+		return;
+	}
+
+	value = _candidate_get_hwaddr (connection);
+	if (value) {
+		gs_free char *hwaddr = _candidate_hwaddr (value);
+
+		*out_key = _candidate_key (type, 'm', hwaddr);
+		*out_key_any = _candidate_key (type, 'M', NULL);
+		return;
+	}
+
+	*out_key = _candidate_key (type, 'a', NULL);
+}
+
+/* Returns the candidate buckets that may contain connections matching
+ * @filter. The buckets are disjoint, so no connection is part of more
+ * than one of them. */
+static GPtrArray *
+_candidate_filter_get_keys (const NMSettingsCandidateFilter *filter)
+{
+	GPtrArray *keys;
+	guint i;
+
+	keys = g_ptr_array_new_with_free_func (g_free);
+	for (i = 0; filter->types[i]; i++) {
+		const char *type = filter->types[i];
+
+		g_ptr_array_add (keys, _candidate_key (type, 'a', NULL));
+		if (filter->iface)
+			g_ptr_array_add (keys, _candidate_key (type, 'i', filter->iface));
+
+		if (filter->filter_parent) {
+			if (filter->parent_iface)
+				g_ptr_array_add (keys, _candidate_key (type, 'p', filter->parent_iface));
+			if (filter->parent_uuid)
+				g_ptr_array_add (keys, _candidate_key (type, 'p', filter->parent_uuid));
+		} else
+			g_ptr_array_add (keys, _candidate_key (type, 'P', NULL));
+
+		if (filter->filter_hwaddr) {
+			if (filter->hwaddr) {
+				gs_free char *hwaddr = _candidate_hwaddr (filter->hwaddr);
+
+				g_ptr_array_add (keys, _candidate_key (type, 'm', hwaddr));
+			}
+		} else
+			g_ptr_array_add (keys, _candidate_key (type, 'M', NULL));
+	}
+	return keys;
+}
+
+static void
+_index_update (NMSettings *self, NMSettingsConnection *connection)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	NMSettingConnection *s_con;
+	IndexKeys *keys;
+	const char *uuid;
+	gs_free char *candidate = NULL;
+	gs_free char *candidate_any = NULL;
+
+	s_con = nm_connection_get_setting_connection (NM_CONNECTION (connection));
+	g_return_if_fail (s_con);
+
+	keys = g_hash_table_lookup (priv->index.keys, connection);
+	if (!keys) {
+		keys = g_slice_new0 (IndexKeys);
+		g_hash_table_insert (priv->index.keys, connection, keys);
+	}
+
+	/* the UUID cannot change once the connection is exported, but handle
+	 * it anyway to keep the index consistent. */
+	uuid = nm_setting_connection_get_uuid (s_con);
+	if (g_strcmp0 (keys->uuid, uuid)) {
+		_index_uuid_remove (priv->index.by_uuid, keys->uuid, connection);
+		g_free (keys->uuid);
+		keys->uuid = g_strdup (uuid);
+		if (keys->uuid)
+			g_hash_table_replace (priv->index.by_uuid, g_strdup (keys->uuid), connection);
+	}
+
+	_index_multi_update (priv->index.by_id, &keys->id,
+	                     nm_setting_connection_get_id (s_con), connection);
+	_index_multi_update (priv->index.by_iface, &keys->iface,
+	                     nm_setting_connection_get_interface_name (s_con), connection);
+	_index_multi_update (priv->index.by_type, &keys->type,
+	                     nm_setting_connection_get_connection_type (s_con), connection);
+
+	_candidate_key_get (NM_CONNECTION (connection), keys->type, keys->iface,
+	                    &candidate, &candidate_any);
+	_index_multi_update (priv->index.by_candidate, &keys->candidate, candidate, connection);
+	_index_multi_update (priv->index.by_candidate, &keys->candidate_any, candidate_any, connection);
+}
+
+static void
+_index_remove (NMSettings *self, NMSettingsConnection *connection)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	IndexKeys *keys;
+
+	keys = g_hash_table_lookup (priv->index.keys, connection);
+	if (!keys)
+		g_return_if_reached ();
+
+	_index_uuid_remove (priv->index.by_uuid, keys->uuid, connection);
+	_index_multi_remove (priv->index.by_id, keys->id, connection);
+	_index_multi_remove (priv->index.by_iface, keys->iface, connection);
+	_index_multi_remove (priv->index.by_type, keys->type, connection);
+	_index_multi_remove (priv->index.by_candidate, keys->candidate, connection);
+	_index_multi_remove (priv->index.by_candidate, keys->candidate_any, connection);
+	g_hash_table_remove (priv->index.keys, connection);
+}
+
+/*****************************************************************************/
+
 static void
 check_startup_complete (NMSettings *self)
 {
@@ -198,6 +533,9 @@ check_startup_complete (NMSettings *self)
 	if (priv->startup_complete)
 		return;
 
+	if (nm_settings_get_loading (self))
+		return;
+
 	g_hash_table_iter_init (&iter, priv->connections);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &conn)) {
 		if (!nm_settings_connection_get_ready (conn))
@@ -232,6 +570,27 @@ plugin_connection_added (NMSettingsPlugin *config,
 	claim_connection (NM_SETTINGS (user_data), connection);
 }
 
+static void
+plugin_loading_finished (NMSettingsPlugin *config,
+                         gpointer user_data)
+{
+	NMSettings *self = NM_SETTINGS (user_data);
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	GSList *devices, *iter;
+
+	if (nm_settings_get_loading (self))
+		return;
+
+	devices = g_slist_reverse (priv->default_wired_pending);
+	priv->default_wired_pending = NULL;
+	for (iter = devices; iter; iter = iter->next)
+		device_realized (iter->data, NULL, self);
+	g_slist_free (devices);
+
+	_notify (self, PROP_LOADING);
+	check_startup_complete (self);
+}
+
 static void
 load_connections (NMSettings *self)
 {
@@ -260,6 +619,8 @@ load_connections (NMSettings *self)
 		                  G_CALLBACK (unmanaged_specs_changed), self);
 		g_signal_connect (plugin, NM_SETTINGS_PLUGIN_UNRECOGNIZED_SPECS_CHANGED,
 		                  G_CALLBACK (unrecognized_specs_changed), self);
+		g_signal_connect (plugin, NM_SETTINGS_PLUGIN_LOADING_FINISHED,
+		                  G_CALLBACK (plugin_loading_finished), self);
 	}
 
 	priv->connections_loaded = TRUE;
@@ -310,23 +671,193 @@ impl_settings_list_connections (NMSettings *self,
 
 NMSettingsConnection *
 nm_settings_get_connection_by_uuid (NMSettings *self, const char *uuid)
+{
+	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
+	g_return_val_if_fail (uuid != NULL, NULL);
+
+	return g_hash_table_lookup (NM_SETTINGS_GET_PRIVATE (self)->index.by_uuid, uuid);
+}
+
+/**
+ * nm_settings_get_connections_by_id:
+ * @self: the #NMSettings
+ * @id: the connection id to look up
+ * @out_len: (out): the number of returned connections
+ *
+ * Returns: (transfer none): %NULL or an array of @out_len connections
+ *   with the given @id, in no particular order. The array is only valid
+ *   until the next modification of the connections.
+ */
+NMSettingsConnection *const*
+nm_settings_get_connections_by_id (NMSettings *self, const char *id, guint *out_len)
+{
+	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
+	g_return_val_if_fail (id, NULL);
+	g_return_val_if_fail (out_len, NULL);
+
+	return _index_multi_lookup (NM_SETTINGS_GET_PRIVATE (self)->index.by_id, id, out_len);
+}
+
+/**
+ * nm_settings_get_connections_by_interface_name:
+ * @self: the #NMSettings
+ * @iface: the interface name to look up
+ * @out_len: (out): the number of returned connections
+ *
+ * Returns: (transfer none): %NULL or an array of @out_len connections
+ *   that are restricted to @iface. Connections without an interface-name
+ *   are not part of the result. The array is only valid until the next
+ *   modification of the connections.
+ */
+NMSettingsConnection *const*
+nm_settings_get_connections_by_interface_name (NMSettings *self, const char *iface, guint *out_len)
+{
+	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
+	g_return_val_if_fail (iface, NULL);
+	g_return_val_if_fail (out_len, NULL);
+
+	return _index_multi_lookup (NM_SETTINGS_GET_PRIVATE (self)->index.by_iface, iface, out_len);
+}
+
+/**
+ * nm_settings_get_connections_by_type:
+ * @self: the #NMSettings
+ * @type: the connection type to look up, like %NM_SETTING_WIRED_SETTING_NAME
+ * @out_len: (out): the number of returned connections
+ *
+ * Returns: (transfer none): %NULL or an array of @out_len connections
+ *   of the given @type. The array is only valid until the next modification
+ *   of the connections.
+ */
+NMSettingsConnection *const*
+nm_settings_get_connections_by_type (NMSettings *self, const char *type, guint *out_len)
+{
+	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
+	g_return_val_if_fail (type, NULL);
+	g_return_val_if_fail (out_len, NULL);
+
+	return _index_multi_lookup (NM_SETTINGS_GET_PRIVATE (self)->index.by_type, type, out_len);
+}
+
+/**
+ * nm_settings_get_candidate_connections:
+ * @self: the #NMSettings
+ * @filter: describes the device for which to look up connections
+ * @out_len: (allow-none) (out): the number of returned connections
+ *
+ * Looks up the connections that might be compatible with a device
+ * described by @filter, without checking every connection. The result
+ * is a superset of the compatible connections, the caller still has to
+ * check each of them. If @filter has no types, all connections are
+ * returned.
+ *
+ * Returns: (transfer container): a %NULL terminated array of connections,
+ *   in no particular order. Free it with g_free().
+ */
+NMSettingsConnection **
+nm_settings_get_candidate_connections (NMSettings *self,
+                                       const NMSettingsCandidateFilter *filter,
+                                       guint *out_len)
 {
 	NMSettingsPrivate *priv;
-	NMSettingsConnection *candidate;
-	GHashTableIter iter;
+	gs_unref_ptrarray GPtrArray *keys = NULL;
+	GPtrArray *result;
+	guint i;
 
 	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
-	g_return_val_if_fail (uuid != NULL, NULL);
+	g_return_val_if_fail (filter, NULL);
 
 	priv = NM_SETTINGS_GET_PRIVATE (self);
 
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &candidate)) {
-		if (g_strcmp0 (uuid, nm_settings_connection_get_uuid (candidate)) == 0)
-			return candidate;
+	if (!filter->types) {
+		NMSettingsConnection *const*connections;
+		guint len;
+
+		connections = nm_settings_get_connections (self, &len);
+		NM_SET_OUT (out_len, len);
+		return g_memdup (connections, sizeof (NMSettingsConnection *) * (len + 1));
 	}
 
-	return NULL;
+	keys = _candidate_filter_get_keys (filter);
+	result = g_ptr_array_new ();
+	for (i = 0; i < keys->len; i++) {
+		GPtrArray *connections;
+		guint j;
+
+		connections = g_hash_table_lookup (priv->index.by_candidate, keys->pdata[i]);
+		if (!connections)
+			continue;
+		for (j = 0; j < connections->len; j++)
+			g_ptr_array_add (result, connections->pdata[j]);
+	}
+	g_ptr_array_add (result, NULL);
+	NM_SET_OUT (out_len, result->len - 1);
+	return (NMSettingsConnection **) g_ptr_array_free (result, FALSE);
+}
+
+/**
+ * nm_settings_candidate_filter_matches:
+ * @self: the #NMSettings
+ * @filter: describes the device
+ * @connection: a connection of @self
+ *
+ * Returns: %TRUE if @connection would be part of the result of
+ *   nm_settings_get_candidate_connections() for @filter.
+ */
+gboolean
+nm_settings_candidate_filter_matches (NMSettings *self,
+                                      const NMSettingsCandidateFilter *filter,
+                                      NMSettingsConnection *connection)
+{
+	IndexKeys *index_keys;
+	const char *value;
+	gsize type_len;
+	char kind;
+	guint i;
+
+	g_return_val_if_fail (NM_IS_SETTINGS (self), FALSE);
+	g_return_val_if_fail (filter, FALSE);
+
+	if (!filter->types)
+		return TRUE;
+
+	index_keys = g_hash_table_lookup (NM_SETTINGS_GET_PRIVATE (self)->index.keys, connection);
+	if (!index_keys || !index_keys->candidate)
+		return FALSE;
+
+	for (i = 0; filter->types[i]; i++) {
+		if (nm_streq (filter->types[i], index_keys->type))
+			break;
+	}
+	if (!filter->types[i])
+		return FALSE;
+
+	/* Check the bucket of the connection against @filter directly, like
+	 * _candidate_filter_get_keys() would, but without building the keys.
+	 * See _candidate_key() for the format. */
+	type_len = strlen (index_keys->type);
+	kind = index_keys->candidate[type_len + 1];
+	value = index_keys->candidate[type_len + 2] ? &index_keys->candidate[type_len + 3] : NULL;
+
+	switch (kind) {
+	case 'a':
+		return TRUE;
+	case 'i':
+		return nm_streq0 (filter->iface, value);
+	case 'p':
+		if (!filter->filter_parent)
+			return TRUE;
+		return    nm_streq0 (filter->parent_iface, value)
+		       || nm_streq0 (filter->parent_uuid, value);
+	case 'm':
+		if (!filter->filter_hwaddr)
+			return TRUE;
+		return    filter->hwaddr
+		       && (   nm_streq (filter->hwaddr, value)
+		           || nm_utils_hwaddr_matches (filter->hwaddr, -1, value, -1));
+	default:
+		g_return_val_if_reached (FALSE);
+	}
 }
 
 static void
@@ -406,6 +937,106 @@ connection_sort (gconstpointer pa, gconstpointer pb)
 	return 1;
 }
 
+static void
+_sorted_reindex (NMSettings *self, guint from)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	guint i;
+
+	for (i = from; i < priv->sorted.len; i++)
+		g_hash_table_insert (priv->sorted.idx, priv->sorted.list[i], GUINT_TO_POINTER (i));
+}
+
+static void
+_sorted_insert (NMSettings *self, NMSettingsConnection *connection)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	guint lo, hi, mid;
+
+	if (priv->sorted.len == priv->sorted.alloc) {
+		priv->sorted.alloc = MAX (16, priv->sorted.alloc * 2);
+		priv->sorted.list = g_renew (NMSettingsConnection *, priv->sorted.list, priv->sorted.alloc);
+	}
+
+	/* insert after all connections that compare equal, like
+	 * g_slist_insert_sorted() does. */
+	lo = 0;
+	hi = priv->sorted.len;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (connection_sort (priv->sorted.list[mid], connection) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	memmove (&priv->sorted.list[lo + 1],
+	         &priv->sorted.list[lo],
+	         (priv->sorted.len - lo) * sizeof (NMSettingsConnection *));
+	priv->sorted.list[lo] = connection;
+	priv->sorted.len++;
+	_sorted_reindex (self, lo);
+}
+
+static gboolean
+_sorted_find (NMSettings *self, NMSettingsConnection *connection, guint *out_idx)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	gpointer idx;
+
+	/* we cannot bisect, because the sort key of @connection might
+	 * already have changed. */
+	if (!g_hash_table_lookup_extended (priv->sorted.idx, connection, NULL, &idx))
+		return FALSE;
+
+	nm_assert (priv->sorted.list[GPOINTER_TO_UINT (idx)] == connection);
+	*out_idx = GPOINTER_TO_UINT (idx);
+	return TRUE;
+}
+
+static void
+_sorted_remove_idx (NMSettings *self, guint idx)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+
+	nm_assert (idx < priv->sorted.len);
+
+	g_hash_table_remove (priv->sorted.idx, priv->sorted.list[idx]);
+	priv->sorted.len--;
+	memmove (&priv->sorted.list[idx],
+	         &priv->sorted.list[idx + 1],
+	         (priv->sorted.len - idx) * sizeof (NMSettingsConnection *));
+	_sorted_reindex (self, idx);
+}
+
+static void
+_sorted_remove (NMSettings *self, NMSettingsConnection *connection)
+{
+	guint idx;
+
+	if (!_sorted_find (self, connection, &idx))
+		g_return_if_reached ();
+	_sorted_remove_idx (self, idx);
+}
+
+static void
+_sorted_update (NMSettings *self, NMSettingsConnection *connection)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	guint idx;
+
+	if (!_sorted_find (self, connection, &idx))
+		g_return_if_reached ();
+
+	/* most updates don't change the order. */
+	if (   (idx == 0 || connection_sort (priv->sorted.list[idx - 1], connection) <= 0)
+	    && (idx + 1 == priv->sorted.len || connection_sort (connection, priv->sorted.list[idx + 1]) <= 0))
+		return;
+
+	_sorted_remove_idx (self, idx);
+	_sorted_insert (self, connection);
+}
+
 /**
  * nm_settings_get_connections:
  * @self: the #NMSettings
@@ -457,22 +1088,81 @@ nm_settings_get_connections (NMSettings *self, guint *out_len)
  * The list is sorted in the order suitable for auto-connecting, i.e.
  * first go connections with autoconnect=yes and most recent timestamp.
  * Caller must free the list with g_slist_free().
+ *
+ * Callers that don't modify the connections while iterating should
+ * prefer nm_settings_iter_init(), which does not allocate.
  */
 GSList *
 nm_settings_get_connections_sorted (NMSettings *self)
 {
-	GHashTableIter iter;
-	gpointer data = NULL;
+	NMSettingsPrivate *priv;
 	GSList *list = NULL;
+	guint i;
 
 	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
 
-	g_hash_table_iter_init (&iter, NM_SETTINGS_GET_PRIVATE (self)->connections);
-	while (g_hash_table_iter_next (&iter, NULL, &data))
-		list = g_slist_insert_sorted (list, data, connection_sort);
+	priv = NM_SETTINGS_GET_PRIVATE (self);
+
+	for (i = priv->sorted.len; i > 0; i--)
+		list = g_slist_prepend (list, priv->sorted.list[i - 1]);
 	return list;
 }
 
+/**
+ * nm_settings_iter_init:
+ * @iter: the iterator to initialize
+ * @self: the #NMSettings
+ *
+ * Iterate over all connections, in the same order as
+ * nm_settings_get_connections_sorted() returns them. The iterator
+ * does not allocate memory.
+ *
+ * Each step continues after the connection returned last, even if
+ * connections were added or removed meanwhile. Connections added
+ * before it are not visited. A connection whose position changes
+ * during the iteration, because it was updated or its timestamp
+ * changed, might be skipped or visited twice.
+ */
+void
+nm_settings_iter_init (NMSettingsIter *iter, NMSettings *self)
+{
+	g_return_if_fail (iter);
+	g_return_if_fail (NM_IS_SETTINGS (self));
+
+	iter->_self = self;
+	iter->_current = NULL;
+	iter->_idx = 0;
+}
+
+gboolean
+nm_settings_iter_next (NMSettingsIter *iter, NMSettingsConnection **out_connection)
+{
+	NMSettingsPrivate *priv;
+	guint idx;
+
+	g_return_val_if_fail (iter, FALSE);
+
+	priv = NM_SETTINGS_GET_PRIVATE (iter->_self);
+
+	if (iter->_current && _sorted_find (iter->_self, iter->_current, &idx))
+		idx++;
+	else {
+		/* the last connection was removed, the next one took its place. */
+		idx = iter->_idx;
+	}
+
+	if (idx >= priv->sorted.len) {
+		iter->_current = NULL;
+		iter->_idx = priv->sorted.len;
+		return FALSE;
+	}
+
+	iter->_current = priv->sorted.list[idx];
+	iter->_idx = idx;
+	NM_SET_OUT (out_connection, iter->_current);
+	return TRUE;
+}
+
 NMSettingsConnection *
 nm_settings_get_connection_by_path (NMSettings *self, const char *path)
 {
@@ -489,16 +1179,7 @@ nm_settings_get_connection_by_path (NMSettings *self, const char *path)
 gboolean
 nm_settings_has_connection (NMSettings *self, NMSettingsConnection *connection)
 {
-	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
-	GHashTableIter iter;
-	gpointer data;
-
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, &data))
-		if (data == connection)
-			return TRUE;
-
-	return FALSE;
+	return g_hash_table_contains (NM_SETTINGS_GET_PRIVATE (self)->index.keys, connection);
 }
 
 const GSList *
@@ -933,6 +1614,10 @@ next:
 static void
 connection_updated (NMSettingsConnection *connection, gboolean by_user, gpointer user_data)
 {
+	/* the id, interface-name, type or autoconnect might have changed. */
+	_index_update (NM_SETTINGS (user_data), connection);
+	_sorted_update (NM_SETTINGS (user_data), connection);
+
 	g_signal_emit (NM_SETTINGS (user_data),
 	               signals[CONNECTION_UPDATED],
 	               0,
@@ -940,6 +1625,12 @@ connection_updated (NMSettingsConnection *connection, gboolean by_user, gpointer
 	               by_user);
 }
 
+static void
+connection_timestamp_changed (NMSettingsConnection *connection, gpointer user_data)
+{
+	_sorted_update (NM_SETTINGS (user_data), connection);
+}
+
 static void
 connection_visibility_changed (NMSettingsConnection *connection,
                                GParamSpec *pspec,
@@ -970,12 +1661,15 @@ connection_removed (NMSettingsConnection *connection, gpointer user_data)
 
 	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_removed), self);
 	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_updated), self);
+	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_timestamp_changed), self);
 	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_visibility_changed), self);
 	if (!priv->startup_complete)
 		g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_ready_changed), self);
 	g_object_unref (self);
 
 	/* Forget about the connection internally */
+	_index_remove (self, connection);
+	_sorted_remove (self, connection);
 	g_hash_table_remove (priv->connections, (gpointer) cpath);
 	g_clear_pointer (&priv->connections_cached_list, g_free);
 
@@ -1049,20 +1743,15 @@ claim_connection (NMSettings *self, NMSettingsConnection *connection)
 {
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 	GError *error = NULL;
-	GHashTableIter iter;
-	gpointer data;
 	const char *path;
 	NMSettingsConnection *existing;
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (connection));
 	g_return_if_fail (nm_connection_get_path (NM_CONNECTION (connection)) == NULL);
 
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, &data)) {
-		/* prevent duplicates */
-		if (data == connection)
-			return;
-	}
+	/* prevent duplicates */
+	if (g_hash_table_contains (priv->index.keys, connection))
+		return;
 
 	if (!nm_connection_normalize (NM_CONNECTION (connection), NULL, NULL, &error)) {
 		_LOGW ("plugin provided invalid connection: %s", error->message);
@@ -1104,6 +1793,8 @@ claim_connection (NMSettings *self, NMSettingsConnection *connection)
 	                  G_CALLBACK (connection_removed), self);
 	g_signal_connect (connection, NM_SETTINGS_CONNECTION_UPDATED_INTERNAL,
 	                  G_CALLBACK (connection_updated), self);
+	g_signal_connect (connection, NM_SETTINGS_CONNECTION_TIMESTAMP_CHANGED,
+	                  G_CALLBACK (connection_timestamp_changed), self);
 	g_signal_connect (connection, "notify::" NM_SETTINGS_CONNECTION_VISIBLE,
 	                  G_CALLBACK (connection_visibility_changed),
 	                  self);
@@ -1121,6 +1812,8 @@ claim_connection (NMSettings *self, NMSettingsConnection *connection)
 	g_hash_table_insert (priv->connections,
 	                     (gpointer) nm_connection_get_path (NM_CONNECTION (connection)),
 	                     g_object_ref (connection));
+	_index_update (self, connection);
+	_sorted_insert (self, connection);
 	g_clear_pointer (&priv->connections_cached_list, g_free);
 
 	nm_utils_log_connection_diff (NM_CONNECTION (connection), NULL, LOGL_DEBUG, LOGD_CORE, "new connection", "++ ");
@@ -1161,20 +1854,17 @@ nm_settings_add_connection (NMSettings *self,
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 	GSList *iter;
 	NMSettingsConnection *added = NULL;
-	GHashTableIter citer;
-	NMConnection *candidate = NULL;
+	const char *uuid;
 
 	/* Make sure a connection with this UUID doesn't already exist */
-	g_hash_table_iter_init (&citer, priv->connections);
-	while (g_hash_table_iter_next (&citer, NULL, (gpointer *) &candidate)) {
-		if (g_strcmp0 (nm_connection_get_uuid (connection),
-		               nm_connection_get_uuid (candidate)) == 0) {
-			g_set_error_literal (error,
-			                     NM_SETTINGS_ERROR,
-			                     NM_SETTINGS_ERROR_UUID_EXISTS,
-			                     "A connection with this UUID already exists.");
-			return NULL;
-		}
+	uuid = nm_connection_get_uuid (connection);
+	if (   uuid
+	    && g_hash_table_contains (priv->index.by_uuid, uuid)) {
+		g_set_error_literal (error,
+		                     NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_UUID_EXISTS,
+		                     "A connection with this UUID already exists.");
+		return NULL;
 	}
 
 	/* 1) plugin writes the NMConnection to disk
@@ -1873,56 +2563,59 @@ hostname_file_changed_cb (GFileMonitor *monitor,
 static gboolean
 have_connection_for_device (NMSettings *self, NMDevice *device)
 {
+	static const char *const ctypes[] = {
+		NM_SETTING_WIRED_SETTING_NAME,
+		NM_SETTING_PPPOE_SETTING_NAME,
+	};
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
-	GHashTableIter iter;
-	gpointer data;
+	NMSettingsConnection *const*connections;
 	NMSettingConnection *s_con;
 	NMSettingWired *s_wired;
 	const char *setting_hwaddr;
 	const char *perm_hw_addr;
+	guint i, j, len;
 
 	g_return_val_if_fail (NM_IS_SETTINGS (self), FALSE);
 
 	perm_hw_addr = nm_device_get_permanent_hw_address (device, FALSE);
 
 	/* Find a wired connection locked to the given MAC address, if any */
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, &data)) {
-		NMConnection *connection = NM_CONNECTION (data);
-		const char *ctype, *iface;
+	for (j = 0; j < G_N_ELEMENTS (ctypes); j++) {
+		const char *ctype = ctypes[j];
 
-		if (!nm_device_check_connection_compatible (device, connection))
-			continue;
+		connections = nm_settings_get_connections_by_type (self, ctype, &len);
+		for (i = 0; i < len; i++) {
+			NMConnection *connection = NM_CONNECTION (connections[i]);
+			const char *iface;
 
-		s_con = nm_connection_get_setting_connection (connection);
+			if (!nm_device_check_connection_compatible (device, connection))
+				continue;
 
-		iface = nm_setting_connection_get_interface_name (s_con);
-		if (iface && strcmp (iface, nm_device_get_iface (device)) != 0)
-			continue;
+			s_con = nm_connection_get_setting_connection (connection);
 
-		ctype = nm_setting_connection_get_connection_type (s_con);
-		if (   strcmp (ctype, NM_SETTING_WIRED_SETTING_NAME)
-		    && strcmp (ctype, NM_SETTING_PPPOE_SETTING_NAME))
-			continue;
+			iface = nm_setting_connection_get_interface_name (s_con);
+			if (iface && strcmp (iface, nm_device_get_iface (device)) != 0)
+				continue;
 
-		s_wired = nm_connection_get_setting_wired (connection);
+			s_wired = nm_connection_get_setting_wired (connection);
 
-		if (!s_wired && !strcmp (ctype, NM_SETTING_PPPOE_SETTING_NAME)) {
-			/* No wired setting; therefore the PPPoE connection applies to any device */
-			return TRUE;
-		}
+			if (!s_wired && !strcmp (ctype, NM_SETTING_PPPOE_SETTING_NAME)) {
+				/* No wired setting; therefore the PPPoE connection applies to any device */
+				return TRUE;
+			}
 
-		g_assert (s_wired != NULL);
+			g_assert (s_wired != NULL);
 
-		setting_hwaddr = nm_setting_wired_get_mac_address (s_wired);
-		if (setting_hwaddr) {
-			/* A connection mac-locked to this device */
-			if (   perm_hw_addr
-			    && nm_utils_hwaddr_matches (setting_hwaddr, -1, perm_hw_addr, -1))
+			setting_hwaddr = nm_setting_wired_get_mac_address (s_wired);
+			if (setting_hwaddr) {
+				/* A connection mac-locked to this device */
+				if (   perm_hw_addr
+				    && nm_utils_hwaddr_matches (setting_hwaddr, -1, perm_hw_addr, -1))
+					return TRUE;
+			} else {
+				/* A connection that applies to any wired device */
 				return TRUE;
-		} else {
-			/* A connection that applies to any wired device */
-			return TRUE;
+			}
 		}
 	}
 
@@ -2009,6 +2702,15 @@ device_realized (NMDevice *device, GParamSpec *pspec, NMSettings *self)
 	                                      G_CALLBACK (device_realized),
 	                                      self);
 
+	/* Connections that are still being loaded might match the device. */
+	if (nm_settings_get_loading (self)) {
+		NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+
+		if (!g_slist_find (priv->default_wired_pending, device))
+			priv->default_wired_pending = g_slist_prepend (priv->default_wired_pending, device);
+		return;
+	}
+
 	/* If the device isn't managed or it already has a default wired connection,
 	 * ignore it.
 	 */
@@ -2063,11 +2765,13 @@ nm_settings_device_added (NMSettings *self, NMDevice *device)
 void
 nm_settings_device_removed (NMSettings *self, NMDevice *device, gboolean quitting)
 {
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 	NMSettingsConnection *connection;
 
 	g_signal_handlers_disconnect_by_func (device,
 	                                      G_CALLBACK (device_realized),
 	                                      self);
+	priv->default_wired_pending = g_slist_remove (priv->default_wired_pending, device);
 
 	connection = g_object_get_data (G_OBJECT (device), DEFAULT_WIRED_CONNECTION_TAG);
 	if (connection) {
@@ -2192,6 +2896,27 @@ nm_settings_get_startup_complete (NMSettings *self)
 	return priv->startup_complete;
 }
 
+/**
+ * nm_settings_get_loading:
+ * @self: the #NMSettings
+ *
+ * Returns: %TRUE while a settings plugin still loads connections in
+ * the background. Once all are loaded, #NMSettings:loading changes
+ * to %FALSE.
+ */
+gboolean
+nm_settings_get_loading (NMSettings *self)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	GSList *iter;
+
+	for (iter = priv->plugins; iter; iter = iter->next) {
+		if (nm_settings_plugin_get_loading (iter->data))
+			return TRUE;
+	}
+	return FALSE;
+}
+
 /***************************************************************/
 
 static void
@@ -2349,6 +3074,14 @@ nm_settings_init (NMSettings *self)
 
 	priv->connections = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
 
+	priv->index.keys = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) _index_keys_free);
+	priv->index.by_uuid = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->index.by_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->index.by_iface = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->index.by_type = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->index.by_candidate = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->sorted.idx = g_hash_table_new (g_direct_hash, g_direct_equal);
+
 	/* Hold a reference to the agent manager so it stays alive; the only
 	 * other holders are NMSettingsConnection objects which are often
 	 * transient, and we don't want the agent manager to get destroyed and
@@ -2368,6 +3101,9 @@ dispose (GObject *object)
 	g_slist_free_full (priv->auths, (GDestroyNotify) nm_auth_chain_unref);
 	priv->auths = NULL;
 
+	g_slist_free (priv->default_wired_pending);
+	priv->default_wired_pending = NULL;
+
 	g_object_unref (priv->agent_mgr);
 
 	if (priv->hostname.hostnamed_proxy) {
@@ -2396,6 +3132,8 @@ dispose (GObject *object)
 
 	g_clear_pointer (&priv->hostname.value, g_free);
 
+	nm_settings_connection_flush_state_db ();
+
 	G_OBJECT_CLASS (nm_settings_parent_class)->dispose (object);
 }
 
@@ -2408,6 +3146,15 @@ finalize (GObject *object)
 	g_hash_table_destroy (priv->connections);
 	g_clear_pointer (&priv->connections_cached_list, g_free);
 
+	g_hash_table_destroy (priv->index.by_uuid);
+	g_hash_table_destroy (priv->index.by_id);
+	g_hash_table_destroy (priv->index.by_iface);
+	g_hash_table_destroy (priv->index.by_type);
+	g_hash_table_destroy (priv->index.by_candidate);
+	g_hash_table_destroy (priv->index.keys);
+	g_free (priv->sorted.list);
+	g_hash_table_destroy (priv->sorted.idx);
+
 	g_slist_free_full (priv->unmanaged_specs, g_free);
 	g_slist_free_full (priv->unrecognized_specs, g_free);
 
@@ -2457,6 +3204,9 @@ get_property (GObject *object, guint prop_id,
 	case PROP_STARTUP_COMPLETE:
 		g_value_set_boolean (value, nm_settings_get_startup_complete (self));
 		break;
+	case PROP_LOADING:
+		g_value_set_boolean (value, nm_settings_get_loading (self));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -2510,6 +3260,12 @@ nm_settings_class_init (NMSettingsClass *class)
 	                          G_PARAM_READABLE |
 	                          G_PARAM_STATIC_STRINGS);
 
+	obj_properties[PROP_LOADING] =
+	    g_param_spec_boolean (NM_SETTINGS_LOADING, "", "",
+	                          FALSE,
+	                          G_PARAM_READABLE |
+	                          G_PARAM_STATIC_STRINGS);
+
 	g_object_class_install_properties (object_class, _PROPERTY_ENUMS_LAST, obj_properties);
 
 	/* signals */
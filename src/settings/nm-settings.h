@@ -42,6 +42,7 @@
 #define NM_SETTINGS_CAN_MODIFY       "can-modify"
 #define NM_SETTINGS_CONNECTIONS      "connections"
 #define NM_SETTINGS_STARTUP_COMPLETE "startup-complete"
+#define NM_SETTINGS_LOADING          "loading"
 
 #define NM_SETTINGS_SIGNAL_CONNECTION_ADDED              "connection-added"
 #define NM_SETTINGS_SIGNAL_CONNECTION_UPDATED            "connection-updated"
@@ -105,6 +106,15 @@ NMSettingsConnection *const* nm_settings_get_connections (NMSettings *settings,
 
 GSList *nm_settings_get_connections_sorted (NMSettings *settings);
 
+typedef struct {
+	NMSettings *_self;
+	NMSettingsConnection *_current;
+	guint _idx;
+} NMSettingsIter;
+
+void nm_settings_iter_init (NMSettingsIter *iter, NMSettings *self);
+gboolean nm_settings_iter_next (NMSettingsIter *iter, NMSettingsConnection **out_connection);
+
 GSList *nm_settings_get_best_connections (NMSettings *self,
                                           guint max_requested,
                                           const char *ctype1,
@@ -122,6 +132,50 @@ NMSettingsConnection *nm_settings_get_connection_by_path (NMSettings *settings,
 NMSettingsConnection *nm_settings_get_connection_by_uuid (NMSettings *settings,
                                                           const char *uuid);
 
+NMSettingsConnection *const*nm_settings_get_connections_by_id (NMSettings *self,
+                                                               const char *id,
+                                                               guint *out_len);
+NMSettingsConnection *const*nm_settings_get_connections_by_interface_name (NMSettings *self,
+                                                                           const char *iface,
+                                                                           guint *out_len);
+NMSettingsConnection *const*nm_settings_get_connections_by_type (NMSettings *self,
+                                                                 const char *type,
+                                                                 guint *out_len);
+
+/**
+ * NMSettingsCandidateFilter:
+ * @types: %NULL terminated list of connection types the device can handle,
+ *   or %NULL to not filter connections at all.
+ * @iface: the interface name of the device. Connections locked to
+ *   a different interface-name are skipped.
+ * @filter_parent: whether to skip connections locked to a parent other
+ *   than @parent_iface or @parent_uuid.
+ * @filter_hwaddr: whether to skip connections locked to a MAC address
+ *   other than @hwaddr.
+ * @parent_iface: the interface name of the parent device, or %NULL.
+ * @parent_uuid: the UUID of the connection active on the parent device, or %NULL.
+ * @hwaddr: the MAC address connections can be locked to, or %NULL.
+ *
+ * Describes a device to look up the connections that might be compatible
+ * with it, see nm_settings_get_candidate_connections().
+ */
+struct _NMSettingsCandidateFilter {
+	const char *const*types;
+	const char *iface;
+	bool filter_parent:1;
+	bool filter_hwaddr:1;
+	const char *parent_iface;
+	const char *parent_uuid;
+	const char *hwaddr;
+};
+
+NMSettingsConnection **nm_settings_get_candidate_connections (NMSettings *self,
+                                                              const NMSettingsCandidateFilter *filter,
+                                                              guint *out_len);
+gboolean nm_settings_candidate_filter_matches (NMSettings *self,
+                                               const NMSettingsCandidateFilter *filter,
+                                               NMSettingsConnection *connection);
+
 gboolean nm_settings_has_connection (NMSettings *self, NMSettingsConnection *connection);
 
 const GSList *nm_settings_get_unmanaged_specs (NMSettings *self);
@@ -136,6 +190,8 @@ gint nm_settings_sort_connections (gconstpointer a, gconstpointer b);
 
 gboolean nm_settings_get_startup_complete (NMSettings *self);
 
+gboolean nm_settings_get_loading (NMSettings *self);
+
 void nm_settings_set_transient_hostname (NMSettings *self,
                                          const char *hostname,
                                          NMSettingsSetHostnameCb cb,
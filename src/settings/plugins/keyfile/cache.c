@@ -0,0 +1,303 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager system settings service - keyfile plugin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "cache.h"
+
+#include <string.h>
+#include <sys/stat.h>
+
+#include "nm-core-internal.h"
+#include "reader.h"
+
+/* The cache remembers the parsed connections of unchanged keyfiles across
+ * restarts. It is a serialized GVariant of type CACHE_TYPE, mapped into
+ * memory when loading. Every entry holds the path, the stat() data of
+ * the file when it was read, and the connection as D-Bus dictionary.
+ *
+ * The cache contains secrets, just like the keyfiles themselves. */
+
+#define CACHE_VERSION      1
+
+#define CACHE_ENTRY_TYPE   "(stttxxa{sa{sv}})"
+#define CACHE_TYPE         "(usa" CACHE_ENTRY_TYPE ")"
+
+struct _NMKeyfileCache {
+	GMappedFile *mapped;
+	GVariant *entries;
+	GHashTable *by_path;
+};
+
+/*****************************************************************************/
+
+/**
+ * nm_keyfile_cache_load:
+ * @filename: the cache file
+ *
+ * Maps the cache file into memory. If the file does not exist or
+ * was written by another version, the returned cache is empty.
+ *
+ * Returns: the cache, to be freed with nm_keyfile_cache_free().
+ */
+NMKeyfileCache *
+nm_keyfile_cache_load (const char *filename)
+{
+	NMKeyfileCache *cache;
+	GError *error = NULL;
+	GVariant *data;
+	guint32 version;
+	const char *nm_version;
+	gsize i, n;
+
+	g_return_val_if_fail (filename, NULL);
+
+	cache = g_slice_new0 (NMKeyfileCache);
+	cache->by_path = g_hash_table_new (g_str_hash, g_str_equal);
+
+	cache->mapped = g_mapped_file_new (filename, FALSE, &error);
+	if (!cache->mapped) {
+		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+			nm_log_dbg (LOGD_SETTINGS, "keyfile: cannot load cache %s: %s", filename, error->message);
+		g_clear_error (&error);
+		return cache;
+	}
+
+	/* The data is not trusted. GVariant handles malformed data by returning
+	 * default values, which at worst results in cache misses. */
+	data = g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE (CACHE_TYPE),
+	                                                    g_mapped_file_get_contents (cache->mapped),
+	                                                    g_mapped_file_get_length (cache->mapped),
+	                                                    FALSE,
+	                                                    (GDestroyNotify) g_mapped_file_unref,
+	                                                    g_mapped_file_ref (cache->mapped)));
+
+	g_variant_get (data, "(u&s@a" CACHE_ENTRY_TYPE ")", &version, &nm_version, &cache->entries);
+	if (   version != CACHE_VERSION
+	    || strcmp (nm_version, VERSION) != 0) {
+		nm_log_dbg (LOGD_SETTINGS, "keyfile: ignore cache %s from version %s", filename, nm_version);
+		g_clear_pointer (&cache->entries, g_variant_unref);
+		g_variant_unref (data);
+		return cache;
+	}
+	g_variant_unref (data);
+
+	n = g_variant_n_children (cache->entries);
+	for (i = 0; i < n; i++) {
+		const char *path;
+
+		g_variant_get_child (cache->entries, i, "(&stttxx@a{sa{sv}})",
+		                     &path, NULL, NULL, NULL, NULL, NULL, NULL);
+		if (path[0] == '/')
+			g_hash_table_insert (cache->by_path, (gpointer) path, GSIZE_TO_POINTER (i + 1));
+	}
+
+	nm_log_dbg (LOGD_SETTINGS, "keyfile: loaded cache %s with %u entries",
+	            filename, g_hash_table_size (cache->by_path));
+	return cache;
+}
+
+void
+nm_keyfile_cache_free (NMKeyfileCache *cache)
+{
+	if (!cache)
+		return;
+
+	g_hash_table_unref (cache->by_path);
+	if (cache->entries)
+		g_variant_unref (cache->entries);
+	if (cache->mapped)
+		g_mapped_file_unref (cache->mapped);
+	g_slice_free (NMKeyfileCache, cache);
+}
+
+guint
+nm_keyfile_cache_get_size (NMKeyfileCache *cache)
+{
+	g_return_val_if_fail (cache, 0);
+
+	return g_hash_table_size (cache->by_path);
+}
+
+/*****************************************************************************/
+
+static gboolean
+_stat_is_cacheable (const struct stat *st)
+{
+	/* Only files that pass the checks of nm_keyfile_plugin_connection_from_file()
+	 * are served from the cache. Other files are read, which reports the error. */
+	return nm_keyfile_plugin_check_file (st, NULL);
+}
+
+/**
+ * nm_keyfile_cache_lookup:
+ * @cache: the #NMKeyfileCache
+ * @full_path: the keyfile
+ * @st: the current stat() data of @full_path
+ *
+ * Looks up the entry for @full_path. The entry is only returned if
+ * the file did not change since it was cached. This does not modify
+ * @cache and can be called from several threads at once.
+ *
+ * Returns: (transfer full): the cache entry or %NULL.
+ */
+GVariant *
+nm_keyfile_cache_lookup (NMKeyfileCache *cache,
+                         const char *full_path,
+                         const struct stat *st)
+{
+	GVariant *entry;
+	gsize idx;
+	guint64 dev, ino, size;
+	gint64 mtime_sec, mtime_nsec;
+
+	g_return_val_if_fail (cache, NULL);
+	g_return_val_if_fail (full_path, NULL);
+	g_return_val_if_fail (st, NULL);
+
+	if (!_stat_is_cacheable (st))
+		return NULL;
+
+	idx = GPOINTER_TO_SIZE (g_hash_table_lookup (cache->by_path, full_path));
+	if (idx == 0)
+		return NULL;
+
+	entry = g_variant_get_child_value (cache->entries, idx - 1);
+	g_variant_get (entry, "(&stttxx@a{sa{sv}})",
+	               NULL, &dev, &ino, &size, &mtime_sec, &mtime_nsec, NULL);
+	if (   dev != (guint64) st->st_dev
+	    || ino != (guint64) st->st_ino
+	    || size != (guint64) st->st_size
+	    || mtime_sec != (gint64) st->st_mtim.tv_sec
+	    || mtime_nsec != (gint64) st->st_mtim.tv_nsec) {
+		g_variant_unref (entry);
+		return NULL;
+	}
+	return entry;
+}
+
+/**
+ * nm_keyfile_cache_entry_new:
+ * @full_path: the keyfile
+ * @st: the stat() data of @full_path from before reading it
+ * @connection: the connection read from @full_path
+ *
+ * Returns: (transfer full): a new cache entry, or %NULL if @full_path
+ *   is not suitable for caching.
+ */
+GVariant *
+nm_keyfile_cache_entry_new (const char *full_path,
+                            const struct stat *st,
+                            NMConnection *connection)
+{
+	g_return_val_if_fail (full_path, NULL);
+	g_return_val_if_fail (st, NULL);
+	g_return_val_if_fail (NM_IS_CONNECTION (connection), NULL);
+
+	if (!_stat_is_cacheable (st))
+		return NULL;
+
+	return g_variant_ref_sink (g_variant_new ("(stttxx@a{sa{sv}})",
+	                                          full_path,
+	                                          (guint64) st->st_dev,
+	                                          (guint64) st->st_ino,
+	                                          (guint64) st->st_size,
+	                                          (gint64) st->st_mtim.tv_sec,
+	                                          (gint64) st->st_mtim.tv_nsec,
+	                                          nm_connection_to_dbus (connection, NM_CONNECTION_SERIALIZE_ALL)));
+}
+
+/**
+ * nm_keyfile_cache_entry_get_connection:
+ * @entry: the cache entry
+ * @error: on return, the reason why the entry is unusable
+ *
+ * Returns: (transfer full): the connection of @entry or %NULL.
+ */
+NMConnection *
+nm_keyfile_cache_entry_get_connection (GVariant *entry,
+                                       GError **error)
+{
+	gs_unref_variant GVariant *settings = NULL;
+	NMConnection *connection;
+
+	g_return_val_if_fail (entry, NULL);
+
+	g_variant_get_child (entry, 6, "@a{sa{sv}}", &settings);
+
+	connection = nm_simple_connection_new_from_dbus (settings, error);
+	if (!connection)
+		return NULL;
+
+	if (!nm_connection_get_uuid (connection)) {
+		g_set_error_literal (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
+		                     "cached connection had no UUID");
+		g_object_unref (connection);
+		return NULL;
+	}
+	return connection;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_keyfile_cache_write:
+ * @filename: the cache file
+ * @entries: the cache entries, as returned by nm_keyfile_cache_lookup()
+ *   and nm_keyfile_cache_entry_new()
+ * @error: on return, a location to store any errors that may occur
+ *
+ * Replaces the cache file with @entries.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_keyfile_cache_write (const char *filename,
+                        GPtrArray *entries,
+                        GError **error)
+{
+	GVariantBuilder builder;
+	gs_unref_variant GVariant *data = NULL;
+	mode_t saved_umask;
+	gboolean success;
+	guint i;
+
+	g_return_val_if_fail (filename, FALSE);
+	g_return_val_if_fail (entries, FALSE);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a" CACHE_ENTRY_TYPE));
+	for (i = 0; i < entries->len; i++)
+		g_variant_builder_add_value (&builder, entries->pdata[i]);
+
+	data = g_variant_ref_sink (g_variant_new ("(us@a" CACHE_ENTRY_TYPE ")",
+	                                          (guint32) CACHE_VERSION,
+	                                          VERSION,
+	                                          g_variant_builder_end (&builder)));
+
+	/* The cache contains secrets. Make sure it's only readable by root. */
+	saved_umask = umask (S_IRWXG | S_IRWXO);
+	success = g_file_set_contents (filename,
+	                               g_variant_get_data (data),
+	                               g_variant_get_size (data),
+	                               error);
+	umask (saved_umask);
+
+	return success;
+}
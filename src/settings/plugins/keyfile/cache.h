@@ -0,0 +1,53 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager system settings service - keyfile plugin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ */
+
+#ifndef _KEYFILE_PLUGIN_CACHE_H
+#define _KEYFILE_PLUGIN_CACHE_H
+
+#include <sys/stat.h>
+
+#include <nm-connection.h>
+
+#include "nm-default.h"
+
+#define NM_KEYFILE_CACHE_FILE NMSTATEDIR "/keyfile-cache"
+
+typedef struct _NMKeyfileCache NMKeyfileCache;
+
+NMKeyfileCache *nm_keyfile_cache_load (const char *filename);
+void nm_keyfile_cache_free (NMKeyfileCache *cache);
+
+guint nm_keyfile_cache_get_size (NMKeyfileCache *cache);
+
+GVariant *nm_keyfile_cache_lookup (NMKeyfileCache *cache,
+                                   const char *full_path,
+                                   const struct stat *st);
+
+GVariant *nm_keyfile_cache_entry_new (const char *full_path,
+                                      const struct stat *st,
+                                      NMConnection *connection);
+NMConnection *nm_keyfile_cache_entry_get_connection (GVariant *entry,
+                                                     GError **error);
+
+gboolean nm_keyfile_cache_write (const char *filename,
+                                 GPtrArray *entries,
+                                 GError **error);
+
+#endif /* _KEYFILE_PLUGIN_CACHE_H */
@@ -36,14 +36,70 @@
 
 G_DEFINE_TYPE (NMKeyfileConnection, nm_keyfile_connection, NM_TYPE_SETTINGS_CONNECTION)
 
+/**
+ * nm_keyfile_connection_read:
+ * @full_path: the keyfile to read
+ * @error: on return, the reason why the file could not be read
+ *
+ * Reads and verifies the connection in @full_path. Contrary to
+ * nm_keyfile_connection_new(), this does not create a settings
+ * connection and can thus be called from a worker thread.
+ *
+ * Returns: (transfer full): the connection, or %NULL on failure.
+ */
+NMConnection *
+nm_keyfile_connection_read (const char *full_path,
+                            GError **error)
+{
+	NMConnection *tmp;
+
+	g_return_val_if_fail (full_path, NULL);
+
+	tmp = nm_keyfile_plugin_connection_from_file (full_path, error);
+	if (!tmp)
+		return NULL;
+
+	if (!nm_connection_get_uuid (tmp)) {
+		g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
+		             "Connection in file %s had no UUID", full_path);
+		g_object_unref (tmp);
+		return NULL;
+	}
+	return tmp;
+}
+
+static NMKeyfileConnection *
+_connection_new (NMConnection *settings,
+                 const char *full_path,
+                 gboolean update_unsaved,
+                 GError **error)
+{
+	GObject *object;
+
+	object = (GObject *) g_object_new (NM_TYPE_KEYFILE_CONNECTION,
+	                                   NM_SETTINGS_CONNECTION_FILENAME, full_path,
+	                                   NULL);
+
+	/* Update our settings with what was read from the file */
+	if (!nm_settings_connection_replace_settings (NM_SETTINGS_CONNECTION (object),
+	                                              settings,
+	                                              update_unsaved,
+	                                              NULL,
+	                                              error)) {
+		g_object_unref (object);
+		object = NULL;
+	}
+
+	return (NMKeyfileConnection *) object;
+}
+
 NMKeyfileConnection *
 nm_keyfile_connection_new (NMConnection *source,
                            const char *full_path,
                            GError **error)
 {
-	GObject *object;
+	NMKeyfileConnection *connection;
 	NMConnection *tmp;
-	const char *uuid;
 	gboolean update_unsaved = TRUE;
 
 	g_assert (source || full_path);
@@ -52,38 +108,39 @@ nm_keyfile_connection_new (NMConnection *source,
 	if (source)
 		tmp = g_object_ref (source);
 	else {
-		tmp = nm_keyfile_plugin_connection_from_file (full_path, error);
+		tmp = nm_keyfile_connection_read (full_path, error);
 		if (!tmp)
 			return NULL;
 
-		uuid = nm_connection_get_uuid (NM_CONNECTION (tmp));
-		if (!uuid) {
-			g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
-			             "Connection in file %s had no UUID", full_path);
-			g_object_unref (tmp);
-			return NULL;
-		}
-
 		/* If we just read the connection from disk, it's clearly not Unsaved */
 		update_unsaved = FALSE;
 	}
 
-	object = (GObject *) g_object_new (NM_TYPE_KEYFILE_CONNECTION,
-	                                   NM_SETTINGS_CONNECTION_FILENAME, full_path,
-	                                   NULL);
+	connection = _connection_new (tmp, full_path, update_unsaved, error);
+	g_object_unref (tmp);
+	return connection;
+}
 
-	/* Update our settings with what was read from the file */
-	if (!nm_settings_connection_replace_settings (NM_SETTINGS_CONNECTION (object),
-	                                              tmp,
-	                                              update_unsaved,
-	                                              NULL,
-	                                              error)) {
-		g_object_unref (object);
-		object = NULL;
-	}
+/**
+ * nm_keyfile_connection_new_read:
+ * @read_connection: the connection as returned by nm_keyfile_connection_read()
+ * @full_path: the file @read_connection was read from
+ * @error: on return, a location to store any errors that may occur
+ *
+ * Like nm_keyfile_connection_new() without source, but for a file that
+ * was already read.
+ *
+ * Returns: the new connection or %NULL.
+ */
+NMKeyfileConnection *
+nm_keyfile_connection_new_read (NMConnection *read_connection,
+                                const char *full_path,
+                                GError **error)
+{
+	g_return_val_if_fail (NM_IS_CONNECTION (read_connection), NULL);
+	g_return_val_if_fail (full_path, NULL);
 
-	g_object_unref (tmp);
-	return (NMKeyfileConnection *) object;
+	return _connection_new (read_connection, full_path, FALSE, error);
 }
 
 static void
@@ -47,6 +47,13 @@ NMKeyfileConnection *nm_keyfile_connection_new (NMConnection *source,
                                                 const char *filename,
                                                 GError **error);
 
+NMConnection *nm_keyfile_connection_read (const char *full_path,
+                                          GError **error);
+
+NMKeyfileConnection *nm_keyfile_connection_new_read (NMConnection *read_connection,
+                                                     const char *full_path,
+                                                     GError **error);
+
 G_END_DECLS
 
 #endif /* __NETWORKMANAGER_KEYFILE_CONNECTION_H__ */
@@ -34,12 +34,14 @@
 #include "nm-utils.h"
 #include "nm-config.h"
 #include "nm-core-internal.h"
+#include "nm-core-utils.h"
 
 #include "plugin.h"
 #include "nm-settings-plugin.h"
 #include "nm-keyfile-connection.h"
 #include "writer.h"
 #include "utils.h"
+#include "cache.h"
 
 static void settings_plugin_interface_init (NMSettingsPluginInterface *plugin_iface);
 
@@ -49,6 +51,8 @@ G_DEFINE_TYPE_EXTENDED (SettingsPluginKeyfile, settings_plugin_keyfile, G_TYPE_O
 
 #define SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), SETTINGS_TYPE_PLUGIN_KEYFILE, SettingsPluginKeyfilePrivate))
 
+typedef struct _LoadData LoadData;
+
 typedef struct {
 	GHashTable *connections;  /* uuid::connection */
 
@@ -56,6 +60,10 @@ typedef struct {
 	GFileMonitor *monitor;
 	gulong monitor_id;
 
+	/* the initial loading of connections, while it is still in progress
+	 * on worker threads. */
+	LoadData *load;
+
 	NMConfig *config;
 } SettingsPluginKeyfilePrivate;
 
@@ -111,6 +119,8 @@ find_by_path (SettingsPluginKeyfile *self, const char *path)
  *   and updates it. When passing @source, this adds a connection from
  *   memory.
  * @full_path: the filename of the keyfile to be loaded
+ * @read_connection: (allow-none): if given, @full_path was already read
+ *   with nm_keyfile_connection_read() and the file is not read again.
  * @connection: an existing connection that might be updated.
  *   If given, @connection must be an existing connection that is currently
  *   owned by the plugin.
@@ -140,6 +150,7 @@ static NMKeyfileConnection *
 update_connection (SettingsPluginKeyfile *self,
                    NMConnection *source,
                    const char *full_path,
+                   NMConnection *read_connection,
                    NMKeyfileConnection *connection,
                    gboolean protect_existing_connection,
                    GHashTable *protected_connections,
@@ -153,11 +164,15 @@ update_connection (SettingsPluginKeyfile *self,
 
 	g_return_val_if_fail (!source || NM_IS_CONNECTION (source), NULL);
 	g_return_val_if_fail (full_path || source, NULL);
-
-	if (full_path)
-		nm_log_dbg (LOGD_SETTINGS, "keyfile: loading from file \"%s\"...", full_path);
-
-	connection_new = nm_keyfile_connection_new (source, full_path, &local);
+	g_return_val_if_fail (!read_connection || (!source && full_path), NULL);
+
+	if (read_connection)
+		connection_new = nm_keyfile_connection_new_read (read_connection, full_path, &local);
+	else {
+		if (full_path)
+			nm_log_dbg (LOGD_SETTINGS, "keyfile: loading from file \"%s\"...", full_path);
+		connection_new = nm_keyfile_connection_new (source, full_path, &local);
+	}
 	if (!connection_new) {
 		/* Error; remove the connection */
 		if (source)
@@ -299,7 +314,7 @@ dir_changed (GFileMonitor *monitor,
 	case G_FILE_MONITOR_EVENT_CREATED:
 	case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
 		if (exists)
-			update_connection (SETTINGS_PLUGIN_KEYFILE (config), NULL, full_path, connection, TRUE, NULL, NULL);
+			update_connection (SETTINGS_PLUGIN_KEYFILE (config), NULL, full_path, NULL, connection, TRUE, NULL, NULL);
 		break;
 	default:
 		break;
@@ -385,19 +400,13 @@ _sort_paths (const char **f1, const char **f2, GHashTable *paths)
 	return strcmp (*f1, *f2);
 }
 
-static void
-read_connections (NMSettingsPlugin *config)
+static GPtrArray *
+_read_filenames (SettingsPluginKeyfile *self)
 {
-	SettingsPluginKeyfile *self = SETTINGS_PLUGIN_KEYFILE (config);
 	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
 	GDir *dir;
 	GError *error = NULL;
 	const char *item;
-	GHashTable *alive_connections;
-	GHashTableIter iter;
-	NMKeyfileConnection *connection;
-	GPtrArray *dead_connections = NULL;
-	guint i;
 	GPtrArray *filenames;
 	GHashTable *paths;
 
@@ -407,11 +416,9 @@ read_connections (NMSettingsPlugin *config)
 		             nm_keyfile_plugin_get_path (),
 		             error->message);
 		g_clear_error (&error);
-		return;
+		return NULL;
 	}
 
-	alive_connections = g_hash_table_new (NULL, NULL);
-
 	filenames = g_ptr_array_new_with_free_func (g_free);
 	while ((item = g_dir_read_name (dir))) {
 		if (nm_keyfile_plugin_utils_should_ignore_file (item))
@@ -430,13 +437,127 @@ read_connections (NMSettingsPlugin *config)
 	g_ptr_array_sort_with_data (filenames, (GCompareDataFunc) _sort_paths, paths);
 	g_hash_table_destroy (paths);
 
+	return filenames;
+}
+
+/* _read_connection:
+ * @cache: the cache of previously read files
+ * @full_path: the keyfile to read
+ * @out_entry: on return, the cache entry for @full_path, if any
+ * @out_cached: on return, whether the connection was taken from @cache
+ * @error: on return, the reason why the file could not be read
+ *
+ * Like nm_keyfile_connection_read(), but uses @cache if @full_path
+ * did not change since it was cached. Can be called from a worker thread.
+ */
+static NMConnection *
+_read_connection (NMKeyfileCache *cache,
+                  const char *full_path,
+                  GVariant **out_entry,
+                  gboolean *out_cached,
+                  GError **error)
+{
+	struct stat st;
+	NMConnection *connection;
+	GVariant *entry;
+
+	*out_entry = NULL;
+	*out_cached = FALSE;
+
+	if (stat (full_path, &st) != 0)
+		return nm_keyfile_connection_read (full_path, error);
+
+	entry = nm_keyfile_cache_lookup (cache, full_path, &st);
+	if (entry) {
+		connection = nm_keyfile_cache_entry_get_connection (entry, NULL);
+		if (connection) {
+			*out_entry = entry;
+			*out_cached = TRUE;
+			return connection;
+		}
+		g_variant_unref (entry);
+	}
+
+	connection = nm_keyfile_connection_read (full_path, error);
+	if (connection)
+		*out_entry = nm_keyfile_cache_entry_new (full_path, &st, connection);
+	return connection;
+}
+
+static void
+_cache_update (NMKeyfileCache *cache, GPtrArray *entries, guint n_cached)
+{
+	GError *error = NULL;
+
+	/* Only rewrite the cache if a file was not served from it or
+	 * if it has entries for files that are gone. */
+	if (   n_cached == entries->len
+	    && n_cached == nm_keyfile_cache_get_size (cache))
+		return;
+
+	if (!nm_keyfile_cache_write (NM_KEYFILE_CACHE_FILE, entries, &error)) {
+		nm_log_warn (LOGD_SETTINGS, "keyfile: cannot write cache %s: %s",
+		             NM_KEYFILE_CACHE_FILE, error->message);
+		g_clear_error (&error);
+		return;
+	}
+	nm_log_dbg (LOGD_SETTINGS, "keyfile: wrote cache %s with %u entries (%u unchanged)",
+	            NM_KEYFILE_CACHE_FILE, entries->len, n_cached);
+}
+
+static void
+read_connections (NMSettingsPlugin *config)
+{
+	SettingsPluginKeyfile *self = SETTINGS_PLUGIN_KEYFILE (config);
+	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
+	GHashTable *alive_connections;
+	GHashTableIter iter;
+	NMKeyfileConnection *connection;
+	GPtrArray *dead_connections = NULL;
+	guint i;
+	GPtrArray *filenames;
+	NMKeyfileCache *cache;
+	GPtrArray *entries;
+	guint n_cached = 0;
+
+	filenames = _read_filenames (self);
+	if (!filenames)
+		return;
+
+	alive_connections = g_hash_table_new (NULL, NULL);
+
+	cache = nm_keyfile_cache_load (NM_KEYFILE_CACHE_FILE);
+	entries = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+
 	for (i = 0; i < filenames->len; i++) {
-		connection = update_connection (self, NULL, filenames->pdata[i], NULL, FALSE, alive_connections, NULL);
+		const char *full_path = filenames->pdata[i];
+		gs_unref_object NMConnection *read_connection = NULL;
+		GVariant *entry;
+		gboolean cached;
+		GError *error = NULL;
+
+		read_connection = _read_connection (cache, full_path, &entry, &cached, &error);
+		if (!read_connection) {
+			nm_log_warn (LOGD_SETTINGS, "keyfile: error loading connection from file %s: %s", full_path, error->message);
+			g_clear_error (&error);
+			continue;
+		}
+		if (entry) {
+			g_ptr_array_add (entries, entry);
+			if (cached)
+				n_cached++;
+		}
+
+		connection = update_connection (self, NULL, full_path, read_connection, NULL, FALSE, alive_connections, NULL);
 		if (connection)
 			g_hash_table_add (alive_connections, connection);
 	}
 	g_ptr_array_free (filenames, TRUE);
 
+	_cache_update (cache, entries, n_cached);
+	g_ptr_array_unref (entries);
+	nm_keyfile_cache_free (cache);
+
 	g_hash_table_iter_init (&iter, priv->connections);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &connection)) {
 		if (   !g_hash_table_contains (alive_connections, connection)
@@ -455,21 +576,277 @@ read_connections (NMSettingsPlugin *config)
 	}
 }
 
+/*****************************************************************************/
+
+struct _LoadData {
+	SettingsPluginKeyfile *self;
+	GThreadPool *pool;
+
+	/* the files to read, sorted like for read_connections(). The worker
+	 * for the file at index i sets connections[i] or errors[i], and
+	 * entries[i] for the cache. */
+	GPtrArray *filenames;
+	NMConnection **connections;
+	GError **errors;
+	GVariant **entries;
+
+	/* read-only while workers are running */
+	NMKeyfileCache *cache;
+
+	/* the number of files not yet read and the number of
+	 * files served from the cache. Accessed atomically. */
+	int n_pending;
+	int n_cached;
+
+	/* the idle source that completes the load, scheduled by the worker
+	 * that read the last file. @lock protects @idle_id and @cancelled,
+	 * because the main thread may cancel the load meanwhile. */
+	GMutex lock;
+	guint idle_id;
+	gboolean cancelled;
+
+	gint64 start_ms;
+};
+
+static void
+_load_data_free (LoadData *load)
+{
+	guint i;
+
+	nm_assert (!load->pool);
+
+	for (i = 0; i < load->filenames->len; i++) {
+		if (load->connections[i])
+			g_object_unref (load->connections[i]);
+		if (load->entries[i])
+			g_variant_unref (load->entries[i]);
+		g_clear_error (&load->errors[i]);
+	}
+	g_free (load->connections);
+	g_free (load->errors);
+	g_free (load->entries);
+	nm_keyfile_cache_free (load->cache);
+	g_ptr_array_unref (load->filenames);
+	g_mutex_clear (&load->lock);
+	g_slice_free (LoadData, load);
+}
+
+static void
+_load_ensure_setting_types (void)
+{
+	/* Settings register their name when their GType is created. Looking
+	 * up setting types by name is not thread-safe against that, so create
+	 * all types on the main thread before reading files on worker threads. */
+	g_type_ensure (NM_TYPE_SETTING_802_1X);
+	g_type_ensure (NM_TYPE_SETTING_ADSL);
+	g_type_ensure (NM_TYPE_SETTING_BLUETOOTH);
+	g_type_ensure (NM_TYPE_SETTING_BOND);
+	g_type_ensure (NM_TYPE_SETTING_BRIDGE);
+	g_type_ensure (NM_TYPE_SETTING_BRIDGE_PORT);
+	g_type_ensure (NM_TYPE_SETTING_CDMA);
+	g_type_ensure (NM_TYPE_SETTING_CONNECTION);
+	g_type_ensure (NM_TYPE_SETTING_DCB);
+	g_type_ensure (NM_TYPE_SETTING_GENERIC);
+	g_type_ensure (NM_TYPE_SETTING_GSM);
+	g_type_ensure (NM_TYPE_SETTING_INFINIBAND);
+	g_type_ensure (NM_TYPE_SETTING_IP4_CONFIG);
+	g_type_ensure (NM_TYPE_SETTING_IP6_CONFIG);
+	g_type_ensure (NM_TYPE_SETTING_IP_TUNNEL);
+	g_type_ensure (NM_TYPE_SETTING_MACVLAN);
+	g_type_ensure (NM_TYPE_SETTING_OLPC_MESH);
+	g_type_ensure (NM_TYPE_SETTING_PPP);
+	g_type_ensure (NM_TYPE_SETTING_PPPOE);
+	g_type_ensure (NM_TYPE_SETTING_SERIAL);
+	g_type_ensure (NM_TYPE_SETTING_TEAM);
+	g_type_ensure (NM_TYPE_SETTING_TEAM_PORT);
+	g_type_ensure (NM_TYPE_SETTING_TUN);
+	g_type_ensure (NM_TYPE_SETTING_VLAN);
+	g_type_ensure (NM_TYPE_SETTING_VPN);
+	g_type_ensure (NM_TYPE_SETTING_VXLAN);
+	g_type_ensure (NM_TYPE_SETTING_WIMAX);
+	g_type_ensure (NM_TYPE_SETTING_WIRED);
+	g_type_ensure (NM_TYPE_SETTING_WIRELESS);
+	g_type_ensure (NM_TYPE_SETTING_WIRELESS_SECURITY);
+}
+
+static gboolean _load_done (gpointer user_data);
+
+static void
+_load_thread_func (gpointer data, gpointer user_data)
+{
+	LoadData *load = user_data;
+	guint i = GPOINTER_TO_UINT (data) - 1;
+	gboolean cached;
+
+	/* Runs on a worker thread. Only touch the slots for this file. */
+	load->connections[i] = _read_connection (load->cache,
+	                                         load->filenames->pdata[i],
+	                                         &load->entries[i],
+	                                         &cached,
+	                                         &load->errors[i]);
+	if (cached)
+		g_atomic_int_inc (&load->n_cached);
+
+	if (g_atomic_int_dec_and_test (&load->n_pending)) {
+		g_mutex_lock (&load->lock);
+		if (!load->cancelled)
+			load->idle_id = g_idle_add (_load_done, load);
+		g_mutex_unlock (&load->lock);
+	}
+}
+
+static gboolean
+_load_done (gpointer user_data)
+{
+	LoadData *load = user_data;
+	SettingsPluginKeyfile *self = load->self;
+	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
+	GHashTable *alive_connections;
+	NMKeyfileConnection *connection;
+	GPtrArray *entries;
+	guint i;
+
+	nm_assert (priv->load == load);
+
+	/* All files are read. This only waits for the last worker to return. */
+	g_thread_pool_free (load->pool, FALSE, TRUE);
+	load->pool = NULL;
+	g_mutex_lock (&load->lock);
+	load->idle_id = 0;
+	g_mutex_unlock (&load->lock);
+	priv->load = NULL;
+
+	nm_log_dbg (LOGD_SETTINGS, "keyfile: read %u files in %lld msec (%d from cache)",
+	            load->filenames->len,
+	            (long long) (nm_utils_get_monotonic_timestamp_ms () - load->start_ms),
+	            load->n_cached);
+
+	entries = g_ptr_array_new ();
+	for (i = 0; i < load->filenames->len; i++) {
+		if (load->entries[i])
+			g_ptr_array_add (entries, load->entries[i]);
+	}
+	_cache_update (load->cache, entries, load->n_cached);
+	g_ptr_array_unref (entries);
+
+	/* Add the connections in the same order as read_connections() would. */
+	alive_connections = g_hash_table_new (NULL, NULL);
+	for (i = 0; i < load->filenames->len; i++) {
+		const char *full_path = load->filenames->pdata[i];
+
+		if (!load->connections[i]) {
+			nm_log_warn (LOGD_SETTINGS, "keyfile: error loading connection from file %s: %s",
+			             full_path, load->errors[i]->message);
+			continue;
+		}
+
+		connection = update_connection (self, NULL, full_path, load->connections[i], NULL, FALSE, alive_connections, NULL);
+		if (connection)
+			g_hash_table_add (alive_connections, connection);
+	}
+	g_hash_table_destroy (alive_connections);
+
+	_load_data_free (load);
+
+	g_signal_emit_by_name (self, NM_SETTINGS_PLUGIN_LOADING_FINISHED);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_load_start (SettingsPluginKeyfile *self, guint n_threads)
+{
+	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
+	LoadData *load;
+	GPtrArray *filenames;
+	guint i;
+
+	nm_assert (!priv->load);
+	nm_assert (n_threads > 0);
+
+	filenames = _read_filenames (self);
+	if (!filenames)
+		return;
+	if (filenames->len == 0) {
+		g_ptr_array_unref (filenames);
+		return;
+	}
+
+	_load_ensure_setting_types ();
+
+	load = g_slice_new0 (LoadData);
+	load->self = self;
+	load->filenames = filenames;
+	load->connections = g_new0 (NMConnection *, filenames->len);
+	load->errors = g_new0 (GError *, filenames->len);
+	load->entries = g_new0 (GVariant *, filenames->len);
+	load->cache = nm_keyfile_cache_load (NM_KEYFILE_CACHE_FILE);
+	load->n_pending = filenames->len;
+	load->start_ms = nm_utils_get_monotonic_timestamp_ms ();
+	g_mutex_init (&load->lock);
+	load->pool = g_thread_pool_new (_load_thread_func, load,
+	                                MIN (n_threads, filenames->len),
+	                                TRUE, NULL);
+	priv->load = load;
+
+	nm_log_dbg (LOGD_SETTINGS, "keyfile: reading %u files with %u threads",
+	            filenames->len, MIN (n_threads, filenames->len));
+
+	for (i = 0; i < filenames->len; i++)
+		g_thread_pool_push (load->pool, GUINT_TO_POINTER (i + 1), NULL);
+}
+
+static void
+_load_cancel (SettingsPluginKeyfile *self)
+{
+	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
+	LoadData *load = priv->load;
+
+	if (!load)
+		return;
+	priv->load = NULL;
+
+	/* A worker that finishes from now on must not schedule _load_done(). */
+	g_mutex_lock (&load->lock);
+	load->cancelled = TRUE;
+	nm_clear_g_source (&load->idle_id);
+	g_mutex_unlock (&load->lock);
+
+	/* Drop the files not yet started and wait for the running workers.
+	 * Afterwards, no worker accesses @load anymore. */
+	g_thread_pool_free (load->pool, TRUE, TRUE);
+	load->pool = NULL;
+
+	_load_data_free (load);
+}
+
 /* Plugin */
 
 static GSList *
 get_connections (NMSettingsPlugin *config)
 {
-	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (config);
+	SettingsPluginKeyfile *self = SETTINGS_PLUGIN_KEYFILE (config);
+	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self);
+	guint n_threads;
 
 	if (!priv->initialized) {
 		setup_monitoring (config);
-		read_connections (config);
+
+		n_threads = nm_config_get_connection_load_threads (priv->config);
+		if (n_threads > 0)
+			_load_start (self, n_threads);
+		else
+			read_connections (config);
 		priv->initialized = TRUE;
 	}
 	return _nm_utils_hash_values_to_slist (priv->connections);
 }
 
+static gboolean
+get_loading (NMSettingsPlugin *config)
+{
+	return !!SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (config)->load;
+}
+
 static gboolean
 load_connection (NMSettingsPlugin *config,
                  const char *filename)
@@ -486,7 +863,7 @@ load_connection (NMSettingsPlugin *config,
 	if (nm_keyfile_plugin_utils_should_ignore_file (filename + dir_len + 1))
 		return FALSE;
 
-	connection = update_connection (self, NULL, filename, find_by_path (self, filename), TRUE, NULL, NULL);
+	connection = update_connection (self, NULL, filename, NULL, find_by_path (self, filename), TRUE, NULL, NULL);
 
 	return (connection != NULL);
 }
@@ -494,6 +871,17 @@ load_connection (NMSettingsPlugin *config,
 static void
 reload_connections (NMSettingsPlugin *config)
 {
+	SettingsPluginKeyfile *self = SETTINGS_PLUGIN_KEYFILE (config);
+
+	if (SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (self)->load) {
+		/* Reloading is synchronous. Instead of waiting for the
+		 * initial load, read everything again right away. */
+		_load_cancel (self);
+		read_connections (config);
+		g_signal_emit_by_name (self, NM_SETTINGS_PLUGIN_LOADING_FINISHED);
+		return;
+	}
+
 	read_connections (config);
 }
 
@@ -510,7 +898,7 @@ add_connection (NMSettingsPlugin *config,
 		if (!nm_keyfile_plugin_write_connection (connection, NULL, FALSE, &path, error))
 			return NULL;
 	}
-	return NM_SETTINGS_CONNECTION (update_connection (self, connection, path, NULL, FALSE, NULL, error));
+	return NM_SETTINGS_CONNECTION (update_connection (self, connection, path, NULL, NULL, FALSE, NULL, error));
 }
 
 static GSList *
@@ -585,6 +973,8 @@ dispose (GObject *object)
 {
 	SettingsPluginKeyfilePrivate *priv = SETTINGS_PLUGIN_KEYFILE_GET_PRIVATE (object);
 
+	_load_cancel (SETTINGS_PLUGIN_KEYFILE (object));
+
 	if (priv->monitor) {
 		nm_clear_g_signal_handler (priv->monitor, &priv->monitor_id);
 
@@ -639,6 +1029,7 @@ settings_plugin_interface_init (NMSettingsPluginInterface *plugin_iface)
 	plugin_iface->reload_connections = reload_connections;
 	plugin_iface->add_connection = add_connection;
 	plugin_iface->get_unmanaged_specs = get_unmanaged_specs;
+	plugin_iface->get_loading = get_loading;
 }
 
 GObject *
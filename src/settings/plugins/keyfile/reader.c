@@ -85,36 +85,61 @@ _handler_read (GKeyFile *keyfile,
 	return FALSE;
 }
 
-NMConnection *
-nm_keyfile_plugin_connection_from_file (const char *filename, GError **error)
+/**
+ * nm_keyfile_plugin_check_file:
+ * @st: the stat() data of a keyfile
+ * @error: on return, the reason why the file is rejected
+ *
+ * Checks that the file type, permissions and owner of a keyfile are
+ * safe to load the connection from.
+ *
+ * Returns: %TRUE if the file is acceptable.
+ */
+gboolean
+nm_keyfile_plugin_check_file (const struct stat *st, GError **error)
 {
-	GKeyFile *key_file;
-	struct stat statbuf;
-	NMConnection *connection = NULL;
-	GError *verify_error = NULL;
-
-	if (stat (filename, &statbuf) != 0 || !S_ISREG (statbuf.st_mode)) {
+	if (!S_ISREG (st->st_mode)) {
 		g_set_error_literal (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
 		                     "File did not exist or was not a regular file");
-		return NULL;
+		return FALSE;
 	}
 
-	if (statbuf.st_mode & 0077) {
+	if (st->st_mode & 0077) {
 		g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
 		             "File permissions (%o) were insecure",
-		             statbuf.st_mode);
-		return NULL;
+		             st->st_mode);
+		return FALSE;
 	}
 
 	if (!NM_FLAGS_HAS (nm_utils_get_testing (), NM_UTILS_TEST_NO_KEYFILE_OWNER_CHECK)) {
-		if (statbuf.st_uid != 0) {
+		if (st->st_uid != 0) {
 			g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
 			             "File owner (%o) is insecure",
-			             statbuf.st_mode);
-			return NULL;
+			             st->st_mode);
+			return FALSE;
 		}
 	}
 
+	return TRUE;
+}
+
+NMConnection *
+nm_keyfile_plugin_connection_from_file (const char *filename, GError **error)
+{
+	GKeyFile *key_file;
+	struct stat statbuf;
+	NMConnection *connection = NULL;
+	GError *verify_error = NULL;
+
+	if (stat (filename, &statbuf) != 0) {
+		g_set_error_literal (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
+		                     "File did not exist or was not a regular file");
+		return NULL;
+	}
+
+	if (!nm_keyfile_plugin_check_file (&statbuf, error))
+		return NULL;
+
 	key_file = g_key_file_new ();
 	if (!g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, error))
 		goto out;
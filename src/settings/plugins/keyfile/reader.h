@@ -22,10 +22,14 @@
 #ifndef _KEYFILE_PLUGIN_READER_H
 #define _KEYFILE_PLUGIN_READER_H
 
+#include <sys/stat.h>
+
 #include <nm-connection.h>
 
 #include "nm-default.h"
 
+gboolean nm_keyfile_plugin_check_file (const struct stat *st, GError **error);
+
 NMConnection *nm_keyfile_plugin_connection_from_file (const char *filename, GError **error);
 
 #endif /* _KEYFILE_PLUGIN_READER_H */
@@ -33,6 +33,13 @@
 #include "reader.h"
 #include "writer.h"
 #include "utils.h"
+#include "cache.h"
+#include "plugin.h"
+#include "nm-config.h"
+#include "nm-auth-manager.h"
+#include "nm-settings-plugin.h"
+#include "nm-settings-connection.h"
+#include "nm-settings.h"
 
 #include "nm-test-utils-core.h"
 
@@ -2944,6 +2951,326 @@ test_write_flags_property (void)
 
 /*****************************************************************************/
 
+static void
+test_cache (void)
+{
+	const char *keyfile = TEST_KEYFILES_DIR "/Test_Wired_Connection";
+	const char *cachefile = TEST_SCRATCH_DIR "/keyfile-cache";
+	gs_unref_object NMConnection *connection = NULL;
+	gs_unref_object NMConnection *cached = NULL;
+	gs_unref_ptrarray GPtrArray *entries = NULL;
+	gs_unref_variant GVariant *entry = NULL;
+	NMKeyfileCache *cache;
+	GError *error = NULL;
+	struct stat st;
+	struct stat st_changed;
+	gboolean success;
+
+	g_assert_cmpint (stat (keyfile, &st), ==, 0);
+
+	connection = nm_keyfile_plugin_connection_from_file (keyfile, &error);
+	g_assert_no_error (error);
+	g_assert (connection);
+
+	entries = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+	g_ptr_array_add (entries, nm_keyfile_cache_entry_new (keyfile, &st, connection));
+	g_assert (entries->pdata[0]);
+
+	unlink (cachefile);
+	success = nm_keyfile_cache_write (cachefile, entries, &error);
+	g_assert_no_error (error);
+	g_assert (success);
+
+	cache = nm_keyfile_cache_load (cachefile);
+	g_assert_cmpint (nm_keyfile_cache_get_size (cache), ==, 1);
+
+	g_assert (!nm_keyfile_cache_lookup (cache, TEST_KEYFILES_DIR "/Test_Wired_Connection_IP6", &st));
+
+	/* a modified file is not served from the cache */
+	st_changed = st;
+	st_changed.st_mtim.tv_nsec++;
+	g_assert (!nm_keyfile_cache_lookup (cache, keyfile, &st_changed));
+	st_changed = st;
+	st_changed.st_size++;
+	g_assert (!nm_keyfile_cache_lookup (cache, keyfile, &st_changed));
+
+	entry = nm_keyfile_cache_lookup (cache, keyfile, &st);
+	g_assert (entry);
+
+	cached = nm_keyfile_cache_entry_get_connection (entry, &error);
+	g_assert_no_error (error);
+	g_assert (cached);
+	g_assert (nm_connection_compare (connection, cached, NM_SETTING_COMPARE_FLAG_EXACT));
+
+	nm_keyfile_cache_free (cache);
+	unlink (cachefile);
+
+	/* a missing cache file yields an empty cache */
+	cache = nm_keyfile_cache_load (cachefile);
+	g_assert_cmpint (nm_keyfile_cache_get_size (cache), ==, 0);
+	g_assert (!nm_keyfile_cache_lookup (cache, keyfile, &st));
+	nm_keyfile_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+#define LOAD_THREADS_DIR      TEST_SCRATCH_DIR "/load-threads"
+#define LOAD_THREADS_CONFIG   TEST_SCRATCH_DIR "/load-threads.conf"
+#define LOAD_THREADS_N        20
+
+static void
+_load_threads_setup_config (void)
+{
+	NMConfigCmdLineOptions *cli;
+	GOptionContext *context;
+	NMConfig *config;
+	GError *error = NULL;
+	char *args[] = { "test-keyfile",
+	                 "--config", LOAD_THREADS_CONFIG,
+	                 "--config-dir", "/no/such/dir",
+	                 "--system-config-dir", "/no/such/dir",
+	                 "--intern-config", "",
+	                 NULL };
+	char **argv = args;
+	int argc = G_N_ELEMENTS (args) - 1;
+	gboolean success;
+
+	success = g_file_set_contents (LOAD_THREADS_CONFIG,
+	                               "[main]\n"
+	                               "plugins=keyfile\n"
+	                               "connection-load-threads=4\n"
+	                               "\n"
+	                               "[keyfile]\n"
+	                               "path=" LOAD_THREADS_DIR "\n",
+	                               -1, &error);
+	g_assert_no_error (error);
+	g_assert (success);
+
+	cli = nm_config_cmd_line_options_new ();
+	context = g_option_context_new (NULL);
+	nm_config_cmd_line_options_add_to_entries (cli, context);
+	success = g_option_context_parse (context, &argc, &argv, &error);
+	g_assert_no_error (error);
+	g_assert (success);
+	g_option_context_free (context);
+
+	config = nm_config_setup (cli, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (config);
+	nm_config_cmd_line_options_free (cli);
+
+	g_assert_cmpint (nm_config_get_connection_load_threads (config), ==, 4);
+	g_assert_cmpstr (nm_keyfile_plugin_get_path (), ==, LOAD_THREADS_DIR);
+
+	nm_auth_manager_setup (FALSE);
+
+	unlink (LOAD_THREADS_CONFIG);
+}
+
+static void
+_load_threads_finished (NMSettingsPlugin *plugin, GMainLoop *loop)
+{
+	g_main_loop_quit (loop);
+}
+
+static void
+test_load_threads (void)
+{
+	gs_unref_object GObject *plugin = NULL;
+	gs_unref_ptrarray GPtrArray *files = NULL;
+	char *uuids[LOAD_THREADS_N];
+	GMainLoop *loop;
+	GSList *connections, *iter;
+	GError *error = NULL;
+	gboolean success;
+	guint i;
+
+	g_assert_cmpint (g_mkdir_with_parents (LOAD_THREADS_DIR, 0755), ==, 0);
+	files = g_ptr_array_new_with_free_func (g_free);
+	for (i = 0; i < LOAD_THREADS_N; i++) {
+		gs_unref_object NMConnection *connection = NULL;
+		gs_free char *id = g_strdup_printf ("Load Threads %u", i);
+		char *testfile = NULL;
+
+		uuids[i] = nm_utils_uuid_generate ();
+		connection = nmtst_create_minimal_connection (id, uuids[i], NM_SETTING_WIRED_SETTING_NAME, NULL);
+		nmtst_connection_normalize (connection);
+
+		success = nm_keyfile_plugin_write_test_connection (connection, LOAD_THREADS_DIR, geteuid (), getegid (), &testfile, &error);
+		g_assert_no_error (error);
+		g_assert (success);
+		g_ptr_array_add (files, testfile);
+	}
+
+	_load_threads_setup_config ();
+
+	plugin = nm_settings_keyfile_plugin_new ();
+
+	/* With worker threads, the connections are only there once
+	 * the plugin is done loading. */
+	connections = nm_settings_plugin_get_connections (NM_SETTINGS_PLUGIN (plugin));
+	g_assert (nm_settings_plugin_get_loading (NM_SETTINGS_PLUGIN (plugin)));
+	g_assert_cmpint (g_slist_length (connections), ==, 0);
+	g_slist_free (connections);
+
+	loop = g_main_loop_new (NULL, FALSE);
+	g_signal_connect (plugin, NM_SETTINGS_PLUGIN_LOADING_FINISHED,
+	                  G_CALLBACK (_load_threads_finished), loop);
+	g_assert (nmtst_main_loop_run (loop, 5000));
+	g_main_loop_unref (loop);
+
+	g_assert (!nm_settings_plugin_get_loading (NM_SETTINGS_PLUGIN (plugin)));
+	connections = nm_settings_plugin_get_connections (NM_SETTINGS_PLUGIN (plugin));
+	g_assert_cmpint (g_slist_length (connections), ==, LOAD_THREADS_N);
+	for (i = 0; i < LOAD_THREADS_N; i++) {
+		for (iter = connections; iter; iter = iter->next) {
+			if (nm_streq (nm_connection_get_uuid (iter->data), uuids[i]))
+				break;
+		}
+		g_assert (iter);
+	}
+	g_slist_free (connections);
+
+	for (i = 0; i < LOAD_THREADS_N; i++) {
+		unlink (files->pdata[i]);
+		g_free (uuids[i]);
+	}
+	rmdir (LOAD_THREADS_DIR);
+}
+
+/*****************************************************************************/
+
+#define SORTED_N 10
+
+/* the order of nm_settings_get_connections_sorted(): autoconnect first,
+ * then the most recent timestamp. */
+static int
+_sorted_cmp (NMSettingsConnection *a, NMSettingsConnection *b)
+{
+	gboolean ac_a, ac_b;
+	guint64 ts_a = 0, ts_b = 0;
+
+	ac_a = nm_setting_connection_get_autoconnect (nm_connection_get_setting_connection (NM_CONNECTION (a)));
+	ac_b = nm_setting_connection_get_autoconnect (nm_connection_get_setting_connection (NM_CONNECTION (b)));
+	if (ac_a != ac_b)
+		return ac_a ? -1 : 1;
+
+	nm_settings_connection_get_timestamp (a, &ts_a);
+	nm_settings_connection_get_timestamp (b, &ts_b);
+	if (ts_a != ts_b)
+		return ts_a > ts_b ? -1 : 1;
+	return 0;
+}
+
+static void
+_assert_sorted (NMSettings *settings, guint expected_len)
+{
+	NMSettingsIter iter;
+	NMSettingsConnection *connection, *prev = NULL;
+	GSList *list, *l;
+	guint n = 0;
+
+	list = nm_settings_get_connections_sorted (settings);
+	l = list;
+	nm_settings_iter_init (&iter, settings);
+	while (nm_settings_iter_next (&iter, &connection)) {
+		g_assert (l && l->data == connection);
+		if (prev)
+			g_assert_cmpint (_sorted_cmp (prev, connection), <=, 0);
+		prev = connection;
+		l = l->next;
+		n++;
+	}
+	g_assert (!l);
+	g_assert_cmpint (n, ==, expected_len);
+	g_slist_free (list);
+}
+
+static void
+test_sorted_connections (void)
+{
+	gs_unref_object NMSettings *settings = NULL;
+	NMSettingsConnection *connections[SORTED_N];
+	char *filenames[SORTED_N];
+	NMSettingsIter iter;
+	NMSettingsConnection *connection;
+	GError *error = NULL;
+	gboolean success;
+	guint i, n, round;
+
+	/* Uses the configuration of test_load_threads(). */
+	g_assert_cmpint (g_mkdir_with_parents (LOAD_THREADS_DIR, 0755), ==, 0);
+
+	settings = nm_settings_new ();
+	success = nm_settings_start (settings, &error);
+	g_assert_no_error (error);
+	g_assert (success);
+	while (nm_settings_get_loading (settings))
+		g_main_context_iteration (NULL, TRUE);
+	_assert_sorted (settings, 0);
+
+	for (i = 0; i < SORTED_N; i++) {
+		gs_unref_object NMConnection *connection = NULL;
+		gs_free char *id = g_strdup_printf ("Sorted %u", i);
+		gs_free char *uuid = nm_utils_uuid_generate ();
+
+		connection = nmtst_create_minimal_connection (id, uuid, NM_SETTING_WIRED_SETTING_NAME, NULL);
+		g_object_set (nm_connection_get_setting_connection (connection),
+		              NM_SETTING_CONNECTION_AUTOCONNECT, (gboolean) (i % 3 != 0),
+		              NULL);
+		nmtst_connection_normalize (connection);
+
+		connections[i] = nm_settings_add_connection (settings, connection, TRUE, &error);
+		g_assert_no_error (error);
+		g_assert (connections[i]);
+		filenames[i] = g_strdup (nm_settings_connection_get_filename (connections[i]));
+		nm_settings_connection_update_timestamp (connections[i], nmtst_get_rand_int () % 1000 + 1, FALSE);
+		_assert_sorted (settings, i + 1);
+	}
+
+	/* the order follows timestamp changes... */
+	for (round = 0; round < 50; round++) {
+		i = nmtst_get_rand_int () % SORTED_N;
+		nm_settings_connection_update_timestamp (connections[i], nmtst_get_rand_int () % 1000 + 1, FALSE);
+		_assert_sorted (settings, SORTED_N);
+	}
+
+	/* ... and updates of autoconnect. */
+	for (i = 0; i < SORTED_N; i += 2) {
+		gs_unref_object NMConnection *copy = nm_simple_connection_new_clone (NM_CONNECTION (connections[i]));
+		NMSettingConnection *s_con = nm_connection_get_setting_connection (copy);
+
+		g_object_set (s_con,
+		              NM_SETTING_CONNECTION_AUTOCONNECT, !nm_setting_connection_get_autoconnect (s_con),
+		              NULL);
+		success = nm_settings_connection_replace_settings (connections[i], copy, TRUE, "test", &error);
+		g_assert_no_error (error);
+		g_assert (success);
+		_assert_sorted (settings, SORTED_N);
+	}
+
+	/* The iterator continues after the connection it returned last,
+	 * even if that one is removed. */
+	n = 0;
+	nm_settings_iter_init (&iter, settings);
+	while (nm_settings_iter_next (&iter, &connection)) {
+		n++;
+		if (n % 2)
+			nm_settings_connection_signal_remove (connection);
+	}
+	g_assert_cmpint (n, ==, SORTED_N);
+	_assert_sorted (settings, SORTED_N / 2);
+
+	for (i = 0; i < SORTED_N; i++) {
+		if (filenames[i])
+			unlink (filenames[i]);
+		g_free (filenames[i]);
+	}
+	rmdir (LOAD_THREADS_DIR);
+}
+
+/*****************************************************************************/
+
 static void
 _escape_filename (const char *filename, gboolean would_be_ignored)
 {
@@ -3064,6 +3391,10 @@ int main (int argc, char **argv)
 	g_test_add_func ("/keyfile/test_read_flags_property", test_read_flags_property);
 	g_test_add_func ("/keyfile/test_write_flags_property", test_write_flags_property);
 
+	g_test_add_func ("/keyfile/test_cache", test_cache);
+	g_test_add_func ("/keyfile/test_load_threads", test_load_threads);
+	g_test_add_func ("/keyfile/test_sorted_connections", test_sorted_connections);
+
 	g_test_add_func ("/keyfile/test_nm_keyfile_plugin_utils_escape_filename", test_nm_keyfile_plugin_utils_escape_filename);
 
 	return g_test_run ();
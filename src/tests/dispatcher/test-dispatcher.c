@@ -0,0 +1,423 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ */
+
+#include "nm-default.h"
+
+#include <string.h>
+
+#include "nm-dispatcher.h"
+#include "nm-dispatcher-api.h"
+
+#include "nm-test-utils-core.h"
+
+/*******************************************/
+
+/* A fake dispatcher on the session bus. It runs in its own thread, so that
+ * it can answer the synchronous calls of nm_dispatcher_shutdown(). */
+
+static const char introspection_xml[] =
+	"<node>"
+	"  <interface name='" NM_DISPATCHER_DBUS_INTERFACE "'>"
+	"    <method name='Action'>"
+	"      <arg name='action' type='s' direction='in'/>"
+	"      <arg name='connection' type='a{sa{sv}}' direction='in'/>"
+	"      <arg name='connection_properties' type='a{sv}' direction='in'/>"
+	"      <arg name='device_properties' type='a{sv}' direction='in'/>"
+	"      <arg name='device_ip4_config' type='a{sv}' direction='in'/>"
+	"      <arg name='device_ip6_config' type='a{sv}' direction='in'/>"
+	"      <arg name='device_dhcp4_config' type='a{sv}' direction='in'/>"
+	"      <arg name='device_dhcp6_config' type='a{sv}' direction='in'/>"
+	"      <arg name='connectivity_state' type='s' direction='in'/>"
+	"      <arg name='vpn_ip_iface' type='s' direction='in'/>"
+	"      <arg name='vpn_ip4_config' type='a{sv}' direction='in'/>"
+	"      <arg name='vpn_ip6_config' type='a{sv}' direction='in'/>"
+	"      <arg name='debug' type='b' direction='in'/>"
+	"      <arg name='results' type='a(sus)' direction='out'/>"
+	"    </method>"
+	"    <method name='ActionBatch'>"
+	"      <arg name='events' type='a(sa{sa{sv}}a{sv}a{sv}a{sv}a{sv}a{sv}a{sv}ssa{sv}a{sv}b)' direction='in'/>"
+	"      <arg name='results' type='aa(sus)' direction='out'/>"
+	"    </method>"
+	"  </interface>"
+	"</node>";
+
+static struct {
+	GThread *thread;
+	GMainContext *context;
+	GMainLoop *loop;
+	GDBusConnection *connection;
+
+	GMutex lock;
+	GPtrArray *calls;      /* the received calls, as strings */
+	GQueue held;           /* Action calls waiting for the reply */
+	gboolean hold;         /* don't reply to Action calls right away */
+	gboolean no_batch;     /* reject ActionBatch like an older dispatcher */
+} fake;
+
+static void
+_event_describe (GString *str, GVariant *event)
+{
+	const char *action, *connectivity_state;
+
+	g_variant_get_child (event, 0, "&s", &action);
+	g_variant_get_child (event, 8, "&s", &connectivity_state);
+	g_string_append_printf (str, " %s:%s", action, connectivity_state);
+}
+
+static void
+_fake_reply_action (GDBusMethodInvocation *invocation)
+{
+	g_dbus_method_invocation_return_value (invocation,
+	                                       g_variant_new ("(@a(sus))",
+	                                                      g_variant_new_array (G_VARIANT_TYPE ("(sus)"), NULL, 0)));
+}
+
+static void
+_fake_method_call (GDBusConnection *connection,
+                   const char *sender,
+                   const char *object_path,
+                   const char *interface_name,
+                   const char *method_name,
+                   GVariant *parameters,
+                   GDBusMethodInvocation *invocation,
+                   gpointer user_data)
+{
+	GString *str = g_string_new (method_name);
+	gboolean hold, reject;
+
+	if (nm_streq (method_name, "ActionBatch")) {
+		gs_unref_variant GVariant *events = g_variant_get_child_value (parameters, 0);
+		GVariantBuilder results;
+		GVariantIter iter;
+		GVariant *event;
+
+		g_variant_builder_init (&results, G_VARIANT_TYPE ("aa(sus)"));
+		g_variant_iter_init (&iter, events);
+		while ((event = g_variant_iter_next_value (&iter))) {
+			_event_describe (str, event);
+			g_variant_builder_add_value (&results, g_variant_new_array (G_VARIANT_TYPE ("(sus)"), NULL, 0));
+			g_variant_unref (event);
+		}
+
+		g_mutex_lock (&fake.lock);
+		g_ptr_array_add (fake.calls, g_string_free (str, FALSE));
+		reject = fake.no_batch;
+		g_mutex_unlock (&fake.lock);
+
+		if (reject) {
+			g_variant_builder_clear (&results);
+			g_dbus_method_invocation_return_dbus_error (invocation,
+			                                            "org.freedesktop.DBus.Error.UnknownMethod",
+			                                            "No such method 'ActionBatch'");
+		} else
+			g_dbus_method_invocation_return_value (invocation, g_variant_new ("(aa(sus))", &results));
+		return;
+	}
+
+	_event_describe (str, parameters);
+
+	g_mutex_lock (&fake.lock);
+	g_ptr_array_add (fake.calls, g_string_free (str, FALSE));
+	hold = fake.hold;
+	if (hold)
+		g_queue_push_tail (&fake.held, invocation);
+	g_mutex_unlock (&fake.lock);
+
+	if (!hold)
+		_fake_reply_action (invocation);
+}
+
+static const GDBusInterfaceVTable fake_vtable = {
+	_fake_method_call,
+};
+
+static gpointer
+_fake_thread (gpointer user_data)
+{
+	g_main_context_push_thread_default (fake.context);
+	g_main_loop_run (fake.loop);
+	g_main_context_pop_thread_default (fake.context);
+	return NULL;
+}
+
+static void
+fake_dispatcher_start (void)
+{
+	gs_unref_variant GVariant *ret = NULL;
+	GDBusNodeInfo *info;
+	const char *address;
+	GError *error = NULL;
+	guint32 result;
+
+	address = g_getenv ("DBUS_SESSION_BUS_ADDRESS");
+	g_assert (address && *address);
+
+	g_mutex_init (&fake.lock);
+	fake.calls = g_ptr_array_new_with_free_func (g_free);
+	fake.context = g_main_context_new ();
+	fake.loop = g_main_loop_new (fake.context, FALSE);
+
+	/* Method calls are dispatched in the thread-default context at the
+	 * time of the registration. */
+	g_main_context_push_thread_default (fake.context);
+
+	fake.connection = g_dbus_connection_new_for_address_sync (address,
+	                                                          G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+	                                                              G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+	                                                          NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	info = g_dbus_node_info_new_for_xml (introspection_xml, &error);
+	g_assert_no_error (error);
+	g_dbus_connection_register_object (fake.connection,
+	                                   NM_DISPATCHER_DBUS_PATH,
+	                                   info->interfaces[0],
+	                                   &fake_vtable,
+	                                   NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_dbus_node_info_unref (info);
+
+	g_main_context_pop_thread_default (fake.context);
+
+	ret = g_dbus_connection_call_sync (fake.connection,
+	                                   "org.freedesktop.DBus",
+	                                   "/org/freedesktop/DBus",
+	                                   "org.freedesktop.DBus",
+	                                   "RequestName",
+	                                   g_variant_new ("(su)", NM_DISPATCHER_DBUS_SERVICE, 0x4 /* DBUS_NAME_FLAG_DO_NOT_QUEUE */),
+	                                   G_VARIANT_TYPE ("(u)"),
+	                                   G_DBUS_CALL_FLAGS_NONE, -1,
+	                                   NULL, &error);
+	g_assert_no_error (error);
+	g_variant_get (ret, "(u)", &result);
+	g_assert_cmpint (result, ==, 1 /* DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER */);
+
+	fake.thread = g_thread_new ("fake-dispatcher", _fake_thread, NULL);
+
+	/* NetworkManager talks to the dispatcher on the system bus. */
+	g_setenv ("DBUS_SYSTEM_BUS_ADDRESS", address, TRUE);
+}
+
+static void
+fake_dispatcher_release (void)
+{
+	GDBusMethodInvocation *invocation;
+
+	g_mutex_lock (&fake.lock);
+	invocation = g_queue_pop_head (&fake.held);
+	g_mutex_unlock (&fake.lock);
+
+	g_assert (invocation);
+	_fake_reply_action (invocation);
+}
+
+static guint
+_calls_len (void)
+{
+	guint len;
+
+	g_mutex_lock (&fake.lock);
+	len = fake.calls->len;
+	g_mutex_unlock (&fake.lock);
+	return len;
+}
+
+/* Iterates the main context until the fake dispatcher received @n calls,
+ * and a while longer to catch calls that shouldn't come. */
+static void
+_wait_for_calls (guint n)
+{
+	gint64 end = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+	gint64 settle;
+
+	while (_calls_len () < n) {
+		g_assert (g_get_monotonic_time () < end);
+		g_main_context_iteration (NULL, FALSE);
+		g_usleep (1000);
+	}
+
+	settle = g_get_monotonic_time () + 100 * 1000;
+	while (g_get_monotonic_time () < settle) {
+		g_main_context_iteration (NULL, FALSE);
+		g_usleep (1000);
+	}
+}
+
+/* Compares the received calls with the %NULL terminated list of
+ * expected calls, and forgets them. */
+static void
+_assert_calls (const char *first, ...)
+{
+	const char *expected;
+	va_list ap;
+	guint i = 0;
+
+	g_mutex_lock (&fake.lock);
+
+	va_start (ap, first);
+	for (expected = first; expected; expected = va_arg (ap, const char *)) {
+		g_assert_cmpint (i, <, fake.calls->len);
+		g_assert_cmpstr (fake.calls->pdata[i], ==, expected);
+		i++;
+	}
+	va_end (ap);
+	g_assert_cmpint (i, ==, fake.calls->len);
+	g_ptr_array_set_size (fake.calls, 0);
+
+	g_mutex_unlock (&fake.lock);
+}
+
+static void
+_call (NMConnectivityState state)
+{
+	g_assert (nm_dispatcher_call_connectivity (DISPATCHER_ACTION_CONNECTIVITY_CHANGE, state));
+}
+
+/*******************************************/
+
+static void
+test_batch (void)
+{
+	GString *expected1, *expected2;
+	guint i;
+
+	/* The events of one main loop iteration are sent together. */
+	_call (NM_CONNECTIVITY_FULL);
+	_call (NM_CONNECTIVITY_LIMITED);
+	_call (NM_CONNECTIVITY_NONE);
+	_wait_for_calls (1);
+	_assert_calls ("ActionBatch"
+	               " connectivity-change:FULL"
+	               " connectivity-change:LIMITED"
+	               " connectivity-change:NONE",
+	               NULL);
+
+	/* A single event is sent with Action. */
+	_call (NM_CONNECTIVITY_PORTAL);
+	_wait_for_calls (1);
+	_assert_calls ("Action connectivity-change:PORTAL", NULL);
+
+	/* A batch has at most 100 events. */
+	expected1 = g_string_new ("ActionBatch");
+	expected2 = g_string_new ("ActionBatch");
+	for (i = 0; i < 150; i++) {
+		_call (i % 2 ? NM_CONNECTIVITY_FULL : NM_CONNECTIVITY_NONE);
+		g_string_append (i < 100 ? expected1 : expected2,
+		                 i % 2 ? " connectivity-change:FULL" : " connectivity-change:NONE");
+	}
+	_wait_for_calls (2);
+	_assert_calls (expected1->str, expected2->str, NULL);
+	g_string_free (expected1, TRUE);
+	g_string_free (expected2, TRUE);
+}
+
+static void
+test_shutdown (void)
+{
+	/* Queued events are sent right away, without the main loop. */
+	_call (NM_CONNECTIVITY_FULL);
+	_call (NM_CONNECTIVITY_NONE);
+	nm_dispatcher_shutdown ();
+	_assert_calls ("ActionBatch"
+	               " connectivity-change:FULL"
+	               " connectivity-change:NONE",
+	               NULL);
+
+	_wait_for_calls (0);
+	_assert_calls (NULL);
+}
+
+static void
+test_fallback (void)
+{
+	g_mutex_lock (&fake.lock);
+	fake.no_batch = TRUE;
+	fake.hold = TRUE;
+	g_mutex_unlock (&fake.lock);
+
+	/* Without ActionBatch, the events of the batch are sent one
+	 * after another. */
+	_call (NM_CONNECTIVITY_FULL);
+	_call (NM_CONNECTIVITY_LIMITED);
+	_call (NM_CONNECTIVITY_NONE);
+	_wait_for_calls (2);
+	_assert_calls ("ActionBatch"
+	               " connectivity-change:FULL"
+	               " connectivity-change:LIMITED"
+	               " connectivity-change:NONE",
+	               "Action connectivity-change:FULL",
+	               NULL);
+
+	/* Events queued meanwhile come after them. */
+	_call (NM_CONNECTIVITY_PORTAL);
+	_wait_for_calls (0);
+	_assert_calls (NULL);
+
+	fake_dispatcher_release ();
+	_wait_for_calls (1);
+	_assert_calls ("Action connectivity-change:LIMITED", NULL);
+
+	fake_dispatcher_release ();
+	_wait_for_calls (1);
+	_assert_calls ("Action connectivity-change:NONE", NULL);
+
+	fake_dispatcher_release ();
+	_wait_for_calls (1);
+	_assert_calls ("Action connectivity-change:PORTAL", NULL);
+
+	fake_dispatcher_release ();
+	_wait_for_calls (0);
+	_assert_calls (NULL);
+
+	/* Once known, ActionBatch is not tried again. */
+	_call (NM_CONNECTIVITY_FULL);
+	_call (NM_CONNECTIVITY_NONE);
+	_wait_for_calls (1);
+	_assert_calls ("Action connectivity-change:FULL", NULL);
+
+	fake_dispatcher_release ();
+	_wait_for_calls (1);
+	_assert_calls ("Action connectivity-change:NONE", NULL);
+
+	fake_dispatcher_release ();
+	_wait_for_calls (0);
+	_assert_calls (NULL);
+}
+
+/*******************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_with_logging (&argc, &argv, NULL, "DEFAULT");
+
+	fake_dispatcher_start ();
+	nm_dispatcher_init ();
+
+	/* The tests depend on each other: once the dispatcher is found
+	 * not to know ActionBatch, it isn't tried again. */
+	g_test_add_func ("/dispatcher/batch", test_batch);
+	g_test_add_func ("/dispatcher/shutdown", test_shutdown);
+	g_test_add_func ("/dispatcher/fallback", test_fallback);
+
+	return g_test_run ();
+}
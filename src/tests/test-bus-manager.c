@@ -0,0 +1,261 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ */
+
+#include "nm-default.h"
+
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "nm-bus-manager.h"
+#include "nm-ip4-config.h"
+
+#include "nm-test-utils-core.h"
+
+/*******************************************/
+
+/* The objects are exported, but the bus manager has no connection. The
+ * PropertiesChanged signals are still emitted on the skeletons, and
+ * that is what the tests count. */
+
+typedef struct {
+	NMIP4Config *config;
+	GDBusInterface *interface;
+	gulong handler_id;
+	guint emitted;
+	guint emitted_at;
+} Obj;
+
+static struct {
+	guint emitted;
+	guint iteration;
+	guint changes;
+} props;
+
+static void
+_props_changed_cb (GDBusInterface *interface, GVariant *properties, Obj *obj)
+{
+	obj->emitted++;
+	obj->emitted_at = props.iteration;
+	props.emitted++;
+}
+
+static Obj *
+_objs_new (guint n)
+{
+	Obj *objs = g_new0 (Obj, n);
+	guint i;
+
+	memset (&props, 0, sizeof (props));
+
+	for (i = 0; i < n; i++) {
+		objs[i].config = nm_ip4_config_new (1);
+		nm_exported_object_export ((NMExportedObject *) objs[i].config);
+		objs[i].interface = g_dbus_object_get_interface ((GDBusObject *) objs[i].config,
+		                                                 NM_DBUS_INTERFACE_IP4_CONFIG);
+		g_assert (objs[i].interface);
+		objs[i].handler_id = g_signal_connect (objs[i].interface, "properties-changed",
+		                                       G_CALLBACK (_props_changed_cb), &objs[i]);
+	}
+	return objs;
+}
+
+static void
+_objs_change (Obj *objs, guint n)
+{
+	guint i;
+
+	/* a different gateway each time, so that the property changes. */
+	props.changes++;
+	for (i = 0; i < n; i++) {
+		nm_ip4_config_set_gateway (objs[i].config,
+		                           htonl (ntohl (nmtst_inet4_from_string ("192.0.2.0")) + props.changes));
+	}
+}
+
+static void
+_objs_free (Obj *objs, guint n)
+{
+	guint i;
+
+	for (i = 0; i < n; i++) {
+		g_signal_handler_disconnect (objs[i].interface, objs[i].handler_id);
+		g_object_unref (objs[i].interface);
+		if (nm_exported_object_is_exported ((NMExportedObject *) objs[i].config))
+			nm_exported_object_unexport ((NMExportedObject *) objs[i].config);
+		g_object_unref (objs[i].config);
+	}
+	g_free (objs);
+
+	nm_bus_manager_set_properties_changed_limits (nm_bus_manager_get (),
+	                                              NM_BUS_MANAGER_PROPERTIES_MAX_LATENCY_DEFAULT,
+	                                              NM_BUS_MANAGER_PROPERTIES_BATCH_SIZE_DEFAULT);
+}
+
+/* Keeps the main loop busy with a source of default priority, so that
+ * sources of default idle priority never run. */
+static gboolean
+_busy_cb (gpointer user_data)
+{
+	props.iteration++;
+	g_usleep (1000);
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+_iterate_until_emitted (guint n, guint timeout_msec)
+{
+	gint64 end = g_get_monotonic_time () + timeout_msec * 1000;
+
+	while (   props.emitted < n
+	       && g_get_monotonic_time () < end)
+		g_main_context_iteration (NULL, FALSE);
+}
+
+/*******************************************/
+
+static void
+test_batch_limit (void)
+{
+	Obj *objs;
+
+	nm_bus_manager_set_properties_changed_limits (nm_bus_manager_get (), 200, 2);
+
+	objs = _objs_new (5);
+	_objs_change (objs, 5);
+
+	/* Each flush emits at most 2 signals, in the order of scheduling. */
+	g_assert (g_main_context_iteration (NULL, FALSE));
+	g_assert_cmpint (props.emitted, ==, 2);
+	g_assert_cmpint (objs[0].emitted, ==, 1);
+	g_assert_cmpint (objs[1].emitted, ==, 1);
+	g_assert (g_main_context_iteration (NULL, FALSE));
+	g_assert_cmpint (props.emitted, ==, 4);
+	g_assert_cmpint (objs[4].emitted, ==, 0);
+	g_assert (g_main_context_iteration (NULL, FALSE));
+	g_assert_cmpint (props.emitted, ==, 5);
+	g_assert_cmpint (objs[4].emitted, ==, 1);
+
+	g_assert (!g_main_context_iteration (NULL, FALSE));
+	g_assert_cmpint (props.emitted, ==, 5);
+
+	_objs_free (objs, 5);
+}
+
+static void
+test_max_latency (void)
+{
+	Obj *objs;
+	guint busy_id;
+	gint64 start;
+
+	/* Without a timeout, nothing is emitted while the main loop is busy. */
+	nm_bus_manager_set_properties_changed_limits (nm_bus_manager_get (), 0, 0);
+
+	objs = _objs_new (3);
+	busy_id = g_idle_add_full (G_PRIORITY_DEFAULT, _busy_cb, NULL, NULL);
+	_objs_change (objs, 3);
+
+	_iterate_until_emitted (1, 100);
+	g_assert_cmpint (props.emitted, ==, 0);
+
+	/* Setting a timeout applies to the already scheduled objects. */
+	start = g_get_monotonic_time ();
+	nm_bus_manager_set_properties_changed_limits (nm_bus_manager_get (), 50, 0);
+
+	_iterate_until_emitted (3, 2000);
+	g_assert_cmpint (props.emitted, ==, 3);
+	g_assert_cmpint (g_get_monotonic_time () - start, >=, 50 * 1000);
+
+	nm_clear_g_source (&busy_id);
+	_objs_free (objs, 3);
+}
+
+static void
+test_max_latency_leftover (void)
+{
+	Obj *objs;
+	guint busy_id;
+
+	nm_bus_manager_set_properties_changed_limits (nm_bus_manager_get (), 50, 2);
+
+	objs = _objs_new (5);
+	busy_id = g_idle_add_full (G_PRIORITY_DEFAULT, _busy_cb, NULL, NULL);
+	_objs_change (objs, 5);
+
+	_iterate_until_emitted (5, 2000);
+	g_assert_cmpint (props.emitted, ==, 5);
+
+	/* The first batch is emitted after the timeout. The objects left over
+	 * are already overdue and don't wait for another timeout, but follow
+	 * in the next iterations, one batch per iteration. */
+	g_assert_cmpint (objs[0].emitted_at, ==, objs[1].emitted_at);
+	g_assert_cmpint (objs[2].emitted_at, ==, objs[3].emitted_at);
+	g_assert_cmpint (objs[4].emitted_at - objs[0].emitted_at, <=, 2);
+
+	nm_clear_g_source (&busy_id);
+	_objs_free (objs, 5);
+}
+
+static void
+test_cancel_on_unexport (void)
+{
+	Obj *objs;
+
+	nm_bus_manager_set_properties_changed_limits (nm_bus_manager_get (), 200, 0);
+
+	objs = _objs_new (3);
+	_objs_change (objs, 3);
+
+	/* The unexported object has no pending changes anymore. If it was
+	 * still queued, emitting would fail an assertion. */
+	nm_exported_object_unexport ((NMExportedObject *) objs[1].config);
+
+	while (g_main_context_iteration (NULL, FALSE)) {
+	}
+	g_assert_cmpint (props.emitted, ==, 2);
+	g_assert_cmpint (objs[0].emitted, ==, 1);
+	g_assert_cmpint (objs[1].emitted, ==, 0);
+	g_assert_cmpint (objs[2].emitted, ==, 1);
+
+	/* Unexporting the last scheduled object removes the sources. */
+	_objs_change (objs, 1);
+	nm_exported_object_unexport ((NMExportedObject *) objs[0].config);
+	g_assert (!g_main_context_iteration (NULL, FALSE));
+	g_assert_cmpint (props.emitted, ==, 2);
+
+	_objs_free (objs, 3);
+}
+
+/*******************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_with_logging (&argc, &argv, NULL, "DEFAULT");
+
+	g_test_add_func ("/bus-manager/properties-changed/batch-limit", test_batch_limit);
+	g_test_add_func ("/bus-manager/properties-changed/max-latency", test_max_latency);
+	g_test_add_func ("/bus-manager/properties-changed/max-latency-leftover", test_max_latency_leftover);
+	g_test_add_func ("/bus-manager/properties-changed/cancel-on-unexport", test_cancel_on_unexport);
+
+	return g_test_run ();
+}
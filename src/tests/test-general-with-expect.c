@@ -684,8 +684,9 @@ _mi_rebucket (GRand *rand, guint num_values, guint num_buckets, NMMultiIndexOper
 	NMMultiIndexTestValue *v;
 	NMMultiIndexIdTest id, id_old;
 	const NMMultiIndexIdTest *id_reverse;
-	guint64 buckets_old;
-	guint i;
+	const NMMultiIndexIdTest *const*ids_reverse;
+	guint64 buckets_old, buckets_reverse;
+	guint i, len;
 	gboolean had_bucket, had_bucket_old;
 
 	g_assert (array_idx < num_values);
@@ -760,6 +761,15 @@ _mi_rebucket (GRand *rand, guint num_values, guint num_buckets, NMMultiIndexOper
 	else
 		g_assert (v->buckets == 0);
 
+	ids_reverse = (const NMMultiIndexIdTest *const*) nm_multi_index_lookup_ids_by_value (index, v->ptr_value, &len);
+	g_assert ((len == 0 && !ids_reverse) || (len > 0 && ids_reverse && !ids_reverse[len]));
+	buckets_reverse = 0;
+	for (i = 0; i < len; i++) {
+		g_assert (!(buckets_reverse & (((guint64) 1) << ids_reverse[i]->bucket)));
+		buckets_reverse |= (((guint64) 1) << ids_reverse[i]->bucket);
+	}
+	g_assert (buckets_reverse == v->buckets);
+
 	for (i = 0; i < 64; i++) {
 		id.bucket = i;
 		if (nm_multi_index_contains (index, &id.id_base, v->ptr_value))
@@ -779,7 +789,8 @@ _mi_test_run (guint num_values, guint num_buckets)
 	NMMultiIndex *index = nm_multi_index_new ((NMMultiIndexFuncHash) _mi_idx_hash,
 	                                          (NMMultiIndexFuncEqual) _mi_idx_equal,
 	                                          (NMMultiIndexFuncClone) _mi_idx_clone,
-	                                          (NMMultiIndexFuncDestroy) _mi_idx_destroy);
+	                                          (NMMultiIndexFuncDestroy) _mi_idx_destroy,
+	                                          NULL);
 	gs_free NMMultiIndexTestValue *array = _mi_create_array (num_values);
 	GRand *rand = nmtst_get_rand ();
 	guint i, i_rd, i_idx, i_bucket;
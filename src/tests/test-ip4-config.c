@@ -322,6 +322,286 @@ test_strip_search_trailing_dot (void)
 	g_object_unref (config);
 }
 
+static void
+_fill_config (NMIP4Config *config, guint n, guint step)
+{
+	NMPlatformIP4Address addr;
+	NMPlatformIP4Route route;
+	guint i;
+
+	for (i = 0; i < n; i += step) {
+		memset (&addr, 0, sizeof (addr));
+		addr.address = htonl (0x0a000000u + i);
+		addr.peer_address = addr.address;
+		addr.plen = 32;
+		addr.lifetime = NM_PLATFORM_LIFETIME_PERMANENT;
+		addr.preferred = NM_PLATFORM_LIFETIME_PERMANENT;
+		nm_ip4_config_add_address (config, &addr);
+
+		memset (&route, 0, sizeof (route));
+		route.network = htonl (0x0b000000u + (i << 8));
+		route.plen = 24;
+		route.gateway = nmtst_inet4_from_string ("192.168.1.1");
+		route.metric = 100;
+		nm_ip4_config_add_route (config, &route);
+	}
+}
+
+static void
+test_many_entries (void)
+{
+	const guint n = 10000;
+	NMIP4Config *all, *even, *config;
+	gint64 time, start_time;
+	NMPlatformIP4Address addr;
+	NMPlatformIP4Route route;
+	guint i;
+
+	all = nm_ip4_config_new (1);
+	even = nm_ip4_config_new (1);
+
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+
+	_fill_config (all, n, 1);
+	_fill_config (even, n, 2);
+	g_assert_cmpuint (nm_ip4_config_get_num_addresses (all), ==, n);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (all), ==, n);
+
+	/* adding the same entries again doesn't duplicate them */
+	config = nm_ip4_config_new (1);
+	nm_ip4_config_merge (config, all, NM_IP_CONFIG_MERGE_DEFAULT);
+	nm_ip4_config_merge (config, even, NM_IP_CONFIG_MERGE_DEFAULT);
+	g_assert_cmpuint (nm_ip4_config_get_num_addresses (config), ==, n);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (config), ==, n);
+
+	nm_ip4_config_subtract (config, even);
+	g_assert_cmpuint (nm_ip4_config_get_num_addresses (config), ==, n / 2);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (config), ==, n / 2);
+	g_assert_cmpuint (nm_ip4_config_get_address (config, 0)->address, ==, htonl (0x0a000001u));
+
+	memset (&route, 0, sizeof (route));
+	route.network = htonl (0x0b000000u + (3 << 8));
+	route.plen = 24;
+	g_assert (nm_ip4_config_route_exists (config, &route));
+	route.network = htonl (0x0b000000u + (4 << 8));
+	g_assert (!nm_ip4_config_route_exists (config, &route));
+
+	nm_ip4_config_intersect (all, config);
+	g_assert_cmpuint (nm_ip4_config_get_num_addresses (all), ==, n / 2);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (all), ==, n / 2);
+
+	g_assert (!nm_ip4_config_replace (config, all, NULL));
+
+	/* removing entries other than the last keeps the index valid */
+	for (i = 1; i < 200; i += 2) {
+		memset (&addr, 0, sizeof (addr));
+		addr.address = htonl (0x0a000000u + i);
+		addr.peer_address = addr.address;
+		addr.plen = 32;
+		g_assert (nm_ip4_config_remove_address (all, &addr));
+		g_assert (!nm_ip4_config_address_exists (all, &addr));
+		addr.address = htonl (0x0a000000u + i + 2);
+		addr.peer_address = addr.address;
+		g_assert (nm_ip4_config_address_exists (all, &addr));
+	}
+	g_assert_cmpuint (nm_ip4_config_get_num_addresses (all), ==, n / 2 - 100);
+	g_assert_cmpuint (nm_ip4_config_get_address (all, 0)->address, ==, htonl (0x0a000000u + 201));
+	addr.address = htonl (0x0a000000u + n - 1);
+	addr.peer_address = addr.address;
+	g_assert (nm_ip4_config_address_exists (all, &addr));
+
+	time = nm_utils_get_monotonic_timestamp_ns () - start_time;
+	g_test_message ("ip4-config: merge, subtract, intersect and remove of %u entries in %ld.%09ld seconds",
+	                n, (long) (time / NM_UTILS_NS_PER_SECOND), (long) (time % NM_UTILS_NS_PER_SECOND));
+
+	g_object_unref (all);
+	g_object_unref (even);
+	g_object_unref (config);
+}
+
+/*******************************************/
+
+typedef struct {
+	/* what the kernel has */
+	NMIP4Config *platform;
+
+	/* updated by capturing the configuration anew */
+	NMIP4Config *ext_full;
+	GPtrArray *internal_full;
+
+	/* updated by applying the changes */
+	NMIP4Config *ext_delta;
+	GPtrArray *internal_delta;
+} ChangesData;
+
+static NMIP4Config *
+_config_clone (const NMIP4Config *src)
+{
+	NMIP4Config *dst;
+
+	dst = nm_ip4_config_new (nm_ip4_config_get_ifindex (src));
+	nm_ip4_config_replace (dst, src, NULL);
+	return dst;
+}
+
+static void
+_changes_capture (ChangesData *data)
+{
+	guint i;
+
+	/* like update_ip4_config() in nm-device.c */
+	g_clear_object (&data->ext_full);
+	data->ext_full = _config_clone (data->platform);
+	for (i = 0; i < data->internal_full->len; i++)
+		nm_ip4_config_intersect (data->internal_full->pdata[i], data->ext_full);
+	for (i = 0; i < data->internal_full->len; i++)
+		nm_ip4_config_subtract (data->ext_full, data->internal_full->pdata[i]);
+}
+
+static void
+_changes_resync (ChangesData *data)
+{
+	guint i;
+
+	nm_ip4_config_replace (data->ext_delta, data->ext_full, NULL);
+	for (i = 0; i < data->internal_full->len; i++)
+		nm_ip4_config_replace (data->internal_delta->pdata[i], data->internal_full->pdata[i], NULL);
+}
+
+static void
+_changes_assert_equal (ChangesData *data)
+{
+	guint i;
+
+	g_assert (nm_ip4_config_equal (data->ext_delta, data->ext_full));
+	for (i = 0; i < data->internal_full->len; i++)
+		g_assert (nm_ip4_config_equal (data->internal_delta->pdata[i], data->internal_full->pdata[i]));
+}
+
+static gboolean
+_changes_address (ChangesData *data, const NMPlatformIP4Address *address, gboolean removed)
+{
+	NMPlatformIP4Address a = *address;
+	gboolean applied;
+
+	if (removed)
+		nm_ip4_config_remove_address (data->platform, &a);
+	else
+		nm_ip4_config_replace_address (data->platform, &a);
+
+	applied = nm_ip4_config_apply_address_change (data->ext_delta, data->internal_delta, &a, removed);
+	_changes_capture (data);
+	if (!applied)
+		_changes_resync (data);
+	_changes_assert_equal (data);
+	return applied;
+}
+
+static gboolean
+_changes_route (ChangesData *data, const NMPlatformIP4Route *route, gboolean removed)
+{
+	NMPlatformIP4Route r = *route;
+	gboolean applied;
+
+	if (removed)
+		nm_ip4_config_remove_route (data->platform, &r);
+	else
+		nm_ip4_config_replace_route (data->platform, &r);
+
+	applied = nm_ip4_config_apply_route_change (data->ext_delta, data->internal_delta, &r, removed);
+	_changes_capture (data);
+	if (!applied)
+		_changes_resync (data);
+	_changes_assert_equal (data);
+	return applied;
+}
+
+static void
+test_apply_changes (void)
+{
+	ChangesData data = { NULL };
+	NMIP4Config *con, *dev;
+	NMPlatformIP4Address addr_a, addr_b, addr_c;
+	NMPlatformIP4Route route_1, route_2;
+	guint i;
+
+	addr_a = *nmtst_platform_ip4_address ("192.168.1.10", NULL, 24);
+	addr_b = *nmtst_platform_ip4_address ("192.168.2.10", NULL, 24);
+	addr_c = *nmtst_platform_ip4_address ("192.168.3.10", NULL, 24);
+	route_1 = *nmtst_platform_ip4_route_full ("10.0.0.0", 8, "192.168.1.1", 1, NM_IP_CONFIG_SOURCE_USER, 100, 0, 0, "0.0.0.0");
+	route_2 = *nmtst_platform_ip4_route_full ("172.16.0.0", 16, "192.168.3.1", 1, NM_IP_CONFIG_SOURCE_KERNEL, 100, 0, 0, "0.0.0.0");
+
+	/* the connection configures A and route 1, DHCP address B */
+	con = nm_ip4_config_new (1);
+	nm_ip4_config_add_address (con, &addr_a);
+	nm_ip4_config_add_route (con, &route_1);
+	nm_ip4_config_set_gateway (con, nmtst_inet4_from_string ("192.168.1.1"));
+	dev = nm_ip4_config_new (1);
+	nm_ip4_config_add_address (dev, &addr_b);
+
+	data.platform = nm_ip4_config_new (1);
+	nm_ip4_config_merge (data.platform, con, NM_IP_CONFIG_MERGE_DEFAULT);
+	nm_ip4_config_merge (data.platform, dev, NM_IP_CONFIG_MERGE_DEFAULT);
+
+	data.internal_full = g_ptr_array_new_with_free_func (g_object_unref);
+	g_ptr_array_add (data.internal_full, con);
+	g_ptr_array_add (data.internal_full, dev);
+	_changes_capture (&data);
+
+	data.ext_delta = _config_clone (data.ext_full);
+	data.internal_delta = g_ptr_array_new_with_free_func (g_object_unref);
+	for (i = 0; i < data.internal_full->len; i++)
+		g_ptr_array_add (data.internal_delta, _config_clone (data.internal_full->pdata[i]));
+	_changes_assert_equal (&data);
+
+	/* an external address is added and changes */
+	g_assert (_changes_address (&data, &addr_c, FALSE));
+	addr_c.lifetime = 3600;
+	addr_c.preferred = 1800;
+	g_assert (_changes_address (&data, &addr_c, FALSE));
+	g_assert_cmpint (nm_ip4_config_get_num_addresses (data.ext_delta), ==, 1);
+
+	/* an internal address changes */
+	addr_a.lifetime = 600;
+	g_assert (_changes_address (&data, &addr_a, FALSE));
+
+	/* an external route is added and changes */
+	g_assert (_changes_route (&data, &route_2, FALSE));
+	route_2.mss = 1400;
+	g_assert (_changes_route (&data, &route_2, FALSE));
+	g_assert_cmpint (nm_ip4_config_get_num_routes (data.ext_delta), ==, 1);
+
+	/* an internal route changes */
+	route_1.mss = 1400;
+	g_assert (_changes_route (&data, &route_1, FALSE));
+
+	/* another route to the same destination needs a capture */
+	route_2.metric = 200;
+	g_assert (!_changes_route (&data, &route_2, FALSE));
+	route_2.gateway = nmtst_inet4_from_string ("192.168.3.2");
+	g_assert (!_changes_route (&data, &route_2, FALSE));
+	route_1.metric = 200;
+	g_assert (!_changes_route (&data, &route_1, FALSE));
+
+	/* removing a route needs a capture */
+	g_assert (!_changes_route (&data, &route_2, TRUE));
+
+	/* the DHCP address goes away */
+	g_assert (_changes_address (&data, &addr_b, TRUE));
+	g_assert_cmpint (nm_ip4_config_get_num_addresses (data.internal_delta->pdata[1]), ==, 0);
+
+	/* the last external address goes away, and comes back */
+	g_assert (_changes_address (&data, &addr_c, TRUE));
+	g_assert_cmpint (nm_ip4_config_get_num_addresses (data.ext_delta), ==, 0);
+	g_assert (!_changes_address (&data, &addr_c, FALSE));
+
+	g_object_unref (data.platform);
+	g_object_unref (data.ext_full);
+	g_object_unref (data.ext_delta);
+	g_ptr_array_unref (data.internal_full);
+	g_ptr_array_unref (data.internal_delta);
+}
+
 /*******************************************/
 
 NMTST_DEFINE ();
@@ -337,6 +617,8 @@ main (int argc, char **argv)
 	g_test_add_func ("/ip4-config/add-route-with-source", test_add_route_with_source);
 	g_test_add_func ("/ip4-config/merge-subtract-mss-mtu", test_merge_subtract_mss_mtu);
 	g_test_add_func ("/ip4-config/strip-search-trailing-dot", test_strip_search_trailing_dot);
+	g_test_add_func ("/ip4-config/many-entries", test_many_entries);
+	g_test_add_func ("/ip4-config/apply-changes", test_apply_changes);
 
 	return g_test_run ();
 }